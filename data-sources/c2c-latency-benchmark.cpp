@@ -0,0 +1,305 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "sys-sage.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+/*! \file */
+
+////////////////////////////////////////////////////////////////////////
+//DEFAULT PARAMS (can be changed on the command line)
+#define REPEATS 5               //number of samples (CSV rows) per pair of Cores
+#define ITERATIONS 10000        //number of ping-pong round trips per sample
+#define WARMUP_ITERATIONS 1000  //round trips before the timed ones
+#define CACHE_LINE_SZ 64
+////////////////////////////////////////////////////////////////////////
+
+/// @private
+struct alignas(CACHE_LINE_SZ) c2c_line
+{
+    std::atomic<int> flag{0};
+    char padding[CACHE_LINE_SZ - sizeof(std::atomic<int>)];
+};
+
+/// @private
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/// @private
+static int pin_to_cpu(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/**
+Measures the one-way cache-line transfer latency between two HW threads.
+\n Thread x writes the shared cache line and waits until thread y answers; one round trip moves the line twice, so the result is the round-trip time divided by two.
+@param x_cpu - OS index of the first HW thread (Thread id)
+@param y_cpu - OS index of the second HW thread (Thread id)
+@param repeats - number of samples to take
+@param iterations - number of round trips per sample
+@return one latency value (ns) per sample; empty vector if pinning failed
+*/
+vector<float> measure_pair(int x_cpu, int y_cpu, int repeats, int iterations)
+{
+    vector<float> samples;
+    c2c_line line;
+    std::atomic<bool> pin_failed{false};
+    int total = WARMUP_ITERATIONS + iterations;
+
+    for(int r = 0; r < repeats; r++)
+    {
+        line.flag.store(0);
+        std::atomic<int> ready{0};
+        high_resolution_clock::time_point t_start, t_end;
+
+        //both threads get pinned first; the ping-pong starts only when both succeeded
+        auto pin_and_wait = [&](int cpu) -> bool {
+            if(pin_to_cpu(cpu) != 0)
+                pin_failed = true;
+            ready++;
+            while(ready.load() < 2)
+                cpu_relax();
+            return !pin_failed;
+        };
+
+        std::thread pong([&]() {
+            if(!pin_and_wait(y_cpu))
+                return;
+            for(int i = 0; i < total; i++)
+            {
+                int expected = 2*i + 1;
+                while(line.flag.load(std::memory_order_acquire) != expected)
+                    cpu_relax();
+                line.flag.store(expected + 1, std::memory_order_release);
+            }
+        });
+
+        std::thread ping([&]() {
+            if(!pin_and_wait(x_cpu))
+                return;
+            for(int i = 0; i < total; i++)
+            {
+                if(i == WARMUP_ITERATIONS)
+                    t_start = high_resolution_clock::now();
+                line.flag.store(2*i + 1, std::memory_order_release);
+                while(line.flag.load(std::memory_order_acquire) != 2*i + 2)
+                    cpu_relax();
+            }
+            t_end = high_resolution_clock::now();
+        });
+
+        ping.join();
+        pong.join();
+        if(pin_failed)
+            return vector<float>();
+
+        double elapsed = duration_cast<nanoseconds>(t_end - t_start).count();
+        samples.push_back((float)(elapsed / (2.0 * iterations)));
+    }
+    return samples;
+}
+
+/// @private
+//finds the lowest common ancestor of two components in the Component Tree
+Component* lowest_common_ancestor(Component* a, Component* b)
+{
+    std::set<Component*> ancestors;
+    for(Component* c = a; c != NULL; c = c->GetParent())
+        ancestors.insert(c);
+    for(Component* c = b; c != NULL; c = c->GetParent())
+        if(ancestors.count(c))
+            return c;
+    return NULL;
+}
+
+/// @private
+//builds a minimal Chip/Core/Thread tree of the CPUs this process may run on (used when no hwloc XML is provided)
+void build_topology_from_affinity(Node* n)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) != 0)
+        return;
+
+    auto read_sysfs_int = [](int cpu, string file) -> int {
+        std::ifstream f("/sys/devices/system/cpu/cpu" + to_string(cpu) + "/topology/" + file);
+        int val = -1;
+        if(f.good())
+            f >> val;
+        return val;
+    };
+
+    for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if(!CPU_ISSET(cpu, &set))
+            continue;
+        int package = std::max(read_sysfs_int(cpu, "physical_package_id"), 0);
+        int core_id = read_sysfs_int(cpu, "core_id");
+        if(core_id < 0)
+            core_id = cpu;
+
+        Component* socket = n->GetChildById(package);
+        if(socket == NULL)
+            socket = new Chip(n, package, "socket", SYS_SAGE_CHIP_TYPE_CPU_SOCKET);
+        Component* core = socket->GetChildById(core_id);
+        if(core == NULL)
+            core = new Core(socket, core_id);
+        new Thread(core, cpu, "HW_thread");
+    }
+}
+
+void usage(char* argv0)
+{
+    std::cerr << "usage: " << argv0 << " [-x hwloc_xml] [-r repeats] [-i iterations] [-p] [-o output_xml] > output_file.csv" << std::endl;
+    std::cerr << "  -x hwloc_xml   take the Cores and their HW threads from an hwloc XML; otherwise all CPUs in the affinity mask are used" << std::endl;
+    std::cerr << "  -r repeats     number of samples per pair of Cores, default " << REPEATS << std::endl;
+    std::cerr << "  -i iterations  number of ping-pong round trips per sample, default " << ITERATIONS << std::endl;
+    std::cerr << "  -p             measure only one representative pair per class of pairs (pairs with the same type and depth of the lowest common ancestor, e.g. same L3, cross-socket); other pairs take over its values" << std::endl;
+    std::cerr << "  -o output_xml  instead of printing cccbench CSV (xcore,ycore,xylat; Core ids) to stdout, store the topology with C2C DataPaths between the Cores to a sys-sage XML file" << std::endl;
+}
+
+/**
+Binary (entrypoint) of the cache-to-cache latency data source. For each pair of Cores, pins a pair of their HW threads (the first HW thread of each Core) and measures the latency of moving a cache line between them (ping-pong).
+\n The output is either in the cccbench CSV format with Core ids (parsed by parseCccbenchOutput, which looks the ids up among the Cores), or the measured values are stored directly as SYS_SAGE_DATAPATH_TYPE_C2C DataPaths between the Cores and exported to a sys-sage XML.
+\n usage: ./c2c-latency-benchmark [-x hwloc_xml] [-r repeats] [-i iterations] [-p] [-o output_xml]
+*/
+int main(int argc, char* argv[])
+{
+    string xmlPath, outputXml;
+    int repeats = REPEATS;
+    int iterations = ITERATIONS;
+    bool representative_only = false;
+
+    int opt;
+    while((opt = getopt(argc, argv, "x:r:i:po:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'x': xmlPath = optarg; break;
+            case 'r': repeats = stoi(optarg); break;
+            case 'i': iterations = stoi(optarg); break;
+            case 'p': representative_only = true; break;
+            case 'o': outputXml = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if(repeats < 1 || iterations < 1){
+        usage(argv[0]);
+        return 1;
+    }
+
+    Topology* topo = new Topology();
+    Node* n = new Node(topo, 0);
+    if(!xmlPath.empty()){
+        if(parseHwlocOutput(n, xmlPath) != 0){
+            std::cerr << "failed parsing hwloc output " << xmlPath << std::endl;
+            return 1;
+        }
+    }
+    else {
+        build_topology_from_affinity(n);
+    }
+
+    //one HW thread per Core: the data is per Core (as in cccbench), SMT siblings would only repeat it
+    vector<Component*> all_cores, cores;
+    n->GetAllSubcomponentsByType(&all_cores, SYS_SAGE_COMPONENT_CORE);
+    std::map<Component*, Component*> core_thread;
+    for(Component* c : all_cores)
+    {
+        Component* t = c->GetChildByType(SYS_SAGE_COMPONENT_THREAD);
+        if(t == NULL)
+            continue;
+        cores.push_back(c);
+        core_thread[c] = t;
+    }
+    std::cerr << "# cores: " << cores.size() << ", repeats: " << repeats << ", iterations: " << iterations << (representative_only ? ", representative pairs only" : "") << std::endl;
+    if(cores.size() < 2){
+        std::cerr << "at least 2 Cores with a HW thread are required" << std::endl;
+        return 1;
+    }
+
+    //class of a pair -> (component type, depth) of its lowest common ancestor; only the first pair of each class is measured
+    std::map<std::pair<int,int>, size_t> representative;
+    vector<std::tuple<Component*, Component*, vector<float>>> results;
+    for(Component* x : cores)
+    {
+        for(Component* y : cores)
+        {
+            if(x == y)
+                continue;
+            if(representative_only)
+            {
+                Component* lca = lowest_common_ancestor(x, y);
+                std::pair<int,int> pair_class(lca->GetComponentType(), lca->GetDepth(true));
+                auto it = representative.find(pair_class);
+                if(it != representative.end()){
+                    results.push_back({x, y, std::get<2>(results[it->second])});
+                    continue;
+                }
+                representative[pair_class] = results.size();
+                std::cerr << "    class " << lca->GetComponentTypeStr() << " (depth " << pair_class.second << ") represented by " << x->GetId() << " -> " << y->GetId() << std::endl;
+            }
+            Component* x_thread = core_thread[x];
+            Component* y_thread = core_thread[y];
+            vector<float> samples = measure_pair(x_thread->GetId(), y_thread->GetId(), repeats, iterations);
+            if(samples.empty())
+                std::cerr << "    could not pin threads " << x_thread->GetId() << " and " << y_thread->GetId() << " (cores " << x->GetId() << " and " << y->GetId() << "); skipping" << std::endl;
+            results.push_back({x, y, samples});
+        }
+    }
+
+    if(outputXml.empty())
+    {
+        std::cout << "xcore,ycore,xylat" << std::endl;
+        for(auto const& [x, y, samples] : results)
+            for(float lat : samples)
+                std::cout << x->GetId() << "," << y->GetId() << "," << lat << std::endl;
+    }
+    else
+    {
+        //same attributes as parseCccbenchOutput creates
+        for(auto const& [x, y, samples] : results)
+        {
+            if(samples.empty())
+                continue;
+            auto mean = new float(std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size());
+            auto max = new float(*std::max_element(samples.begin(), samples.end()));
+            auto min = new float(*std::min_element(samples.begin(), samples.end()));
+            DataPath* dp = new DataPath(x, y, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_C2C, 0, *mean);
+            dp->attrib.insert({"latency_max", (void*)max});
+            dp->attrib.insert({"latency_min", (void*)min});
+            dp->attrib.insert({"latency", (void*)mean});
+        }
+        exportToXml(topo, outputXml);
+    }
+
+    topo->Delete(true);
+    return 0;
+}
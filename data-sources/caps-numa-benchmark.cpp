@@ -8,6 +8,14 @@
 #include <thread>
 #include <sys/wait.h>
 #include <bitset>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <barrier>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 using namespace std::chrono;
@@ -20,6 +28,8 @@ using namespace std::chrono;
 #define CACHE_LINE_SZ 64
 #define TIMER_WARMUP 32
 #define TIMER_REPEATS 128
+#define SWEEP_REPEATS 5                 //repeats of each bandwidth kernel in the thread sweep; the best one is reported
+#define SWEEP_ARR_MB 512                //size of each array used by the thread sweep (can be changed with -m)
 
 //#define MEASURE_EACH_CPU
 ////////////////////////////////////////////////////////////////////////
@@ -37,16 +47,220 @@ struct numa_region
 
     uint64_t latency_time;
     uint64_t bw_time;
+
+    vector<double> sweep_bw; //[kernel][thread count] in MB/s
 } ;
 
-void fill_arr(uint64_t * arr, int num_elems)
+void fill_arr(uint64_t * arr, size_t num_elems)
 {
-    for(int i=0; i<num_elems; i++)
+    for(size_t i=0; i<num_elems; i++)
     {
         arr[i] = i;
     }
 }
 
+//bandwidth kernels of the thread sweep; each thread works on its chunk [begin, end) of the arrays
+enum sweep_kernel { KERNEL_READ, KERNEL_WRITE, KERNEL_COPY, NUM_KERNELS };
+const char* kernel_names[NUM_KERNELS] = {"read", "write", "copy"};
+enum simd_isa { ISA_SCALAR, ISA_AVX2, ISA_AVX512 };
+const char* isa_names[] = {"scalar", "avx2", "avx512"};
+
+struct sweep_params
+{
+    bool enabled = true;
+    vector<int> thread_counts; //empty -> 1,2,4,... up to the number of CPUs of the source NUMA node
+    long long arrsz = (long long)SWEEP_ARR_MB << 20;
+    simd_isa isa = ISA_SCALAR;
+} sweep;
+
+volatile uint64_t sink; //keeps the read loops from being optimized away
+
+void read_scalar(uint64_t* a, uint64_t*, size_t begin, size_t end)
+{
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for(size_t i = begin; i < end; i += 4){
+        s0 += a[i]; s1 += a[i+1]; s2 += a[i+2]; s3 += a[i+3];
+    }
+    sink = s0 + s1 + s2 + s3;
+}
+void write_scalar(uint64_t* a, uint64_t*, size_t begin, size_t end)
+{
+    for(size_t i = begin; i < end; i++)
+        a[i] = i;
+}
+void copy_scalar(uint64_t* a, uint64_t* b, size_t begin, size_t end)
+{
+    for(size_t i = begin; i < end; i++)
+        b[i] = a[i];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) void read_avx2(uint64_t* a, uint64_t*, size_t begin, size_t end)
+{
+    __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+    for(size_t i = begin; i < end; i += 8){
+        s0 = _mm256_add_epi64(s0, _mm256_load_si256((__m256i*)&a[i]));
+        s1 = _mm256_add_epi64(s1, _mm256_load_si256((__m256i*)&a[i+4]));
+    }
+    uint64_t r[4];
+    _mm256_storeu_si256((__m256i*)r, _mm256_add_epi64(s0, s1));
+    sink = r[0] + r[1] + r[2] + r[3];
+}
+__attribute__((target("avx2"))) void write_avx2(uint64_t* a, uint64_t*, size_t begin, size_t end)
+{
+    __m256i v = _mm256_set1_epi64x(begin);
+    for(size_t i = begin; i < end; i += 4)
+        _mm256_store_si256((__m256i*)&a[i], v);
+}
+__attribute__((target("avx2"))) void copy_avx2(uint64_t* a, uint64_t* b, size_t begin, size_t end)
+{
+    for(size_t i = begin; i < end; i += 4)
+        _mm256_store_si256((__m256i*)&b[i], _mm256_load_si256((__m256i*)&a[i]));
+}
+__attribute__((target("avx512f"))) void read_avx512(uint64_t* a, uint64_t*, size_t begin, size_t end)
+{
+    __m512i s0 = _mm512_setzero_si512(), s1 = _mm512_setzero_si512();
+    for(size_t i = begin; i < end; i += 16){
+        s0 = _mm512_add_epi64(s0, _mm512_load_si512(&a[i]));
+        s1 = _mm512_add_epi64(s1, _mm512_load_si512(&a[i+8]));
+    }
+    uint64_t r[8];
+    _mm512_storeu_si512(r, _mm512_add_epi64(s0, s1));
+    sink = r[0] + r[1] + r[2] + r[3] + r[4] + r[5] + r[6] + r[7];
+}
+__attribute__((target("avx512f"))) void write_avx512(uint64_t* a, uint64_t*, size_t begin, size_t end)
+{
+    __m512i v = _mm512_set1_epi64(begin);
+    for(size_t i = begin; i < end; i += 8)
+        _mm512_store_si512(&a[i], v);
+}
+__attribute__((target("avx512f"))) void copy_avx512(uint64_t* a, uint64_t* b, size_t begin, size_t end)
+{
+    for(size_t i = begin; i < end; i += 8)
+        _mm512_store_si512(&b[i], _mm512_load_si512(&a[i]));
+}
+#endif
+
+typedef void (*kernel_fcn)(uint64_t*, uint64_t*, size_t, size_t);
+
+kernel_fcn get_kernel(sweep_kernel k, simd_isa isa)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if(isa == ISA_AVX512)
+        return k == KERNEL_READ ? read_avx512 : k == KERNEL_WRITE ? write_avx512 : copy_avx512;
+    if(isa == ISA_AVX2)
+        return k == KERNEL_READ ? read_avx2 : k == KERNEL_WRITE ? write_avx2 : copy_avx2;
+#endif
+    return k == KERNEL_READ ? read_scalar : k == KERNEL_WRITE ? write_scalar : copy_scalar;
+}
+
+simd_isa detect_isa()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+        return ISA_AVX512;
+    if(__builtin_cpu_supports("avx2"))
+        return ISA_AVX2;
+#endif
+    return ISA_SCALAR;
+}
+
+vector<int> get_node_cpus(int numa_node)
+{
+    vector<int> cpus;
+    struct bitmask* mask = numa_allocate_cpumask();
+    if(numa_node_to_cpus(numa_node, mask) == 0)
+        for(unsigned int cpu = 0; cpu < mask->size; cpu++)
+            if(numa_bitmask_isbitset(mask, cpu))
+                cpus.push_back(cpu);
+    numa_free_cpumask(mask);
+    return cpus;
+}
+
+vector<int> get_thread_counts(int max_threads)
+{
+    vector<int> counts;
+    if(!sweep.thread_counts.empty()){
+        for(int t : sweep.thread_counts)
+            if(t <= max_threads)
+                counts.push_back(t);
+        return counts;
+    }
+    for(int t = 1; t < max_threads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(max_threads);
+    return counts;
+}
+
+/**
+Runs one kernel with num_threads threads pinned to the CPUs src_cpus (one thread per CPU); arrays a and b are split into equal chunks.
+@return bandwidth in MB/s (best of SWEEP_REPEATS); the copy kernel counts both the read and the written bytes
+*/
+double run_kernel(sweep_kernel k, uint64_t* a, uint64_t* b, size_t num_elems, const vector<int>& src_cpus, int num_threads)
+{
+    kernel_fcn fcn = get_kernel(k, sweep.isa);
+    size_t chunk = (num_elems / num_threads) & ~(size_t)15; //whole cache lines, aligned for AVX-512
+    high_resolution_clock::time_point t_start;
+    double best = 0;
+    std::barrier sync(num_threads + 1);
+
+    vector<std::thread> threads;
+    for(int t = 0; t < num_threads; t++)
+    {
+        threads.emplace_back([&, t]() {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(src_cpus[t], &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            fcn(a, b, t*chunk, (t+1)*chunk); //first touch/warmup
+            for(int r = 0; r < SWEEP_REPEATS; r++)
+            {
+                sync.arrive_and_wait();
+                fcn(a, b, t*chunk, (t+1)*chunk);
+                sync.arrive_and_wait();
+            }
+        });
+    }
+    for(int r = 0; r < SWEEP_REPEATS; r++)
+    {
+        sync.arrive_and_wait();
+        t_start = high_resolution_clock::now();
+        sync.arrive_and_wait();
+        double us = duration_cast<nanoseconds>(high_resolution_clock::now() - t_start).count() / 1000.0;
+        double bytes = (double)chunk * num_threads * sizeof(uint64_t) * (k == KERNEL_COPY ? 2 : 1);
+        best = std::max(best, bytes / us); //B/us == MB/s
+    }
+    for(std::thread& th : threads)
+        th.join();
+    return best;
+}
+
+/**
+Measures the read, write and copy bandwidth from the CPUs of src_numa to memory of target_numa for each thread count of the sweep.
+*/
+vector<double> run_sweep(int src_numa, int target_numa, long long max_arrsz, const vector<int>& thread_counts)
+{
+    vector<double> bw;
+    vector<int> src_cpus = get_node_cpus(src_numa);
+    long long arrsz = std::min(sweep.arrsz, max_arrsz);
+    size_t num_elems = arrsz / sizeof(uint64_t);
+    uint64_t* a = (uint64_t*)numa_alloc_onnode(arrsz, target_numa);
+    uint64_t* b = (uint64_t*)numa_alloc_onnode(arrsz, target_numa);
+    if(a == NULL || b == NULL)
+        errExit("numa_alloc_onnode");
+    fill_arr(a, num_elems);
+    fill_arr(b, num_elems);
+
+    for(int k = 0; k < NUM_KERNELS; k++)
+        for(int t : thread_counts)
+            bw.push_back(run_kernel((sweep_kernel)k, a, b, num_elems, src_cpus, t));
+
+    numa_free(a, arrsz);
+    numa_free(b, arrsz);
+    return bw;
+}
+
 uint64_t get_timer_overhead(int repeats, int warmup)
 {
     high_resolution_clock::time_point t_start, t_end;
@@ -73,7 +287,7 @@ uint64_t get_timer_overhead(int repeats, int warmup)
 }
 
 
-int run_measurement(unsigned int src_cpu, unsigned int src_numa, int numa_nodes)
+int run_measurement(unsigned int src_cpu, unsigned int src_numa, int numa_nodes, const vector<int>& thread_counts)
 {
     uint64_t *arr, *mock_arr;
     high_resolution_clock::time_point t_start, t_end;
@@ -134,6 +348,7 @@ if(round == 0) cerr << "    numa" << n << ": mem_sz[mb] "<< numa[n].numa_mem_sz/
                 sum+=arr[i];
             }
             t_end = high_resolution_clock::now();
+            sink = sum;
             numa[n].bw_time += t_end.time_since_epoch().count()-t_start.time_since_epoch().count()-numa[n].timer_overhead;
 
             numa_free(mock_arr, numa[n].arrsz);
@@ -142,6 +357,17 @@ if(round == 0) cerr << "    numa" << n << ": mem_sz[mb] "<< numa[n].numa_mem_sz/
         //cerr << round+1 << "/" << REPEATS << " done" << endl;
     } //cerr << endl << endl;
 
+    if(sweep.enabled)
+    {
+        for(int n=0; n<numa_nodes; n++)
+        {
+            if(numa[n].numa_mem_sz == 0)
+                continue;
+            numa[n].sweep_bw = run_sweep(src_numa, n, numa[n].arrsz, thread_counts);
+            cerr << "    sweep numa" << src_numa << " -> numa" << n << " done" << endl;
+        }
+    }
+
     for(int n=0; n<numa_nodes; n++)
     {
         if(numa[n].numa_mem_sz == 0)
@@ -151,15 +377,26 @@ if(round == 0) cerr << "    numa" << n << ": mem_sz[mb] "<< numa[n].numa_mem_sz/
         #else
             cout << src_numa;
         #endif
-        cout << "; " << n << "; " << numa[n].numa_mem_sz << "; " << numa[n].arrsz << "; " << numa[n].timer_overhead << "; " << numa[n].latency_time/(REPEATS*LATENCY_REPEATS) << "; " << numa[n].arrsz/((numa[n].bw_time/REPEATS)/1000) << endl;
+        cout << "; " << n << "; " << numa[n].numa_mem_sz << "; " << numa[n].arrsz << "; " << numa[n].timer_overhead << "; " << numa[n].latency_time/(REPEATS*LATENCY_REPEATS) << "; " << numa[n].arrsz/((numa[n].bw_time/REPEATS)/1000);
+        for(double bw : numa[n].sweep_bw)
+            cout << "; " << (uint64_t)bw;
+        cout << endl;
     }
     delete[] numa;
     return 0;
 }
 
+void usage()
+{
+    std::cerr << "usage: ./caps-numa-benchmark [-t thread_counts] [-m array_size_mb] [-i scalar|avx2|avx512] [-n] > output_file.csv     (otherwise, stdout gets mixed with stderr debug ouput)" << std::endl;
+    std::cerr << "  -t thread_counts  comma-separated thread counts of the bandwidth sweep; default: 1,2,4,... up to the number of CPUs of a NUMA node" << std::endl;
+    std::cerr << "  -m array_size_mb  size of each array of the bandwidth sweep (at most 1/" << MAIN_MEM_FRACTION << " of the NUMA node memory), default " << SWEEP_ARR_MB << std::endl;
+    std::cerr << "  -i isa            instruction set of the sweep kernels; default: the widest one supported by the CPU" << std::endl;
+    std::cerr << "  -n                no bandwidth sweep; only the single-threaded latency and bandwidth" << std::endl;
+    std::cerr << "  params: MEASURE_EACH_CPU, REPEATS, LATENCY_REPEATS, MAIN_MEM_FRACTION, CACHE_LINE_SZ, TIMER_WARMUP, TIMER_REPEATS, SWEEP_REPEATS can be set only in the source code" << std::endl;
+}
+
 void run_caps_numa_benchmark() {
-    std::cerr << "usage: ./caps-numa-benchmark > output_file.csv     (otherwise, stdout gets mixed with stderr debug ouput)" << std::endl;
-    std::cerr << "  params: MEASURE_EACH_CPU, REPEATS, LATENCY_REPEATS, MAIN_MEM_FRACTION, CACHE_LINE_SZ, TIMER_WARMUP, TIMER_REPEATS can be set only in the source code (will be improved)" << std::endl;
 
     cpu_set_t set;
     unsigned int this_cpu, this_numa;
@@ -175,13 +412,35 @@ void run_caps_numa_benchmark() {
     int numa_nodes = numa_num_configured_nodes();
     const auto cpu_count = std::thread::hardware_concurrency();
     std::cerr << "# hw threads: " << cpu_count << ", numa nodes: " << numa_nodes << std::endl;
+
+    //the same thread counts are used for all source NUMA nodes, so they are limited by the smallest one
+    vector<int> thread_counts;
+    if(sweep.enabled)
+    {
+        int max_threads = cpu_count;
+        for(int n=0; n<numa_nodes; n++)
+        {
+            int node_cpus = get_node_cpus(n).size();
+            if(node_cpus > 0)
+                max_threads = std::min(max_threads, node_cpus);
+        }
+        thread_counts = get_thread_counts(max_threads);
+        std::cerr << "# bandwidth sweep: isa " << isa_names[sweep.isa] << ", array size[mb] " << (sweep.arrsz>>20) << ", threads";
+        for(int t : thread_counts)
+            std::cerr << " " << t;
+        std::cerr << std::endl;
+    }
     std::cerr << "################################" << std::endl;
     #ifdef MEASURE_EACH_CPU
     std::cout << "src_cpu;";
     #else
     std::cout << "src_numa;";
     #endif
-    std::cout << "target_numa;mem_size;arrsz;timer_ovh;ldlat(ns);bw(MB/s);" << std::endl;
+    std::cout << "target_numa;mem_size;arrsz;timer_ovh;ldlat(ns);bw(MB/s);";
+    for(int k = 0; k < NUM_KERNELS; k++)
+        for(int t : thread_counts)
+            std::cout << "bw_" << kernel_names[k] << "_" << t << "t(MB/s);";
+    std::cout << std::endl;
 
     unsigned long long mask_checked_component = 0; //each bit is one numa region/one HW thread
     for (unsigned int current_cpu = 0; current_cpu < cpu_count; current_cpu++)
@@ -204,12 +463,43 @@ void run_caps_numa_benchmark() {
         if ((mask_checked_component & (1 << mask_bit)) == 0)
         {
             mask_checked_component += (1 << mask_bit); //je jen v child process
-            run_measurement(this_cpu, this_numa, numa_nodes);
+            run_measurement(this_cpu, this_numa, numa_nodes, thread_counts);
         }
     }
 }
 
 int main(int argc, char* argv[]) {
+    sweep.isa = detect_isa();
+    int opt;
+    while((opt = getopt(argc, argv, "t:m:i:nh")) != -1)
+    {
+        switch(opt)
+        {
+            case 't': {
+                std::stringstream ss(optarg);
+                string t;
+                while(getline(ss, t, ','))
+                    if(stoi(t) > 0)
+                        sweep.thread_counts.push_back(stoi(t));
+                break;
+            }
+            case 'm': sweep.arrsz = stoll(optarg) << 20; break;
+            case 'i': {
+                string isa = optarg;
+                simd_isa requested = isa == "avx512" ? ISA_AVX512 : isa == "avx2" ? ISA_AVX2 : ISA_SCALAR;
+                if(requested > detect_isa())
+                    std::cerr << "isa " << isa << " not supported by this CPU; using " << isa_names[sweep.isa] << std::endl;
+                else
+                    sweep.isa = requested;
+                break;
+            }
+            case 'n': sweep.enabled = false; break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    usage();
     run_caps_numa_benchmark();
     return 0;
 }
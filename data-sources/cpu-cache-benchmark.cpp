@@ -0,0 +1,231 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+#include <sched.h>
+
+#include "sys-sage.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+/*! \file */
+
+////////////////////////////////////////////////////////////////////////
+//DEFAULT PARAMS (can be changed on the command line)
+#define REPEATS 5                   //number of measurements per cache level; the minimum latency and maximum bandwidth are reported
+#define LATENCY_STEPS (1<<22)       //number of dependent loads per latency measurement
+#define BW_BYTES (1ll<<31)          //number of bytes read per bandwidth measurement (the working set is read repeatedly)
+#define CACHE_LINE_SZ 64            //used if the Cache component has no cache line size
+////////////////////////////////////////////////////////////////////////
+
+/// @private
+//prevents the compiler from optimizing away the benchmark loops
+volatile uint64_t sink;
+
+/**
+Pointer-chasing load latency: the working set is split into cache lines which are linked in a random cyclic order, so that each load depends on the previous one and the hardware prefetchers cannot help.
+@return average latency of one load in ns
+*/
+double measure_latency(size_t ws_size, int line_size, int repeats)
+{
+    size_t num_lines = std::max<size_t>(ws_size / line_size, 2);
+    size_t stride = line_size / sizeof(void*);
+    void** arr = (void**)aligned_alloc(line_size, num_lines * line_size);
+
+    vector<size_t> order(num_lines);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin() + 1, order.end(), std::mt19937_64(42));
+    for(size_t i = 0; i < num_lines; i++)
+        arr[order[i] * stride] = (void*)&arr[order[(i + 1) % num_lines] * stride];
+
+    double best = -1;
+    for(int r = 0; r < repeats; r++)
+    {
+        void** p = arr;
+        for(size_t i = 0; i < num_lines; i++) //warm up the cache level
+            p = (void**)*p;
+
+        auto t_start = high_resolution_clock::now();
+        for(long i = 0; i < LATENCY_STEPS; i++)
+            p = (void**)*p;
+        auto t_end = high_resolution_clock::now();
+        sink = (uint64_t)p;
+
+        double lat = duration_cast<nanoseconds>(t_end - t_start).count() / (double)LATENCY_STEPS;
+        if(best < 0 || lat < best)
+            best = lat;
+    }
+    free(arr);
+    return best;
+}
+
+/**
+Streaming-read bandwidth: the working set is read sequentially (several independent accumulators) until BW_BYTES were read.
+@return read bandwidth in MB/s
+*/
+double measure_bandwidth(size_t ws_size, int repeats)
+{
+    size_t num_elems = std::max<size_t>(ws_size / sizeof(uint64_t), 8) & ~(size_t)7;
+    uint64_t* arr = (uint64_t*)aligned_alloc(CACHE_LINE_SZ, num_elems * sizeof(uint64_t) + CACHE_LINE_SZ);
+    for(size_t i = 0; i < num_elems; i++)
+        arr[i] = i;
+    long passes = std::max<long>(BW_BYTES / (num_elems * sizeof(uint64_t)), 1);
+
+    double best = 0;
+    for(int r = 0; r < repeats; r++)
+    {
+        uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        auto t_start = high_resolution_clock::now();
+        for(long pass = 0; pass < passes; pass++)
+        {
+            for(size_t i = 0; i < num_elems; i += 4)
+            {
+                s0 += arr[i];
+                s1 += arr[i+1];
+                s2 += arr[i+2];
+                s3 += arr[i+3];
+            }
+        }
+        auto t_end = high_resolution_clock::now();
+        sink = s0 + s1 + s2 + s3;
+
+        double us = duration_cast<nanoseconds>(t_end - t_start).count() / 1000.0;
+        double bw = (double)passes * num_elems * sizeof(uint64_t) / us; //B/us == MB/s
+        if(bw > best)
+            best = bw;
+    }
+    free(arr);
+    return best;
+}
+
+/**
+Retrieves the Cache ancestors of a Thread, ordered from the closest (L1) to the farthest (LLC).
+*/
+vector<Cache*> get_cache_hierarchy(Component* thread)
+{
+    vector<Cache*> caches;
+    for(Component* c = thread->GetParent(); c != NULL; c = c->GetParent())
+        if(c->GetComponentType() == SYS_SAGE_COMPONENT_CACHE && ((Cache*)c)->GetCacheSize() > 0)
+            caches.push_back((Cache*)c);
+    return caches;
+}
+
+void usage(char* argv0)
+{
+    std::cerr << "usage: " << argv0 << " -x hwloc_xml [-t thread_id[,thread_id...]] [-a] [-r repeats] [-o output_xml] > output_file.csv" << std::endl;
+    std::cerr << "  -x hwloc_xml   topology with the Cache components (their sizes define the working sets)" << std::endl;
+    std::cerr << "  -t thread_ids  HW threads (Thread ids) to measure from; default: the first HW thread of each Chip" << std::endl;
+    std::cerr << "  -a             measure from all HW threads" << std::endl;
+    std::cerr << "  -r repeats     number of measurements per cache level, default " << REPEATS << std::endl;
+    std::cerr << "  -o output_xml  instead of printing CSV to stdout, store the topology with the Thread->Cache DataPaths to a sys-sage XML file" << std::endl;
+}
+
+/**
+Binary (entrypoint) of the CPU cache latency and bandwidth data source.
+\n For each selected HW thread (the process is pinned to it), each Cache above the thread in the Component Tree is measured with a working set sized between the previous cache level and this one ((size of previous level + size of this level)/2, i.e. half of L1 for L1).
+\n The output is a CSV (thread;cache_id;cache_level;ws_size;ldlat(ns);bw(MB/s);), which is parsed by parseCpuCacheBenchmark. Alternatively, the DataPaths are created directly and the topology is exported to a sys-sage XML.
+\n usage: ./cpu-cache-benchmark -x hwloc_xml [-t thread_ids] [-a] [-r repeats] [-o output_xml]
+*/
+int main(int argc, char* argv[])
+{
+    string xmlPath, outputXml, threadList;
+    bool all_threads = false;
+    int repeats = REPEATS;
+
+    int opt;
+    while((opt = getopt(argc, argv, "x:t:ar:o:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'x': xmlPath = optarg; break;
+            case 't': threadList = optarg; break;
+            case 'a': all_threads = true; break;
+            case 'r': repeats = stoi(optarg); break;
+            case 'o': outputXml = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if(xmlPath.empty() || repeats < 1){
+        usage(argv[0]);
+        return 1;
+    }
+
+    Topology* topo = new Topology();
+    Node* n = new Node(topo, 0);
+    if(parseHwlocOutput(n, xmlPath) != 0){
+        std::cerr << "failed parsing hwloc output " << xmlPath << std::endl;
+        return 1;
+    }
+
+    vector<Component*> threads;
+    if(!threadList.empty()){
+        std::stringstream ss(threadList);
+        string id;
+        while(getline(ss, id, ',')){
+            Component* t = n->GetSubcomponentById(stoi(id), SYS_SAGE_COMPONENT_THREAD);
+            if(t == NULL)
+                std::cerr << "HW thread " << id << " not found in the topology; skipping" << std::endl;
+            else
+                threads.push_back(t);
+        }
+    }
+    else if(all_threads){
+        n->GetAllSubcomponentsByType(&threads, SYS_SAGE_COMPONENT_THREAD);
+    }
+    else{
+        for(Component* chip : n->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_CHIP)){
+            vector<Component*> chip_threads = chip->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD);
+            if(!chip_threads.empty())
+                threads.push_back(chip_threads.front());
+        }
+    }
+
+    if(outputXml.empty())
+        std::cout << "thread;cache_id;cache_level;ws_size;ldlat(ns);bw(MB/s);" << std::endl;
+    for(Component* t : threads)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(t->GetId(), &set);
+        if(sched_setaffinity(getpid(), sizeof(set), &set) == -1){
+            std::cerr << "could not pin to HW thread " << t->GetId() << "; skipping" << std::endl;
+            continue;
+        }
+
+        long long prev_size = 0;
+        for(Cache* c : get_cache_hierarchy(t))
+        {
+            size_t ws_size = (prev_size + c->GetCacheSize()) / 2;
+            prev_size = c->GetCacheSize();
+            int line_size = c->GetCacheLineSize() > 0 ? c->GetCacheLineSize() : CACHE_LINE_SZ;
+
+            double ldlat = measure_latency(ws_size, line_size, repeats);
+            double bw = measure_bandwidth(ws_size, repeats);
+            std::cerr << "    thread " << t->GetId() << " L" << c->GetCacheLevel() << " (id " << c->GetId() << "): ws " << ws_size << " B, " << ldlat << " ns, " << bw << " MB/s" << std::endl;
+            if(outputXml.empty()){
+                std::cout << t->GetId() << ";" << c->GetId() << ";" << c->GetCacheLevel() << ";" << ws_size << ";" << ldlat << ";" << bw << ";" << std::endl;
+            }
+            else{
+                //same DataPath and attributes as parseCpuCacheBenchmark creates
+                DataPath* dp = new DataPath(t, c, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_DATATRANSFER, bw, ldlat);
+                dp->attrib.insert({"working_set_size", (void*) new long long(ws_size)});
+            }
+        }
+    }
+
+    if(!outputXml.empty())
+        exportToXml(topo, outputXml);
+
+    topo->Delete(true);
+    return 0;
+}
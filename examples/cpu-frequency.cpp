@@ -2,6 +2,7 @@
 #include <filesystem>
 #include <unistd.h>
 #include <tuple>
+#include <chrono>
 
 #include "sys-sage.hpp"
 
@@ -53,7 +54,7 @@ int main(int argc, char *argv[])
     }
 
     cout << "-- Refresh frequency on all cores of Node 1(and store the timestamp). " << endl;
-    //Frequency gets stored in attrib freq_history (value of type std::vector<std::tuple<long long=timestamp,double=frequency in MHz>>)
+    //Frequency gets stored in attrib freq_history (value of type TimeSeries* of <long long=timestamp,double=frequency in MHz>, bounded to the last SYS_SAGE_TIMESERIES_DEFAULT_CAPACITY samples)
     int repeat = 10;
     for(int i = 0; i<repeat; i++)
     {
@@ -62,11 +63,35 @@ int main(int argc, char *argv[])
     }
 
     cout << "-- Print out frequency history on core 1 of Node 1. " << endl;
-    std::vector<std::tuple<long long,double>>* fh = (std::vector<std::tuple<long long,double>>*)c1->attrib["freq_history"];
-    for(auto [ ts,freq ] : *fh)
+    TimeSeries* fh = (TimeSeries*)c1->attrib["freq_history"];
+    for(auto [ ts,freq ] : fh->GetSamples())
     {
         cout << "    ts: " << ts << " frequency[MHz]: " << freq << endl;
     }
+    cout << "    last 0.5 s: min " << fh->Min(0.5) << " max " << fh->Max(0.5) << " mean " << fh->Mean(0.5) << " median " << fh->Percentile(50, 0.5) << " [MHz]" << endl;
+
+    cout << "-- Compare the time of one refresh of all cores: /proc/cpuinfo vs. cpufreq sysfs (file descriptors kept open between the refreshes). " << endl;
+    n->RefreshCpuCoreFrequency(false, SYS_SAGE_FREQ_SOURCE_CPUFREQ); //opens the files
+    for(int source : {SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO, SYS_SAGE_FREQ_SOURCE_CPUFREQ})
+    {
+        auto t_start = std::chrono::high_resolution_clock::now();
+        n->RefreshCpuCoreFrequency(false, source);
+        auto t_end = std::chrono::high_resolution_clock::now();
+        cout << "    " << (source == SYS_SAGE_FREQ_SOURCE_CPUFREQ ? "cpufreq sysfs: " : "/proc/cpuinfo: ") << std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_start).count() << " us" << endl;
+    }
+
+    cout << "-- Refresh the frequency every 100 ms on a background thread; the reads do not wait for /proc/cpuinfo. " << endl;
+    RefreshScheduler sched;
+    int freq_src = sched.AddCpuFrequencySource(n, std::chrono::milliseconds(100), true);
+    sched.Start();
+    for(int i = 0; i<repeat; i++)
+    {
+        sched.WaitForNextSample(freq_src);
+        std::shared_lock<std::shared_mutex> lock(sched.GetTopologyLock());
+        if(c1 != NULL)
+            cout << "    core 1 frequency[MHz]: " << c1->GetFreq() << endl;
+    }
+    sched.Stop();
 
     cout << "-- Export all information to xml " << output_name << endl;
     exportToXml(topo, output_name);
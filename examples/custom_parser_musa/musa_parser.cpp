@@ -24,61 +24,16 @@ MusaParser::MusaParser(Chip* _socket, std::string _datapath) {
     socket = _socket;
 }
 
-std::ostream& operator<<(std::ostream& output, std::map<std::string, double>& map) {
-	std::map<std::string, double>::iterator that = map.begin();
-
-
-	// Iterate through the map and print the elements
-	while (that != map.end())
-	{
-		output << "Key: " << that->first << ", Value: " << that->second << std::endl;
-		++that;
-	}
-	return output;
-}
-
-int MusaParser::ReadData(std::vector<std::string> search) {
-	std::ifstream myfile(datapath);
-	if (!myfile.good()) {
-		std::cout << " Couldn't open data source path " << datapath << std::endl;
-		return 1;
-	}
-	std::string line, subline, word;
-	int offset;
-	std::string value;
-	for (const auto & element : search) {
-		myfile.clear();
-		myfile.seekg(0, myfile.beg);
-		while (!myfile.eof()) {
-			std::getline(myfile, line);
-			if ((offset = line.find(element, 0) != std::string::npos)) {
-				std::map<std::string, std::string> input;
-				do {
-					std::getline(myfile, subline);
-					subline.erase(remove(subline.begin(), subline.end(), '='), subline.end());
-					std::istringstream ss(subline);
-					ss >> word >> value;
-					input.insert({ word,value });
-				} while (!subline.empty());
-
-				mapping.insert({ element, input });
-			}
-		}
-	}
-
-	return 0;
-}
-
 int MusaParser::ParseData() {
-	std::vector<std::string> search = { "DL1Cache", "Global", "Memory", "L2Cache", "L3Cache", "RAMULATOR"};
-	int ret = ReadData(search);
-	if (ret != 0) {
+	//the whole file is indexed in one pass; the sections are then looked up directly
+	if (config.Load(datapath) != 0) {
 		std::cout << "Was not able to parse information from file" << std::endl;
 		return 1;
 	}
+	std::vector<std::string> search = { "DL1Cache", "Global", "Memory", "L2Cache", "L3Cache", "RAMULATOR"};
     int memory_found=1;
 	for (auto element : search) {
-        if (mapping.find(element) == mapping.end()) {
+        if (!config.HasSection(element)) {
             if(element == "Memory") //memory is not mandatory -- it only contains bw,lat information..so proceed if not found
                 memory_found = 0;
             else{
@@ -91,20 +46,26 @@ int MusaParser::ParseData() {
 	Memory* mem = ParseMemory();
     double main_mem_bw=0, main_mem_lat=0;
     if(memory_found){
-        main_mem_bw = stod(mapping["Memory"]["bandwidth"]);
-        main_mem_lat = stod(mapping["Memory"]["latency"]);
+        main_mem_bw = config.GetDouble("Memory", "bandwidth");
+        main_mem_lat = config.GetDouble("Memory", "latency");
     }
-    double l1_lat = stod(mapping["DL1Cache"]["latency"]);
-    double l2_lat = stod(mapping["L2Cache"]["latency"]);
-    double l3_lat = stod(mapping["L3Cache"]["latency"]);
+    double l1_lat = config.GetDouble("DL1Cache", "latency");
+    double l2_lat = config.GetDouble("L2Cache", "latency");
+    double l3_lat = config.GetDouble("L3Cache", "latency");
 
 	Cache* l3cache = ParseCache("L3Cache", mem);
-	int ncpus = stoi(mapping["Global"]["ncpus"]);
-	int nthreads= stoi(mapping["Global"]["threads_per_cpu"]);
+	if (l3cache == NULL)
+		return 1;
+	int ncpus = config.GetInt("Global", "ncpus");
+	int nthreads= config.GetInt("Global", "threads_per_cpu");
     int coreId = 0, threadId = 0;
 	for (int i = 0; i < ncpus; i++) {
 		Cache* l2cache = ParseCache("L2Cache", l3cache);
+		if (l2cache == NULL)
+			return 1;
 		Cache* l1cache = ParseCache("DL1Cache", l2cache);
+		if (l1cache == NULL)
+			return 1;
 		Core* core = new Core(l1cache, coreId);
         coreId++;
 		for (int i = 0; i < nthreads; i++) {
@@ -124,8 +85,8 @@ int MusaParser::ParseData() {
 }
 
 Memory* MusaParser::ParseMemory() {
-    // parsing memory size from the
-	std::string input = mapping["RAMULATOR"]["org"];
+    // parsing memory size from the org string, e.g. DDR4_8Gb_x8
+	std::string input = config.Get("RAMULATOR", "org");
 	int pos1 = input.find("_");
 	int pos2 = input.find("_", pos1+1);
 	std::string output;
@@ -135,44 +96,18 @@ Memory* MusaParser::ParseMemory() {
     else{
 		output = input.substr(pos1 + 1, pos2 - pos1 - 1);
 	}
-        
-		
-	long long size = stol(output);
-    long long channels = stol(mapping["RAMULATOR"]["channels"]);
+
+	long long size = 0;
+    ConfigFile::ParseSize(output, &size);
+    long long channels = config.GetInt("RAMULATOR", "channels");
     if(channels > 0)
         size *= channels;
 
-    std::transform(output.begin(), output.end(), output.begin(),
-        [](unsigned char c){ return std::tolower(c); }); //convert to lower case for comparison
-    if (output.find("kib") != std::string::npos)
-        size *= (long long)1024;
-    else if (output.find("mib") != std::string::npos)
-        size *= (long long)1024*(long long)1024;
-    else if (output.find("gib") != std::string::npos)
-        size *= (long long)1024*(long long)1024*(long long)1024;
-    else if (output.find("tib") != std::string::npos)
-        size *= (long long)1024*(long long)1024*(long long)1024*(long long)1024;
-    else if (output.find("kb") != std::string::npos)
-        size *= (long long)1000;
-    else if (output.find("mb") != std::string::npos)
-        size *= (long long)1000*(long long)1000;
-    else if (output.find("gb") != std::string::npos)
-        size *= (long long)1000*(long long)1000*(long long)1000;
-    else if (output.find("tb") != std::string::npos)
-        size *= (long long)1000*(long long)1000*(long long)1000*(long long)1000;
-
     Memory* mem = new Memory(socket, 0, input, size);
 	return mem;
 }
 
 Cache* MusaParser::ParseCache(std::string level, Component* parent) {
-	std::map<std::string, std::string> data = mapping[level];
-
-    unsigned long long cache_size = stoul(data["size"]);
-    int cache_line_size = stoi(data["line-size"]);
-    int associativity = stoi(data["assoc"]);
-    int cache_level = stoi(data["level"]);
-
-    Cache* cache = new Cache(parent, 0/*id*/, cache_level, cache_size, associativity, cache_line_size);
-	return cache;
+    ConfigMapping mapping{level, SYS_SAGE_COMPONENT_CACHE, {{"cache_level", "level"}, {"cache_size", "size"}, {"cache_associativity_ways", "assoc"}, {"cache_line_size", "line-size"}}, {}};
+	return (Cache*)config.CreateComponent(mapping, parent, 0/*id*/);
 }
@@ -2,11 +2,9 @@
 #define MUSA_PARSER
 
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <map>
-#include <sstream>
 
 
 #include "sys-sage.hpp"
@@ -20,11 +18,10 @@ public:
 	MusaParser(Chip* _socket, std::string _datapath);
 
 private:
-	int ReadData(std::vector<std::string>);
 	Memory* ParseMemory();
 	Cache* ParseCache(std::string, Component* parent);
 
-	std::map<std::string, std::map<std::string, std::string>> mapping;
+	ConfigFile config;
 	std::string datapath;
 	Chip* socket;
 };
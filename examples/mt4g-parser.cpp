@@ -40,6 +40,14 @@ int main(int argc, char *argv[])
 
     cout << "Total num GPU cores: " << topo->CountAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD) << endl;
 
+    //the SMs (and the cores of one L1 cache) are identical -- keep one prototype of each
+    unsigned component_size = 0, dataPath_size = 0;
+    int size_before = topo->GetTopologySize(&component_size, &dataPath_size);
+    int collapsed = topo->CollapseIdenticalChildren();
+    component_size = 0, dataPath_size = 0;
+    int size_after = topo->GetTopologySize(&component_size, &dataPath_size);
+    cout << "Collapsed " << collapsed << " identical components: topology size " << size_before << " B -> " << size_after << " B (num GPU cores still " << topo->CountAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD) << ")" << endl;
+
     string output_name = "sys-sage_gpu_sample_output.xml";
     cout << "-------- Exporting as XML to " << output_name << " --------" << endl;
     
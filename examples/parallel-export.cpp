@@ -0,0 +1,64 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+#include "sys-sage.hpp"
+
+using namespace std::chrono;
+
+static string readFile(string path)
+{
+    std::ifstream f(path);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+//builds a cluster of Nodes (hwloc CPU topology, CAPS numa benchmark, one mt4g GPU each) and exports it with 1 to 64 threads
+int main(int argc, char *argv[])
+{
+    std::string path_prefix(argv[0]);
+    std::size_t found = path_prefix.find_last_of("/\\");
+    path_prefix=path_prefix.substr(0,found) + "/";
+    string xmlPath = path_prefix + "example_data/skylake_hwloc.xml";
+    string bwPath = path_prefix + "example_data/skylake_caps_numa_benchmark.csv";
+    string mt4gPath = path_prefix + "example_data/ampere_gpu_topo.csv";
+    int num_nodes = argc > 1 ? std::stoi(argv[1]) : 64;
+
+    Topology* topo = new Topology();
+    for(int i = 0; i < num_nodes; i++)
+    {
+        Node* n = new Node(topo, i);
+        if(parseHwlocOutput(n, xmlPath) != 0 || parseCapsNumaBenchmark(n, bwPath, ";") != 0 || parseMt4gTopo(n, mt4gPath, 0) != 0)
+        {
+            std::cerr << "failed to parse the example data" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Nodes: " << num_nodes << ", components: " << topo->CountAllSubcomponents() << std::endl;
+
+    XmlExporter exporter;
+    string serial;
+    double serial_time = 0;
+    for(int threads = 1; threads <= 64; threads *= 2)
+    {
+        string path = "parallel-export-" + std::to_string(threads) + ".xml";
+        //the document is created in parallel; writing it to the file is serial
+        auto t_start = high_resolution_clock::now();
+        xmlDocPtr doc = exporter.CreateDocument(topo, threads);
+        double t = duration<double>(high_resolution_clock::now() - t_start).count();
+        xmlSaveFormatFileEnc(path.c_str(), doc, "UTF-8", 1);
+        xmlFreeDoc(doc);
+        double t_total = duration<double>(high_resolution_clock::now() - t_start).count();
+        string out = readFile(path);
+        if(threads == 1){
+            serial = out;
+            serial_time = t;
+        }
+        std::cout << "threads " << threads << ": document " << t << " s (speedup " << serial_time / t << "), with writing " << t_total << " s" << (out == serial ? "" : " -- OUTPUT DIFFERS") << std::endl;
+    }
+
+    topo->Delete(true);
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <chrono>
+
+#include "sys-sage.hpp"
+
+using namespace std::chrono;
+
+////////////////////////////////////////////////////////////////////////
+//PARAMS TO SET
+#define REPEATS 10
+
+////////////////////////////////////////////////////////////////////////
+
+void usage(char* argv0)
+{
+    std::cerr << "usage: " << argv0 << " [hwloc xml path] [sysfs root]" << std::endl;
+    std::cerr << "       default hwloc xml path: example_data/skylake_hwloc.xml; default sysfs root: /sys" << std::endl;
+    std::cerr << "       (for a fair comparison, use an hwloc xml of this machine, e.g. generated by hwloc-output)" << std::endl;
+}
+
+//builds the topology with parse_fcn REPEATS times; returns the best time in ns and the number of components per type of the last run
+template<typename F>
+uint64_t time_parser(F parse_fcn, vector<int>* counts)
+{
+    uint64_t best = 0;
+    for(int r = 0; r < REPEATS; r++)
+    {
+        Topology* t = new Topology();
+        Node* n = new Node(t, 0);
+
+        high_resolution_clock::time_point t_start = high_resolution_clock::now();
+        int ret = parse_fcn(n);
+        high_resolution_clock::time_point t_end = high_resolution_clock::now();
+        if(ret != 0){
+            t->Delete(true);
+            return 0;
+        }
+        uint64_t time = duration_cast<nanoseconds>(t_end - t_start).count();
+        if(best == 0 || time < best)
+            best = time;
+
+        counts->clear();
+        for(int type : {SYS_SAGE_COMPONENT_CHIP, SYS_SAGE_COMPONENT_NUMA, SYS_SAGE_COMPONENT_CACHE, SYS_SAGE_COMPONENT_CORE, SYS_SAGE_COMPONENT_THREAD})
+            counts->push_back(n->CountAllSubcomponentsByType(type));
+        t->Delete(true);
+    }
+    return best;
+}
+
+//compares the time to build the CPU topology from sysfs (parseSysfsTopology) and from an hwloc XML (parseHwlocOutput)
+int main(int argc, char *argv[])
+{
+    std::string path_prefix(argv[0]);
+    std::size_t found = path_prefix.find_last_of("/\\");
+    path_prefix=path_prefix.substr(0,found) + "/";
+    string xmlPath = path_prefix + "example_data/skylake_hwloc.xml";
+    string sysfsRoot = "/sys";
+    if(argc > 3 || (argc > 1 && string(argv[1]) == "-h")){
+        usage(argv[0]);
+        return 1;
+    }
+    if(argc > 1)
+        xmlPath = argv[1];
+    if(argc > 2)
+        sysfsRoot = argv[2];
+
+    vector<int> hwlocCounts, sysfsCounts;
+    uint64_t time_parseHwlocOutput = time_parser([&](Node* n){ return parseHwlocOutput(n, xmlPath); }, &hwlocCounts);
+    uint64_t time_parseSysfsTopology = time_parser([&](Node* n){ return parseSysfsTopology(n, sysfsRoot); }, &sysfsCounts);
+    if(time_parseHwlocOutput == 0){
+        cerr << "failed parsing hwloc output " << xmlPath << endl;
+        return 1;
+    }
+    if(time_parseSysfsTopology == 0){
+        cerr << "failed parsing sysfs " << sysfsRoot << endl;
+        return 1;
+    }
+
+    cout << "time_parseHwlocOutput[ns], " << time_parseHwlocOutput;
+    cout << ", time_parseSysfsTopology[ns], " << time_parseSysfsTopology;
+    cout << ", speedup, " << (double)time_parseHwlocOutput / time_parseSysfsTopology << endl;
+
+    const char* names[] = {"chips", "numas", "caches", "cores", "threads"};
+    for(size_t i = 0; i < sysfsCounts.size(); i++)
+        cout << names[i] << ": hwloc " << hwlocCounts[i] << ", sysfs " << sysfsCounts[i] << (hwlocCounts[i] != sysfsCounts[i] ? "  <-- differs" : "") << endl;
+
+    return 0;
+}
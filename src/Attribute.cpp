@@ -0,0 +1,345 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <tuple>
+#include <unordered_map>
+
+#include "Attribute.hpp"
+#include "TimeSeries.hpp"
+
+//helper: value of a property of an xml node, or "" if missing
+static string getProp(xmlNodePtr n, const char* prop)
+{
+    xmlChar* v = xmlGetProp(n, (const xmlChar*)prop);
+    if(v == NULL)
+        return "";
+    string ret((const char*)v);
+    xmlFree(v);
+    return ret;
+}
+
+//value: TimeSeries* -- stored compressed (base64 of TimeSeries::Serialize()); older files (freq_history) have one element per sample
+static AttributeHandler timeSeriesHandler(string unit)
+{
+    AttributeHandler h;
+    h.type = "timeseries";
+    h.serialize_xml = [unit](const string& key, void* value, xmlNodePtr attrib_node) {
+        TimeSeries* val = (TimeSeries*)value;
+        xmlNodePtr attrib = xmlNewNode(NULL, (const unsigned char *)key.c_str());
+        xmlNewProp(attrib, (const unsigned char *)"encoding", (const unsigned char *)"timeseries-base64");
+        xmlNewProp(attrib, (const unsigned char *)"samples", (const unsigned char *)std::to_string(val->GetSize()).c_str());
+        xmlNewProp(attrib, (const unsigned char *)"unit", (const unsigned char *)unit.c_str());
+        xmlNewProp(attrib, (const unsigned char *)"data", (const unsigned char *)val->ToBase64().c_str());
+        xmlAddChild(attrib_node, attrib);
+    };
+    h.deserialize_xml = [](xmlNodePtr n) -> void* {
+        TimeSeries* val = new TimeSeries();
+        for (xmlNodePtr cur = n->children; cur != NULL; cur = cur->next) {
+            if (cur->type == XML_TEXT_NODE)
+                continue;
+            if (xmlHasProp(cur, (const xmlChar *)"data")) {
+                if (val->FromBase64(getProp(cur, "data")) != 0)
+                    std::cerr << getProp(n, "name") << ": malformed data, skipping" << std::endl;
+                continue;
+            }
+            long long ts = std::strtoll(getProp(cur, "timestamp").c_str(), NULL, 10);
+            double freq = std::strtod(getProp(cur, "frequency").c_str(), NULL);
+            val->Add(ts, freq);
+        }
+        return val;
+    };
+    h.size = [](void* value) { return sizeof(TimeSeries) + ((TimeSeries*)value)->GetCapacity() * sizeof(tuple<long long,double>); };
+    h.destroy = [](void* value) { delete (TimeSeries*)value; };
+    h.clone = [](void* value) { return (void*)new TimeSeries(*(TimeSeries*)value); };
+    return h;
+}
+
+//value: std::vector<std::tuple<std::string,int,double>>* -- (kernel, threads, bandwidth in MB/s)
+static AttributeHandler bwSweepHandler()
+{
+    typedef vector<tuple<string,int,double>> BwSweep;
+    AttributeHandler h;
+    h.type = "bw_sweep";
+    h.serialize_xml = [](const string& key, void* value, xmlNodePtr attrib_node) {
+        for(auto const& [ kernel,threads,bw ] : *(BwSweep*)value)
+        {
+            xmlNodePtr attrib = xmlNewNode(NULL, (const unsigned char *)key.c_str());
+            xmlNewProp(attrib, (const unsigned char *)"kernel", (const unsigned char *)kernel.c_str());
+            xmlNewProp(attrib, (const unsigned char *)"threads", (const unsigned char *)std::to_string(threads).c_str());
+            xmlNewProp(attrib, (const unsigned char *)"bw", (const unsigned char *)std::to_string(bw).c_str());
+            xmlNewProp(attrib, (const unsigned char *)"unit", (const unsigned char *)"MB/s");
+            xmlAddChild(attrib_node, attrib);
+        }
+    };
+    h.deserialize_xml = [](xmlNodePtr n) -> void* {
+        BwSweep* val = new BwSweep();
+        for (xmlNodePtr cur = n->children; cur != NULL; cur = cur->next) {
+            if (cur->type == XML_TEXT_NODE)
+                continue;
+            val->push_back(std::make_tuple(getProp(cur, "kernel"), std::atoi(getProp(cur, "threads").c_str()), std::strtod(getProp(cur, "bw").c_str(), NULL)));
+        }
+        return val;
+    };
+    h.size = [](void* value) {
+        size_t s = sizeof(BwSweep);
+        for(auto const& t : *(BwSweep*)value)
+            s += sizeof(t) + std::get<0>(t).capacity();
+        return s;
+    };
+    h.destroy = [](void* value) { delete (BwSweep*)value; };
+    h.clone = [](void* value) { return (void*)new BwSweep(*(BwSweep*)value); };
+    return h;
+}
+
+//value: double* -- clock rate in Hz (mt4g); exported as an element with the frequency and its unit
+static AttributeHandler clockRateHandler()
+{
+    AttributeHandler h;
+    h.type = "clock_rate";
+    h.serialize_xml = [](const string& key, void* value, xmlNodePtr attrib_node) {
+        xmlNodePtr attrib = xmlNewNode(NULL, (const unsigned char *)key.c_str());
+        xmlNewProp(attrib, (const unsigned char *)"frequency", (const unsigned char *)std::to_string(*(double*)value).c_str());
+        xmlNewProp(attrib, (const unsigned char *)"unit", (const unsigned char *)"Hz");
+        xmlAddChild(attrib_node, attrib);
+    };
+    h.deserialize_xml = [](xmlNodePtr n) -> void* {
+        xmlNodePtr attr = n->children;
+        while(attr != NULL && attr->type == XML_TEXT_NODE)
+            attr = attr->next;
+        if(attr == NULL)
+            return NULL;
+        double freq = std::strtod(getProp(attr, "frequency").c_str(), NULL);
+        string unit = getProp(attr, "unit");
+        if(unit == "KHz")
+            freq *= 1000;
+        else if(unit == "MHz")
+            freq *= 1000*1000;
+        else if(unit == "GHz")
+            freq *= 1000*1000*1000;
+        return new double(freq);
+    };
+    h.size = [](void*) { return sizeof(double); };
+    h.destroy = [](void* value) { delete (double*)value; };
+    h.clone = [](void* value) { return (void*)new double(*(double*)value); };
+    return h;
+}
+
+//the registry of attribute keys; the default keys are registered on first use
+static unordered_map<string, AttributeHandler>& attributeRegistry()
+{
+    static unordered_map<string, AttributeHandler> registry = [] {
+        unordered_map<string, AttributeHandler> r;
+        for(string key : {"CATcos", "CATL3mask", "MBAthrottle"})
+            r[key] = ScalarAttributeHandler<uint64_t>("uint64");
+        for(string key : {"mig_size", "working_set_size"})
+            r[key] = ScalarAttributeHandler<long long>("long long");
+        for(string key : {"Number_of_streaming_multiprocessors", "Number_of_cores_in_GPU", "Number_of_cores_per_SM", "Bus_Width_bit"})
+            r[key] = ScalarAttributeHandler<int>("int");
+        r["Clock_Frequency"] = ScalarAttributeHandler<double>("double");
+        for(string key : {"latency", "latency_min", "latency_max"})
+            r[key] = ScalarAttributeHandler<float>("float");
+        for(string key : {"CUDA_compute_capability", "mig_uuid", "resctrl_group"})
+            r[key] = ScalarAttributeHandler<string>("string");
+        r["freq_history"] = timeSeriesHandler("MHz");
+        r["llc_occupancy"] = timeSeriesHandler("B");
+        r["mbm_total_bw"] = timeSeriesHandler("B/s");
+        r["mbm_local_bw"] = timeSeriesHandler("B/s");
+        r["bw_sweep"] = bwSweepHandler();
+        r["GPU_Clock_Rate"] = clockRateHandler();
+        return r;
+    }();
+    return registry;
+}
+
+int RegisterAttributeHandler(string key, AttributeHandler handler)
+{
+    if(!(handler.serialize && handler.deserialize) && !(handler.serialize_xml && handler.deserialize_xml))
+    {
+        cerr << "RegisterAttributeHandler: handler of " << key << " must provide serialize+deserialize or serialize_xml+deserialize_xml" << endl;
+        return 1;
+    }
+    attributeRegistry()[key] = handler;
+    return 0;
+}
+
+int UnregisterAttributeHandler(string key)
+{
+    return attributeRegistry().erase(key) == 1 ? 0 : 1;
+}
+
+AttributeHandler* GetAttributeHandler(const string& key)
+{
+    auto& registry = attributeRegistry();
+    auto it = registry.find(key);
+    if(it == registry.end())
+        return NULL;
+    return &it->second;
+}
+
+vector<string> GetAttributeHandlerKeys()
+{
+    vector<string> keys;
+    for(auto const& [key, handler] : attributeRegistry())
+        keys.push_back(key);
+    return keys;
+}
+
+size_t GetAttributesSize(const map<string, void*>& attrib)
+{
+    size_t s = 0;
+    for(auto const& [key, value] : attrib)
+    {
+        s += sizeof(string) + sizeof(void*);
+        AttributeHandler* h = GetAttributeHandler(key);
+        if(h != NULL && h->size && value != NULL)
+            s += h->size(value);
+    }
+    return s;
+}
+
+//copies a value without a clone hook through its export form; NULL if it cannot be read back
+static void* cloneThroughExport(const string& key, AttributeHandler* h, void* value)
+{
+    if(h->serialize && h->deserialize)
+        return h->deserialize(h->serialize(value));
+    xmlNodePtr n = xmlNewNode(NULL, (const xmlChar*)"Attribute");
+    xmlNewProp(n, (const xmlChar*)"name", (const xmlChar*)key.c_str());
+    h->serialize_xml(key, value, n);
+    void* copy = h->deserialize_xml(n);
+    xmlFreeNode(n);
+    return copy;
+}
+
+map<string, void*> CloneAttributes(const map<string, void*>& attrib)
+{
+    map<string, void*> copy;
+    for(auto const& [key, value] : attrib)
+    {
+        AttributeHandler* h = GetAttributeHandler(key);
+        if(h == NULL || value == NULL)
+        {
+            copy[key] = value;
+            continue;
+        }
+        void* v = h->clone ? h->clone(value) : cloneThroughExport(key, h, value);
+        if(v == NULL)
+        {
+            cerr << "CloneAttributes: value of " << key << " could not be copied, skipping" << endl;
+            continue;
+        }
+        copy[key] = v;
+    }
+    return copy;
+}
+
+void DestroyAttributes(map<string, void*>* attrib)
+{
+    for(auto const& [key, value] : *attrib)
+    {
+        AttributeHandler* h = GetAttributeHandler(key);
+        if(h != NULL && h->destroy && value != NULL)
+            h->destroy(value);
+    }
+    attrib->clear();
+}
+
+bool SameAttributes(const map<string, void*>& a, const map<string, void*>& b)
+{
+    if(a.size() != b.size())
+        return false;
+    for(auto ia = a.begin(), ib = b.begin(); ia != a.end(); ++ia, ++ib)
+    {
+        if(ia->first != ib->first)
+            return false;
+        if(ia->second == ib->second)
+            continue;
+        if(GetAttributeHandler(ia->first) == NULL || ia->second == NULL || ib->second == NULL)
+            return false;
+    }
+    return HashAttributes(a, HashBytes(NULL, 0)) == HashAttributes(b, HashBytes(NULL, 0));
+}
+
+uint64_t HashBytes(const void* data, size_t len, uint64_t h)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    for(size_t i = 0; i < len; i++)
+    {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+//strings are prefixed with their length, so that consecutive strings cannot be confused
+static uint64_t hashString(const string& s, uint64_t h)
+{
+    h = HashValue(s.size(), h);
+    return HashBytes(s.data(), s.size(), h);
+}
+
+uint64_t HashAttributes(const map<string, void*>& attrib, uint64_t h)
+{
+    h = HashValue(attrib.size(), h);
+    for(auto const& [key, value] : attrib)
+    {
+        h = hashString(key, h);
+        AttributeHandler* handler = GetAttributeHandler(key);
+        if(handler == NULL || value == NULL)
+            continue;
+        if(handler->serialize)
+            h = hashString(handler->serialize(value), h);
+        else if(handler->serialize_xml)
+        {
+            xmlNodePtr n = xmlNewNode(NULL, (const xmlChar*)"Attribute");
+            handler->serialize_xml(key, value, n);
+            xmlBufferPtr buf = xmlBufferCreate();
+            xmlNodeDump(buf, NULL, n, 0, 0);
+            h = HashBytes(xmlBufferContent(buf), xmlBufferLength(buf), h);
+            xmlBufferFree(buf);
+            xmlFreeNode(n);
+        }
+    }
+    return h;
+}
+
+static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+string Base64Encode(const string& bin)
+{
+    string out;
+    out.reserve((bin.size() + 2) / 3 * 4);
+    for(size_t i = 0; i < bin.size(); i += 3)
+    {
+        uint32_t v = (uint8_t)bin[i] << 16;
+        if(i + 1 < bin.size()) v |= (uint8_t)bin[i+1] << 8;
+        if(i + 2 < bin.size()) v |= (uint8_t)bin[i+2];
+        out.push_back(base64_chars[(v >> 18) & 0x3f]);
+        out.push_back(base64_chars[(v >> 12) & 0x3f]);
+        out.push_back(i + 1 < bin.size() ? base64_chars[(v >> 6) & 0x3f] : '=');
+        out.push_back(i + 2 < bin.size() ? base64_chars[v & 0x3f] : '=');
+    }
+    return out;
+}
+
+int Base64Decode(const string& data, string* bin)
+{
+    bin->clear();
+    bin->reserve(data.size() / 4 * 3);
+    uint32_t v = 0;
+    int bits = 0;
+    for(char c : data)
+    {
+        if(c == '=' || isspace((unsigned char)c))
+            continue;
+        const char* p = strchr(base64_chars, c);
+        if(p == NULL || c == '\0')
+            return 1;
+        v = (v << 6) | (uint32_t)(p - base64_chars);
+        bits += 6;
+        if(bits >= 8){
+            bits -= 8;
+            bin->push_back((char)((v >> bits) & 0xff));
+        }
+    }
+    return 0;
+}
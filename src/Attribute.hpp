@@ -0,0 +1,146 @@
+#ifndef ATTRIBUTE
+#define ATTRIBUTE
+
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstdlib>
+#include <type_traits>
+#include <libxml/parser.h>
+
+/*! \file */
+
+using namespace std;
+
+/**
+Describes how the value of one attribute key (Component::attrib, DataPath::attrib) is handled.
+\n The keys are registered with RegisterAttributeHandler() and looked up in a hash map, so the XML export/import, GetTopologySize() and the Python bindings dispatch on the key in O(1).
+\n Simple values (numbers, strings) are exported as the "value" property of the Attribute XML node and provide serialize/deserialize; complex values (e.g. TimeSeries) create their own child nodes of the Attribute node and provide serialize_xml/deserialize_xml.
+*/
+struct AttributeHandler {
+    string type; /**< name of the value type, e.g. "int" or "timeseries" */
+    std::function<string(void*)> serialize; /**< simple values: returns the value as a string (NULL for complex values) */
+    std::function<void*(const string&)> deserialize; /**< simple values: creates a new value from the string, or returns NULL if it is malformed */
+    std::function<void(const string&, void*, xmlNodePtr)> serialize_xml; /**< complex values: appends the value to the Attribute node (key, value, node) */
+    std::function<void*(xmlNodePtr)> deserialize_xml; /**< complex values: creates a new value from the Attribute node, or returns NULL */
+    std::function<size_t(void*)> size; /**< memory footprint of the value in bytes */
+    std::function<void(void*)> destroy; /**< deletes the value */
+    std::function<void*(void*)> clone; /**< creates a deep copy of the value; if NULL, CloneAttributes() copies it through serialize+deserialize (or serialize_xml+deserialize_xml) */
+    std::function<void*(void*)> to_python; /**< returns a new reference to a Python object (PyObject*) holding a copy of the value; set by the Python bindings, NULL otherwise */
+};
+
+/**
+Registers (or replaces) the handler of an attribute key.
+\n The default keys (e.g. "CATcos", "mig_uuid", "freq_history") are registered on the first use of the registry. Registering is not thread-safe with respect to concurrent lookups; register user keys before starting threads that export or import.
+@param key - the attribute key
+@param handler - its handler; either serialize+deserialize or serialize_xml+deserialize_xml must be set
+@return 0 on success, 1 if the handler can neither serialize nor deserialize
+*/
+int RegisterAttributeHandler(string key, AttributeHandler handler);
+/**
+Removes the handler of an attribute key.
+@return 0 on success, 1 if the key is not registered
+*/
+int UnregisterAttributeHandler(string key);
+/**
+@returns the handler of an attribute key, or NULL if the key is not registered
+*/
+AttributeHandler* GetAttributeHandler(const string& key);
+/**
+@returns all registered attribute keys
+*/
+vector<string> GetAttributeHandlerKeys();
+/**
+@returns estimated memory footprint of the attributes in bytes: the map entries plus, for registered keys, the values
+*/
+size_t GetAttributesSize(const map<string, void*>& attrib);
+/**
+Deep-copies attributes, e.g. for a copy of a Component or DataPath that must own its values (see Component::ExpandInstance(), PatchTopology()).
+\n The values of registered keys are copied with their AttributeHandler (clone, or a serialize+deserialize round trip). The values of unregistered keys cannot be copied: the copy shares them (their pointers are copied), so their owner has to keep them alive.
+@return the copy
+*/
+map<string, void*> CloneAttributes(const map<string, void*>& attrib);
+/**
+Destroys the values of registered keys with their AttributeHandler (destroy) and clears the attributes. The values of unregistered keys are not destroyed.
+\n Only for attributes that own their values, e.g. those created by importFromXml() or CloneAttributes().
+*/
+void DestroyAttributes(map<string, void*>* attrib);
+/**
+@return true if both have the same keys and equal values: the values of registered keys are compared as exported (see HashAttributes()), those of unregistered keys by their pointers
+*/
+bool SameAttributes(const map<string, void*>& a, const map<string, void*>& b);
+
+/**
+Hashes binary data (FNV-1a), e.g. for Component::GetHash().
+@param data - the data
+@param len - its length in bytes
+@param h - the hash to continue; the default starts a new hash
+@return the hash
+*/
+uint64_t HashBytes(const void* data, size_t len, uint64_t h = 14695981039346656037ULL);
+/**
+Continues a hash (see HashBytes()) with the bytes of a trivially copyable value.
+*/
+template <typename T>
+uint64_t HashValue(const T& v, uint64_t h)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    return HashBytes(&v, sizeof(T), h);
+}
+/**
+Continues a hash (see HashBytes()) with attributes: the keys and, for registered keys, the values as exported (serialize, or the XML nodes of serialize_xml). The values of unregistered keys cannot be read, so only their keys are hashed.
+@return the hash
+*/
+uint64_t HashAttributes(const map<string, void*>& attrib, uint64_t h);
+
+/**
+Encodes binary data (e.g. a compressed TimeSeries or a DataPath matrix) as base64 text, for the XML export.
+*/
+string Base64Encode(const string& bin);
+/**
+Decodes base64 text; whitespace is skipped.
+@param data - the base64 text
+@param bin - output: the binary data
+@return 0 on success, 1 if data contains a character that is not base64
+*/
+int Base64Decode(const string& data, string* bin);
+
+/**
+Creates an AttributeHandler of a simple value of type T (an arithmetic type or string), stored as T* and exported with std::to_string().
+\n Example: RegisterAttributeHandler("temperature", ScalarAttributeHandler<double>("double"));
+@param type - name of the value type
+*/
+template <typename T>
+AttributeHandler ScalarAttributeHandler(string type)
+{
+    AttributeHandler h;
+    h.type = type;
+    h.size = [](void*) { return sizeof(T); };
+    h.destroy = [](void* v) { delete (T*)v; };
+    h.clone = [](void* v) { return (void*)new T(*(T*)v); };
+    if constexpr (std::is_same_v<T, string>) {
+        h.serialize = [](void* v) { return *(string*)v; };
+        h.deserialize = [](const string& s) { return (void*)new string(s); };
+        h.size = [](void* v) { return sizeof(string) + ((string*)v)->capacity(); };
+    } else {
+        h.serialize = [](void* v) { return std::to_string(*(T*)v); };
+        h.deserialize = [](const string& s) -> void* {
+            char* end;
+            T val;
+            if constexpr (std::is_floating_point_v<T>)
+                val = (T)std::strtod(s.c_str(), &end);
+            else if constexpr (std::is_signed_v<T>)
+                val = (T)std::strtoll(s.c_str(), &end, 10);
+            else
+                val = (T)std::strtoull(s.c_str(), &end, 10);
+            if (end == s.c_str())
+                return NULL;
+            return new T(val);
+        };
+    }
+    return h;
+}
+
+#endif
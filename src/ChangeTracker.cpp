@@ -0,0 +1,676 @@
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "ChangeTracker.hpp"
+#include "Attribute.hpp"
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+#define SYS_SAGE_DELTA_BINARY_MAGIC "SSD1" /**< first bytes of a binary delta record, followed by the length of the record (u32 little-endian) */
+#define SYS_SAGE_DELTA_XML_END "</sys-sage-delta>"
+
+#define DELTA_FLAG_ATTRIBUTES 1
+#define DELTA_FLAG_DATAPATHS 2
+#define DELTA_FLAG_FREQ 4
+
+static string dumpNode(xmlNodePtr n)
+{
+    xmlBufferPtr buf = xmlBufferCreate();
+    xmlNodeDump(buf, NULL, n, 0, 0);
+    string s((const char*)xmlBufferContent(buf), xmlBufferLength(buf));
+    xmlBufferFree(buf);
+    return s;
+}
+
+//hash of the exported attributes (the same callbacks and allow-list as the export); 0 for no attributes
+static uint64_t hashAttrib(const XmlExporter& exporter, const map<string, void*>& attrib, uint64_t h)
+{
+    if(attrib.empty())
+        return h;
+    xmlNodePtr n = xmlNewNode(NULL, BAD_CAST "attributes");
+    exporter.PrintAttrib(attrib, n);
+    string s = dumpNode(n);
+    xmlFreeNode(n);
+    return HashBytes(s.data(), s.size(), h);
+}
+
+//the DataPaths of c whose source it is (a bidirectional DataPath belongs to its source), in the order of dp_outgoing
+static vector<DataPath*> ownDataPaths(const XmlExporter& exporter, Component* c)
+{
+    vector<DataPath*> dps;
+    int dp_types = exporter.GetOptions().datapath_types;
+    for(DataPath* dp : *c->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+        if(dp->GetSource() == c && (dp->GetDataPathType() & dp_types))
+            dps.push_back(dp);
+    return dps;
+}
+
+static void getComponentsDfs(Component* c, vector<Component*>* out)
+{
+    out->push_back(c);
+    for(Component* child : *c->GetChildren())
+        getComponentsDfs(child, out);
+}
+
+ChangeTracker::ChangeTracker(Component* _root, const XmlExporter& _exporter): root(_root), exporter(_exporter), seq(0)
+{
+    //the deltas address all Components of the tree
+    XmlExportOptions options = exporter.GetOptions();
+    options.component_types = -1;
+    options.max_depth = -1;
+    options.subtree_roots.clear();
+    exporter.SetOptions(options);
+    Checkpoint();
+}
+
+vector<ChangeTracker::ComponentState> ChangeTracker::scan()
+{
+    vector<Component*> components;
+    getComponentsDfs(root, &components);
+    vector<ComponentState> states;
+    states.reserve(components.size());
+    for(Component* c : components)
+    {
+        ComponentState s{c, c->GetComponentType(), hashAttrib(exporter, c->attrib, 0), 0, 0};
+#ifdef PROC_CPUINFO
+        if(s.type == SYS_SAGE_COMPONENT_CORE)
+        {
+            double freq = ((Core*)c)->GetFreq();
+            memcpy(&s.freq_bits, &freq, sizeof(double));
+        }
+#endif
+        for(DataPath* dp : ownDataPaths(exporter, c))
+        {
+            uint64_t h = HashValue(dp->GetTarget(), s.dp_hash);
+            h = HashValue(dp->GetOrientation(), h);
+            h = HashValue(dp->GetDataPathType(), h);
+            h = HashValue(dp->GetBandwidth(), h);
+            h = HashValue(dp->GetLatency(), h);
+            h = HashValue(dp->GetBroadcastType(), h);
+            s.dp_hash = hashAttrib(exporter, dp->attrib, h);
+        }
+        states.push_back(s);
+    }
+    return states;
+}
+
+void ChangeTracker::Checkpoint()
+{
+    checkpoint = scan();
+}
+
+int ChangeTracker::GetChanges(vector<Component*>* attributes, vector<Component*>* datapaths)
+{
+    vector<ComponentState> current = scan();
+    if(current.size() != checkpoint.size())
+        return 1;
+    for(size_t i = 0; i < current.size(); i++)
+        if(current[i].component != checkpoint[i].component || current[i].type != checkpoint[i].type)
+            return 1;
+    for(size_t i = 0; i < current.size(); i++)
+    {
+        if(attributes != NULL && (current[i].attrib_hash != checkpoint[i].attrib_hash || current[i].freq_bits != checkpoint[i].freq_bits))
+            attributes->push_back(current[i].component);
+        if(datapaths != NULL && current[i].dp_hash != checkpoint[i].dp_hash)
+            datapaths->push_back(current[i].component);
+    }
+    return 0;
+}
+
+int ChangeTracker::WriteSnapshot(string path)
+{
+    int ret = exporter.Export(root, path);
+    Checkpoint();
+    return ret;
+}
+
+int ChangeTracker::GetSequenceNumber()
+{
+    return seq;
+}
+
+xmlDocPtr ChangeTracker::createDelta(const vector<ComponentState>& current, const vector<bool>& attrib_changed, const vector<bool>& dp_changed)
+{
+    std::unordered_map<Component*, size_t> indices;
+    for(size_t i = 0; i < current.size(); i++)
+        indices[current[i].component] = i;
+
+    xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+    xmlNodePtr delta_n = xmlNewNode(NULL, BAD_CAST "sys-sage-delta");
+    xmlNewProp(delta_n, BAD_CAST "seq", BAD_CAST std::to_string(seq + 1).c_str());
+    xmlDocSetRootElement(doc, delta_n);
+    for(size_t i = 0; i < current.size(); i++)
+    {
+        if(!attrib_changed[i] && !dp_changed[i])
+            continue;
+        Component* c = current[i].component;
+        xmlNodePtr c_n = xmlNewChild(delta_n, NULL, BAD_CAST "component", NULL);
+        xmlNewProp(c_n, BAD_CAST "addr", BAD_CAST std::to_string(i).c_str());
+#ifdef PROC_CPUINFO
+        if(current[i].type == SYS_SAGE_COMPONENT_CORE)
+            xmlNewProp(c_n, BAD_CAST "freq", BAD_CAST std::to_string(((Core*)c)->GetFreq()).c_str());
+#endif
+        if(attrib_changed[i])
+        {
+            xmlNodePtr attrib_n = xmlNewChild(c_n, NULL, BAD_CAST "attributes", NULL);
+            exporter.PrintAttrib(c->attrib, attrib_n);
+        }
+        if(dp_changed[i])
+        {
+            xmlNodePtr dps_n = xmlNewChild(c_n, NULL, BAD_CAST "datapaths", NULL);
+            for(DataPath* dp : ownDataPaths(exporter, c))
+            {
+                //DataPaths leading out of the tree cannot be addressed (nor are they in the snapshot)
+                auto target = indices.find(dp->GetTarget());
+                if(target == indices.end())
+                    continue;
+                xmlNodePtr dp_n = xmlNewChild(dps_n, NULL, BAD_CAST "datapath", NULL);
+                xmlNewProp(dp_n, BAD_CAST "target", BAD_CAST std::to_string(target->second).c_str());
+                xmlNewProp(dp_n, BAD_CAST "oriented", BAD_CAST std::to_string(dp->GetOrientation()).c_str());
+                xmlNewProp(dp_n, BAD_CAST "dp_type", BAD_CAST std::to_string(dp->GetDataPathType()).c_str());
+                xmlNewProp(dp_n, BAD_CAST "bw", BAD_CAST std::to_string(dp->GetBandwidth()).c_str());
+                xmlNewProp(dp_n, BAD_CAST "latency", BAD_CAST std::to_string(dp->GetLatency()).c_str());
+                if(dp->IsBroadcast())
+                    xmlNewProp(dp_n, BAD_CAST "broadcast_type", BAD_CAST std::to_string(dp->GetBroadcastType()).c_str());
+                exporter.PrintAttrib(dp->attrib, dp_n);
+            }
+        }
+    }
+    return doc;
+}
+
+//binary encoding: unsigned LEB128 integers, little-endian doubles, strings as length + bytes
+static void putVarint(string* out, uint64_t v)
+{
+    while(v >= 0x80)
+    {
+        out->push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out->push_back((char)v);
+}
+
+static void putDouble(string* out, double v)
+{
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(double));
+    for(int i = 0; i < 8; i++)
+        out->push_back((char)(bits >> (8 * i)));
+}
+
+static void putString(string* out, const string& s)
+{
+    putVarint(out, s.size());
+    out->append(s);
+}
+
+static string getProp(xmlNodePtr n, const char* prop)
+{
+    xmlChar* v = xmlGetProp(n, BAD_CAST prop);
+    if(v == NULL)
+        return "";
+    string s((const char*)v);
+    xmlFree(v);
+    return s;
+}
+
+static vector<xmlNodePtr> elementChildren(xmlNodePtr n)
+{
+    vector<xmlNodePtr> children;
+    for(xmlNodePtr cur = n->children; cur != NULL; cur = cur->next)
+        if(cur->type == XML_ELEMENT_NODE)
+            children.push_back(cur);
+    return children;
+}
+
+//simple attributes as key and value, the others (complex values, custom nodes) as XML text
+static void putAttributes(string* out, xmlNodePtr n)
+{
+    vector<xmlNodePtr> attribs;
+    for(xmlNodePtr a : elementChildren(n))
+        if(xmlStrcmp(a->name, BAD_CAST "datapath") != 0)
+            attribs.push_back(a);
+    putVarint(out, attribs.size());
+    for(xmlNodePtr a : attribs)
+    {
+        bool simple = xmlStrcmp(a->name, BAD_CAST "Attribute") == 0 && xmlHasProp(a, BAD_CAST "name") && xmlHasProp(a, BAD_CAST "value") && elementChildren(a).empty();
+        out->push_back(simple ? 0 : 1);
+        if(simple)
+        {
+            putString(out, getProp(a, "name"));
+            putString(out, getProp(a, "value"));
+        }
+        else
+            putString(out, dumpNode(a));
+    }
+}
+
+static string encodeBinaryDelta(xmlDocPtr doc)
+{
+    xmlNodePtr delta_n = xmlDocGetRootElement(doc);
+    vector<xmlNodePtr> components = elementChildren(delta_n);
+    string payload;
+    putVarint(&payload, std::stoull(getProp(delta_n, "seq")));
+    putVarint(&payload, components.size());
+    for(xmlNodePtr c_n : components)
+    {
+        xmlNodePtr attrib_n = NULL, dps_n = NULL;
+        for(xmlNodePtr child : elementChildren(c_n))
+        {
+            if(xmlStrcmp(child->name, BAD_CAST "attributes") == 0)
+                attrib_n = child;
+            else if(xmlStrcmp(child->name, BAD_CAST "datapaths") == 0)
+                dps_n = child;
+        }
+        bool has_freq = xmlHasProp(c_n, BAD_CAST "freq");
+        putVarint(&payload, std::stoull(getProp(c_n, "addr")));
+        payload.push_back((char)((attrib_n != NULL ? DELTA_FLAG_ATTRIBUTES : 0) | (dps_n != NULL ? DELTA_FLAG_DATAPATHS : 0) | (has_freq ? DELTA_FLAG_FREQ : 0)));
+        if(has_freq)
+            putDouble(&payload, std::stod(getProp(c_n, "freq")));
+        if(attrib_n != NULL)
+            putAttributes(&payload, attrib_n);
+        if(dps_n != NULL)
+        {
+            vector<xmlNodePtr> dps = elementChildren(dps_n);
+            putVarint(&payload, dps.size());
+            for(xmlNodePtr dp_n : dps)
+            {
+                putVarint(&payload, std::stoull(getProp(dp_n, "target")));
+                putVarint(&payload, std::stoull(getProp(dp_n, "oriented")));
+                putVarint(&payload, std::stoull(getProp(dp_n, "dp_type")));
+                putDouble(&payload, std::stod(getProp(dp_n, "bw")));
+                putDouble(&payload, std::stod(getProp(dp_n, "latency")));
+                putVarint(&payload, xmlHasProp(dp_n, BAD_CAST "broadcast_type") ? std::stoull(getProp(dp_n, "broadcast_type")) : 0);
+                putAttributes(&payload, dp_n);
+            }
+        }
+    }
+    string record = SYS_SAGE_DELTA_BINARY_MAGIC;
+    uint32_t len = payload.size();
+    for(int i = 0; i < 4; i++)
+        record.push_back((char)(len >> (8 * i)));
+    return record + payload;
+}
+
+int ChangeTracker::AppendDelta(string path, int format)
+{
+    vector<ComponentState> current = scan();
+    if(current.size() != checkpoint.size())
+        return 2;
+    vector<bool> attrib_changed(current.size()), dp_changed(current.size());
+    bool changed = false;
+    for(size_t i = 0; i < current.size(); i++)
+    {
+        if(current[i].component != checkpoint[i].component || current[i].type != checkpoint[i].type)
+            return 2;
+        attrib_changed[i] = current[i].attrib_hash != checkpoint[i].attrib_hash || current[i].freq_bits != checkpoint[i].freq_bits;
+        dp_changed[i] = current[i].dp_hash != checkpoint[i].dp_hash;
+        changed = changed || attrib_changed[i] || dp_changed[i];
+    }
+    if(!changed)
+        return 0;
+
+    xmlDocPtr doc = createDelta(current, attrib_changed, dp_changed);
+    string data;
+    if(format == SYS_SAGE_DELTA_BINARY)
+        data = encodeBinaryDelta(doc);
+    else
+    {
+        xmlChar* mem;
+        int size;
+        xmlDocDumpFormatMemoryEnc(doc, &mem, &size, "UTF-8", 1);
+        data.assign((const char*)mem, size);
+        xmlFree(mem);
+    }
+    xmlFreeDoc(doc);
+
+    std::ofstream out(path, std::ios::app | std::ios::binary);
+    out.write(data.data(), data.size());
+    out.flush();
+    if(!out)
+    {
+        std::cerr << "ChangeTracker::AppendDelta: could not write " << path << std::endl;
+        return 1;
+    }
+    checkpoint = current;
+    seq++;
+    return 0;
+}
+
+//reads the binary encoding; each getter returns false at the end of the data
+struct BinaryDeltaReader {
+    const string& data;
+    size_t pos;
+
+    bool Varint(uint64_t* v)
+    {
+        *v = 0;
+        for(int shift = 0; shift < 64; shift += 7)
+        {
+            if(pos >= data.size())
+                return false;
+            unsigned char b = data[pos++];
+            *v |= (uint64_t)(b & 0x7f) << shift;
+            if(!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+    bool Double(double* v)
+    {
+        if(pos + 8 > data.size())
+            return false;
+        uint64_t bits = 0;
+        for(int i = 0; i < 8; i++)
+            bits |= (uint64_t)(unsigned char)data[pos++] << (8 * i);
+        memcpy(v, &bits, sizeof(double));
+        return true;
+    }
+    bool String(string* s)
+    {
+        uint64_t len;
+        if(!Varint(&len) || len > data.size() - pos)
+            return false;
+        *s = data.substr(pos, len);
+        pos += len;
+        return true;
+    }
+    bool Attributes(xmlNodePtr n)
+    {
+        uint64_t count;
+        if(!Varint(&count))
+            return false;
+        for(uint64_t i = 0; i < count; i++)
+        {
+            if(pos >= data.size())
+                return false;
+            char kind = data[pos++];
+            string name, value;
+            if(kind == 0)
+            {
+                if(!String(&name) || !String(&value))
+                    return false;
+                xmlNodePtr a = xmlNewChild(n, NULL, BAD_CAST "Attribute", NULL);
+                xmlNewProp(a, BAD_CAST "name", BAD_CAST name.c_str());
+                xmlNewProp(a, BAD_CAST "value", BAD_CAST value.c_str());
+                continue;
+            }
+            if(!String(&value))
+                return false;
+            xmlDocPtr fragment = xmlReadMemory(value.data(), value.size(), NULL, NULL, 0);
+            if(fragment == NULL)
+                return false;
+            xmlAddChild(n, xmlDocCopyNode(xmlDocGetRootElement(fragment), n->doc, 1));
+            xmlFreeDoc(fragment);
+        }
+        return true;
+    }
+};
+
+//decodes the payload of a binary record into the XML form of the delta; NULL if it is malformed
+static xmlDocPtr decodeBinaryDelta(const string& payload)
+{
+    BinaryDeltaReader r{payload, 0};
+    uint64_t seq, count;
+    if(!r.Varint(&seq) || !r.Varint(&count))
+        return NULL;
+    xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+    xmlNodePtr delta_n = xmlNewNode(NULL, BAD_CAST "sys-sage-delta");
+    xmlNewProp(delta_n, BAD_CAST "seq", BAD_CAST std::to_string(seq).c_str());
+    xmlDocSetRootElement(doc, delta_n);
+    bool ok = true;
+    for(uint64_t i = 0; ok && i < count; i++)
+    {
+        uint64_t addr;
+        if(!r.Varint(&addr) || r.pos >= payload.size())
+        {
+            ok = false;
+            break;
+        }
+        int flags = payload[r.pos++];
+        xmlNodePtr c_n = xmlNewChild(delta_n, NULL, BAD_CAST "component", NULL);
+        xmlNewProp(c_n, BAD_CAST "addr", BAD_CAST std::to_string(addr).c_str());
+        double freq;
+        if(flags & DELTA_FLAG_FREQ)
+        {
+            if(!r.Double(&freq))
+            {
+                ok = false;
+                break;
+            }
+            xmlNewProp(c_n, BAD_CAST "freq", BAD_CAST std::to_string(freq).c_str());
+        }
+        if(ok && (flags & DELTA_FLAG_ATTRIBUTES))
+            ok = r.Attributes(xmlNewChild(c_n, NULL, BAD_CAST "attributes", NULL));
+        uint64_t num_dps = 0;
+        if(ok && (flags & DELTA_FLAG_DATAPATHS))
+        {
+            xmlNodePtr dps_n = xmlNewChild(c_n, NULL, BAD_CAST "datapaths", NULL);
+            ok = r.Varint(&num_dps);
+            for(uint64_t j = 0; ok && j < num_dps; j++)
+            {
+                uint64_t target, oriented, dp_type, broadcast_type;
+                double bw, latency;
+                ok = r.Varint(&target) && r.Varint(&oriented) && r.Varint(&dp_type) && r.Double(&bw) && r.Double(&latency) && r.Varint(&broadcast_type);
+                if(!ok)
+                    break;
+                xmlNodePtr dp_n = xmlNewChild(dps_n, NULL, BAD_CAST "datapath", NULL);
+                xmlNewProp(dp_n, BAD_CAST "target", BAD_CAST std::to_string(target).c_str());
+                xmlNewProp(dp_n, BAD_CAST "oriented", BAD_CAST std::to_string(oriented).c_str());
+                xmlNewProp(dp_n, BAD_CAST "dp_type", BAD_CAST std::to_string(dp_type).c_str());
+                xmlNewProp(dp_n, BAD_CAST "bw", BAD_CAST std::to_string(bw).c_str());
+                xmlNewProp(dp_n, BAD_CAST "latency", BAD_CAST std::to_string(latency).c_str());
+                if(broadcast_type != 0)
+                    xmlNewProp(dp_n, BAD_CAST "broadcast_type", BAD_CAST std::to_string(broadcast_type).c_str());
+                ok = r.Attributes(dp_n);
+            }
+        }
+    }
+    if(!ok || r.pos != payload.size())
+    {
+        xmlFreeDoc(doc);
+        return NULL;
+    }
+    return doc;
+}
+
+static bool parseIndex(const string& s, size_t limit, size_t* index)
+{
+    if(s.empty() || s.size() > 18 || s.find_first_not_of("0123456789") != string::npos)
+        return false;
+    *index = std::stoull(s);
+    return *index < limit;
+}
+
+static bool parseInt(const string& s, int* value)
+{
+    if(s.empty())
+        return false;
+    char* end;
+    errno = 0;
+    long v = strtol(s.c_str(), &end, 10);
+    if(*end != '\0' || errno != 0 || v < INT_MIN || v > INT_MAX)
+        return false;
+    *value = (int)v;
+    return true;
+}
+
+static bool parseDouble(const string& s, double* value)
+{
+    if(s.empty())
+        return false;
+    char* end;
+    errno = 0;
+    *value = strtod(s.c_str(), &end);
+    return *end == '\0' && errno == 0;
+}
+
+//the values of a datapath element of a delta
+struct delta_datapath {
+    xmlNodePtr n;
+    size_t target;
+    int oriented, dp_type, broadcast_type;
+    double bw, latency;
+};
+
+//the values of a component element of a delta
+struct delta_component {
+    xmlNodePtr n;
+    Component* c;
+    bool has_freq;
+    double freq;
+    std::map<xmlNodePtr, vector<delta_datapath>> datapaths; /**< by datapaths element */
+};
+
+//applies one delta to the Components of the tree (in DFS order); returns 1 if it is malformed (then nothing is applied)
+static int applyDelta(xmlDocPtr doc, const vector<Component*>& components, const XmlImporter& importer)
+{
+    xmlNodePtr delta_n = xmlDocGetRootElement(doc);
+    if(delta_n == NULL || xmlStrcmp(delta_n->name, BAD_CAST "sys-sage-delta") != 0)
+        return 1;
+    //parse all addresses and numbers first, so that a malformed delta is not applied partially
+    vector<delta_component> changes;
+    for(xmlNodePtr c_n : elementChildren(delta_n))
+    {
+        size_t index;
+        if(xmlStrcmp(c_n->name, BAD_CAST "component") != 0 || !parseIndex(getProp(c_n, "addr"), components.size(), &index))
+            return 1;
+        delta_component change{c_n, components[index], xmlHasProp(c_n, BAD_CAST "freq") != NULL, 0, {}};
+        if(change.has_freq && !parseDouble(getProp(c_n, "freq"), &change.freq))
+            return 1;
+        for(xmlNodePtr child : elementChildren(c_n))
+        {
+            if(xmlStrcmp(child->name, BAD_CAST "datapaths") != 0)
+                continue;
+            vector<delta_datapath>& dps = change.datapaths[child];
+            for(xmlNodePtr dp_n : elementChildren(child))
+            {
+                delta_datapath dp{dp_n, 0, 0, 0, 0, 0, 0};
+                if(!parseIndex(getProp(dp_n, "target"), components.size(), &dp.target) ||
+                   !parseInt(getProp(dp_n, "oriented"), &dp.oriented) || !parseInt(getProp(dp_n, "dp_type"), &dp.dp_type) ||
+                   !parseDouble(getProp(dp_n, "bw"), &dp.bw) || !parseDouble(getProp(dp_n, "latency"), &dp.latency) ||
+                   (xmlHasProp(dp_n, BAD_CAST "broadcast_type") && !parseInt(getProp(dp_n, "broadcast_type"), &dp.broadcast_type)))
+                    return 1;
+                dps.push_back(dp);
+            }
+        }
+        changes.push_back(change);
+    }
+
+    for(delta_component const& change : changes)
+    {
+        Component* c = change.c;
+#ifdef PROC_CPUINFO
+        if(change.has_freq && c->GetComponentType() == SYS_SAGE_COMPONENT_CORE)
+            ((Core*)c)->SetFreq(change.freq);
+#endif
+        for(xmlNodePtr child : elementChildren(change.n))
+        {
+            if(xmlStrcmp(child->name, BAD_CAST "attributes") == 0)
+            {
+                DestroyAttributes(&c->attrib);
+                for(xmlNodePtr a : elementChildren(child))
+                    importer.CollectAttrib(a, c);
+                c->MarkDirty();
+            }
+            else if(xmlStrcmp(child->name, BAD_CAST "datapaths") == 0)
+            {
+                vector<DataPath*> old;
+                for(DataPath* dp : *c->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+                    if(dp->GetSource() == c)
+                        old.push_back(dp);
+                for(DataPath* dp : old)
+                {
+                    DestroyAttributes(&dp->attrib);
+                    c->DeleteDataPath(dp);
+                }
+                for(delta_datapath const& d : change.datapaths.at(child))
+                {
+                    DataPath* dp = new DataPath(c, components[d.target], d.oriented, d.dp_type, d.bw, d.latency, d.broadcast_type);
+                    importer.CollectDataPathAttrib(d.n, dp);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int ApplyDeltas(Component* root, string path, size_t* offset, const XmlImporter& importer)
+{
+    std::ifstream in(path, std::ios::binary);
+    if(!in)
+    {
+        std::cerr << "ApplyDeltas: could not read " << path << std::endl;
+        return -1;
+    }
+    //only the tail after the offset is read; data[pos] is at the offset start + pos of the file
+    in.seekg(0, std::ios::end);
+    size_t start = std::min(offset != NULL ? *offset : 0, (size_t)in.tellg());
+    in.seekg(start);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    string data = ss.str();
+
+    vector<Component*> components;
+    getComponentsDfs(root, &components);
+
+    size_t pos = 0;
+    int applied = 0;
+    const size_t magic_len = strlen(SYS_SAGE_DELTA_BINARY_MAGIC);
+    const size_t end_len = strlen(SYS_SAGE_DELTA_XML_END);
+    while(true)
+    {
+        pos = data.find_first_not_of(" \t\r\n", pos);
+        if(pos == string::npos)
+        {
+            pos = data.size();
+            break;
+        }
+        xmlDocPtr doc;
+        size_t end;
+        if(data.compare(pos, magic_len, SYS_SAGE_DELTA_BINARY_MAGIC) == 0)
+        {
+            //a record that is not complete yet (the producer is writing it) ends the log
+            if(data.size() - pos < magic_len + 4)
+                break;
+            uint32_t len = 0;
+            for(int i = 0; i < 4; i++)
+                len |= (uint32_t)(unsigned char)data[pos + magic_len + i] << (8 * i);
+            if(data.size() - pos - magic_len - 4 < len)
+                break;
+            end = pos + magic_len + 4 + len;
+            doc = decodeBinaryDelta(data.substr(pos + magic_len + 4, len));
+        }
+        else if(data[pos] == '<')
+        {
+            end = data.find(SYS_SAGE_DELTA_XML_END, pos);
+            if(end == string::npos)
+                break;
+            end += end_len;
+            doc = xmlReadMemory(data.data() + pos, end - pos, NULL, NULL, 0);
+        }
+        else
+            doc = NULL;
+        int ret = doc != NULL ? applyDelta(doc, components, importer) : 1;
+        if(doc != NULL)
+            xmlFreeDoc(doc);
+        if(ret != 0)
+        {
+            std::cerr << "ApplyDeltas: malformed delta at offset " << start + pos << " of " << path << std::endl;
+            if(offset != NULL)
+                *offset = start + pos;
+            return -1;
+        }
+        applied++;
+        pos = end;
+    }
+    if(offset != NULL)
+        *offset = start + pos;
+    return applied;
+}
@@ -0,0 +1,96 @@
+#ifndef CHANGE_TRACKER
+#define CHANGE_TRACKER
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Component.hpp"
+#include "xml_dump.hpp"
+#include "xml_load.hpp"
+
+/*! \file */
+
+using namespace std;
+
+#define SYS_SAGE_DELTA_XML 0 /**< Delta log format: each delta is an XML document (sys-sage-delta) appended to the log. */
+#define SYS_SAGE_DELTA_BINARY 1 /**< Delta log format: each delta is a binary record ("SSD1", length, entries). */
+
+/**
+Class ChangeTracker tracks the changes of a Component Tree since a checkpoint, so that the periodically changing state (e.g. attributes such as freq_history, CATcos or mig_size, the frequencies of the Cores, the DataPaths of MIG instances) can be shipped as a log of small deltas instead of full exports.
+\n The tracker keeps a fingerprint of each Component of the tree: its attributes (and the frequency of a Core), and its DataPaths (those whose source it is). GetChanges() compares the tree with the fingerprints of the last checkpoint; AppendDelta() appends the changed Components to a delta log and takes a new checkpoint. The static part of the tree is written only once, by WriteSnapshot().
+\n A consumer imports the snapshot (importFromXml()) and follows the log with ApplyDeltas(). The Components are identified by their index in the DFS order of the tree, i.e. their addr in the snapshot. A delta describes the changed Components completely (all their attributes, all their DataPaths), so applying it replaces their previous state.
+\n Adding or removing Components changes the indices, which a delta cannot describe; AppendDelta() reports it, and a new snapshot has to be written.
+\n Example:
+\n ChangeTracker tracker(topo);
+\n tracker.WriteSnapshot("topo.xml");
+\n while(...) { node->RefreshCpuCoreFrequency(true); tracker.AppendDelta("topo.delta"); }
+\n consumer: Component* t = importFromXml("topo.xml"); size_t offset = 0; ApplyDeltas(t, "topo.delta", &offset);
+*/
+class ChangeTracker {
+public:
+    /**
+    ChangeTracker constructor; takes the first checkpoint.
+    @param _root - root of the tracked tree
+    @param _exporter - export context used for the snapshots and the attributes of the deltas (custom attribute callbacks, attribute allow-list); the Component filters of its options are not used, the deltas always cover the whole tree
+    */
+    ChangeTracker(Component* _root, const XmlExporter& _exporter = XmlExporter());
+
+    /**
+    Records the current state of the tree as the checkpoint.
+    */
+    void Checkpoint();
+    /**
+    Finds the Components that changed since the checkpoint.
+    @param attributes - output (if not NULL): the Components whose attributes (or frequency) changed
+    @param datapaths - output (if not NULL): the Components whose DataPaths changed
+    @return 0 on success, 1 if Components were added or removed since the checkpoint (the outputs are then empty)
+    */
+    int GetChanges(vector<Component*>* attributes, vector<Component*>* datapaths);
+    /**
+    Exports the whole tree (the base of a delta log) and takes a checkpoint.
+    @param path - path of the XML file
+    @return 0 on success, 1 if the file could not be written
+    */
+    int WriteSnapshot(string path);
+    /**
+    Appends the changes since the checkpoint to a delta log and takes a checkpoint. Nothing is appended if nothing changed.
+    @param path - path of the delta log
+    @param format - SYS_SAGE_DELTA_XML (default) or SYS_SAGE_DELTA_BINARY
+    @return 0 on success, 1 if the log could not be written, 2 if Components were added or removed (nothing is appended; write a new snapshot)
+    */
+    int AppendDelta(string path, int format = SYS_SAGE_DELTA_XML);
+    /**
+    @returns the number of deltas appended so far
+    */
+    int GetSequenceNumber();
+
+private:
+    struct ComponentState {
+        Component* component;
+        int type;
+        uint64_t attrib_hash;
+        uint64_t freq_bits;
+        uint64_t dp_hash;
+    };
+    vector<ComponentState> scan();
+    xmlDocPtr createDelta(const vector<ComponentState>& current, const vector<bool>& attrib_changed, const vector<bool>& dp_changed);
+
+    Component* root;
+    XmlExporter exporter;
+    vector<ComponentState> checkpoint;
+    int seq;
+};
+
+/**
+Applies the deltas of a delta log (written by ChangeTracker::AppendDelta(), in either format) to a tree imported from the snapshot of the log.
+\n The attributes of a changed Component are replaced; the replaced values of registered attribute keys are destroyed with their AttributeHandler (see DestroyAttributes()): the tree must own its attribute values, as after importFromXml() (Component::ExpandInstance() and PatchTopology() give the new Components copies of the values). The DataPaths of a changed Component (those whose source it is) are deleted and created again.
+@param root - root of the tree imported from the snapshot
+@param path - path of the delta log
+@param offset - input/output (if not NULL): the position in the log to start at (only the part of the log after it is read), set to the end of the last applied delta, so that a consumer can follow a growing log
+@param importer - import context (custom attribute callbacks)
+@return the number of applied deltas, or -1 if the log could not be read or contains a malformed delta (the deltas before it are applied)
+*/
+int ApplyDeltas(Component* root, string path, size_t* offset = NULL, const XmlImporter& importer = XmlImporter());
+
+#endif
@@ -1,6 +1,10 @@
 #include "Component.hpp"
+#include "Attribute.hpp"
+#include "xml_load.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <unordered_map>
 
 void Component::PrintSubtree() { PrintSubtree(0); }
 void Component::PrintSubtree(int level)
@@ -48,6 +52,7 @@ void Component::InsertChild(Component * child)
 {
     child->SetParent(this);
     children.push_back(child);
+    MarkDirty();
 }
 int Component::InsertBetweenParentAndChild(Component* parent, Component* child, bool alreadyParentsChild)
 {
@@ -115,6 +120,7 @@ int Component::RemoveChild(Component * child)
 {
     int orig_size = children.size();
     children.erase(std::remove(children.begin(), children.end(), child), children.end());
+    MarkDirty();
     return orig_size - children.size();
     //return std::erase(children, child); -- not supported in some compilers
 }
@@ -312,10 +318,10 @@ void Component::GetAllSubcomponentsByType(vector<Component*>* outArray, int _com
 
 int Component::CountAllSubcomponents()
 {
-    int cnt = children.size();
+    int cnt = 0;
     for(Component * child : children)
     {
-        cnt += child->CountAllSubcomponents();
+        cnt += child->GetInstanceCount() * (1 + child->CountAllSubcomponents());
     }
     return cnt;
 }
@@ -325,12 +331,8 @@ int Component::CountAllSubcomponentsByType(int _componentType)
     int cnt = 0;
     for(Component * child : children)
     {
-        if(child->GetComponentType() == _componentType)
-            cnt++;
-    }
-    for(Component * child : children)
-    {
-        cnt += child->CountAllSubcomponentsByType(_componentType);
+        int child_cnt = (child->GetComponentType() == _componentType) ? 1 : 0;
+        cnt += child->GetInstanceCount() * (child_cnt + child->CountAllSubcomponentsByType(_componentType));
     }
     return cnt;
 }
@@ -341,7 +343,7 @@ int Component::CountAllChildrenByType(int _componentType)
     for(Component * child : children)
     {
         if(child->GetComponentType() == _componentType)
-            cnt++;
+            cnt += child->GetInstanceCount();
     }
 
     return cnt;
@@ -369,10 +371,18 @@ void Component::AddDataPath(DataPath* p, int orientation)
         dp_outgoing.push_back(p);
     else if(orientation == SYS_SAGE_DATAPATH_INCOMING)
         dp_incoming.push_back(p);
+    MarkDirty(true);
+}
+
+void Component::loadLazyDataPaths()
+{
+    if(lazy_datapaths)
+        lazy_loader->LoadDataPaths(this);
 }
 
 DataPath* Component::GetDataPathByType(int dp_type, int orientation)
 {
+    loadLazyDataPaths();
     if(orientation & SYS_SAGE_DATAPATH_OUTGOING){
         for(DataPath* dp : dp_outgoing){
             if(dp->GetDataPathType() == dp_type)
@@ -381,14 +391,23 @@ DataPath* Component::GetDataPathByType(int dp_type, int orientation)
     }
     if(orientation & SYS_SAGE_DATAPATH_INCOMING){
         for(DataPath* dp : dp_incoming){
-            if(dp->GetDataPathType() == dp_type)
+            if(dp->GetDataPathType() == dp_type && (!dp->IsBroadcast() || (dp->GetBroadcastType() & componentType)))
                 return dp;
         }
+        //broadcast data paths to the subtree of an ancestor
+        for(Component* a = parent; a != NULL; a = a->parent){
+            a->loadLazyDataPaths();
+            for(DataPath* dp : a->dp_incoming){
+                if(dp->GetDataPathType() == dp_type && (dp->GetBroadcastType() & componentType))
+                    return dp;
+            }
+        }
     }
     return NULL;
 }
 void Component::GetAllDataPathsByType(vector<DataPath*>* outDpArr, int dp_type, int orientation)
 {
+    loadLazyDataPaths();
     if(orientation & SYS_SAGE_DATAPATH_OUTGOING){
         for(DataPath* dp : dp_outgoing){
             if(dp->GetDataPathType() == dp_type)
@@ -397,9 +416,17 @@ void Component::GetAllDataPathsByType(vector<DataPath*>* outDpArr, int dp_type,
     }
     if(orientation & SYS_SAGE_DATAPATH_INCOMING){
         for(DataPath* dp : dp_incoming){
-            if(dp->GetDataPathType() == dp_type)
+            if(dp->GetDataPathType() == dp_type && (!dp->IsBroadcast() || (dp->GetBroadcastType() & componentType)))
                 outDpArr->push_back(dp);
         }
+        //broadcast data paths to the subtree of an ancestor
+        for(Component* a = parent; a != NULL; a = a->parent){
+            a->loadLazyDataPaths();
+            for(DataPath* dp : a->dp_incoming){
+                if(dp->GetDataPathType() == dp_type && (dp->GetBroadcastType() & componentType))
+                    outDpArr->push_back(dp);
+            }
+        }
     }
     return;
 }
@@ -413,6 +440,7 @@ vector<DataPath*> Component::GetAllDataPathsByType(int dp_type, int orientation)
 
 vector<DataPath*>* Component::GetDataPaths(int orientation)
 {
+    loadLazyDataPaths();
     if(orientation == SYS_SAGE_DATAPATH_INCOMING)
         return &dp_incoming;
     else if(orientation == SYS_SAGE_DATAPATH_OUTGOING)
@@ -473,7 +501,8 @@ int Component::GetTopologySize(unsigned * out_component_size, unsigned * out_dat
 
 int Component::GetTopologySize(unsigned * out_component_size, unsigned * out_dataPathSize, std::set<DataPath*>* counted_dataPaths)
 {
-    if(counted_dataPaths == NULL)
+    bool own_counted_dataPaths = (counted_dataPaths == NULL);
+    if(own_counted_dataPaths)
         counted_dataPaths = new std::set<DataPath*>();
 
     int component_size = 0;
@@ -512,8 +541,9 @@ int Component::GetTopologySize(unsigned * out_component_size, unsigned * out_dat
             component_size += sizeof(Topology);
         break;
     }
-    component_size += attrib.size()*(sizeof(string)+sizeof(void*)); //TODO improve
+    component_size += GetAttributesSize(attrib);
     component_size += children.size()*sizeof(Component*);
+    component_size += instance_ids.size()*sizeof(int);
     (*out_component_size) += component_size;
 
     int dataPathSize = 0;
@@ -523,7 +553,7 @@ int Component::GetTopologySize(unsigned * out_component_size, unsigned * out_dat
         if(!counted_dataPaths->count((DataPath*)(*it))) {
             //cout << "new datapath " << (DataPath*)(*it) << endl;
             dataPathSize += sizeof(DataPath);
-            dataPathSize += (*it)->attrib.size() * (sizeof(string)+sizeof(void*)); //TODO improve
+            dataPathSize += GetAttributesSize((*it)->attrib);
             counted_dataPaths->insert((DataPath*)(*it));
         }
     }
@@ -531,7 +561,7 @@ int Component::GetTopologySize(unsigned * out_component_size, unsigned * out_dat
         if(!counted_dataPaths->count((DataPath*)(*it))){
             //cout << "new datapath " << (DataPath*)(*it) << endl;
             dataPathSize += sizeof(DataPath);
-            dataPathSize += (*it)->attrib.size() * (sizeof(string)+sizeof(void*)); //TODO improve
+            dataPathSize += GetAttributesSize((*it)->attrib);
             counted_dataPaths->insert((DataPath*)(*it));
         }
     }
@@ -542,11 +572,378 @@ int Component::GetTopologySize(unsigned * out_component_size, unsigned * out_dat
         subtreeSize += (*it)->GetTopologySize(out_component_size, out_dataPathSize, counted_dataPaths);
     }
 
-    if(counted_dataPaths != NULL)
+    if(own_counted_dataPaths)
         delete counted_dataPaths;
     return component_size + dataPathSize + subtreeSize;
 }
 
+void Component::SetInstances(vector<int> ids)
+{
+    instance_ids = ids;
+    count = ids.empty() ? -1 : 1 + ids.size();
+    MarkDirty();
+}
+
+int Component::GetInstanceCount()
+{
+    return 1 + instance_ids.size();
+}
+
+vector<int> Component::GetInstanceIds()
+{
+    return instance_ids;
+}
+
+Component* cloneComponentNode(Component* c)
+{
+    Component* copy;
+    switch(c->GetComponentType())
+    {
+        case SYS_SAGE_COMPONENT_THREAD:
+            copy = new Thread(c->GetId(), c->GetName());
+        break;
+        case SYS_SAGE_COMPONENT_CORE:
+            copy = new Core(c->GetId(), c->GetName());
+        break;
+        case SYS_SAGE_COMPONENT_CACHE:{
+            Cache* cache = (Cache*)c;
+            copy = new Cache(c->GetId(), 0, cache->GetCacheSize(), cache->GetCacheAssociativityWays(), cache->GetCacheLineSize());
+            ((Cache*)copy)->SetCacheName(cache->GetCacheName());
+        }
+        break;
+        case SYS_SAGE_COMPONENT_SUBDIVISION:
+            copy = new Subdivision(c->GetId(), c->GetName(), c->GetComponentType());
+            ((Subdivision*)copy)->SetSubdivisionType(((Subdivision*)c)->GetSubdivisionType());
+        break;
+        case SYS_SAGE_COMPONENT_NUMA:
+            copy = new Numa(c->GetId(), ((Numa*)c)->GetSize());
+            ((Numa*)copy)->SetSubdivisionType(((Numa*)c)->GetSubdivisionType());
+        break;
+        case SYS_SAGE_COMPONENT_CHIP:{
+            Chip* chip = (Chip*)c;
+            copy = new Chip(c->GetId(), c->GetName(), chip->GetChipType(), chip->GetVendor(), chip->GetModel());
+        }
+        break;
+        case SYS_SAGE_COMPONENT_MEMORY:
+            copy = new Memory(NULL, c->GetId(), c->GetName(), ((Memory*)c)->GetSize(), ((Memory*)c)->GetIsVolatile());
+        break;
+        case SYS_SAGE_COMPONENT_STORAGE:
+            copy = new Storage(((Storage*)c)->GetSize());
+        break;
+        case SYS_SAGE_COMPONENT_NODE:
+            copy = new Node(c->GetId(), c->GetName());
+        break;
+        default:
+            copy = new Component(c->GetId(), c->GetName(), c->GetComponentType());
+        break;
+    }
+    copy->id = c->id;
+    copy->SetName(c->GetName());
+#ifdef PROC_CPUINFO
+    if(c->GetComponentType() == SYS_SAGE_COMPONENT_CORE)
+        ((Core*)copy)->SetFreq(((Core*)c)->GetFreq());
+#endif
+    copy->SetInstances(c->GetInstanceIds());
+    copy->attrib = CloneAttributes(c->attrib);
+    return copy;
+}
+
+//true if a and b have the same class, properties (except for the id and the instances) and attribute values (see SameAttributes())
+static bool sameComponentNode(Component* a, Component* b)
+{
+    if(a->GetComponentType() != b->GetComponentType() || a->GetName() != b->GetName() || !SameAttributes(a->attrib, b->attrib))
+        return false;
+    switch(a->GetComponentType())
+    {
+        case SYS_SAGE_COMPONENT_CACHE:{
+            Cache* x = (Cache*)a; Cache* y = (Cache*)b;
+            return x->GetCacheName() == y->GetCacheName() && x->GetCacheSize() == y->GetCacheSize() && x->GetCacheAssociativityWays() == y->GetCacheAssociativityWays() && x->GetCacheLineSize() == y->GetCacheLineSize();
+        }
+        case SYS_SAGE_COMPONENT_SUBDIVISION:
+            return ((Subdivision*)a)->GetSubdivisionType() == ((Subdivision*)b)->GetSubdivisionType();
+        case SYS_SAGE_COMPONENT_NUMA:
+            return ((Numa*)a)->GetSize() == ((Numa*)b)->GetSize();
+        case SYS_SAGE_COMPONENT_CHIP:{
+            Chip* x = (Chip*)a; Chip* y = (Chip*)b;
+            return x->GetChipType() == y->GetChipType() && x->GetVendor() == y->GetVendor() && x->GetModel() == y->GetModel();
+        }
+        case SYS_SAGE_COMPONENT_MEMORY:
+            return ((Memory*)a)->GetSize() == ((Memory*)b)->GetSize() && ((Memory*)a)->GetIsVolatile() == ((Memory*)b)->GetIsVolatile();
+        case SYS_SAGE_COMPONENT_STORAGE:
+            return ((Storage*)a)->GetSize() == ((Storage*)b)->GetSize();
+    }
+    return true;
+}
+
+//the other end of dp, seen from c
+static Component* dataPathPeer(DataPath* dp, Component* c)
+{
+    return dp->GetSource() == c ? dp->GetTarget() : dp->GetSource();
+}
+
+//true if the subtrees of a and b are identical except for the ids of a and b themselves (see CollapseIdenticalChildren())
+static bool sameSubtree(Component* a, Component* b)
+{
+    vector<Component*> sub_a = a->GetComponentsInSubtree();
+    vector<Component*> sub_b = b->GetComponentsInSubtree();
+    if(sub_a.size() != sub_b.size())
+        return false;
+    std::unordered_map<Component*,size_t> pos_a, pos_b; //component -> DFS position in its subtree
+    for(size_t i = 0; i < sub_a.size(); i++){
+        if(!sameComponentNode(sub_a[i], sub_b[i]) || sub_a[i]->GetChildren()->size() != sub_b[i]->GetChildren()->size())
+            return false;
+        if(i > 0 && (sub_a[i]->GetId() != sub_b[i]->GetId() || sub_a[i]->GetInstanceIds() != sub_b[i]->GetInstanceIds()))
+            return false;
+        pos_a[sub_a[i]] = i;
+        pos_b[sub_b[i]] = i;
+    }
+    for(size_t i = 0; i < sub_a.size(); i++){
+        for(int orientation : { SYS_SAGE_DATAPATH_OUTGOING, SYS_SAGE_DATAPATH_INCOMING }){
+            vector<DataPath*>* dps_a = sub_a[i]->GetDataPaths(orientation);
+            vector<DataPath*>* dps_b = sub_b[i]->GetDataPaths(orientation);
+            if(dps_a->size() != dps_b->size())
+                return false;
+            for(size_t j = 0; j < dps_a->size(); j++){
+                DataPath* x = (*dps_a)[j];
+                DataPath* y = (*dps_b)[j];
+                if(x->GetDataPathType() != y->GetDataPathType() || x->GetOrientation() != y->GetOrientation() || x->GetBandwidth() != y->GetBandwidth() || x->GetLatency() != y->GetLatency() || x->GetBroadcastType() != y->GetBroadcastType() || !SameAttributes(x->attrib, y->attrib) || (x->GetSource() == sub_a[i]) != (y->GetSource() == sub_b[i]))
+                    return false;
+                Component* peer_a = dataPathPeer(x, sub_a[i]);
+                Component* peer_b = dataPathPeer(y, sub_b[i]);
+                auto in_a = pos_a.find(peer_a);
+                auto in_b = pos_b.find(peer_b);
+                if((in_a == pos_a.end()) != (in_b == pos_b.end()))
+                    return false;
+                if(in_a == pos_a.end() ? peer_a != peer_b : in_a->second != in_b->second)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+Component* Component::ExpandInstance(int instance_id)
+{
+    auto it = std::find(instance_ids.begin(), instance_ids.end(), instance_id);
+    if(it == instance_ids.end() || parent == NULL)
+        return NULL;
+    instance_ids.erase(it);
+    count = instance_ids.empty() ? -1 : 1 + instance_ids.size();
+
+    //copy the components
+    vector<Component*> sub = GetComponentsInSubtree();
+    std::unordered_map<Component*,Component*> copy_of;
+    for(Component* c : sub){
+        Component* copy = cloneComponentNode(c);
+        copy->id = c->id;
+        copy_of[c] = copy;
+        if(c != this)
+            copy_of[c->GetParent()]->InsertChild(copy);
+    }
+    Component* ret = copy_of[this];
+    ret->id = instance_id;
+    ret->SetInstances({});
+    parent->InsertChild(ret);
+
+    //copy the data paths; a data path between two components of the subtree is copied once
+    std::set<DataPath*> copied;
+    for(Component* c : sub){
+        for(int orientation : { SYS_SAGE_DATAPATH_OUTGOING, SYS_SAGE_DATAPATH_INCOMING }){
+            for(DataPath* dp : *c->GetDataPaths(orientation)){
+                if(!copied.insert(dp).second)
+                    continue;
+                auto src = copy_of.find(dp->GetSource());
+                auto trg = copy_of.find(dp->GetTarget());
+                DataPath* copy = new DataPath(src == copy_of.end() ? dp->GetSource() : src->second, trg == copy_of.end() ? dp->GetTarget() : trg->second, dp->GetOrientation(), dp->GetDataPathType(), dp->GetBandwidth(), dp->GetLatency(), dp->GetBroadcastType());
+                copy->attrib = CloneAttributes(dp->attrib);
+            }
+        }
+    }
+    return ret;
+}
+
+int Component::ExpandAllInstances()
+{
+    int cnt = 0;
+    //the instances are copies of an already expanded prototype subtree
+    for(size_t i = 0; i < children.size(); i++)
+        cnt += children[i]->ExpandAllInstances();
+    while(!instance_ids.empty()){
+        if(ExpandInstance(instance_ids.front()) == NULL)
+            break;
+        cnt++;
+    }
+    return cnt;
+}
+
+Component* Component::GetOrExpandSubcomponentById(int _id, int _componentType)
+{
+    Component* ret = GetSubcomponentById(_id, _componentType);
+    if(ret != NULL)
+        return ret;
+    vector<Component*> prototypes = GetAllSubcomponentsByType(_componentType);
+    for(Component* c : prototypes){
+        vector<int> ids = c->GetInstanceIds();
+        if(std::find(ids.begin(), ids.end(), _id) != ids.end())
+            return c->ExpandInstance(_id);
+    }
+    return NULL;
+}
+
+int Component::CollapseIdenticalChildren()
+{
+    int cnt = 0;
+    vector<Component*> prototypes;
+    for(size_t i = 0; i < children.size(); )
+    {
+        Component* child = children[i];
+        Component* prototype = NULL;
+        for(Component* p : prototypes){
+            if(sameSubtree(p, child)){
+                prototype = p;
+                break;
+            }
+        }
+        if(prototype == NULL){
+            prototypes.push_back(child);
+            i++;
+            continue;
+        }
+        vector<int> ids = prototype->GetInstanceIds();
+        ids.push_back(child->GetId());
+        for(int id : child->GetInstanceIds())
+            ids.push_back(id);
+        prototype->SetInstances(ids);
+        //the Components deleted with the child (its instances are represented by the prototype now)
+        cnt += child->GetComponentsInSubtree().size();
+        child->Delete(true);
+    }
+    for(Component* child : children)
+        cnt += child->CollapseIdenticalChildren();
+    return cnt;
+}
+
+static uint64_t hashString(const string& s, uint64_t h)
+{
+    h = HashValue(s.size(), h);
+    return HashBytes(s.data(), s.size(), h);
+}
+
+//hash of the properties of c itself (not of its children nor DataPaths)
+static uint64_t hashComponentNode(Component* c, bool ignore_id, uint64_t h)
+{
+    h = HashValue(c->GetComponentType(), h);
+    if(!ignore_id)
+    {
+        h = HashValue(c->GetId(), h);
+        h = hashString(c->GetName(), h);
+        vector<int> ids = c->GetInstanceIds();
+        h = HashValue(ids.size(), h);
+        h = HashBytes(ids.data(), ids.size() * sizeof(int), h);
+    }
+    switch(c->GetComponentType())
+    {
+        case SYS_SAGE_COMPONENT_CACHE:{
+            Cache* x = (Cache*)c;
+            h = hashString(x->GetCacheName(), h);
+            h = HashValue(x->GetCacheSize(), h);
+            h = HashValue(x->GetCacheAssociativityWays(), h);
+            h = HashValue(x->GetCacheLineSize(), h);
+            break;
+        }
+        case SYS_SAGE_COMPONENT_SUBDIVISION:
+            h = HashValue(((Subdivision*)c)->GetSubdivisionType(), h);
+            break;
+        case SYS_SAGE_COMPONENT_NUMA:
+            h = HashValue(((Numa*)c)->GetSubdivisionType(), h);
+            h = HashValue(((Numa*)c)->GetSize(), h);
+            break;
+        case SYS_SAGE_COMPONENT_CHIP:{
+            Chip* x = (Chip*)c;
+            h = HashValue(x->GetChipType(), h);
+            h = hashString(x->GetVendor(), h);
+            h = hashString(x->GetModel(), h);
+            break;
+        }
+        case SYS_SAGE_COMPONENT_MEMORY:
+            h = HashValue(((Memory*)c)->GetSize(), h);
+            h = HashValue(((Memory*)c)->GetIsVolatile(), h);
+            break;
+        case SYS_SAGE_COMPONENT_STORAGE:
+            h = HashValue(((Storage*)c)->GetSize(), h);
+            break;
+#ifdef PROC_CPUINFO
+        case SYS_SAGE_COMPONENT_CORE:
+            h = HashValue(((Core*)c)->GetFreq(), h);
+            break;
+#endif
+    }
+    return HashAttributes(c->attrib, h);
+}
+
+static uint64_t hashDataPath(DataPath* dp, uint64_t h)
+{
+    h = HashValue(dp->GetDataPathType(), h);
+    h = HashValue(dp->GetOrientation(), h);
+    h = HashValue(dp->GetBandwidth(), h);
+    h = HashValue(dp->GetLatency(), h);
+    h = HashValue(dp->GetBroadcastType(), h);
+    h = HashValue(dp->GetTarget()->GetComponentType(), h);
+    h = HashValue(dp->GetTarget()->GetId(), h);
+    return HashAttributes(dp->attrib, h);
+}
+
+uint64_t Component::GetHash(int flags)
+{
+    bool datapaths = flags & SYS_SAGE_HASH_DATAPATHS;
+    bool cached = !(flags & (SYS_SAGE_HASH_IGNORE_ID | SYS_SAGE_HASH_NO_CHILDREN));
+    if(cached && datapaths && !hash_datapaths_dirty)
+        return hash_datapaths;
+    if(cached && !datapaths && !hash_dirty)
+        return hash;
+
+    uint64_t h = hashComponentNode(this, flags & SYS_SAGE_HASH_IGNORE_ID, HashBytes(NULL, 0));
+    if(!(flags & SYS_SAGE_HASH_NO_CHILDREN))
+    {
+        h = HashValue(children.size(), h);
+        for(Component* child : children)
+            h = HashValue(child->GetHash(flags & SYS_SAGE_HASH_DATAPATHS), h);
+    }
+    if(datapaths)
+    {
+        loadLazyDataPaths();
+        //a DataPath is hashed by its source (a bidirectional one is also listed in dp_outgoing of its target); the order of the DataPaths does not matter
+        uint64_t dps = 0;
+        for(DataPath* dp : dp_outgoing)
+            if(dp->GetSource() == this)
+                dps += hashDataPath(dp, HashBytes(NULL, 0));
+        h = HashValue(dps, h);
+    }
+    if(!cached)
+        return h;
+    if(datapaths){
+        hash_datapaths = h;
+        hash_datapaths_dirty = false;
+    }else{
+        hash = h;
+        hash_dirty = false;
+    }
+    return h;
+}
+
+void Component::MarkDirty(bool datapaths_only)
+{
+    //the ancestors of a dirty Component are dirty, so the walk stops at the first one already marked
+    for(Component* c = this; c != NULL; c = c->parent)
+    {
+        if(c->hash_datapaths_dirty && (datapaths_only || c->hash_dirty))
+            break;
+        c->hash_datapaths_dirty = true;
+        if(!datapaths_only)
+            c->hash_dirty = true;
+    }
+}
+
 int Component::GetDepth(bool refresh)
 {
     if(refresh)
@@ -570,6 +967,9 @@ void Component::DeleteDataPath(DataPath * dp)
 
 void Component::DeleteAllDataPaths()
 {
+    //when called directly, the DataPaths not loaded yet would be loaded (and reappear) later, so they are loaded and deleted now;
+    //Delete() calls XmlLazyLoader::Forget() first, which detaches the loader (nothing is loaded here) and makes it skip the DataPaths of this component
+    loadLazyDataPaths();
     while(!dp_outgoing.empty())
     {
         DataPath * dp = dp_outgoing.back();
@@ -591,6 +991,8 @@ void Component::DeleteSubtree()
 }
 void Component::Delete(bool withSubtree)
 {
+    if(lazy_loader != nullptr)
+        lazy_loader->Forget(this);
     // Delete subtree and all data paths
     if (withSubtree)
     {
@@ -624,7 +1026,7 @@ void Component::Delete(bool withSubtree)
     delete this;
 }
 
-void Component::SetName(string _name){ name = _name; }
+void Component::SetName(string _name){ name = _name; MarkDirty(); }
 Component* Component::GetParent(){return parent;}
 void Component::SetParent(Component* _parent){parent = _parent;}
 vector<Component*>* Component::GetChildren(){return &children;}
@@ -632,29 +1034,29 @@ int Component::GetComponentType(){return componentType;}
 string Component::GetName(){return name;}
 int Component::GetId(){return id;}
 
-void Storage::SetSize(long long _size){size = _size;} 
+void Storage::SetSize(long long _size){size = _size; MarkDirty();} 
 long long Storage::GetSize(){return size;}
 
 string Chip::GetVendor(){return vendor;}
-void Chip::SetVendor(string _vendor){vendor = _vendor;}
+void Chip::SetVendor(string _vendor){vendor = _vendor; MarkDirty();}
 string Chip::GetModel(){return model;}
-void Chip::SetModel(string _model){model = _model;}
-void Chip::SetChipType(int chipType){type = chipType;}
+void Chip::SetModel(string _model){model = _model; MarkDirty();}
+void Chip::SetChipType(int chipType){type = chipType; MarkDirty();}
 int Chip::GetChipType(){return type;}
 
-void Subdivision::SetSubdivisionType(int subdivisionType){type = subdivisionType;}
+void Subdivision::SetSubdivisionType(int subdivisionType){type = subdivisionType; MarkDirty();}
 int Subdivision::GetSubdivisionType(){return type;}
 
 long long Numa::GetSize(){return size;}
-void Numa::SetSize(long long _size) { size = _size;}
+void Numa::SetSize(long long _size) { size = _size; MarkDirty();}
 
 long long Memory::GetSize() {return size;}
-void Memory::SetSize(long long _size) {size = _size;}
+void Memory::SetSize(long long _size) {size = _size; MarkDirty();}
 bool Memory::GetIsVolatile() {return is_volatile;}
-void Memory::SetIsVolatile(bool _is_volatile) {is_volatile = _is_volatile;}
+void Memory::SetIsVolatile(bool _is_volatile) {is_volatile = _is_volatile; MarkDirty();}
 
 string Cache::GetCacheName(){return cache_type;}
-void Cache::SetCacheName(string _name) { cache_type = _name;}
+void Cache::SetCacheName(string _name) { cache_type = _name; MarkDirty();}
 
 int Cache::GetCacheLevel(){
 
@@ -674,13 +1076,13 @@ int Cache::GetCacheLevel(){
     
 }
 
-void Cache::SetCacheLevel(int _cache_level) { cache_type = to_string(_cache_level); }
+void Cache::SetCacheLevel(int _cache_level) { cache_type = to_string(_cache_level); MarkDirty(); }
 long long Cache::GetCacheSize(){return cache_size;}
-void Cache::SetCacheSize(long long _cache_size){cache_size = _cache_size;}
+void Cache::SetCacheSize(long long _cache_size){cache_size = _cache_size; MarkDirty();}
 int Cache::GetCacheLineSize(){return cache_line_size;}
-void Cache::SetCacheLineSize(int _cache_line_size){cache_line_size = _cache_line_size;}
+void Cache::SetCacheLineSize(int _cache_line_size){cache_line_size = _cache_line_size; MarkDirty();}
 int Cache::GetCacheAssociativityWays(){return cache_associativity_ways;}
-void Cache::SetCacheAssociativityWays(int _associativity) { cache_associativity_ways = _associativity;}
+void Cache::SetCacheAssociativityWays(int _associativity) { cache_associativity_ways = _associativity; MarkDirty();}
 
 Component::Component(int _id, string _name, int _componentType) : id(_id), name(_name), componentType(_componentType)
 {
@@ -714,7 +1116,7 @@ Chip::Chip(Component * parent, int _id, string _name, int _type, string _vendor,
 
 Cache::Cache(int _id, int  _cache_level, long long _cache_size, int _associativity, int _cache_line_size): Component(_id, "Cache", SYS_SAGE_COMPONENT_CACHE), cache_type(to_string(_cache_level)), cache_size(_cache_size), cache_associativity_ways(_associativity), cache_line_size(_cache_line_size){}
 Cache::Cache(Component * parent, int _id, string _cache_type, long long _cache_size, int _associativity, int _cache_line_size): Component(parent, _id, "Cache", SYS_SAGE_COMPONENT_CACHE), cache_type(_cache_type), cache_size(_cache_size), cache_associativity_ways(_associativity), cache_line_size(_cache_line_size){}
-Cache::Cache(Component * parent, int _id, int _cache_level, long long _cache_size, int _associativity, int _cache_line_size): Cache(parent, _id, to_string(_cache_level), _cache_size, _associativity, -1){}
+Cache::Cache(Component * parent, int _id, int _cache_level, long long _cache_size, int _associativity, int _cache_line_size): Cache(parent, _id, to_string(_cache_level), _cache_size, _associativity, _cache_line_size){}
 
 Subdivision::Subdivision(Component * parent, int _id, string _name, int _componentType): Component(parent, _id, _name, _componentType)
 {
@@ -735,3 +1137,135 @@ Core::Core(Component * parent, int _id, string _name):Component(parent, _id, _na
 
 Thread::Thread(int _id, string _name):Component(_id, _name, SYS_SAGE_COMPONENT_THREAD){}
 Thread::Thread(Component * parent, int _id, string _name):Component(parent, _id, _name, SYS_SAGE_COMPONENT_THREAD){}
+
+#if defined(INTEL_PQOS) || defined(RESCTRL)
+long long Thread::GetCATAwareL3Size()
+{
+    //look for dp_outgoing where attrib contains "CATL3mask"
+    for(auto it = std::begin(dp_outgoing); it != std::end(dp_outgoing); ++it)
+    {
+        DataPath* dp = *it;
+        auto search = dp->attrib.find("CATL3mask");
+        if (search == dp->attrib.end()) {
+            continue;
+        }
+        uint64_t* mask = (uint64_t*)search->second;
+
+        Cache* c = (Cache*)dp->GetTarget();
+        int ways = c->GetCacheAssociativityWays();
+        uint64_t all_ways = ways >= 64 ? ~0ull : (1ull << ways) - 1;
+        int available_cache_associativity_ways = std::popcount(*mask & all_ways);
+        return c->GetCacheSize() / ways * available_cache_associativity_ways ;
+    }
+
+    Component* c = (Component*)this;
+    while(c->GetParent() != NULL){
+        //go up until L3 found
+        c = c->GetParent();
+        if(c->GetComponentType() == SYS_SAGE_COMPONENT_CACHE && ((Cache*)c)->GetCacheLevel() == 3)
+            return ((Cache*)c)->GetCacheSize();
+    };
+    return -1;
+}
+
+CATAwareL3Sizes Node::GetCATAwareL3Sizes(const map<int,uint64_t>& thread_cos, const map<uint64_t,uint64_t>& cos_masks)
+{
+    CATAwareL3Sizes ret;
+    vector<Component*> threads;
+    GetAllSubcomponentsByType(&threads, SYS_SAGE_COMPONENT_THREAD);
+    size_t n = threads.size();
+    ret.thread_id.resize(n);
+    ret.l3_id.assign(n, -1);
+    ret.cos.assign(n, -1);
+    ret.mask.assign(n, 0);
+    ret.cos_threads.assign(n, 0);
+    ret.l3_size.assign(n, -1);
+    ret.effective_l3_size.assign(n, -1);
+
+    //current settings: L3 and COS/mask of each HW thread
+    vector<Cache*> l3(n, NULL);
+    map<pair<Cache*,int>,uint64_t> current_masks; //(L3, COS) -> mask
+    for(size_t i = 0; i < n; i++)
+    {
+        ret.thread_id[i] = threads[i]->GetId();
+        for(Component* p = threads[i]->GetParent(); p != NULL && l3[i] == NULL; p = p->GetParent())
+            if(p->GetComponentType() == SYS_SAGE_COMPONENT_CACHE && ((Cache*)p)->GetCacheLevel() == 3)
+                l3[i] = (Cache*)p;
+        if(l3[i] == NULL)
+            continue;
+        ret.l3_id[i] = l3[i]->GetId();
+        int ways = l3[i]->GetCacheAssociativityWays();
+        ret.mask[i] = ways <= 0 ? 0 : (ways >= 64 ? ~0ull : (1ull << ways) - 1);
+        for(DataPath* dp : *threads[i]->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+        {
+            if(dp->GetDataPathType() != SYS_SAGE_DATAPATH_TYPE_L3CAT || dp->GetTarget() != l3[i])
+                continue;
+            auto cos = dp->attrib.find("CATcos");
+            auto mask = dp->attrib.find("CATL3mask");
+            if(cos == dp->attrib.end() || mask == dp->attrib.end())
+                continue;
+            ret.cos[i] = (int)*(uint64_t*)cos->second;
+            ret.mask[i] &= *(uint64_t*)mask->second;
+            current_masks[{l3[i], ret.cos[i]}] = ret.mask[i];
+            break;
+        }
+    }
+
+    //hypothetical settings
+    for(size_t i = 0; i < n; i++)
+    {
+        if(l3[i] == NULL)
+            continue;
+        auto moved = thread_cos.find(ret.thread_id[i]);
+        if(moved != thread_cos.end() && (int)moved->second != ret.cos[i]){
+            ret.cos[i] = (int)moved->second;
+            auto m = current_masks.find({l3[i], ret.cos[i]});
+            int ways = l3[i]->GetCacheAssociativityWays();
+            ret.mask[i] = m != current_masks.end() ? m->second : (ways >= 64 ? ~0ull : (1ull << ways) - 1);
+        }
+        auto m = cos_masks.find((uint64_t)ret.cos[i]);
+        if(ret.cos[i] >= 0 && m != cos_masks.end())
+            ret.mask[i] = m->second;
+    }
+
+    //number of HW threads per (L3, COS) and per (L3, way)
+    map<pair<Cache*,int>,int> cos_count;
+    map<Cache*,vector<int>> way_users;
+    for(size_t i = 0; i < n; i++)
+    {
+        if(l3[i] == NULL)
+            continue;
+        cos_count[{l3[i], ret.cos[i]}]++;
+        vector<int>& users = way_users[l3[i]];
+        users.resize(std::max(l3[i]->GetCacheAssociativityWays(), 0), 0);
+        for(size_t way = 0; way < users.size() && way < 64; way++)
+            if(ret.mask[i] & (1ull << way))
+                users[way]++;
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if(l3[i] == NULL)
+            continue;
+        ret.cos_threads[i] = cos_count[{l3[i], ret.cos[i]}];
+        int ways = l3[i]->GetCacheAssociativityWays();
+        if(ways <= 0){
+            ret.l3_size[i] = ret.effective_l3_size[i] = l3[i]->GetCacheSize();
+            continue;
+        }
+        long long way_size = l3[i]->GetCacheSize() / ways;
+        vector<int>& users = way_users[l3[i]];
+        double effective = 0;
+        ret.l3_size[i] = 0;
+        for(size_t way = 0; way < users.size() && way < 64; way++)
+        {
+            if(ret.mask[i] & (1ull << way)){
+                ret.l3_size[i] += way_size;
+                effective += (double)way_size / users[way];
+            }
+        }
+        ret.effective_l3_size[i] = (long long)effective;
+    }
+    return ret;
+}
+#endif
@@ -6,10 +6,13 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <mutex>
+#include <atomic>
 //#include <pybind11/pybind11.h>
 
 #include "defines.hpp"
 #include "DataPath.hpp"
+#include "TimeSeries.hpp"
 #include <libxml/parser.h>
 
 
@@ -33,10 +36,51 @@
 #define SYS_SAGE_CHIP_TYPE_CPU_SOCKET 4 /**< Chip type used for one CPU socket. */
 #define SYS_SAGE_CHIP_TYPE_GPU 8 /**< Chip type used for a GPU.*/
 
+#define SYS_SAGE_HASH_DATAPATHS 1 /**< Component::GetHash(): also hash the DataPaths of the subtree. */
+#define SYS_SAGE_HASH_IGNORE_ID 2 /**< Component::GetHash(): ignore the id, name and instances of the Component itself (not of its descendants), e.g. to find identical Nodes of a cluster. */
+#define SYS_SAGE_HASH_NO_CHILDREN 4 /**< Component::GetHash(): hash only the Component itself (and, with SYS_SAGE_HASH_DATAPATHS, its own DataPaths), not its children. */
+
+#define SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO 1 /**< Frequency is read from "cpu MHz" of /proc/cpuinfo. */
+#define SYS_SAGE_FREQ_SOURCE_CPUFREQ 2 /**< Frequency is read from cpufreq sysfs (scaling_cur_freq, or cpuinfo_cur_freq if not available) through file descriptors kept open between the refreshes. */
+
 
 using namespace std;
 //namespace py = pybind11;
 class DataPath;
+class Core;
+class XmlExporter;
+struct XmlExportState;
+class XmlLazyLoader;
+
+#ifdef PROC_CPUINFO //defined in proc_cpuinfo.cpp
+/**
+Sets the sysfs root used by the SYS_SAGE_FREQ_SOURCE_CPUFREQ frequency source (default "/sys"), e.g. to a captured copy of sysfs for testing.
+\n The file descriptors kept open by previous refreshes are closed.
+*/
+void SetCpufreqSysfsRoot(string sysfsRoot);
+#endif
+#ifdef RESCTRL //defined in resctrl.cpp
+/**
+Sets the paths used by Node::UpdateResctrlSettings(), e.g. to a fake resctrl directory tree for testing.
+@param resctrlRoot - mount point of resctrl (default "/sys/fs/resctrl")
+@param sysfsRoot - sysfs root, where the L3 cache ids (resctrl domain ids) of the HW threads are read (default "/sys")
+*/
+void SetResctrlRoot(string resctrlRoot, string sysfsRoot = "/sys");
+#endif
+#if defined(INTEL_PQOS) || defined(RESCTRL)
+/**
+CAT-aware L3 capacity of all HW threads of a Node, as returned by Node::GetCATAwareL3Sizes(). All vectors have one entry per HW thread (the same index i refers to the same HW thread).
+*/
+struct CATAwareL3Sizes {
+    vector<int> thread_id; /**< id of the HW thread */
+    vector<int> l3_id; /**< id of the L3 cache (class Cache) above the HW thread; -1 if there is none */
+    vector<int> cos; /**< COS (class of service) of the HW thread; -1 if it has no L3CAT data path */
+    vector<uint64_t> mask; /**< L3 way mask of the HW thread (all ways if it has no L3CAT data path) */
+    vector<int> cos_threads; /**< number of HW threads with the same COS in the same L3 cache (including this one) */
+    vector<long long> l3_size; /**< L3 size available to the HW thread, i.e. the size of the ways in its mask (same as Thread::GetCATAwareL3Size()); -1 if there is no L3 */
+    vector<long long> effective_l3_size; /**< fair share of the L3 size: each way in the mask is split evenly among all HW threads of the L3 cache whose masks contain it; -1 if there is no L3 */
+};
+#endif
 
 /**
 Generic class Component - all components inherit from this class, i.e. this class defines attributes and methods common to all components.
@@ -268,20 +312,20 @@ public:
     vector<Component*> GetAllSubcomponentsByType(int _componentType);
     
     /**
-    Counts number of subcomponents (children, their children and so on).
+    Counts number of subcomponents (children, their children and so on). Instanced components (see SetInstances()) are counted with all their instances.
     @return Returns number of subcomponents.
     */
     int CountAllSubcomponents();
     
     /**
-    Counts number of subcomponents (children, their children and so on) matching the requested component type.
+    Counts number of subcomponents (children, their children and so on) matching the requested component type. Instanced components (see SetInstances()) are counted with all their instances.
     @param _componentType - Component type to look for.
     @return Returns number of subcomponents matching the requested component type.
     */
     int CountAllSubcomponentsByType(int _componentType);
 
     /**
-    Counts number of children matching the requested component type.
+    Counts number of children matching the requested component type. Instanced children (see SetInstances()) are counted with all their instances.
 
     @param _componentType - Component type to look for.
     @return Returns number of children matching the requested component type.
@@ -375,6 +419,7 @@ public:
     Returns the DataPaths of this component according to their orientation.
     @param orientation - either SYS_SAGE_DATAPATH_OUTGOING or SYS_SAGE_DATAPATH_INCOMING
     @return Pointer to std::vector<DataPath *> with the result (dp_outgoing on SYS_SAGE_DATAPATH_OUTGOING, or dp_incoming on SYS_SAGE_DATAPATH_INCOMING, otherwise NULL)
+    \n The lists contain the data paths as stored, i.e. a broadcast data path (see DataPath::IsBroadcast()) is only in dp_incoming of the root of its target subtree. Use GetAllDataPathsByType() to resolve the broadcast data paths.
     @see dp_incoming
     @see dp_outgoing
     */
@@ -394,11 +439,12 @@ public:
     @param dp_type - DataPath type (dp_type) to search for
     @param orientation - orientation of the DataPath (SYS_SAGE_DATAPATH_OUTGOING or SYS_SAGE_DATAPATH_INCOMING or a logical or of these)
     @return DataPath pointer to the found data path; NULL if nothing found.
+    \n Incoming data paths include broadcast data paths to this component (see DataPath::IsBroadcast()), also the ones stored at an ancestor.
     */
     DataPath* GetDataPathByType(int dp_type, int orientation);
     /**
     Retrieves all DataPath * from the list of this component's data paths with matching type and orientation.
-    Results are returned in vector<DataPath*>* outDpArr, where first the matching data paths in dp_outgoing are pushed back, then the ones in dp_incoming.
+    Results are returned in vector<DataPath*>* outDpArr, where first the matching data paths in dp_outgoing are pushed back, then the ones in dp_incoming, then the broadcast data paths to this component stored at its ancestors (see DataPath::IsBroadcast()).
     @param dp_type - DataPath type (dp_type) to search for.
     @param orientation - orientation of the DataPath (SYS_SAGE_DATAPATH_OUTGOING or SYS_SAGE_DATAPATH_INCOMING or a logical or of these)
     @param outDpArr - output parameter (vector with results)
@@ -409,7 +455,7 @@ public:
 
     /**
     Retrieves all DataPath * from the list of this component's data paths with matching type and orientation.
-    Results are returned in a vector<DataPath*>*, where first the matching data paths in dp_outgoing are pushed back, then the ones in dp_incoming.
+    Results are returned in a vector<DataPath*>*, where first the matching data paths in dp_outgoing are pushed back, then the ones in dp_incoming, then the broadcast data paths to this component stored at its ancestors (see DataPath::IsBroadcast()).
     @param dp_type - DataPath type (dp_type) to search for.
     @param orientation - orientation of the DataPath (SYS_SAGE_DATAPATH_OUTGOING or SYS_SAGE_DATAPATH_INCOMING or a logical or of these)
     @return A std::vector<DataPath*> with the results.
@@ -430,6 +476,7 @@ public:
     int CheckComponentTreeConsistency();
     /**
     Calculates approximate memory footprint of the subtree of this element (including the relevant data paths).
+    \n The values of the attributes are counted for the keys registered in the attribute registry (see GetAttributesSize()).
     @param out_component_size - output parameter (contains the footprint of the component tree elements); an already allocated unsigned * is the input, the value is expected to be 0 (the result is accumulated here)
     @param out_dataPathSize - output parameter (contains the footprint of the data-path graph elements); an already allocated unsigned * is the input, the value is expected to be 0 (the result is accumulated here)
     @return The total size in bytes
@@ -447,6 +494,59 @@ public:
     */
     int GetTopologySize(unsigned * out_component_size, unsigned * out_dataPathSize, std::set<DataPath*>* counted_dataPaths);
 
+    /**
+    Makes this component (with its subtree) the prototype of instanced components: it then also represents count-1 further components that are identical to it except for their id (flyweight). The instances are not materialized; the counting methods (CountAllSubcomponents(), CountAllSubcomponentsByType(), CountAllChildrenByType()) count them, the search methods returning Component* return only the prototype.
+    \n Components inside the prototype subtree are shared by all instances, i.e. their ids should be local to the subtree (e.g. the HW threads of a GPU SM). Data paths between the prototype subtree and the rest of the tree are logically present for each instance as well.
+    \n An instance is materialized (deep-copied) by ExpandInstance() before it is modified.
+    @param ids - ids of the instances besides the prototype itself (an empty vector makes it a single component again)
+    @see CollapseIdenticalChildren()
+    */
+    void SetInstances(vector<int> ids);
+    /**
+    @returns number of components represented by this component, i.e. 1 + number of not materialized instances (see SetInstances())
+    */
+    int GetInstanceCount();
+    /**
+    @returns ids of the not materialized instances of this component (empty if it is not a prototype)
+    */
+    vector<int> GetInstanceIds();
+    /**
+    Materializes one instance of this prototype: deep-copies the subtree (with the data paths from/to it) and inserts the copy as a new child of the parent, with the instance's id. The copy no longer is an instance of this prototype, so it can be modified independently.
+    \n The attribute values of registered keys are deep-copied as well (see CloneAttributes()); those of unregistered keys are shared with the prototype.
+    @param instance_id - id of the instance
+    @returns the new component, or NULL if this component has no such instance or no parent
+    */
+    Component* ExpandInstance(int instance_id);
+    /**
+    Materializes all instances in the subtree of this component (see ExpandInstance()).
+    @returns number of materialized components
+    */
+    int ExpandAllInstances();
+    /**
+    Searches the subtree for a component with a matching id and componentType like GetSubcomponentById(); if only an instance (see SetInstances()) matches, the instance is materialized (ExpandInstance()) and returned. An instance inside an instanced subtree is materialized in the prototype subtree, i.e. for all instances of the enclosing prototype.
+    @return Component * matching the criteria, or NULL if no match found
+    */
+    Component* GetOrExpandSubcomponentById(int _id, int _componentType);
+    /**
+    Replaces children that are identical to a previous sibling (same class, properties and subtree, equal attribute values (see SameAttributes()) and the same data paths, but a different id) by instances of that sibling (see SetInstances()). The whole subtree is processed top-down, so that e.g. identical nodes are collapsed before their cores are.
+    \n Typically called on a topology built by a parser, e.g. mt4g (identical SMs) or a cluster of identical nodes, to reduce the memory footprint.
+    @returns number of deleted (collapsed) components, including their subtrees
+    */
+    int CollapseIdenticalChildren();
+
+    /**
+    Structural (Merkle) hash of the subtree: covers the type, id, name and instances of the Component, its typed properties (e.g. the size of a Memory, the frequency of a Core), its attributes (see HashAttributes()) and the hashes of its children, in order. Two subtrees with equal hashes are identical (up to hash collisions), so the hash serves as a fast equality check, change detection ("unchanged since the last call") or cache key.
+    \n The hash is cached in each Component and computed again only for the Components changed since (and their ancestors): the modifications made through the API (InsertChild(), SetName(), the setters, new or deleted DataPaths, the refresh functions, ...) call MarkDirty(). Attribute values modified directly in attrib are not noticed; call MarkDirty() after such modifications. Not thread-safe.
+    @param flags - logical or of: SYS_SAGE_HASH_DATAPATHS also covers the DataPaths of the subtree (type, orientation, bandwidth, latency, broadcast type, attributes, and the type and id of the other end), each hashed by its source regardless of their order; SYS_SAGE_HASH_IGNORE_ID ignores the id, name and instances of this Component; SYS_SAGE_HASH_NO_CHILDREN ignores the children. The hashes with SYS_SAGE_HASH_IGNORE_ID or SYS_SAGE_HASH_NO_CHILDREN are not cached, but computed from the cached hashes of the children.
+    @return the hash
+    */
+    uint64_t GetHash(int flags = 0);
+    /**
+    Invalidates the cached hash (see GetHash()) of this Component and of its ancestors.
+    @param datapaths_only - if true, only the DataPaths of this Component changed (e.g. a DataPath was added or its attributes changed), so only the hashes with SYS_SAGE_HASH_DATAPATHS are invalidated
+    */
+    void MarkDirty(bool datapaths_only = false);
+
     /**
      * Retrieves the depth (level) of a component in the topology.
      * @param refresh - Boolean value, if true: recalculate the position (depth) of the component in the tree,
@@ -459,9 +559,12 @@ public:
     /**
     @private
     !!Should normally not be used!! Helper function of XML dump generation.
-    @see exportToXml(Component* root, string path = "", std::function<int(string,void*,string*)> custom_search_attrib_key_fcn = NULL);
+    @param exporter - the export context (custom attribute callbacks); NULL uses the default attributes only
+    @param state - the state of the export (indices of the Components, subtrees created by the parallel export); NULL writes the addresses of the Components as pointers
+    @param depth - depth of the Component below the root of the export (for XmlExportOptions::max_depth)
+    @see XmlExporter
     */
-    xmlNodePtr CreateXmlSubtree();
+    xmlNodePtr CreateXmlSubtree(const XmlExporter* exporter = NULL, const XmlExportState* state = NULL, int depth = 0);
 
     /**
      * @private
@@ -568,7 +671,8 @@ protected:
     int id; /**< Numeric ID of the component. There is no requirement for uniqueness of the ID, however it is advised to have unique IDs at least in the realm of parent's children. Some tree search functions, which take the id as a search parameter search for first match, so the user is responsible to manage uniqueness in the realm of the search subtree (or should be aware of the consequences of not doing so). Component's ID is set by the constructor, and is retrieved via int GetId(); */
     int depth; /**< Depth (level) of the Component in the Component Tree */
     string name; /**< Name of the component (as a string). */
-    int count{-1}; /**< Can be used to represent multiple Components with the same properties. By default, it represents only 1 component, and is set to -1. */
+    int count{-1}; /**< Can be used to represent multiple Components with the same properties. By default, it represents only 1 component, and is set to -1. For an instanced component (see SetInstances()), it is 1 + the number of instances. */
+    vector<int> instance_ids; /**< ids of the not materialized instances of this component (see SetInstances()) */
     /**
     Component type of the component. The component type denotes of which class the instance is (Often the components are stored as Component*, even though they are a member of one of the child classes)
     \n This attribute is constant, set by the constructor, and READONLY.
@@ -589,10 +693,25 @@ protected:
     Component* parent { nullptr }; /**< Contains pointer to the parent component in the component tree. If this component is the root, parent will be NULL.*/
     vector<DataPath*> dp_incoming; /**< Contains references to data paths that point to this component. @see DataPath */
     vector<DataPath*> dp_outgoing; /**< Contains references to data paths that point from this component. @see DataPath */
+    XmlLazyLoader* lazy_loader { nullptr }; /**< The lazy XML import that created this component (see XmlLazyLoader), as long as it exists; NULL otherwise. */
+    std::atomic<bool> lazy_datapaths { false }; /**< True if lazy_loader still holds DataPaths of this component, loaded on the first access. Read without the lock of lazy_loader (set under it), so that the accesses to the DataPaths of a fully loaded component do not take the lock. */
+    uint64_t hash { 0 }; /**< Cached GetHash() of the subtree, valid unless hash_dirty. */
+    uint64_t hash_datapaths { 0 }; /**< Cached GetHash(SYS_SAGE_HASH_DATAPATHS) of the subtree, valid unless hash_datapaths_dirty. */
+    bool hash_dirty { true }; /**< If true, hash is out of date; then also the ancestors' are. */
+    bool hash_datapaths_dirty { true }; /**< If true, hash_datapaths is out of date; then also the ancestors' are. Set whenever hash_dirty is. */
 
 private:
+    void loadLazyDataPaths();
+    friend class XmlLazyLoader;
+    friend Component* cloneComponentNode(Component* c);
 };
 
+/**
+@private
+Creates a copy of c (class, id, properties, attributes (see CloneAttributes()), instances) without parent, children and data paths.
+*/
+Component* cloneComponentNode(Component* c);
+
 /**
 Class Topology - the root of the topology.
 \n It is not required to have an instance of this class at the root of the topology. Any component can be the root. This class is a child of Component class, therefore inherits its attributes and methods.
@@ -644,20 +763,71 @@ public:
 public:
     /**
      * Refreshes the CPU core frequency of the node.
-     * @param keep_history - If true, the history of the CPU core frequency will be kept.
+     * @param keep_history - If true, the history of the CPU core frequency will be kept in attrib freq_history of each Core (TimeSeries* of <timestamp,frequency in MHz>, keeping the last SYS_SAGE_TIMESERIES_DEFAULT_CAPACITY samples unless freq_history was created with a different capacity).
+     * @param freq_source - SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO (default) or SYS_SAGE_FREQ_SOURCE_CPUFREQ.
      */
-    int RefreshCpuCoreFrequency(bool keep_history = false);
+    int RefreshCpuCoreFrequency(bool keep_history = false, int freq_source = SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO);
+    /**
+     * Reads the CPU core frequency of the node without modifying the topology (the first half of RefreshCpuCoreFrequency()); store the result with StoreCpuCoreFrequency().
+     * @param freqs - the <Core, frequency in MHz> pairs of the cores that could be read are appended here
+     * @param freq_source - SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO (default) or SYS_SAGE_FREQ_SOURCE_CPUFREQ.
+     * @return 0 if all cores were read, 1 if some were not, -1 if the frequency source cannot be opened
+     */
+    int ReadCpuCoreFrequency(vector<pair<Core*,double>>* freqs, int freq_source = SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO);
+    /**
+     * Stores the frequencies read by ReadCpuCoreFrequency() in the Cores (the second half of RefreshCpuCoreFrequency()).
+     * @param keep_history - see RefreshCpuCoreFrequency()
+     */
+    void StoreCpuCoreFrequency(vector<pair<Core*,double>> const& freqs, bool keep_history = false);
 #endif
 #ifdef INTEL_PQOS //defined in intel_pqos.cpp
 public:
     /**
     \n Creates/updates (bidirectional) data paths between all cores (class Thread) and their L3 cache segment (class Cache). The data paths of type SYS_SAGE_DATAPATH_TYPE_L3CAT contain the COS id (attrib with key "CATcos", value is of type uint64_t*) and the open L3 cache ways (attrib with key "CATL3mask", value is of type uint64_t*) to contain the current settings.
-    \n Each time the method is called, new DataPath objects get created, so the last one is always the most up-to-date.
+    \n Data paths created by previous calls are updated in place.
     
     Note: This function is defined only when sys-sage is compiled with INTEL_PQOS functionality (only for Intel CPUs).
     */
     int UpdateL3CATCoreCOS();
 #endif
+#ifdef RESCTRL //defined in resctrl.cpp
+public:
+    /**
+    \n Creates/updates (bidirectional) data paths of type SYS_SAGE_DATAPATH_TYPE_L3CAT between all HW threads (class Thread) and their L3 cache (class Cache), based on the Linux resctrl file system (see SetResctrlRoot()). Unlike UpdateL3CATCoreCOS(), it does not need libpqos and is not Intel-specific.
+    \n All resctrl control groups (schemata and cpus_list) are read once per call. resctrl does not expose the CLOSIDs the kernel assigns to the groups, so the groups are numbered locally: the root group gets index 0 (its CLOSID is always 0), the other groups 1.. in the alphabetical order of their names. This index, not the kernel's CLOSID, is stored as "CATcos"; it identifies the group among the data paths of one call (e.g. for GetCATAwareL3Sizes()), and may change when groups are created or removed. HW threads not listed in any group's cpus_list belong to the root group. The per-task assignment (tasks) is not considered -- the settings describe the tasks of the root group running on the HW thread.
+    \n The data paths contain the attributes "CATcos" (uint64_t*, the local index of the group, see above), "CATL3mask" (uint64_t*, L3DATA mask if CDP is enabled), "MBAthrottle" (uint64_t*, MB value of the schemata -- % of the memory bandwidth, or MBps with mba_MBps; only if MBA is available) and "resctrl_group" (string*, name of the group, "" for the root group).
+    \n Data paths created by previous calls are updated in place.
+    @return 0 on success, 1 if resctrl cannot be read or some HW threads could not be updated (no L3 cache above them or no settings for their L3 domain).
+    
+    Note: This function is defined only when sys-sage is compiled with RESCTRL functionality (Linux only).
+    */
+    int UpdateResctrlSettings();
+    /**
+    \n Reads the resctrl L3 monitoring counters (mon_data/mon_L3_<domain>/llc_occupancy, mbm_total_bytes, mbm_local_bytes) of all control groups and appends them as samples to TimeSeries attributes:
+    \n - "llc_occupancy" (TimeSeries*, bytes of the L3 occupied),
+    \n - "mbm_total_bw" and "mbm_local_bw" (TimeSeries*, memory bandwidth in B/s; computed from the byte counters of two consecutive calls, so the first call only records the counters).
+    \n The L3 caches (class Cache) get the sum over all control groups in their domain. The NUMA nodes (class Numa) get the bandwidths summed over the L3 domains of their HW threads (or of the L3 cache above them). The L3CAT data paths created by UpdateResctrlSettings() get the values of the control group of their HW thread.
+    \n Counters reading "Unavailable" or "Error" are skipped.
+    @return 0 on success, 1 if resctrl cannot be read or provides no L3 monitoring data.
+
+    Note: This function is defined only when sys-sage is compiled with RESCTRL functionality (Linux only).
+    */
+    int UpdateResctrlMonitoring();
+#endif
+#if defined(INTEL_PQOS) || defined(RESCTRL)
+public:
+    /**
+    !!! Only if compiled with INTEL_PQOS or RESCTRL functionality !!!
+    \n Computes the CAT-aware L3 capacity of all HW threads of the node in one pass, based on the L3CAT data paths created by UpdateL3CATCoreCOS() or UpdateResctrlSettings(). HW threads without an L3CAT data path are assumed to use all ways.
+    \n The COS of a HW thread is its "CATcos" attribute: the COS set by UpdateL3CATCoreCOS(), or the local group index set by UpdateResctrlSettings().
+    \n Hypothetical settings can be evaluated without applying them: thread_cos moves HW threads to another COS, cos_masks replaces the mask of a COS (in all L3 caches). If a HW thread is moved to a COS that is not in cos_masks, the mask of that COS is taken from another HW thread of the same L3 cache (or all ways if no HW thread uses it).
+    @param thread_cos - optional: HW thread id -> hypothetical COS
+    @param cos_masks - optional: COS -> hypothetical L3 way mask
+    @returns dense arrays with one entry per HW thread, in the order of GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD)
+    @see struct CATAwareL3Sizes
+    */
+    CATAwareL3Sizes GetCATAwareL3Sizes(const map<int,uint64_t>& thread_cos = {}, const map<uint64_t,uint64_t>& cos_masks = {});
+#endif
 
 private:
 };
@@ -717,9 +887,12 @@ public:
     /**
     @private
     !!Should normally not be used!! Helper function of XML dump generation.
-    @see exportToXml(Component* root, string path = "", std::function<int(string,void*,string*)> custom_search_attrib_key_fcn = NULL);
+    @param exporter - the export context (custom attribute callbacks); NULL uses the default attributes only
+    @param state - the state of the export (indices of the Components, subtrees created by the parallel export); NULL writes the addresses of the Components as pointers
+    @param depth - depth of the Component below the root of the export (for XmlExportOptions::max_depth)
+    @see XmlExporter
     */
-    xmlNodePtr CreateXmlSubtree();
+    xmlNodePtr CreateXmlSubtree(const XmlExporter* exporter = NULL, const XmlExportState* state = NULL, int depth = 0);
 private:
     long long size; /**< size/capacity of the memory element*/
     bool is_volatile; /**< is volatile? */
@@ -775,9 +948,12 @@ public:
     /**
     @private
     !!Should normally not be used!! Helper function of XML dump generation.
-    @see exportToXml(Component* root, string path = "", std::function<int(string,void*,string*)> custom_search_attrib_key_fcn = NULL);
+    @param exporter - the export context (custom attribute callbacks); NULL uses the default attributes only
+    @param state - the state of the export (indices of the Components, subtrees created by the parallel export); NULL writes the addresses of the Components as pointers
+    @param depth - depth of the Component below the root of the export (for XmlExportOptions::max_depth)
+    @see XmlExporter
     */
-    xmlNodePtr CreateXmlSubtree();
+    xmlNodePtr CreateXmlSubtree(const XmlExporter* exporter = NULL, const XmlExportState* state = NULL, int depth = 0);
 private:
     long long size; /**< size/capacity of the storage device */
 };
@@ -855,9 +1031,12 @@ public:
     /**
     @private
     !!Should normally not be used!! Helper function of XML dump generation.
-    @see exportToXml(Component* root, string path = "", std::function<int(string,void*,string*)> custom_search_attrib_key_fcn = NULL);
+    @param exporter - the export context (custom attribute callbacks); NULL uses the default attributes only
+    @param state - the state of the export (indices of the Components, subtrees created by the parallel export); NULL writes the addresses of the Components as pointers
+    @param depth - depth of the Component below the root of the export (for XmlExportOptions::max_depth)
+    @see XmlExporter
     */
-    xmlNodePtr CreateXmlSubtree();
+    xmlNodePtr CreateXmlSubtree(const XmlExporter* exporter = NULL, const XmlExportState* state = NULL, int depth = 0);
 private:
     string vendor; /**< Vendor of the chip */
     string model; /**< Model of the chip */
@@ -866,6 +1045,7 @@ private:
 public:
     /**
     Updates the MIG settings for the chip.
+    \n Creates or updates in place (oriented) data paths of type SYS_SAGE_DATAPATH_TYPE_MIG from the chip to its Memory, L2 caches and the SMs of the MIG instance, as reported by the NvmlInterface in use (see SetNvmlInterface()). Repeated calls do not duplicate the data paths; SMs no longer in the instance lose theirs. The NVML session is kept open between the calls.
     @param uuid - The UUID of the chip, default is an empty string.
     @return Status of the update operation.
     */
@@ -873,6 +1053,7 @@ public:
 
     /**
     Gets the number of SMs for the MIG.
+    \n The numbers of SMs and cores and the sizes of each UUID are cached (built from the MIG data paths on the first query); the cache is rebuilt when the subtree or the data paths of the chip have changed since (see GetHash()).
     @param uuid - The UUID of the chip, default is an empty string.
     @return The number of SMs.
     */
@@ -884,6 +1065,25 @@ public:
     @return The number of cores.
     */
     int GetMIGNumCores(string uuid = "");
+
+    /**
+    @private
+    Helper of Memory::GetMIGSize() and Cache::GetMIGSize().
+    @returns the "mig_size" of the MIG data path from this chip to c for the given MIG UUID, or -1 if there is none
+    */
+    long long GetMIGComponentSize(Component* c, string uuid);
+private:
+    //per-UUID summary of the MIG data paths of this chip, built on the first query and rebuilt when the chip changed (its hash differs); the empty UUID describes the whole chip
+    struct mig_index {
+        uint64_t hash = 0; //GetHash(SYS_SAGE_HASH_DATAPATHS) of the chip the index was built for
+        int num_sms = 0;
+        int num_cores = 0;
+        map<Component*,long long> sizes; //target of a MIG data path -> mig_size
+    };
+    map<string,mig_index> mig_indices;
+    std::mutex mig_index_lock;
+    //returns the index of uuid, (re)building it if needed; mig_index_lock must be held
+    mig_index* GetMIGIndex(string uuid);
 #endif
 };
 
@@ -988,9 +1188,12 @@ public:
     /**
     @private
     !!Should normally not be caller from the outside!! Helper function of XML dump generation.
-    @see exportToXml(Component* root, string path = "", std::function<int(string,void*,string*)> custom_search_attrib_key_fcn = NULL);
+    @param exporter - the export context (custom attribute callbacks); NULL uses the default attributes only
+    @param state - the state of the export (indices of the Components, subtrees created by the parallel export); NULL writes the addresses of the Components as pointers
+    @param depth - depth of the Component below the root of the export (for XmlExportOptions::max_depth)
+    @see XmlExporter
     */
-    xmlNodePtr CreateXmlSubtree();
+    xmlNodePtr CreateXmlSubtree(const XmlExporter* exporter = NULL, const XmlExportState* state = NULL, int depth = 0);
 private:
     string cache_type; /**< cache level or cache type */
     long long cache_size;  /**< size/capacity of the cache */
@@ -1045,11 +1248,14 @@ public:
     /**
     @private
     !!Should normally not be used!! Helper function of XML dump generation.
-    @see exportToXml(Component* root, string path = "", std::function<int(string,void*,string*)> custom_search_attrib_key_fcn = NULL);
+    @param exporter - the export context (custom attribute callbacks); NULL uses the default attributes only
+    @param state - the state of the export (indices of the Components, subtrees created by the parallel export); NULL writes the addresses of the Components as pointers
+    @param depth - depth of the Component below the root of the export (for XmlExportOptions::max_depth)
+    @see XmlExporter
     */
-    xmlNodePtr CreateXmlSubtree();
+    xmlNodePtr CreateXmlSubtree(const XmlExporter* exporter = NULL, const XmlExportState* state = NULL, int depth = 0);
 protected:
-    int type; /**< Type of the subdivision. Each user can have his own numbering, i.e. the type is there to identify different types of subdivisions as the user defines it.*/
+    int type { SYS_SAGE_SUBDIVISION_TYPE_NONE }; /**< Type of the subdivision. Each user can have his own numbering, i.e. the type is there to identify different types of subdivisions as the user defines it.*/
 };
 
 /**
@@ -1095,9 +1301,12 @@ public:
     /**
     @private 
     !!Should normally not be used!! Helper function of XML dump generation.
-    @see exportToXml(Component* root, string path = "", std::function<int(string,void*,string*)> custom_search_attrib_key_fcn = NULL);
+    @param exporter - the export context (custom attribute callbacks); NULL uses the default attributes only
+    @param state - the state of the export (indices of the Components, subtrees created by the parallel export); NULL writes the addresses of the Components as pointers
+    @param depth - depth of the Component below the root of the export (for XmlExportOptions::max_depth)
+    @see XmlExporter
     */
-    xmlNodePtr CreateXmlSubtree();
+    xmlNodePtr CreateXmlSubtree(const XmlExporter* exporter = NULL, const XmlExportState* state = NULL, int depth = 0);
 private:
     long long size; /**< size of the Numa memory segment.*/
 };
@@ -1134,8 +1343,10 @@ private:
 public:
     /**
     * Refreshes the frequency of the core.
+    * @param keep_history - If true, the history of the frequency will be kept in attrib freq_history of the Core (TimeSeries*).
+    * @param freq_source - SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO (default) or SYS_SAGE_FREQ_SOURCE_CPUFREQ.
     */
-    int RefreshFreq(bool keep_history = false);
+    int RefreshFreq(bool keep_history = false, int freq_source = SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO);
 
     /**
     * Sets the frequency of the core.
@@ -1147,7 +1358,7 @@ public:
     */
     double GetFreq();
 private:
-    double freq;
+    double freq = 0;
 #endif
 };
 
@@ -1182,8 +1393,10 @@ public:
 public:
     /**
     * Refreshes the frequency of the thread.
+    * @param keep_history - If true, the history of the frequency will be kept in attrib freq_history of the Core (TimeSeries*).
+    * @param freq_source - SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO (default) or SYS_SAGE_FREQ_SOURCE_CPUFREQ.
     */
-    int RefreshFreq(bool keep_history = false);
+    int RefreshFreq(bool keep_history = false, int freq_source = SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO);
 
     /**
     * Gets the frequency of the thread.
@@ -1191,11 +1404,11 @@ public:
     double GetFreq();
 #endif
 
-#ifdef INTEL_PQOS //defined in intel_pqos.cpp
+#if defined(INTEL_PQOS) || defined(RESCTRL)
 public:
         /**
-        !!! Only if compiled with INTEL_PQOS functionality, only for Intel CPUs !!!
-        \n Retrieves the L3 cache size available to this thread. This size is retrieved based on the last update with UpdateL3CATCoreCOS() -- i.e. you should call that method before.
+        !!! Only if compiled with INTEL_PQOS or RESCTRL functionality !!!
+        \n Retrieves the L3 cache size available to this thread. This size is retrieved based on the last update with UpdateL3CATCoreCOS() or UpdateResctrlSettings() -- i.e. you should call one of these methods before.
         @returns Available L3 cache size in bytes.
         @see int UpdateL3CATCoreCOS();
         */
@@ -20,11 +20,36 @@ DataPath* NewDataPath(Component* _source, Component* _target, int _oriented, int
 Component * DataPath::GetSource() {return source;}
 Component * DataPath::GetTarget() {return target;}
 double DataPath::GetBandwidth() {return bw;}
-void DataPath::SetBandwidth(double _bandwidth) { bw = _bandwidth;}
+void DataPath::SetBandwidth(double _bandwidth) { bw = _bandwidth; source->MarkDirty(true);}
 double DataPath::GetLatency() {return latency;}
-void DataPath::SetLatency(double _latency) { latency = _latency; }
+void DataPath::SetLatency(double _latency) { latency = _latency; source->MarkDirty(true); }
 int DataPath::GetDataPathType() {return dp_type;}
 int DataPath::GetOrientation() {return oriented;}
+bool DataPath::IsBroadcast() {return broadcast_type != 0;}
+int DataPath::GetBroadcastType() {return broadcast_type;}
+
+bool DataPath::HasTarget(Component* c)
+{
+    if(broadcast_type == 0)
+        return c == target;
+    if(!(c->GetComponentType() & broadcast_type))
+        return false;
+    for(Component* a = c; a != NULL; a = a->GetParent())
+        if(a == target)
+            return true;
+    return false;
+}
+
+vector<Component*> DataPath::GetTargets()
+{
+    if(broadcast_type == 0)
+        return { target };
+    vector<Component*> targets;
+    for(Component* c : target->GetComponentsInSubtree())
+        if(c->GetComponentType() & broadcast_type)
+            targets.push_back(c);
+    return targets;
+}
 
 void DataPath::UpdateSource(Component * _new_source)
 {
@@ -48,6 +73,7 @@ void DataPath::UpdateSource(Component * _new_source)
         _new_source->AddDataPath(this, SYS_SAGE_DATAPATH_OUTGOING);
     }
 
+    source->MarkDirty(true);
     source = _new_source;
 
 }
@@ -74,14 +100,23 @@ void DataPath::UpdateTarget(Component * _new_target)
         _new_target->AddDataPath(this, SYS_SAGE_DATAPATH_INCOMING);
     }
 
+    target->MarkDirty(true);
     target = _new_target;
+    source->MarkDirty(true);
 
 }
 
 DataPath::DataPath(Component* _source, Component* _target, int _oriented, int _type): DataPath(_source, _target, _oriented, _type, -1, -1) {}
 DataPath::DataPath(Component* _source, Component* _target, int _oriented, double _bw, double _latency): DataPath(_source, _target, _oriented, SYS_SAGE_DATAPATH_TYPE_NONE, _bw, _latency) {}
-DataPath::DataPath(Component* _source, Component* _target, int _oriented, int _type, double _bw, double _latency): source(_source), target(_target), oriented(_oriented), dp_type(_type), bw(_bw), latency(_latency)
+DataPath::DataPath(Component* _source, Component* _target, int _oriented, int _type, double _bw, double _latency): DataPath(_source, _target, _oriented, _type, _bw, _latency, 0) {}
+DataPath::DataPath(Component* _source, Component* _target, int _oriented, int _type, double _bw, double _latency, int _broadcast_type): source(_source), target(_target), oriented(_oriented), dp_type(_type), broadcast_type(_broadcast_type), bw(_bw), latency(_latency)
 {
+    if(_broadcast_type != 0 && _oriented != SYS_SAGE_DATAPATH_ORIENTED)
+    {
+        std::cerr << "DataPath: a broadcast DataPath must be oriented (SYS_SAGE_DATAPATH_ORIENTED)." << std::endl;
+        delete this;
+        return;//error
+    }
     if(_oriented == SYS_SAGE_DATAPATH_BIDIRECTIONAL)
     {
         _source->AddDataPath(this, SYS_SAGE_DATAPATH_OUTGOING);
@@ -122,13 +157,18 @@ void DataPath::DeleteDataPath()
         source_dp_outgoing->erase(std::remove(source_dp_outgoing->begin(), source_dp_outgoing->end(), this), source_dp_outgoing->end());
         target_dp_incoming->erase(std::remove(target_dp_incoming->begin(), target_dp_incoming->end(), this), target_dp_incoming->end());
     }
+    source->MarkDirty(true);
+    target->MarkDirty(true);
     delete this;
 }
 
 
 void DataPath::Print()
 {
-    cout << "DataPath src: (" << source->GetComponentTypeStr() << ") id " << source->GetId() << ", target: (" << target->GetComponentTypeStr() << ") id " << target->GetId() << " - bw: " << bw << ", latency: " << latency;
+    cout << "DataPath src: (" << source->GetComponentTypeStr() << ") id " << source->GetId() << ", target: (" << target->GetComponentTypeStr() << ") id " << target->GetId();
+    if(broadcast_type != 0)
+        cout << " (broadcast to component type " << broadcast_type << ")";
+    cout << " - bw: " << bw << ", latency: " << latency;
     if(!attrib.empty())
     {
         cout << " - attrib: ";
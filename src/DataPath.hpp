@@ -87,6 +87,18 @@ public:
     @param _latency - Data load latency from the source(provides the data) to the target(requests the data)
     */
     DataPath(Component* _source, Component* _target, int _oriented, int _type, double _bw, double _latency);
+    /**
+    Broadcast DataPath constructor. A broadcast Data Path connects the source with every Component in the subtree of _target (including _target) whose component type matches _broadcast_type, with one shared record (type, bw, latency, attributes) -- e.g. a GPU memory with all cores below it.
+    \n It is stored only once, in the outgoing Data Paths of the source and in the incoming Data Paths of _target; Component::GetDataPathByType() and Component::GetAllDataPathsByType() resolve it for the Components it applies to.
+    @param _source - pointer to the source Component.
+    @param _target - pointer to the root of the target subtree.
+    @param _oriented - must be SYS_SAGE_DATAPATH_ORIENTED (a broadcast Data Path always goes from the source to the subtree)
+    @param _type - Denotes type of the Data Path (see above)
+    @param _bw - Bandwidth from the source(provides the data) to each target
+    @param _latency - Data load latency from the source(provides the data) to each target
+    @param _broadcast_type - component type(s) (SYS_SAGE_COMPONENT_*, or a logical or of these) of the targets in the subtree. 0 creates a regular Data Path to _target.
+    */
+    DataPath(Component* _source, Component* _target, int _oriented, int _type, double _bw, double _latency, int _broadcast_type);
 
     /**
     @returns Pointer to the source Component
@@ -146,6 +158,26 @@ public:
     */
     int GetOrientation();
 
+    /**
+    @returns true if this is a broadcast Data Path (see DataPath(Component*, Component*, int, int, double, double, int))
+    */
+    bool IsBroadcast();
+    /**
+    @returns component type(s) of the targets of a broadcast Data Path, 0 if this is a regular Data Path
+    @see broadcast_type
+    */
+    int GetBroadcastType();
+    /**
+    Checks whether the Data Path leads to a Component: c is the target of a regular Data Path, or one of the targets of a broadcast Data Path.
+    @param c - the Component
+    @returns true if the Data Path leads to c
+    */
+    bool HasTarget(Component* c);
+    /**
+    @returns the targets of the Data Path: the target of a regular Data Path, or all Components of the target subtree that match the broadcast type.
+    */
+    vector<Component*> GetTargets();
+
     /**
     Prints basic information about the Data Path to stdout. Prints componentType and Id of the source and target Components, the bandwidth, load latency, and the attributes; for each attribute, the name and value are printed, however the value is only retyped to uint64_t (therefore will print nonsensical values for other data types).
     */
@@ -238,6 +270,7 @@ private:
 
     const int oriented; /**< orientation of the datapath (SYS_SAGE_DATAPATH_ORIENTED or SYS_SAGE_DATAPATH_BIDIRECTIONAL) */
     const int dp_type; /**< type of the datapath */
+    const int broadcast_type; /**< component type(s) of the targets in the subtree of target, if this is a broadcast datapath; 0 otherwise */
 
     double bw; /**< Bandwidth from the source(provides the data) to the target(requests the data) */
     double latency; /**< Data load latency from the source(provides the data) to the target(requests the data) */
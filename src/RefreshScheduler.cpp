@@ -0,0 +1,252 @@
+#include "RefreshScheduler.hpp"
+
+RefreshScheduler::RefreshScheduler(int _num_threads): num_threads(_num_threads < 1 ? 1 : _num_threads) {}
+
+RefreshScheduler::~RefreshScheduler()
+{
+    Stop();
+}
+
+int RefreshScheduler::AddSource(string name, std::function<int()> refresh, std::chrono::milliseconds interval)
+{
+    //nothing to read in advance, the whole refresh is the apply phase
+    return AddSplitSource(name, [refresh]{ return refresh; }, interval);
+}
+
+int RefreshScheduler::AddSplitSource(string name, std::function<std::function<int()>()> collect, std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    int id = next_id++;
+    unique_ptr<Source> s(new Source());
+    s->name = name;
+    s->collect = collect;
+    s->interval = interval;
+    s->next_due = std::chrono::steady_clock::now();
+    sources[id] = std::move(s);
+    cv_work.notify_all();
+    return id;
+}
+
+int RefreshScheduler::RemoveSource(int id)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    if(sources.find(id) == sources.end())
+        return 1;
+    //the source is looked up again after each wake-up: a concurrent RemoveSource() may have erased it
+    cv_done.wait(lock, [this, id]{ return !isRunning(id); });
+    if(sources.erase(id) == 0)
+        return 1;
+    cv_done.notify_all(); //waiters of the removed source return -1
+    return 0;
+}
+
+#ifdef PROC_CPUINFO
+int RefreshScheduler::AddCpuFrequencySource(Node* n, std::chrono::milliseconds interval, bool keep_history, int freq_source)
+{
+    return AddSplitSource("cpu_frequency", [n, keep_history, freq_source]{
+        vector<pair<Core*,double>> freqs;
+        int ret = n->ReadCpuCoreFrequency(&freqs, freq_source);
+        return std::function<int()>([n, keep_history, ret, freqs = std::move(freqs)]{
+            n->StoreCpuCoreFrequency(freqs, keep_history);
+            return ret;
+        });
+    }, interval);
+}
+#endif
+#ifdef INTEL_PQOS
+int RefreshScheduler::AddL3CATSource(Node* n, std::chrono::milliseconds interval)
+{
+    return AddSource("l3_cat", [n]{ return n->UpdateL3CATCoreCOS(); }, interval);
+}
+#endif
+#ifdef RESCTRL
+int RefreshScheduler::AddResctrlSource(Node* n, std::chrono::milliseconds interval)
+{
+    return AddSource("resctrl", [n]{ return n->UpdateResctrlSettings(); }, interval);
+}
+int RefreshScheduler::AddResctrlMonitoringSource(Node* n, std::chrono::milliseconds interval)
+{
+    return AddSource("resctrl_monitoring", [n]{ return n->UpdateResctrlMonitoring(); }, interval);
+}
+#endif
+#ifdef NVIDIA_MIG
+int RefreshScheduler::AddMIGSource(Chip* c, std::chrono::milliseconds interval, string uuid)
+{
+    return AddSource("mig", [c, uuid]{ return c->UpdateMIGSettings(uuid); }, interval);
+}
+#endif
+
+void RefreshScheduler::Start()
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    if(!workers.empty())
+        return;
+    stopping = false;
+    for(int i = 0; i < num_threads; i++)
+        workers.emplace_back(&RefreshScheduler::WorkerLoop, this);
+}
+
+void RefreshScheduler::Stop()
+{
+    vector<std::thread> to_join;
+    {
+        std::lock_guard<std::mutex> guard(mtx);
+        stopping = true;
+        to_join.swap(workers);
+    }
+    cv_work.notify_all();
+    cv_done.notify_all();
+    for(std::thread& t : to_join)
+        t.join();
+}
+
+bool RefreshScheduler::IsRunning()
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    return !workers.empty() && !stopping;
+}
+
+bool RefreshScheduler::isRunning(int id)
+{
+    auto it = sources.find(id);
+    return it != sources.end() && it->second->running;
+}
+
+void RefreshScheduler::RunSource(Source* s, std::unique_lock<std::mutex>& lock)
+{
+    s->running = true;
+    s->requested = false;
+    unsigned long long sample = ++s->started;
+    if(s->interval.count() > 0)
+        s->next_due = std::chrono::steady_clock::now() + s->interval;
+    lock.unlock();
+
+    std::function<int()> apply;
+    {
+        std::shared_lock<std::shared_mutex> topo_guard(topology_lock);
+        apply = s->collect();
+    }
+    int ret = -1;
+    if(apply)
+    {
+        std::unique_lock<std::shared_mutex> topo_guard(topology_lock);
+        ret = apply();
+    }
+
+    lock.lock();
+    s->running = false;
+    s->completed = sample;
+    s->last_result = ret;
+    cv_done.notify_all();
+    cv_work.notify_all(); //a request might have arrived during the refresh
+}
+
+void RefreshScheduler::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while(!stopping)
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto wake_up = std::chrono::steady_clock::time_point::max();
+        Source* todo = NULL;
+        for(auto const& [ id, s ] : sources)
+        {
+            if(s->running)
+                continue;
+            if(s->requested){
+                todo = s.get();
+                break;
+            }
+            if(s->interval.count() <= 0)
+                continue;
+            if(s->next_due <= now){
+                if(todo == NULL || s->next_due < todo->next_due)
+                    todo = s.get();
+            }
+            else if(s->next_due < wake_up)
+                wake_up = s->next_due;
+        }
+
+        if(todo != NULL)
+            RunSource(todo, lock);
+        else if(wake_up == std::chrono::steady_clock::time_point::max())
+            cv_work.wait(lock);
+        else
+            cv_work.wait_until(lock, wake_up);
+    }
+}
+
+int RefreshScheduler::WaitForSample(int id, unsigned long long target, std::unique_lock<std::mutex>& lock, std::chrono::milliseconds timeout)
+{
+    auto done = [&]{
+        auto it = sources.find(id);
+        return it == sources.end() || stopping || it->second->completed >= target;
+    };
+    if(timeout.count() > 0){
+        if(!cv_done.wait_for(lock, timeout, done))
+            return -2;
+    }
+    else
+        cv_done.wait(lock, done);
+
+    auto it = sources.find(id);
+    if(it == sources.end() || it->second->completed < target)
+        return -1;
+    return it->second->last_result;
+}
+
+int RefreshScheduler::RefreshNow(int id)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    auto it = sources.find(id);
+    if(it == sources.end())
+        return -1;
+    Source* s = it->second.get();
+
+    if(workers.empty() || stopping)
+    {
+        //no worker threads: refresh on the calling thread (after a concurrent caller's refresh, if any)
+        cv_done.wait(lock, [this, id]{ return !isRunning(id); });
+        it = sources.find(id);
+        if(it == sources.end())
+            return -1;
+        s = it->second.get();
+        RunSource(s, lock);
+        return s->last_result;
+    }
+
+    //the next refresh that starts after now; requests arriving before it starts share it
+    unsigned long long target = s->started + 1;
+    s->requested = true;
+    cv_work.notify_one();
+    return WaitForSample(id, target, lock, std::chrono::milliseconds(0));
+}
+
+int RefreshScheduler::WaitForNextSample(int id, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    auto it = sources.find(id);
+    if(it == sources.end() || workers.empty() || stopping)
+        return -1;
+    //a refresh already in progress started before this call, so wait for the one after it
+    return WaitForSample(id, it->second->started + 1, lock, timeout);
+}
+
+unsigned long long RefreshScheduler::GetSampleCount(int id)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = sources.find(id);
+    return it == sources.end() ? 0 : it->second->completed;
+}
+
+int RefreshScheduler::GetLastResult(int id)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = sources.find(id);
+    return it == sources.end() ? -1 : it->second->last_result;
+}
+
+std::shared_mutex& RefreshScheduler::GetTopologyLock()
+{
+    return topology_lock;
+}
@@ -0,0 +1,176 @@
+#ifndef REFRESH_SCHEDULER
+#define REFRESH_SCHEDULER
+
+#include <string>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "defines.hpp"
+#include "Component.hpp"
+
+/*! \file */
+
+using namespace std;
+
+/**
+Class RefreshScheduler runs the refreshes of dynamic data sources (e.g. Node::RefreshCpuCoreFrequency, Node::UpdateL3CATCoreCOS, Node::UpdateResctrlSettings, Chip::UpdateMIGSettings) on a pool of background threads, so that the application does not pay the refresh latency on its critical path.
+\n Each registered source is refreshed periodically at its own interval. A source is never refreshed by two threads at once; concurrent RefreshNow() requests of one source are coalesced into a single refresh.
+\n A refresh has two phases: the source is read while holding the topology lock shared, so the reads of different sources run in parallel on the worker threads, and the result is then applied to the topology while holding the lock exclusively. Sources registered by AddSplitSource() (e.g. AddCpuFrequencySource()) do only the short apply phase under the exclusive lock; the refresh function of a source registered by AddSource() runs entirely under it. Readers that need a consistent view of the values written by the sources (e.g. all Core frequencies of one refresh) take the lock shared, see GetTopologyLock(); a reader therefore sees either the complete result of a refresh or none of it.
+\n Example:
+\n RefreshScheduler sched(1);
+\n int id = sched.AddCpuFrequencySource(node, std::chrono::milliseconds(100));
+\n sched.Start();
+\n { std::shared_lock l(sched.GetTopologyLock()); f = core->GetFreq(); }
+\n sched.WaitForNextSample(id);
+*/
+class RefreshScheduler {
+public:
+    /**
+    RefreshScheduler constructor. The worker threads are created by Start().
+    @param _num_threads - number of worker threads (at least 1), default 1
+    */
+    RefreshScheduler(int _num_threads = 1);
+    /**
+    Stops the worker threads (see Stop()).
+    */
+    ~RefreshScheduler();
+
+    /**
+    Registers a data source.
+    @param name - name of the source (for messages)
+    @param refresh - function performing the refresh; its return value (0 = success) is reported by RefreshNow() and GetLastResult()
+    @param interval - time between the start of two periodic refreshes; 0 means that the source is only refreshed on demand (RefreshNow())
+    @returns id of the source, used by the other methods
+    */
+    int AddSource(string name, std::function<int()> refresh, std::chrono::milliseconds interval);
+    /**
+    Registers a data source whose refresh is split into reading the source and applying the result to the topology.
+    @param name - name of the source (for messages)
+    @param collect - function reading the source; it runs while holding the topology lock shared (in parallel with the other sources), so it may read the topology but must not modify it. It returns the function applying the result, which runs while holding the lock exclusively; the return value of the latter (0 = success) is reported by RefreshNow() and GetLastResult(). If collect returns an empty function, the refresh reports -1.
+    @param interval - see AddSource()
+    @returns id of the source, used by the other methods
+    */
+    int AddSplitSource(string name, std::function<std::function<int()>()> collect, std::chrono::milliseconds interval);
+    /**
+    Unregisters a data source. If the source is being refreshed, waits until the refresh finishes.
+    @param id - id returned by AddSource()
+    @returns 0 on success, 1 if no such source exists
+    */
+    int RemoveSource(int id);
+
+#ifdef PROC_CPUINFO
+    /**
+    Registers Node::RefreshCpuCoreFrequency(keep_history, freq_source) of n as a data source. The frequencies are read by Node::ReadCpuCoreFrequency() outside the exclusive topology lock, only Node::StoreCpuCoreFrequency() holds it.
+    @returns id of the source
+    */
+    int AddCpuFrequencySource(Node* n, std::chrono::milliseconds interval, bool keep_history = false, int freq_source = SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO);
+#endif
+#ifdef INTEL_PQOS
+    /**
+    Registers Node::UpdateL3CATCoreCOS() of n as a data source.
+    @returns id of the source
+    */
+    int AddL3CATSource(Node* n, std::chrono::milliseconds interval);
+#endif
+#ifdef RESCTRL
+    /**
+    Registers Node::UpdateResctrlSettings() of n as a data source.
+    @returns id of the source
+    */
+    int AddResctrlSource(Node* n, std::chrono::milliseconds interval);
+    /**
+    Registers Node::UpdateResctrlMonitoring() of n as a data source.
+    @returns id of the source
+    */
+    int AddResctrlMonitoringSource(Node* n, std::chrono::milliseconds interval);
+#endif
+#ifdef NVIDIA_MIG
+    /**
+    Registers Chip::UpdateMIGSettings(uuid) of c as a data source.
+    @returns id of the source
+    */
+    int AddMIGSource(Chip* c, std::chrono::milliseconds interval, string uuid = "");
+#endif
+
+    /**
+    Starts the worker threads. Does nothing if they are already running.
+    */
+    void Start();
+    /**
+    Stops the worker threads after their current refreshes finish. Waiting RefreshNow()/WaitForNextSample() calls return -1.
+    */
+    void Stop();
+    /**
+    @returns true if the worker threads are running
+    */
+    bool IsRunning();
+
+    /**
+    Requests an immediate refresh of a source and blocks until a refresh started after this call has finished. Concurrent requests are served by one refresh.
+    \n If the scheduler is not running, the refresh is executed on the calling thread.
+    @param id - id returned by AddSource()
+    @returns the return value of the refresh function, or -1 if no such source exists or the scheduler was stopped while waiting
+    */
+    int RefreshNow(int id);
+    /**
+    Blocks until the next periodic refresh of a source has finished (without requesting it).
+    @param id - id returned by AddSource()
+    @param timeout - maximum time to wait; 0 (default) means no limit
+    @returns the return value of the refresh function, -1 if no such source exists, the scheduler is not running or was stopped while waiting, -2 on timeout
+    */
+    int WaitForNextSample(int id, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    /**
+    @returns number of finished refreshes of a source (0 if no such source exists)
+    */
+    unsigned long long GetSampleCount(int id);
+    /**
+    @returns return value of the last finished refresh of a source (-1 if no such source exists or it has not been refreshed yet)
+    */
+    int GetLastResult(int id);
+
+    /**
+    @returns the lock held exclusively while the result of a refresh is applied. Lock it shared (std::shared_lock) to read the refreshed values consistently.
+    */
+    std::shared_mutex& GetTopologyLock();
+
+private:
+    struct Source {
+        string name;
+        std::function<std::function<int()>()> collect;
+        std::chrono::milliseconds interval;
+        std::chrono::steady_clock::time_point next_due;
+        bool running = false;
+        bool requested = false; /**< a RefreshNow() is waiting for the next refresh */
+        unsigned long long started = 0;
+        unsigned long long completed = 0;
+        int last_result = -1;
+    };
+
+    void WorkerLoop();
+    //true if the source id exists and is being refreshed; lock (of mtx) has to be held
+    bool isRunning(int id);
+    //runs one refresh of s; lock (of mtx) is held on entry and on return
+    void RunSource(Source* s, std::unique_lock<std::mutex>& lock);
+    //waits until the refresh number target of the source id has finished
+    int WaitForSample(int id, unsigned long long target, std::unique_lock<std::mutex>& lock, std::chrono::milliseconds timeout);
+
+    int num_threads;
+    vector<std::thread> workers;
+    bool stopping = false;
+    int next_id = 0;
+    map<int, unique_ptr<Source>> sources;
+    std::mutex mtx; /**< protects the scheduler state (sources, flags, counters) */
+    std::condition_variable cv_work; /**< wakes up the workers */
+    std::condition_variable cv_done; /**< wakes up the waiting callers */
+    std::shared_mutex topology_lock;
+};
+
+#endif
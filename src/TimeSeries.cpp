@@ -0,0 +1,234 @@
+#include "TimeSeries.hpp"
+#include "Attribute.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+TimeSeries::TimeSeries(size_t _capacity): capacity(std::max<size_t>(_capacity, 1)) {}
+
+void TimeSeries::Add(long long timestamp, double value)
+{
+    if(samples.size() < capacity)
+        samples.push_back(make_tuple(timestamp, value));
+    else
+        samples[head] = make_tuple(timestamp, value);
+    head = (head + 1) % capacity;
+    if(size < capacity)
+        size++;
+}
+
+void TimeSeries::Clear()
+{
+    samples.clear();
+    head = 0;
+    size = 0;
+}
+
+size_t TimeSeries::GetSize() const { return size; }
+size_t TimeSeries::GetCapacity() const { return capacity; }
+
+void TimeSeries::SetCapacity(size_t _capacity)
+{
+    vector<tuple<long long,double>> old = GetSamples();
+    capacity = std::max<size_t>(_capacity, 1);
+    Clear();
+    for(size_t i = old.size() > capacity ? old.size() - capacity : 0; i < old.size(); i++)
+        Add(get<0>(old[i]), get<1>(old[i]));
+}
+
+tuple<long long,double> TimeSeries::Get(size_t i) const
+{
+    if(i >= size)
+        return make_tuple(0ll, 0.0);
+    size_t start = (size == capacity) ? head : 0;
+    return samples[(start + i) % samples.size()];
+}
+
+tuple<long long,double> TimeSeries::GetLast() const
+{
+    if(size == 0)
+        return make_tuple(0ll, 0.0);
+    return Get(size - 1);
+}
+
+vector<tuple<long long,double>> TimeSeries::GetSamples() const
+{
+    vector<tuple<long long,double>> ret;
+    ret.reserve(size);
+    for(size_t i = 0; i < size; i++)
+        ret.push_back(Get(i));
+    return ret;
+}
+
+size_t TimeSeries::WindowStart(double window_s) const
+{
+    if(window_s <= 0 || size == 0)
+        return 0;
+    long long since = get<0>(GetLast()) - (long long)(window_s * 1e9);
+    size_t i = size;
+    while(i > 0 && get<0>(Get(i - 1)) >= since)
+        i--;
+    return i;
+}
+
+double TimeSeries::Min(double window_s) const
+{
+    if(size == 0)
+        return 0;
+    double ret = get<1>(GetLast());
+    for(size_t i = WindowStart(window_s); i < size; i++)
+        ret = std::min(ret, get<1>(Get(i)));
+    return ret;
+}
+
+double TimeSeries::Max(double window_s) const
+{
+    if(size == 0)
+        return 0;
+    double ret = get<1>(GetLast());
+    for(size_t i = WindowStart(window_s); i < size; i++)
+        ret = std::max(ret, get<1>(Get(i)));
+    return ret;
+}
+
+double TimeSeries::Mean(double window_s) const
+{
+    if(size == 0)
+        return 0;
+    size_t start = WindowStart(window_s);
+    double sum = 0;
+    for(size_t i = start; i < size; i++)
+        sum += get<1>(Get(i));
+    return sum / (size - start);
+}
+
+double TimeSeries::Percentile(double p, double window_s) const
+{
+    if(size == 0)
+        return 0;
+    vector<double> values;
+    for(size_t i = WindowStart(window_s); i < size; i++)
+        values.push_back(get<1>(Get(i)));
+    p = std::clamp(p, 0.0, 100.0);
+    size_t rank = (size_t)std::ceil(p / 100.0 * values.size());
+    size_t idx = rank > 0 ? rank - 1 : 0;
+    std::nth_element(values.begin(), values.begin() + idx, values.end());
+    return values[idx];
+}
+
+/// @private
+static void ts_put_varint(string* out, uint64_t v)
+{
+    while(v >= 0x80){
+        out->push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out->push_back((char)v);
+}
+
+/// @private
+static bool ts_get_varint(const string& in, size_t* pos, uint64_t* v)
+{
+    *v = 0;
+    for(int shift = 0; shift < 64; shift += 7)
+    {
+        if(*pos >= in.size())
+            return false;
+        uint8_t b = (uint8_t)in[(*pos)++];
+        *v |= (uint64_t)(b & 0x7f) << shift;
+        if(!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+//binary format: "TS" 0x01 | varint capacity | varint count | count x (zigzag varint delta-of-delta timestamp, XOR-encoded value)
+//XOR-encoded value: x = bits(value) ^ bits(previous value); one control byte (leading zero bytes << 4 | trailing zero bytes) followed by the remaining bytes of x (little endian); x == 0 is the single byte 0x80
+string TimeSeries::Serialize() const
+{
+    string out = "TS\x01";
+    ts_put_varint(&out, capacity);
+    ts_put_varint(&out, size);
+
+    uint64_t prev_ts = 0, prev_delta = 0, prev_bits = 0;
+    for(size_t i = 0; i < size; i++)
+    {
+        auto [ ts, value ] = Get(i);
+        uint64_t delta = (uint64_t)ts - prev_ts;
+        int64_t dod = (int64_t)(delta - prev_delta);
+        ts_put_varint(&out, ((uint64_t)dod << 1) ^ (uint64_t)(dod >> 63));
+        prev_ts = (uint64_t)ts;
+        prev_delta = delta;
+
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint64_t x = bits ^ prev_bits;
+        prev_bits = bits;
+        if(x == 0){
+            out.push_back((char)0x80);
+            continue;
+        }
+        int lz = __builtin_clzll(x) / 8;
+        int tz = __builtin_ctzll(x) / 8;
+        out.push_back((char)((lz << 4) | tz));
+        x >>= 8 * tz;
+        for(int b = 0; b < 8 - lz - tz; b++, x >>= 8)
+            out.push_back((char)(x & 0xff));
+    }
+    return out;
+}
+
+int TimeSeries::Deserialize(const string& data)
+{
+    Clear();
+    size_t pos = 3;
+    uint64_t cap, count;
+    if(data.compare(0, 3, "TS\x01") != 0 || !ts_get_varint(data, &pos, &cap) || !ts_get_varint(data, &pos, &count) || cap == 0 || count > cap)
+        return 1;
+    capacity = cap;
+
+    uint64_t prev_ts = 0, prev_delta = 0, prev_bits = 0;
+    for(uint64_t i = 0; i < count; i++)
+    {
+        uint64_t zz;
+        if(!ts_get_varint(data, &pos, &zz) || pos >= data.size()){
+            Clear();
+            return 1;
+        }
+        int64_t dod = (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);
+        prev_delta += (uint64_t)dod;
+        prev_ts += prev_delta;
+
+        uint8_t ctrl = (uint8_t)data[pos++];
+        int lz = ctrl >> 4, tz = ctrl & 0xf;
+        if(lz + tz > 8 || pos + (8 - lz - tz) > data.size()){
+            Clear();
+            return 1;
+        }
+        uint64_t x = 0;
+        for(int b = 0; b < 8 - lz - tz; b++)
+            x |= (uint64_t)(uint8_t)data[pos++] << (8 * (b + tz));
+        prev_bits ^= x;
+
+        double value;
+        memcpy(&value, &prev_bits, sizeof(value));
+        Add((long long)prev_ts, value);
+    }
+    return 0;
+}
+
+string TimeSeries::ToBase64() const
+{
+    return Base64Encode(Serialize());
+}
+
+int TimeSeries::FromBase64(const string& data)
+{
+    string bin;
+    if(Base64Decode(data, &bin) != 0){
+        Clear();
+        return 1;
+    }
+    return Deserialize(bin);
+}
@@ -0,0 +1,124 @@
+#ifndef TIMESERIES
+#define TIMESERIES
+
+#include <vector>
+#include <tuple>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/*! \file */
+
+#define SYS_SAGE_TIMESERIES_DEFAULT_CAPACITY 1024 /**< Default number of samples kept by a TimeSeries. */
+
+using namespace std;
+
+/**
+Class TimeSeries stores a bounded history of (timestamp, value) samples, e.g. the frequency history of a Core (attrib "freq_history").
+\n The samples are kept in a fixed-capacity ring buffer: when the buffer is full, adding a sample overwrites the oldest one, so the memory footprint does not grow with the number of refreshes.
+\n Timestamps are expected in nanoseconds (e.g. std::chrono::high_resolution_clock::now().time_since_epoch().count()) and in a non-decreasing order; the windowed aggregates (Min, Max, Mean, Percentile) take the window length in seconds and consider the samples not older than the window, measured from the newest sample.
+\n For export, the samples are compressed: timestamps are stored as delta-of-deltas (zigzag varints) and values as the XOR with the previous value (only the non-zero bytes are stored). Regularly sampled series with slowly changing values compress to a few bytes per sample. The compressed form is available as binary (Serialize/Deserialize) or base64 text (ToBase64/FromBase64), which is used by the XML export.
+*/
+class TimeSeries {
+public:
+    /**
+    TimeSeries constructor.
+    @param _capacity - maximum number of samples kept (at least 1), default SYS_SAGE_TIMESERIES_DEFAULT_CAPACITY
+    */
+    TimeSeries(size_t _capacity = SYS_SAGE_TIMESERIES_DEFAULT_CAPACITY);
+
+    /**
+    Appends a sample. If the TimeSeries is full, the oldest sample is dropped.
+    @param timestamp - timestamp of the sample in ns
+    @param value - value of the sample
+    */
+    void Add(long long timestamp, double value);
+    /**
+    Removes all samples (the capacity is kept).
+    */
+    void Clear();
+
+    /**
+    @returns number of samples currently stored
+    */
+    size_t GetSize() const;
+    /**
+    @returns maximum number of samples stored
+    */
+    size_t GetCapacity() const;
+    /**
+    Changes the capacity. If the new capacity is smaller than the number of stored samples, only the newest samples are kept.
+    @param _capacity - new capacity (at least 1)
+    */
+    void SetCapacity(size_t _capacity);
+
+    /**
+    @param i - index of the sample, 0 being the oldest stored sample
+    @returns i-th sample as a tuple (timestamp, value); (0, 0) if there is no such sample
+    */
+    tuple<long long,double> Get(size_t i) const;
+    /**
+    @returns newest sample as a tuple (timestamp, value); (0, 0) if empty
+    */
+    tuple<long long,double> GetLast() const;
+    /**
+    @returns all stored samples, ordered from the oldest to the newest
+    */
+    vector<tuple<long long,double>> GetSamples() const;
+
+    /**
+    @param window_s - window length in seconds, counted back from the newest sample; 0 (default) means all stored samples
+    @returns minimum value in the window; 0 if empty
+    */
+    double Min(double window_s = 0) const;
+    /**
+    @param window_s - window length in seconds, counted back from the newest sample; 0 (default) means all stored samples
+    @returns maximum value in the window; 0 if empty
+    */
+    double Max(double window_s = 0) const;
+    /**
+    @param window_s - window length in seconds, counted back from the newest sample; 0 (default) means all stored samples
+    @returns arithmetic mean of the values in the window; 0 if empty
+    */
+    double Mean(double window_s = 0) const;
+    /**
+    Nearest-rank percentile of the values in the window.
+    @param p - percentile in [0,100], e.g. 50 for the median
+    @param window_s - window length in seconds, counted back from the newest sample; 0 (default) means all stored samples
+    @returns the value of the p-th percentile; 0 if empty
+    */
+    double Percentile(double p, double window_s = 0) const;
+
+    /**
+    Compact binary serialization (capacity, samples compressed with delta-of-delta timestamps and XOR values).
+    @returns the binary representation
+    @see Deserialize()
+    */
+    string Serialize() const;
+    /**
+    Restores the samples and the capacity from the output of Serialize().
+    @param data - the binary representation
+    @returns 0 on success, 1 if data is malformed (the TimeSeries is then left empty)
+    */
+    int Deserialize(const string& data);
+    /**
+    @returns Serialize() encoded as base64, e.g. for the XML export
+    */
+    string ToBase64() const;
+    /**
+    Restores the samples and the capacity from the output of ToBase64().
+    @returns 0 on success, 1 if the input is malformed
+    */
+    int FromBase64(const string& data);
+
+private:
+    //returns the index (0 = oldest) of the first sample in the window
+    size_t WindowStart(double window_s) const;
+
+    vector<tuple<long long,double>> samples; /**< ring buffer; the oldest sample is samples[head] once the buffer is full */
+    size_t capacity;
+    size_t head = 0; /**< index where the next sample will be written */
+    size_t size = 0;
+};
+
+#endif
@@ -0,0 +1,562 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "TopologyDiff.hpp"
+#include "Attribute.hpp"
+
+ComponentPath GetComponentPath(Component* c, Component* root)
+{
+    ComponentPath path;
+    for(Component* x = c; x != root && x->GetParent() != NULL; x = x->GetParent())
+    {
+        int occurrence = 0;
+        for(Component* sibling : *x->GetParent()->GetChildren())
+        {
+            if(sibling == x)
+                break;
+            if(sibling->GetComponentType() == x->GetComponentType() && sibling->GetId() == x->GetId())
+                occurrence++;
+        }
+        path.push_back({x->GetComponentType(), x->GetId(), occurrence});
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+Component* FindComponentByPath(Component* root, const ComponentPath& path)
+{
+    Component* c = root;
+    for(const ComponentKey& key : path)
+    {
+        Component* next = NULL;
+        int occurrence = 0;
+        for(Component* child : *c->GetChildren())
+        {
+            if(child->GetComponentType() == key.type && child->GetId() == key.id && occurrence++ == key.occurrence)
+            {
+                next = child;
+                break;
+            }
+        }
+        if(next == NULL)
+            return NULL;
+        c = next;
+    }
+    return c;
+}
+
+//keys of the children of c, in their order
+static vector<ComponentKey> childKeys(Component* c)
+{
+    vector<ComponentKey> keys;
+    std::map<std::pair<int,int>, int> seen;
+    for(Component* child : *c->GetChildren())
+        keys.push_back({child->GetComponentType(), child->GetId(), seen[{child->GetComponentType(), child->GetId()}]++});
+    return keys;
+}
+
+static ComponentPath childPath(const ComponentPath& path, const ComponentKey& key)
+{
+    ComponentPath ret = path;
+    ret.push_back(key);
+    return ret;
+}
+
+//positions (in seq) of a longest increasing subsequence of seq
+static vector<size_t> longestIncreasing(const vector<size_t>& seq)
+{
+    vector<size_t> tails; //tails[l]: position of the smallest end of an increasing subsequence of length l+1
+    vector<size_t> prev(seq.size(), SIZE_MAX);
+    for(size_t i = 0; i < seq.size(); i++)
+    {
+        auto it = std::lower_bound(tails.begin(), tails.end(), seq[i], [&seq](size_t pos, size_t v) { return seq[pos] < v; });
+        if(it != tails.begin())
+            prev[i] = *(it - 1);
+        if(it == tails.end())
+            tails.push_back(i);
+        else
+            *it = i;
+    }
+    vector<size_t> ret;
+    for(size_t i = tails.empty() ? SIZE_MAX : tails.back(); i != SIZE_MAX; i = prev[i])
+        ret.push_back(i);
+    std::reverse(ret.begin(), ret.end());
+    return ret;
+}
+
+static TopologyEdit newEdit(int op)
+{
+    TopologyEdit e;
+    e.op = op;
+    e.position = 0;
+    e.dp_type = 0;
+    e.orientation = 0;
+    e.broadcast_type = 0;
+    e.occurrence = 0;
+    e.component = NULL;
+    e.datapath = NULL;
+    return e;
+}
+
+//the DataPaths whose source c is, in their order
+static vector<DataPath*> ownDataPaths(Component* c)
+{
+    vector<DataPath*> dps;
+    for(DataPath* dp : *c->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+        if(dp->GetSource() == c)
+            dps.push_back(dp);
+    return dps;
+}
+
+typedef std::tuple<Component*, int, int, int> DataPathKey; //target, type, orientation, broadcast type
+
+static DataPathKey dataPathKey(DataPath* dp, Component* target)
+{
+    return {target, dp->GetDataPathType(), dp->GetOrientation(), dp->GetBroadcastType()};
+}
+
+//a subtree of the new tree without a counterpart in the old tree, or a subtree of the old tree without a counterpart in the new tree
+struct TopologyDiffCandidate {
+    Component* c;
+    ComponentPath old_path; /**< removed: the path of c; added: the path of the parent (in the old tree) */
+    ComponentPath new_path; /**< added: the path of c in the new tree */
+    size_t position; /**< added: the position among the children of the parent */
+};
+
+struct TopologyDiffState {
+    Component* new_root;
+    vector<TopologyEdit>* edits;
+    std::unordered_map<Component*, Component*> old_to_new; /**< the matched Components (NULL for the removed ones); includes all children of the compared Components */
+    vector<TopologyDiffCandidate> removed, added;
+    vector<std::tuple<Component*, Component*, ComponentPath>> datapath_pairs; /**< the matched Components whose own DataPaths differ, with the path in the new tree */
+};
+
+//compares the matched Components a (old tree) and b (new tree)
+static void diffComponent(TopologyDiffState& st, Component* a, Component* b, const ComponentPath& old_path, const ComponentPath& new_path)
+{
+    if(a->GetHash(SYS_SAGE_HASH_DATAPATHS) == b->GetHash(SYS_SAGE_HASH_DATAPATHS))
+        return;
+    if(a->GetHash(SYS_SAGE_HASH_NO_CHILDREN) != b->GetHash(SYS_SAGE_HASH_NO_CHILDREN))
+    {
+        TopologyEdit e = newEdit(SYS_SAGE_EDIT_CHANGE_COMPONENT);
+        e.path = old_path;
+        e.component = b;
+        st.edits->push_back(e);
+    }
+    if(a->GetHash(SYS_SAGE_HASH_NO_CHILDREN | SYS_SAGE_HASH_DATAPATHS) != b->GetHash(SYS_SAGE_HASH_NO_CHILDREN | SYS_SAGE_HASH_DATAPATHS))
+        st.datapath_pairs.push_back({a, b, new_path});
+
+    vector<Component*>& old_children = *a->GetChildren();
+    vector<Component*>& new_children = *b->GetChildren();
+    vector<ComponentKey> old_keys = childKeys(a);
+    vector<ComponentKey> new_keys = childKeys(b);
+    std::map<std::tuple<int,int,int>, size_t> old_index;
+    for(size_t i = 0; i < old_keys.size(); i++)
+        old_index[{old_keys[i].type, old_keys[i].id, old_keys[i].occurrence}] = i;
+
+    vector<size_t> match(new_children.size(), SIZE_MAX);
+    vector<bool> old_matched(old_children.size(), false);
+    vector<size_t> order; //old positions of the matched children, in the new order
+    for(size_t j = 0; j < new_children.size(); j++)
+    {
+        auto it = old_index.find({new_keys[j].type, new_keys[j].id, new_keys[j].occurrence});
+        if(it == old_index.end() || old_children[it->second]->GetComponentType() != new_children[j]->GetComponentType())
+            continue;
+        match[j] = it->second;
+        old_matched[it->second] = true;
+        order.push_back(it->second);
+    }
+    //the matched children in a longest increasing subsequence stay in place, the others are moved
+    vector<bool> in_place(order.size(), false);
+    for(size_t k : longestIncreasing(order))
+        in_place[k] = true;
+
+    size_t k = 0;
+    for(size_t j = 0; j < new_children.size(); j++)
+    {
+        ComponentPath child_new_path = childPath(new_path, new_keys[j]);
+        if(match[j] == SIZE_MAX)
+        {
+            st.added.push_back({new_children[j], old_path, child_new_path, j});
+            continue;
+        }
+        Component* old_child = old_children[match[j]];
+        ComponentPath child_old_path = childPath(old_path, old_keys[match[j]]);
+        st.old_to_new[old_child] = new_children[j];
+        if(!in_place[k++])
+        {
+            TopologyEdit e = newEdit(SYS_SAGE_EDIT_MOVE_COMPONENT);
+            e.path = child_old_path;
+            e.target = old_path;
+            e.position = j;
+            st.edits->push_back(e);
+        }
+        diffComponent(st, old_child, new_children[j], child_old_path, child_new_path);
+    }
+    for(size_t i = 0; i < old_children.size(); i++)
+    {
+        if(old_matched[i])
+            continue;
+        st.old_to_new[old_children[i]] = NULL;
+        st.removed.push_back({old_children[i], childPath(old_path, old_keys[i]), {}, 0});
+    }
+}
+
+//the counterpart of a Component of the old tree in the new tree: the subtrees that were not compared are identical, so their Components correspond by position
+static Component* mapToNew(TopologyDiffState& st, Component* c)
+{
+    vector<size_t> positions;
+    for(Component* x = c; ; )
+    {
+        auto it = st.old_to_new.find(x);
+        if(it != st.old_to_new.end())
+        {
+            Component* ret = it->second;
+            for(auto pos = positions.rbegin(); pos != positions.rend() && ret != NULL; ++pos)
+                ret = *pos < ret->GetChildren()->size() ? (*ret->GetChildren())[*pos] : NULL;
+            return ret;
+        }
+        Component* parent = x->GetParent();
+        if(parent == NULL)
+            return c; //not in the old tree
+        vector<Component*>* siblings = parent->GetChildren();
+        positions.push_back(std::find(siblings->begin(), siblings->end(), x) - siblings->begin());
+        x = parent;
+    }
+}
+
+static bool sameDataPath(DataPath* x, DataPath* y)
+{
+    return x->GetBandwidth() == y->GetBandwidth() && x->GetLatency() == y->GetLatency() && HashAttributes(x->attrib, HashBytes(NULL, 0)) == HashAttributes(y->attrib, HashBytes(NULL, 0));
+}
+
+static TopologyEdit dataPathEdit(TopologyDiffState& st, int op, DataPath* dp, const ComponentPath& source_path, Component* target)
+{
+    TopologyEdit e = newEdit(op);
+    e.path = source_path;
+    e.target = GetComponentPath(target, st.new_root);
+    e.dp_type = dp->GetDataPathType();
+    e.orientation = dp->GetOrientation();
+    e.broadcast_type = dp->GetBroadcastType();
+    return e;
+}
+
+//adds the DataPaths of an added subtree (also those from the rest of the tree)
+static void addSubtreeDataPaths(TopologyDiffState& st, Component* c, const ComponentPath& path, std::unordered_set<DataPath*>* added)
+{
+    for(DataPath* dp : *c->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+    {
+        if(dp->GetSource() != c || !added->insert(dp).second)
+            continue;
+        TopologyEdit e = dataPathEdit(st, SYS_SAGE_EDIT_ADD_DATAPATH, dp, path, dp->GetTarget());
+        e.datapath = dp;
+        st.edits->push_back(e);
+    }
+    for(DataPath* dp : *c->GetDataPaths(SYS_SAGE_DATAPATH_INCOMING))
+    {
+        if(dp->GetSource() == c || !added->insert(dp).second)
+            continue;
+        TopologyEdit e = dataPathEdit(st, SYS_SAGE_EDIT_ADD_DATAPATH, dp, GetComponentPath(dp->GetSource(), st.new_root), dp->GetTarget());
+        e.datapath = dp;
+        st.edits->push_back(e);
+    }
+    vector<ComponentKey> keys = childKeys(c);
+    for(size_t i = 0; i < keys.size(); i++)
+        addSubtreeDataPaths(st, (*c->GetChildren())[i], childPath(path, keys[i]), added);
+}
+
+//compares the own DataPaths of the matched Components a (old tree) and b (new tree)
+static void diffDataPaths(TopologyDiffState& st, Component* a, Component* b, const ComponentPath& new_path, std::unordered_set<DataPath*>* added)
+{
+    //the DataPaths to removed Components are removed with them
+    std::map<DataPathKey, vector<DataPath*>> old_dps;
+    vector<std::pair<DataPath*, DataPathKey>> old_order;
+    for(DataPath* dp : ownDataPaths(a))
+    {
+        Component* target = mapToNew(st, dp->GetTarget());
+        if(target == NULL)
+            continue;
+        DataPathKey key = dataPathKey(dp, target);
+        old_dps[key].push_back(dp);
+        old_order.push_back({dp, key});
+    }
+    std::map<DataPathKey, size_t> new_count;
+    for(DataPath* dp : ownDataPaths(b))
+    {
+        DataPathKey key = dataPathKey(dp, dp->GetTarget());
+        size_t k = new_count[key]++;
+        auto old = old_dps.find(key);
+        if(old != old_dps.end() && k < old->second.size())
+        {
+            if(sameDataPath(old->second[k], dp))
+                continue;
+            TopologyEdit e = dataPathEdit(st, SYS_SAGE_EDIT_CHANGE_DATAPATH, dp, new_path, dp->GetTarget());
+            e.occurrence = k;
+            e.datapath = dp;
+            st.edits->push_back(e);
+        }
+        else if(added->insert(dp).second)
+        {
+            TopologyEdit e = dataPathEdit(st, SYS_SAGE_EDIT_ADD_DATAPATH, dp, new_path, dp->GetTarget());
+            e.datapath = dp;
+            st.edits->push_back(e);
+        }
+    }
+    std::map<DataPathKey, size_t> old_count;
+    for(auto const& [dp, key] : old_order)
+    {
+        size_t k = old_count[key]++;
+        if(k < new_count[key])
+            continue;
+        TopologyEdit e = dataPathEdit(st, SYS_SAGE_EDIT_REMOVE_DATAPATH, dp, new_path, std::get<0>(key));
+        e.occurrence = k;
+        st.edits->push_back(e);
+    }
+}
+
+int DiffTopologies(Component* old_root, Component* new_root, vector<TopologyEdit>* edits)
+{
+    edits->clear();
+    if(old_root->GetComponentType() != new_root->GetComponentType() || old_root->GetId() != new_root->GetId())
+    {
+        std::cerr << "DiffTopologies: the roots have different types or ids." << std::endl;
+        return 1;
+    }
+    TopologyDiffState st;
+    st.new_root = new_root;
+    st.edits = edits;
+    st.old_to_new[old_root] = new_root;
+    diffComponent(st, old_root, new_root, {}, {});
+
+    //an added subtree identical to a removed one is moved
+    std::unordered_multimap<uint64_t, size_t> removed_by_hash;
+    for(size_t i = 0; i < st.removed.size(); i++)
+        removed_by_hash.insert({st.removed[i].c->GetHash(), i});
+    vector<bool> moved(st.removed.size(), false);
+    vector<TopologyDiffCandidate> added_subtrees;
+    for(size_t j = 0; j < st.added.size(); j++)
+    {
+        TopologyDiffCandidate add = st.added[j];
+        auto [begin, end] = removed_by_hash.equal_range(add.c->GetHash());
+        auto it = std::find_if(begin, end, [&moved](auto const& r) { return !moved[r.second]; });
+        if(it == end)
+        {
+            TopologyEdit e = newEdit(SYS_SAGE_EDIT_ADD_COMPONENT);
+            e.target = add.old_path;
+            e.position = add.position;
+            e.component = add.c;
+            edits->push_back(e);
+            added_subtrees.push_back(add);
+            continue;
+        }
+        TopologyDiffCandidate& r = st.removed[it->second];
+        moved[it->second] = true;
+        TopologyEdit e = newEdit(SYS_SAGE_EDIT_MOVE_COMPONENT);
+        e.path = r.old_path;
+        e.target = add.old_path;
+        e.position = add.position;
+        edits->push_back(e);
+        st.old_to_new[r.c] = add.c;
+        diffComponent(st, r.c, add.c, r.old_path, add.new_path);
+    }
+    for(size_t i = 0; i < st.removed.size(); i++)
+    {
+        if(moved[i])
+            continue;
+        TopologyEdit e = newEdit(SYS_SAGE_EDIT_REMOVE_COMPONENT);
+        e.path = st.removed[i].old_path;
+        edits->push_back(e);
+    }
+
+    std::unordered_set<DataPath*> added_dps;
+    for(const TopologyDiffCandidate& add : added_subtrees)
+        addSubtreeDataPaths(st, add.c, add.new_path, &added_dps);
+    for(auto const& [a, b, new_path] : st.datapath_pairs)
+        diffDataPaths(st, a, b, new_path, &added_dps);
+    return 0;
+}
+
+//copies the properties and the attributes of from (of the same type) to c; the replaced attribute values are destroyed
+static void copyProperties(Component* from, Component* c)
+{
+    c->SetName(from->GetName());
+    c->SetInstances(from->GetInstanceIds());
+    switch(c->GetComponentType())
+    {
+        case SYS_SAGE_COMPONENT_CACHE:{
+            Cache* x = (Cache*)from; Cache* y = (Cache*)c;
+            y->SetCacheName(x->GetCacheName());
+            y->SetCacheSize(x->GetCacheSize());
+            y->SetCacheAssociativityWays(x->GetCacheAssociativityWays());
+            y->SetCacheLineSize(x->GetCacheLineSize());
+            break;
+        }
+        case SYS_SAGE_COMPONENT_SUBDIVISION:
+            ((Subdivision*)c)->SetSubdivisionType(((Subdivision*)from)->GetSubdivisionType());
+            break;
+        case SYS_SAGE_COMPONENT_NUMA:
+            ((Numa*)c)->SetSubdivisionType(((Numa*)from)->GetSubdivisionType());
+            ((Numa*)c)->SetSize(((Numa*)from)->GetSize());
+            break;
+        case SYS_SAGE_COMPONENT_CHIP:{
+            Chip* x = (Chip*)from; Chip* y = (Chip*)c;
+            y->SetChipType(x->GetChipType());
+            y->SetVendor(x->GetVendor());
+            y->SetModel(x->GetModel());
+            break;
+        }
+        case SYS_SAGE_COMPONENT_MEMORY:
+            ((Memory*)c)->SetSize(((Memory*)from)->GetSize());
+            ((Memory*)c)->SetIsVolatile(((Memory*)from)->GetIsVolatile());
+            break;
+        case SYS_SAGE_COMPONENT_STORAGE:
+            ((Storage*)c)->SetSize(((Storage*)from)->GetSize());
+            break;
+#ifdef PROC_CPUINFO
+        case SYS_SAGE_COMPONENT_CORE:
+            ((Core*)c)->SetFreq(((Core*)from)->GetFreq());
+            break;
+#endif
+    }
+    DestroyAttributes(&c->attrib);
+    c->attrib = CloneAttributes(from->attrib);
+    c->MarkDirty();
+}
+
+static Component* cloneSubtree(Component* c)
+{
+    Component* copy = cloneComponentNode(c);
+    for(Component* child : *c->GetChildren())
+        copy->InsertChild(cloneSubtree(child));
+    return copy;
+}
+
+//destroys the attribute values of a subtree and of its DataPaths, before it is deleted
+static void destroySubtreeAttributes(Component* c)
+{
+    DestroyAttributes(&c->attrib);
+    for(int orientation : { SYS_SAGE_DATAPATH_OUTGOING, SYS_SAGE_DATAPATH_INCOMING })
+        for(DataPath* dp : *c->GetDataPaths(orientation))
+            DestroyAttributes(&dp->attrib);
+    for(Component* child : *c->GetChildren())
+        destroySubtreeAttributes(child);
+}
+
+static void insertChildAt(Component* parent, Component* child, size_t position)
+{
+    parent->InsertChild(child);
+    vector<Component*>* children = parent->GetChildren();
+    children->pop_back();
+    children->insert(children->begin() + std::min(position, children->size()), child);
+}
+
+//the occurrence-th DataPath of source with the target, type, orientation and broadcast type of the edit, or NULL
+static DataPath* findDataPath(Component* source, Component* target, const TopologyEdit& e)
+{
+    int occurrence = 0;
+    for(DataPath* dp : ownDataPaths(source))
+        if(dp->GetTarget() == target && dp->GetDataPathType() == e.dp_type && dp->GetOrientation() == e.orientation && dp->GetBroadcastType() == e.broadcast_type && occurrence++ == e.occurrence)
+            return dp;
+    return NULL;
+}
+
+int PatchTopology(Component* root, const vector<TopologyEdit>& edits)
+{
+    const int component_ops = SYS_SAGE_EDIT_ADD_COMPONENT | SYS_SAGE_EDIT_REMOVE_COMPONENT | SYS_SAGE_EDIT_MOVE_COMPONENT | SYS_SAGE_EDIT_CHANGE_COMPONENT;
+    //the Component edits address the tree before the patch: resolve them all first
+    vector<Component*> components(edits.size(), NULL), parents(edits.size(), NULL);
+    vector<size_t> inserts;
+    for(size_t i = 0; i < edits.size(); i++)
+    {
+        const TopologyEdit& e = edits[i];
+        if(!(e.op & component_ops))
+            continue;
+        if(e.op != SYS_SAGE_EDIT_ADD_COMPONENT && (components[i] = FindComponentByPath(root, e.path)) == NULL)
+        {
+            std::cerr << "PatchTopology: component of edit " << i << " not found." << std::endl;
+            return 1;
+        }
+        if(e.op == SYS_SAGE_EDIT_ADD_COMPONENT || e.op == SYS_SAGE_EDIT_MOVE_COMPONENT)
+        {
+            if((parents[i] = FindComponentByPath(root, e.target)) == NULL || (e.op == SYS_SAGE_EDIT_ADD_COMPONENT && e.component == NULL))
+            {
+                std::cerr << "PatchTopology: new parent of edit " << i << " not found." << std::endl;
+                return 1;
+            }
+            inserts.push_back(i);
+        }
+    }
+
+    for(size_t i = 0; i < edits.size(); i++)
+    {
+        if(edits[i].op == SYS_SAGE_EDIT_CHANGE_COMPONENT && edits[i].component != NULL)
+            copyProperties(edits[i].component, components[i]);
+        else if(edits[i].op == SYS_SAGE_EDIT_REMOVE_COMPONENT)
+        {
+            destroySubtreeAttributes(components[i]);
+            components[i]->Delete(true);
+        }
+        else if(edits[i].op == SYS_SAGE_EDIT_MOVE_COMPONENT && components[i]->GetParent() != NULL)
+        {
+            components[i]->GetParent()->RemoveChild(components[i]);
+            components[i]->SetParent(NULL);
+        }
+    }
+    //inserted in the order of their positions, the children end up at their positions
+    std::stable_sort(inserts.begin(), inserts.end(), [&edits](size_t x, size_t y) { return edits[x].position < edits[y].position; });
+    for(size_t i : inserts)
+        insertChildAt(parents[i], edits[i].op == SYS_SAGE_EDIT_ADD_COMPONENT ? cloneSubtree(edits[i].component) : components[i], edits[i].position);
+
+    //the DataPath edits address the tree after the Component edits
+    int ret = 0;
+    vector<Component*> sources(edits.size(), NULL), targets(edits.size(), NULL);
+    vector<DataPath*> dps(edits.size(), NULL);
+    for(size_t i = 0; i < edits.size(); i++)
+    {
+        const TopologyEdit& e = edits[i];
+        if(e.op & component_ops)
+            continue;
+        sources[i] = FindComponentByPath(root, e.path);
+        targets[i] = FindComponentByPath(root, e.target);
+        if(sources[i] != NULL && targets[i] != NULL && e.op != SYS_SAGE_EDIT_ADD_DATAPATH)
+            dps[i] = findDataPath(sources[i], targets[i], e);
+        bool resolved = e.op == SYS_SAGE_EDIT_ADD_DATAPATH ? sources[i] != NULL && targets[i] != NULL && e.datapath != NULL : dps[i] != NULL;
+        if(!resolved || (e.op == SYS_SAGE_EDIT_CHANGE_DATAPATH && e.datapath == NULL))
+        {
+            std::cerr << "PatchTopology: data path of edit " << i << " not found." << std::endl;
+            dps[i] = NULL;
+            sources[i] = NULL;
+            ret = 2;
+        }
+    }
+    for(size_t i = 0; i < edits.size(); i++)
+    {
+        const TopologyEdit& e = edits[i];
+        if(e.op == SYS_SAGE_EDIT_CHANGE_DATAPATH && dps[i] != NULL)
+        {
+            dps[i]->SetBandwidth(e.datapath->GetBandwidth());
+            dps[i]->SetLatency(e.datapath->GetLatency());
+            DestroyAttributes(&dps[i]->attrib);
+            dps[i]->attrib = CloneAttributes(e.datapath->attrib);
+        }
+        else if(e.op == SYS_SAGE_EDIT_REMOVE_DATAPATH && dps[i] != NULL)
+        {
+            DestroyAttributes(&dps[i]->attrib);
+            dps[i]->DeleteDataPath();
+        }
+    }
+    for(size_t i = 0; i < edits.size(); i++)
+    {
+        const TopologyEdit& e = edits[i];
+        if(e.op != SYS_SAGE_EDIT_ADD_DATAPATH || sources[i] == NULL)
+            continue;
+        DataPath* dp = new DataPath(sources[i], targets[i], e.orientation, e.dp_type, e.datapath->GetBandwidth(), e.datapath->GetLatency(), e.broadcast_type);
+        dp->attrib = CloneAttributes(e.datapath->attrib);
+        sources[i]->MarkDirty(true);
+    }
+    return ret;
+}
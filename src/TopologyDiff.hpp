@@ -0,0 +1,86 @@
+#ifndef TOPOLOGY_DIFF
+#define TOPOLOGY_DIFF
+
+#include <vector>
+
+#include "Component.hpp"
+#include "DataPath.hpp"
+
+/*! \file */
+
+using namespace std;
+
+#define SYS_SAGE_EDIT_ADD_COMPONENT 1 /**< TopologyEdit: a subtree is added. */
+#define SYS_SAGE_EDIT_REMOVE_COMPONENT 2 /**< TopologyEdit: a subtree is removed (with its DataPaths). */
+#define SYS_SAGE_EDIT_MOVE_COMPONENT 4 /**< TopologyEdit: a subtree is moved to another parent, or to another position among its siblings. */
+#define SYS_SAGE_EDIT_CHANGE_COMPONENT 8 /**< TopologyEdit: the properties (name, instances, size, ...) or the attributes of a Component change. */
+#define SYS_SAGE_EDIT_ADD_DATAPATH 16 /**< TopologyEdit: a DataPath is added. */
+#define SYS_SAGE_EDIT_REMOVE_DATAPATH 32 /**< TopologyEdit: a DataPath is removed. */
+#define SYS_SAGE_EDIT_CHANGE_DATAPATH 64 /**< TopologyEdit: the bandwidth, latency or attributes of a DataPath change. */
+
+/**
+Identifies a Component among its siblings: its type, its id, and the number of its preceding siblings with the same type and id (usually 0).
+*/
+struct ComponentKey {
+    int type; /**< SYS_SAGE_COMPONENT_* */
+    int id;
+    int occurrence; /**< number of preceding siblings with the same type and id */
+    bool operator==(const ComponentKey& other) const { return type == other.type && id == other.id && occurrence == other.occurrence; }
+};
+/**
+Identifies a Component in a Component Tree: the keys of the Components on the path from the root (excluded) to it; empty for the root.
+*/
+typedef vector<ComponentKey> ComponentPath;
+
+/**
+@param c - the Component
+@param root - the root the path starts at (an ancestor of c); NULL (default) uses the root of the tree
+@return the path of c from root (see ComponentPath)
+*/
+ComponentPath GetComponentPath(Component* c, Component* root = NULL);
+/**
+@param root - the root the path starts at
+@param path - the path
+@return the Component at the path, or NULL if there is none
+*/
+Component* FindComponentByPath(Component* root, const ComponentPath& path);
+
+/**
+One edit of an edit script created by DiffTopologies() and applied by PatchTopology().
+\n The Component edits address the Components by their paths in the old tree. The DataPath edits are applied after the Component edits, so they address their Components by their paths in the new tree; a DataPath is identified by its source, target, type, orientation and broadcast type, plus occurrence if its source has more such DataPaths.
+\n The new contents are not copied into the edit script: component and datapath point into the new tree, which must stay alive until the script is applied.
+*/
+struct TopologyEdit {
+    int op; /**< SYS_SAGE_EDIT_* */
+    ComponentPath path; /**< REMOVE_COMPONENT, MOVE_COMPONENT, CHANGE_COMPONENT: the Component (in the old tree); empty for ADD_COMPONENT. DataPath edits: the source of the DataPath (in the new tree). */
+    ComponentPath target; /**< ADD_COMPONENT, MOVE_COMPONENT: the new parent (in the old tree). DataPath edits: the target of the DataPath (in the new tree). */
+    size_t position; /**< ADD_COMPONENT, MOVE_COMPONENT: the position among the children of the new parent (in the new tree). */
+    int dp_type; /**< DataPath edits: SYS_SAGE_DATAPATH_TYPE_* of the DataPath */
+    int orientation; /**< DataPath edits: SYS_SAGE_DATAPATH_ORIENTED or SYS_SAGE_DATAPATH_BIDIRECTIONAL */
+    int broadcast_type; /**< DataPath edits: broadcast type of the DataPath (0 if it is not broadcast) */
+    int occurrence; /**< REMOVE_DATAPATH, CHANGE_DATAPATH: the number of preceding DataPaths of the source with the same target, type, orientation and broadcast type (in the old tree) */
+    Component* component; /**< ADD_COMPONENT: the added subtree; CHANGE_COMPONENT: the changed Component (in the new tree). NULL otherwise. */
+    DataPath* datapath; /**< ADD_DATAPATH, CHANGE_DATAPATH: the DataPath in the new tree. NULL otherwise. */
+};
+
+/**
+Compares two Component Trees, e.g. a topology and the one rebuilt after a CPU was offlined, the CAT masks were reconfigured or a GPU was re-partitioned, and creates the edit script that turns the old tree into the new one (see PatchTopology()).
+\n The children are matched by their type and id (see ComponentKey). The subtrees with equal hashes (see Component::GetHash()) are skipped, so the cost is proportional to the changed parts of the trees (plus computing the hashes that are not cached). A removed subtree that is identical to an added one (the same hash, i.e. also the same type and id) is reported as moved. Children that keep their parent but change their order are moved too (as few as possible).
+\n The DataPaths are compared for the Components whose own DataPaths have different hashes; as in Component::GetHash(), a DataPath is hashed with the type and id of its target, so a DataPath whose target changes to another Component with the same type and id in an otherwise identical subtree is not detected. The DataPaths of the added subtrees are added; those of the removed subtrees are removed with them.
+@param old_root - root of the old tree
+@param new_root - root of the new tree; must have the same type and id as old_root
+@param edits - output: the edit script (the previous content is cleared); empty if the trees are identical
+@return 0 on success, 1 if the roots have different types or ids
+*/
+int DiffTopologies(Component* old_root, Component* new_root, vector<TopologyEdit>* edits);
+
+/**
+Applies an edit script created by DiffTopologies(old_root, new_root, ...) in place, to the old tree or to a tree identical to it (e.g. a copy imported from an export of the old tree). The Components and DataPaths that do not change stay in place, including the pointers to them.
+\n The added Components are copies of the Components of the new tree, and the changed properties, attributes and DataPaths are copied from it. The attribute values are deep-copied (see CloneAttributes()), so the new tree may be deleted afterwards. The patched tree must own its attribute values (as after importFromXml()): the replaced values and those of the removed Components and DataPaths are destroyed (see DestroyAttributes()).
+@param root - root of the tree to patch
+@param edits - the edit script
+@return 0 on success; 1 if a Component addressed by a Component edit is not found (the tree is not modified); 2 if a DataPath edit cannot be resolved after the Component edits (the other DataPath edits are applied)
+*/
+int PatchTopology(Component* root, const vector<TopologyEdit>& edits);
+
+#endif
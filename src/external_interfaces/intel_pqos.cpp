@@ -151,48 +151,27 @@ int Node::UpdateL3CATCoreCOS(){
                 cerr << "L3 cache not found" << endl; continue;
             }
 
-            //TODO check if exists -> overwrite
-
-            //add DataPath to thread and L3
-            DataPath* d = NewDataPath(thread, c, SYS_SAGE_DATAPATH_BIDIRECTIONAL, SYS_SAGE_DATAPATH_TYPE_L3CAT);
-            d->attrib.insert({"CATcos", (void*)cos});
-            d->attrib.insert({"CATL3mask", (void*)mask});
-        }
-    }
-    return 1;
-}
-
-long long Thread::GetCATAwareL3Size()
-{
-    //look for dp_outgoing where attrib contains "CATL3mask"
-    for(auto it = std::begin(dp_outgoing); it != std::end(dp_outgoing); ++it)
-    {
-        DataPath* dp = *it;
-        auto search = dp->attrib.find("CATL3mask");
-        if (search == dp->attrib.end()) {
-            continue;
-        }
-        uint64_t* mask = (uint64_t*)search->second;
-
-        Cache* c = (Cache*)dp->GetTarget();
-        int available_cache_associativity_ways = 0;
-        for(int bit = 0; bit<c->GetCacheAssociativityWays(); bit++){
-            if((*mask & (1<<bit)) == (uint64_t)(1<<bit)){
-                available_cache_associativity_ways++;
+            //update the DataPath of a previous call in place, or add DataPath to thread and L3
+            DataPath* d = NULL;
+            for(DataPath* dp : *thread->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)){
+                if(dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_L3CAT && dp->GetTarget() == c){
+                    d = dp;
+                    break;
+                }
             }
+            if(d == NULL)
+                d = new DataPath(thread, c, SYS_SAGE_DATAPATH_BIDIRECTIONAL, SYS_SAGE_DATAPATH_TYPE_L3CAT);
+            for(auto key : {"CATcos", "CATL3mask"}){
+                auto old = d->attrib.find(key);
+                if(old != d->attrib.end())
+                    delete (uint64_t*)old->second;
+            }
+            d->attrib["CATcos"] = (void*)cos;
+            d->attrib["CATL3mask"] = (void*)mask;
+            thread->MarkDirty(true);
         }
-        //cout << "GetCATAwareL3Size: size " << c->GetCacheSize() << " tot_ways " << c->GetCacheAssociativityWays() << ", available ways " << available_cache_associativity_ways << endl;
-        return c->GetCacheSize() / c->GetCacheAssociativityWays() * available_cache_associativity_ways ;
     }
-
-    Component* c = (Component*)this;
-    while(c->GetParent() != NULL){
-        //go up until L3 found
-        c = c->GetParent();
-        if(c->GetComponentType() == SYS_SAGE_COMPONENT_CACHE && ((Cache*)c)->GetCacheLevel() == 3)
-            return ((Cache*)c)->GetCacheSize();
-    };
-    return -1;
+    return 1;
 }
 
 #endif //INTEL_PQOS
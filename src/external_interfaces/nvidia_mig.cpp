@@ -8,61 +8,85 @@
 #include <sstream>
 #include <string>
 #include <array>
-
-#include <nvml.h>
+#include <algorithm>
 
 #include "Component.hpp"
+#include "nvml_interface.hpp"
 
-
-//nvmlReturn_t nvmlDeviceGetMigDeviceHandleByIndex ( nvmlDevice_t device, unsigned int  index, nvmlDevice_t* migDevice ) --> look for all mig devices and add/update them
-int Chip::UpdateMIGSettings(string uuid)
+//returns uuid, or CUDA_VISIBLE_DEVICES if uuid is empty
+static string migResolveUuid(string uuid)
 {
-    int ret = 0;
-    if(uuid.empty())
-    {
+    if(uuid.empty()){
         if(const char* env_p = std::getenv("CUDA_VISIBLE_DEVICES")){
             uuid = env_p;
         }
-        if(uuid.empty()){
-            std::cout << "Chip::UpdateMIGSettings: UUID is empty! Returning without updating the MIG settings." << std::endl;
-            return 2;
-        }
     }
-	
-    nvmlReturn_t nvml_ret = nvmlInit_v2();
-    if(nvml_ret != NVML_SUCCESS){std::cerr << "Chip::UpdateMIGSettings: Couldn't initialize nvml. nvmlInit_v2 returns " << ret << ". Returning without updating the MIG settings." << std::endl; return 2;}
+    return uuid;
+}
+
+//returns the MIG data path from src to target for uuid, or NULL
+static DataPath* migFindDataPath(Component* src, Component* target, const string& uuid)
+{
+    for(DataPath* dp : *src->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)){
+        if(dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_MIG && dp->GetTarget() == target && dp->attrib.count("mig_uuid") && *(string*)dp->attrib["mig_uuid"] == uuid)
+            return dp;
+    }
+    return NULL;
+}
+
+//creates the MIG data path from src to target for uuid, or updates the existing one in place; mig_size < 0 means no "mig_size" attribute
+static void migSetDataPath(Component* src, Component* target, const string& uuid, long long mig_size)
+{
+    DataPath* d = migFindDataPath(src, target, uuid);
+    if(d == NULL){
+        d = new DataPath(src, target, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_MIG);
+        d->attrib.insert({"mig_uuid",(void*)new string(uuid)});
+    }
+    if(mig_size >= 0){
+        auto it = d->attrib.find("mig_size");
+        if(it == d->attrib.end())
+            d->attrib.insert({"mig_size",(void*)new long long(mig_size)});
+        else
+            *(long long*)it->second = mig_size;
+        src->MarkDirty(true);
+    }
+}
+
+//deletes the MIG data path from src to target for uuid, if it exists
+static void migDeleteDataPath(Component* src, Component* target, const string& uuid)
+{
+    DataPath* d = migFindDataPath(src, target, uuid);
+    if(d == NULL)
+        return;
+    delete (string*)d->attrib["mig_uuid"];
+    if(d->attrib.count("mig_size"))
+        delete (long long*)d->attrib["mig_size"];
+    d->DeleteDataPath();
+}
+
+int Chip::UpdateMIGSettings(string uuid)
+{
+    int ret = 0;
+    uuid = migResolveUuid(uuid);
+    if(uuid.empty()){
+        std::cout << "Chip::UpdateMIGSettings: UUID is empty! Returning without updating the MIG settings." << std::endl;
+        return 2;
+    }
 
-    nvmlDevice_t device;
-    nvml_ret = nvmlDeviceGetHandleByUUID (uuid.c_str(), &device );
-    if(nvml_ret != NVML_SUCCESS){std::cerr << "Chip::UpdateMIGSettings: nvmlDeviceGetHandleByUUID returns " << ret << ". Returning without updating the MIG settings." << std::endl; return 2;}
-    
-    nvmlDeviceAttributes_t attributes;
-    nvml_ret = nvmlDeviceGetAttributes_v2 ( device, &attributes );
-    if(nvml_ret != NVML_SUCCESS){std::cerr << "Chip::UpdateMIGSettings: nvmlDeviceGetAttributes_v2 returns " << ret << ". Returning without updating the MIG settings." << std::endl; return 2;}
+    //the NVML session is opened once and kept open between the calls
+    NvmlInterface* nvml = GetNvmlInterface();
+    if(nvml == NULL){std::cerr << "Chip::UpdateMIGSettings: Couldn't initialize nvml. Returning without updating the MIG settings." << std::endl; return 2;}
 
-    nvml_ret =  nvmlShutdown ( );
-    if(nvml_ret != NVML_SUCCESS){std::cerr << "Chip::UpdateMIGSettings: nvmlShutdown returns " << ret << ". Will continue, though." << std::endl; ret = 1;}
+    NvmlDeviceAttributes attributes;
+    if(nvml->GetDeviceAttributes(uuid, &attributes) != 0){std::cerr << "Chip::UpdateMIGSettings: Couldn't get the attributes of " << uuid << ". Returning without updating the MIG settings." << std::endl; return 2;}
 
     //cout << "...........multiprocessorCount " << attributes.multiprocessorCount << " gpuInstanceSliceCount=" << attributes.gpuInstanceSliceCount << "  computeInstanceSliceCount=" << attributes.computeInstanceSliceCount << "    memorySizeMB=" << attributes.memorySizeMB << endl;
-    
+
     //main memory, expects the memory as a child of
     Memory* m = (Memory*)GetChildByType(SYS_SAGE_COMPONENT_MEMORY);
-    long long* mig_size;
+    long long mig_size = attributes.memorySizeMB*1000000;
     if(m != NULL){
-        DataPath * d = NULL;
-        //iterate over dp_outgoing to check if DP already exists
-        for(DataPath* dp : dp_outgoing){
-            if(dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_MIG && *(string*)dp->attrib["mig_uuid"] == uuid){
-                d = dp;
-                break;
-            }
-        }
-
-        d = new DataPath(this, m, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_MIG);
-        string* mig_uuid = new string(uuid);
-        mig_size = new long long(attributes.memorySizeMB*1000000);
-        d->attrib.insert({"mig_uuid",(void*)mig_uuid});
-        d->attrib.insert({"mig_size",(void*)mig_size});
+        migSetDataPath(this, m, uuid, mig_size);
     } else {
         std::cerr << "Chip::UpdateMIGSettings: Component Type Memory not found as a child of this Chip. Memory info will not be updated." << std::endl;
         ret = 1;
@@ -70,29 +94,24 @@ int Chip::UpdateMIGSettings(string uuid)
 
     //L2 cache(s)
     unsigned int L2_fraction = 1; //which fraction of L2 is in MIG partition (the same fraction as the fraction of main memory)
-    if(m->GetSize() > *mig_size){
-        L2_fraction = (m->GetSize() + (*mig_size/2)) / *mig_size; //divide and round up or down
+    if(m != NULL && mig_size > 0 && m->GetSize() > mig_size){
+        L2_fraction = (m->GetSize() + (mig_size/2)) / mig_size; //divide and round up or down
     }
     vector<Component*> caches;
-    FindAllSubcomponentsByType(&caches, SYS_SAGE_COMPONENT_CACHE);
+    GetAllSubcomponentsByType(&caches, SYS_SAGE_COMPONENT_CACHE);
     vector<Cache*> L2_caches;
     for(Component* c : caches){
         if(((Cache*)c)->GetCacheName() == "L2"){
             L2_caches.push_back((Cache*)c);
-        }            
+        }
     }
     int num_caches = L2_caches.size();
     if(num_caches > 0){
         int cache_id = 0;
         for(Cache* c : L2_caches){
-            DataPath * d = new DataPath(this, c, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_MIG);
-            string* mig_uuid = new string(uuid);
-            mig_size = new long long();
-            *mig_size = c->GetCacheSize() * ( (float)num_caches/(float)L2_fraction-(float)cache_id/(float)num_caches);
-            if(*mig_size <0)
-                *mig_size=0;
-            d->attrib.insert({"mig_uuid",(void*)mig_uuid});
-            d->attrib.insert({"mig_size",(void*)mig_size});
+            long long l2_size = c->GetCacheSize() * ( (float)num_caches/(float)L2_fraction-(float)cache_id/(float)num_caches);
+            l2_size = std::clamp(l2_size, 0ll, c->GetCacheSize());
+            migSetDataPath(this, c, uuid, l2_size);
             cache_id++;
         }
     } else {
@@ -100,135 +119,115 @@ int Chip::UpdateMIGSettings(string uuid)
         ret = 1;
     }
 
-    //sm  attributes.multiprocessorCount
+    //sm  attributes.multiprocessorCount; SMs that left the partition lose their data path
     vector<Component*> subdivisions;
-    FindAllSubcomponentsByType(&subdivisions,SYS_SAGE_COMPONENT_SUBDIVISION);
-    vector<Subdivision*> sms;
+    GetAllSubcomponentsByType(&subdivisions,SYS_SAGE_COMPONENT_SUBDIVISION);
     for(Component* sm : subdivisions){
-        if(((Subdivision*)sm)->GetSubdivisionType() == SYS_SAGE_SUBDIVISION_TYPE_GPU_SM)
-            sms.push_back((Subdivision*)sm);
-    }
-    for(Subdivision* sm: sms){
-        if(sm->GetId() < (int)attributes.multiprocessorCount){
-            DataPath * d = new DataPath(this, sm, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_MIG);
-            string* mig_uuid = new string(uuid);
-            d->attrib.insert({"mig_uuid",(void*)mig_uuid});
-        }
+        if(((Subdivision*)sm)->GetSubdivisionType() != SYS_SAGE_SUBDIVISION_TYPE_GPU_SM)
+            continue;
+        if(sm->GetId() < (int)attributes.multiprocessorCount)
+            migSetDataPath(this, sm, uuid, -1);
+        else
+            migDeleteDataPath(this, sm, uuid);
     }
 
+    std::lock_guard<std::mutex> guard(mig_index_lock);
+    mig_indices.clear();
+    GetMIGIndex(uuid);
+
     return ret;
 }
 
-int Chip::GetMIGNumSMs(string uuid)
+Chip::mig_index* Chip::GetMIGIndex(string uuid)
 {
-    if(uuid.empty()){
-        if(const char* env_p = std::getenv("CUDA_VISIBLE_DEVICES")){
-            uuid = env_p;
-        }
-    }
-    int num_sm = 0;
-    if(uuid.empty()) //when no uuid provided and no uuid found in env CUDA_VISIBLE_DEVICES, return full GPU num SMs.
+    //the subtree may have been edited since the index was built (e.g. SMs deleted, data paths changed outside UpdateMIGSettings())
+    uint64_t hash = GetHash(SYS_SAGE_HASH_DATAPATHS);
+    auto it = mig_indices.find(uuid);
+    if(it != mig_indices.end() && it->second.hash == hash)
+        return &it->second;
+
+    mig_index* idx = &mig_indices[uuid];
+    *idx = mig_index();
+    idx->hash = hash;
+    vector<Component*> sms;
+    if(uuid.empty()) //whole chip
     {
-        std::cerr << "Chip::GetMIGNumSMs: no UUID provided or found in env CUDA_VISIBLE_DEVICES. Returning information for full machine." << std::endl;
-        
         vector<Component*> subdivisions;
-        FindAllSubcomponentsByType(&subdivisions, SYS_SAGE_COMPONENT_SUBDIVISION);
-        vector<Subdivision*> sms;
+        GetAllSubcomponentsByType(&subdivisions, SYS_SAGE_COMPONENT_SUBDIVISION);
         for(Component* sm : subdivisions){
-            if(((Subdivision*)sm)->GetSubdivisionType() == SYS_SAGE_SUBDIVISION_TYPE_GPU_SM){
-                num_sm++;
-            }
+            if(((Subdivision*)sm)->GetSubdivisionType() == SYS_SAGE_SUBDIVISION_TYPE_GPU_SM)
+                sms.push_back(sm);
         }
-    } 
+    }
     else
     {
         for(DataPath* dp: dp_outgoing){
-            if(dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_MIG && *(string*)dp->attrib["mig_uuid"] == uuid){
-                Component* target = dp->GetTarget();
-                if(target->GetComponentType() == SYS_SAGE_COMPONENT_SUBDIVISION && ((Subdivision*)target)->GetSubdivisionType() == SYS_SAGE_SUBDIVISION_TYPE_GPU_SM ){
-                    num_sm++;
-                }
-            }
+            if(dp->GetDataPathType() != SYS_SAGE_DATAPATH_TYPE_MIG || !dp->attrib.count("mig_uuid") || *(string*)dp->attrib["mig_uuid"] != uuid)
+                continue;
+            Component* target = dp->GetTarget();
+            if(target->GetComponentType() == SYS_SAGE_COMPONENT_SUBDIVISION && ((Subdivision*)target)->GetSubdivisionType() == SYS_SAGE_SUBDIVISION_TYPE_GPU_SM)
+                sms.push_back(target);
+            if(dp->attrib.count("mig_size"))
+                idx->sizes[target] = *(long long*)dp->attrib["mig_size"];
         }
     }
-    return num_sm;
+
+    vector<Component*> cores;
+    for(Component* sm : sms)
+        sm->GetAllSubcomponentsByType(&cores, SYS_SAGE_COMPONENT_THREAD);
+    idx->num_sms = sms.size();
+    idx->num_cores = cores.size();
+    return idx;
 }
 
-int Chip::GetMIGNumCores(string uuid)
+int Chip::GetMIGNumSMs(string uuid)
 {
-    vector<Subdivision*> sms;
-    vector<Component*> cores;
-    if(uuid.empty()){
-        if(const char* env_p = std::getenv("CUDA_VISIBLE_DEVICES")){
-            uuid = env_p;
-        }
-    }
+    uuid = migResolveUuid(uuid);
+    if(uuid.empty()) //when no uuid provided and no uuid found in env CUDA_VISIBLE_DEVICES, return full GPU num SMs.
+        std::cerr << "Chip::GetMIGNumSMs: no UUID provided or found in env CUDA_VISIBLE_DEVICES. Returning information for full machine." << std::endl;
+
+    std::lock_guard<std::mutex> guard(mig_index_lock);
+    return GetMIGIndex(uuid)->num_sms;
+}
 
+int Chip::GetMIGNumCores(string uuid)
+{
+    uuid = migResolveUuid(uuid);
     if(uuid.empty()) //when no uuid provided and no uuid found in env CUDA_VISIBLE_DEVICES, return full GPU num SMs.
-    {
         std::cerr << "Chip::GetMIGNumCores: no UUID provided or found in env CUDA_VISIBLE_DEVICES. Returning information for full machine." << std::endl;
 
-        vector<Component*> subdivisions;
-        FindAllSubcomponentsByType(&subdivisions, SYS_SAGE_COMPONENT_SUBDIVISION);
-        for(Component* sm : subdivisions){
-            if(((Subdivision*)sm)->GetSubdivisionType() == SYS_SAGE_SUBDIVISION_TYPE_GPU_SM)
-                sms.push_back((Subdivision*)sm);
-        }
-    }
-    else
-    {
-        for(DataPath* dp: dp_outgoing){
-            if(dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_MIG && *(string*)dp->attrib["mig_uuid"] == uuid){
-                Component* target = dp->GetTarget();
-                if(target->GetComponentType() == SYS_SAGE_COMPONENT_SUBDIVISION && ((Subdivision*)target)->GetSubdivisionType() == SYS_SAGE_SUBDIVISION_TYPE_GPU_SM ){
-                    sms.push_back((Subdivision*)target);
-                }
-            }
-        }
-    }
+    std::lock_guard<std::mutex> guard(mig_index_lock);
+    return GetMIGIndex(uuid)->num_cores;
+}
 
-    for(Subdivision* sm: sms)
-    {
-        sm->FindAllSubcomponentsByType(&cores, SYS_SAGE_COMPONENT_THREAD);
-    }
-    
-    return cores.size();
+long long Chip::GetMIGComponentSize(Component* c, string uuid)
+{
+    std::lock_guard<std::mutex> guard(mig_index_lock);
+    mig_index* idx = GetMIGIndex(uuid);
+    auto it = idx->sizes.find(c);
+    return it == idx->sizes.end() ? -1 : it->second;
 }
 
 long long Memory::GetMIGSize(string uuid)
 {
-    if(uuid.empty()){
-        if(const char* env_p = std::getenv("CUDA_VISIBLE_DEVICES")){
-            uuid = env_p;
-        }
-    }
-
+    uuid = migResolveUuid(uuid);
     if(uuid.empty()) //when no uuid provided and no uuid found in env CUDA_VISIBLE_DEVICES, return full GPU num SMs.
     {
         std::cerr << "Memory::GetMIGSize: no UUID provided or found in env CUDA_VISIBLE_DEVICES. Returning information for full machine." << std::endl;
         return size;
-    } 
-
-    for(DataPath* dp: dp_incoming){
-        if(dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_MIG && *(string*)dp->attrib["mig_uuid"] == uuid){
-            if (dp->attrib.count("mig_size")){
-                long long r = *(long long*)dp->attrib["mig_size"];
-                return r;
-            }
-        }
     }
+
+    Chip* chip = (Chip*)GetAncestorByType(SYS_SAGE_COMPONENT_CHIP);
+    long long r = (chip == NULL) ? -1 : chip->GetMIGComponentSize(this, uuid);
+    if(r >= 0)
+        return r;
     std::cerr << "Memory::GetMIGSize: no information found about specified UUID " << uuid << " - returning full memory size." << std::endl;
-    return size; 
+    return size;
 }
 
 long long Cache::GetMIGSize(string uuid)
 {
-    if(uuid.empty()){
-        if(const char* env_p = std::getenv("CUDA_VISIBLE_DEVICES")){
-            uuid = env_p;
-        }
-    }
-
+    uuid = migResolveUuid(uuid);
     if(uuid.empty()) //when no uuid provided and no uuid found in env CUDA_VISIBLE_DEVICES, return full GPU num SMs.
     {
         std::cerr << "Cache::GetMIGSize: no UUID provided or found in env CUDA_VISIBLE_DEVICES. Returning information for full machine." << std::endl;
@@ -236,14 +235,10 @@ long long Cache::GetMIGSize(string uuid)
     }
 
     if(GetCacheLevel() == 2){
-        for(DataPath* dp: dp_incoming){
-            if(dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_MIG && *(string*)dp->attrib["mig_uuid"] == uuid){
-                if (dp->attrib.count("mig_size")){
-                    long long r = *(long long*)dp->attrib["mig_size"];
-                    return r;
-                }
-            }
-        }
+        Chip* chip = (Chip*)GetAncestorByType(SYS_SAGE_COMPONENT_CHIP);
+        long long r = (chip == NULL) ? -1 : chip->GetMIGComponentSize(this, uuid);
+        if(r >= 0)
+            return r;
     }
     std::cerr << "Cache::GetMIGSize: no information found about specified UUID " << uuid << " - returning full cache size." << std::endl;
     return cache_size;
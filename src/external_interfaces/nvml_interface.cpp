@@ -0,0 +1,157 @@
+#ifndef NVML_INTERFACE_CPP
+#define NVML_INTERFACE_CPP
+
+#include "defines.hpp"
+#ifdef NVIDIA_MIG
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+
+#ifndef NVML_STUB
+#include <nvml.h>
+#endif
+
+#include "nvml_interface.hpp"
+
+#ifndef NVML_STUB
+int NvmlLibrary::Init()
+{
+    nvmlReturn_t nvml_ret = nvmlInit_v2();
+    if(nvml_ret != NVML_SUCCESS){
+        std::cerr << "NvmlLibrary::Init: nvmlInit_v2 returns " << nvml_ret << " (" << nvmlErrorString(nvml_ret) << ")." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int NvmlLibrary::Shutdown()
+{
+    nvmlReturn_t nvml_ret = nvmlShutdown();
+    if(nvml_ret != NVML_SUCCESS){
+        std::cerr << "NvmlLibrary::Shutdown: nvmlShutdown returns " << nvml_ret << " (" << nvmlErrorString(nvml_ret) << ")." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int NvmlLibrary::GetDeviceAttributes(string uuid, NvmlDeviceAttributes* attributes)
+{
+    nvmlDevice_t device;
+    nvmlReturn_t nvml_ret = nvmlDeviceGetHandleByUUID(uuid.c_str(), &device);
+    if(nvml_ret != NVML_SUCCESS){
+        std::cerr << "NvmlLibrary::GetDeviceAttributes: nvmlDeviceGetHandleByUUID(" << uuid << ") returns " << nvml_ret << " (" << nvmlErrorString(nvml_ret) << ")." << std::endl;
+        return 1;
+    }
+    nvmlDeviceAttributes_t attr;
+    nvml_ret = nvmlDeviceGetAttributes_v2(device, &attr);
+    if(nvml_ret != NVML_SUCCESS){
+        std::cerr << "NvmlLibrary::GetDeviceAttributes: nvmlDeviceGetAttributes_v2 returns " << nvml_ret << " (" << nvmlErrorString(nvml_ret) << ")." << std::endl;
+        return 1;
+    }
+    attributes->multiprocessorCount = attr.multiprocessorCount;
+    attributes->gpuInstanceSliceCount = attr.gpuInstanceSliceCount;
+    attributes->computeInstanceSliceCount = attr.computeInstanceSliceCount;
+    attributes->memorySizeMB = attr.memorySizeMB;
+    return 0;
+}
+#endif
+
+NvmlStub::NvmlStub(string _path): path(_path) {}
+
+int NvmlStub::Init()
+{
+    init_count++;
+    ifstream f(path);
+    if(!f.good()){
+        std::cerr << "NvmlStub::Init: cannot open " << path << "." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int NvmlStub::Shutdown()
+{
+    shutdown_count++;
+    return 0;
+}
+
+int NvmlStub::GetDeviceAttributes(string uuid, NvmlDeviceAttributes* attributes)
+{
+    ifstream f(path);
+    string line;
+    while(getline(f, line))
+    {
+        stringstream ss(line);
+        string dev_uuid;
+        if(!(ss >> dev_uuid) || dev_uuid[0] == '#' || dev_uuid != uuid)
+            continue;
+        NvmlDeviceAttributes attr;
+        if(!(ss >> attr.multiprocessorCount >> attr.gpuInstanceSliceCount >> attr.computeInstanceSliceCount >> attr.memorySizeMB)){
+            std::cerr << "NvmlStub::GetDeviceAttributes: malformed line \"" << line << "\" in " << path << "." << std::endl;
+            return 1;
+        }
+        *attributes = attr;
+        return 0;
+    }
+    std::cerr << "NvmlStub::GetDeviceAttributes: device " << uuid << " not found in " << path << "." << std::endl;
+    return 1;
+}
+
+int NvmlStub::GetInitCount() { return init_count; }
+int NvmlStub::GetShutdownCount() { return shutdown_count; }
+
+//the NvmlInterface in use and its session, which is kept open between the MIG calls; the session of the NVML library is shut down at exit
+static struct nvml_session {
+    std::mutex lock;
+#ifndef NVML_STUB
+    NvmlLibrary library;
+    NvmlInterface* nvml = &library;
+#else
+    NvmlInterface* nvml = NULL;
+#endif
+    bool open = false;
+
+    void Close()
+    {
+        if(open && nvml != NULL)
+            nvml->Shutdown();
+        open = false;
+    }
+    //a user-supplied interface may already be destroyed during the static teardown, so it is never called from here
+    ~nvml_session()
+    {
+#ifndef NVML_STUB
+        if(nvml == &library)
+            Close();
+#endif
+    }
+} nvml_session;
+
+void SetNvmlInterface(NvmlInterface* nvml)
+{
+    std::lock_guard<std::mutex> guard(nvml_session.lock);
+    nvml_session.Close();
+#ifndef NVML_STUB
+    nvml_session.nvml = (nvml == NULL) ? &nvml_session.library : nvml;
+#else
+    nvml_session.nvml = nvml;
+#endif
+}
+
+NvmlInterface* GetNvmlInterface()
+{
+    std::lock_guard<std::mutex> guard(nvml_session.lock);
+    if(nvml_session.nvml == NULL)
+        return NULL;
+    if(!nvml_session.open){
+        if(nvml_session.nvml->Init() != 0)
+            return NULL;
+        nvml_session.open = true;
+    }
+    return nvml_session.nvml;
+}
+
+#endif
+#endif
@@ -0,0 +1,99 @@
+#ifndef NVML_INTERFACE
+#define NVML_INTERFACE
+
+#include "defines.hpp"
+#ifdef NVIDIA_MIG
+
+#include <string>
+
+/*! \file */
+
+using namespace std;
+
+/**
+Attributes of a (MIG) GPU device, subset of nvmlDeviceAttributes_t used by Chip::UpdateMIGSettings().
+*/
+struct NvmlDeviceAttributes {
+    unsigned int multiprocessorCount = 0; /**< number of SMs of the device */
+    unsigned int gpuInstanceSliceCount = 0; /**< number of GPU instance slices */
+    unsigned int computeInstanceSliceCount = 0; /**< number of compute instance slices */
+    unsigned long long memorySizeMB = 0; /**< device memory size in MB */
+};
+
+/**
+Class NvmlInterface - the NVML functionality used by the MIG support (Chip::UpdateMIGSettings()). All methods return 0 on success.
+\n The implementation in use is set by SetNvmlInterface(). By default, it is the NVML library (NvmlLibrary), unless sys-sage was built with -DNVML_STUB=ON.
+*/
+class NvmlInterface {
+public:
+    virtual ~NvmlInterface() = default;
+    /**
+    Opens an NVML session (nvmlInit_v2).
+    */
+    virtual int Init() = 0;
+    /**
+    Closes the NVML session (nvmlShutdown).
+    */
+    virtual int Shutdown() = 0;
+    /**
+    Retrieves the attributes of the (MIG) device with the given UUID (nvmlDeviceGetHandleByUUID + nvmlDeviceGetAttributes_v2).
+    @param uuid - UUID of the (MIG) device
+    @param attributes - filled in with the attributes of the device
+    */
+    virtual int GetDeviceAttributes(string uuid, NvmlDeviceAttributes* attributes) = 0;
+};
+
+#ifndef NVML_STUB
+/**
+Class NvmlLibrary - NvmlInterface implemented by the NVML library. Default NvmlInterface.
+*/
+class NvmlLibrary : public NvmlInterface {
+public:
+    int Init() override;
+    int Shutdown() override;
+    int GetDeviceAttributes(string uuid, NvmlDeviceAttributes* attributes) override;
+};
+#endif
+
+/**
+Class NvmlStub - NvmlInterface answered from a text file, for testing the MIG support without a GPU or the NVML library.
+\n Each line of the file describes one (MIG) device: "uuid multiprocessorCount gpuInstanceSliceCount computeInstanceSliceCount memorySizeMB". Empty lines and lines starting with '#' are ignored.
+\n The file is read on every GetDeviceAttributes() call, so that it can be modified between the calls.
+*/
+class NvmlStub : public NvmlInterface {
+public:
+    /**
+    @param _path - path to the file describing the devices
+    */
+    NvmlStub(string _path);
+    int Init() override;
+    int Shutdown() override;
+    int GetDeviceAttributes(string uuid, NvmlDeviceAttributes* attributes) override;
+    /**
+    @returns number of Init() calls so far
+    */
+    int GetInitCount();
+    /**
+    @returns number of Shutdown() calls so far
+    */
+    int GetShutdownCount();
+private:
+    string path;
+    int init_count = 0;
+    int shutdown_count = 0;
+};
+
+/**
+Sets the NvmlInterface used by the MIG support. The NVML session of the previous interface, if open, is shut down.
+\n The session is opened by the first MIG call (Chip::UpdateMIGSettings()) and kept open until the interface is replaced. The session of the default NVML library is also shut down at exit; that of an interface set here is not (it may already be destroyed then): call SetNvmlInterface(NULL) to shut it down before destroying the interface.
+@param nvml - the interface to use (not owned by sys-sage, must stay valid until replaced); NULL restores the default
+*/
+void SetNvmlInterface(NvmlInterface* nvml);
+/**
+Returns the NvmlInterface in use with an open NVML session, opening it if needed.
+@returns the interface, or NULL if no interface is set (build with -DNVML_STUB=ON and no SetNvmlInterface() call) or the session could not be opened
+*/
+NvmlInterface* GetNvmlInterface();
+
+#endif
+#endif
@@ -13,12 +13,100 @@
 #include <algorithm>
 #include <tuple>
 #include <chrono>
+#include <unordered_map>
+#include <mutex>
 
 #include "Component.hpp"
 
+//stores the refreshed frequency (MHz) of a core and, if requested, appends it to its freq_history
+static void storeCoreFreq(Core* c, double freq, bool keep_history)
+{
+    c->SetFreq(freq);
+    if(keep_history)
+    {
+        //check if freq_history exists; if not, create it -- bounded TimeSeries of <timestamp,frequency>
+        if (c->attrib.find("freq_history") == c->attrib.end()) {
+            c->attrib["freq_history"] = (void*) new TimeSeries();
+        }
+        long long ts = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        ((TimeSeries*)c->attrib["freq_history"])->Add(ts,freq);
+    }
+}
+
+//file descriptors of cpufreq sysfs files (one per HW thread), opened on first use and kept open between the refreshes
+static struct {
+    std::mutex lock;
+    string sysfsRoot = "/sys";
+    std::unordered_map<int,int> fds; //HW thread id -> fd (-1 if no cpufreq file could be opened)
+} cpufreq;
+
+//the lock has to be held
+static void closeCpufreqFds()
+{
+    for(auto const& [ cpu, fd ] : cpufreq.fds)
+        if(fd != -1)
+            close(fd);
+    cpufreq.fds.clear();
+}
+
+void SetCpufreqSysfsRoot(string sysfsRoot)
+{
+    std::lock_guard<std::mutex> guard(cpufreq.lock);
+    closeCpufreqFds();
+    cpufreq.sysfsRoot = sysfsRoot;
+}
+
+//retrieve frequency in MHz from cpufreq sysfs (scaling_cur_freq, or cpuinfo_cur_freq, in kHz) for each thread in vector<Thread*> threads
+//the files are opened once and then re-read with pread, so one refresh costs one syscall per thread
+//the <core, frequency> pairs are appended to freqs; the topology is not modified
+//helper function is called by ReadCpuCoreFrequency/RefreshFreq methods
+static int readCpufreqFreq(std::vector<Thread*> threads, vector<pair<Core*,double>>* freqs)
+{
+    std::lock_guard<std::mutex> guard(cpufreq.lock);
+    int threads_processed = 0;
+    char buf[32];
+    for(Thread* t : threads)
+    {
+        int cpu = t->GetId();
+        auto it = cpufreq.fds.find(cpu);
+        if(it == cpufreq.fds.end())
+        {
+            string dir = cpufreq.sysfsRoot + "/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/";
+            int fd = open((dir + "scaling_cur_freq").c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd == -1)
+                fd = open((dir + "cpuinfo_cur_freq").c_str(), O_RDONLY | O_CLOEXEC);
+            it = cpufreq.fds.insert({cpu, fd}).first;
+        }
+        if(it->second == -1)
+            continue;
+
+        ssize_t bytes_read = pread(it->second, buf, sizeof(buf) - 1, 0);
+        if(bytes_read <= 0)
+            continue;
+        buf[bytes_read] = '\0';
+        char* end;
+        long long khz = strtoll(buf, &end, 10);
+        if(end == buf)
+            continue;
+
+        Core* c = (Core*)t->GetAncestorByType(SYS_SAGE_COMPONENT_CORE);
+        if(c != NULL)
+        {
+            freqs->push_back({c, khz / 1000.0});
+            threads_processed++;
+        }
+    }
+    if(threads_processed == (int)threads.size())
+        return 0;
+    cout << "Not all cores updated their Frequency: " << threads_processed << " of total " << threads.size() << " processed." << endl;
+    return 1;
+}
+
+
 //retrieve frequency in MHz from /proc/cpuinfo for each thread in vector<Thread*> threads
-//helper function is called by RefreshCpuCoreFrequency/RefreshFreq methods
-int readCpuinfoFreq(std::vector<Thread*> threads, bool keep_history = false)
+//the <core, frequency> pairs are appended to freqs; the topology is not modified
+//helper function is called by ReadCpuCoreFrequency/RefreshFreq methods
+static int readCpuinfoFreq(std::vector<Thread*> threads, vector<pair<Core*,double>>* freqs)
 {
     int fd = open("/proc/cpuinfo", O_RDONLY);
     if(fd == -1)
@@ -40,9 +128,9 @@ int readCpuinfoFreq(std::vector<Thread*> threads, bool keep_history = false)
     }
 
     int num_threads = threads.size();
-    std::vector<int> threadIds(num_threads);
+    std::unordered_map<int,int> threadPos; //thread id -> position in threads
     for(int i = 0; i<num_threads; i++)
-        threadIds[i] = threads[i]->GetId();
+        threadPos[threads[i]->GetId()] = i;
 
     ptrdiff_t current_thread_pos = -1;
     int threads_processed = 0;
@@ -57,10 +145,8 @@ int readCpuinfoFreq(std::vector<Thread*> threads, bool keep_history = false)
             {
                 int current_thread = stoi(line.substr(pos + 1));
                 //cout << "------------Found thread " << current_thread << endl;
-                current_thread_pos = find(threadIds.begin(), threadIds.end(), current_thread) - threadIds.begin();
-                if((long unsigned int)current_thread_pos >= threadIds.size()) {
-                    current_thread_pos = -1;
-                }
+                auto it = threadPos.find(current_thread);
+                current_thread_pos = (it == threadPos.end()) ? -1 : it->second;
             }
         }
         else if (current_thread_pos != -1 && line.rfind("cpu MHz", 0) == 0)
@@ -72,16 +158,7 @@ int readCpuinfoFreq(std::vector<Thread*> threads, bool keep_history = false)
                 Core* c = (Core*)threads[current_thread_pos]->FindParentByType(SYS_SAGE_COMPONENT_CORE);
                 if(c != NULL)
                 {
-                    ((Core*)c)->SetFreq(freq);
-                    if(keep_history)
-                    {
-                        //check if freq_history exists; if not, create it -- vector of tuples <timestamp,frequency>
-                        if (c->attrib.find("freq_history") == c->attrib.end()) {
-                            c->attrib["freq_history"] = (void*) new std::vector<std::tuple<long long,double>>();
-                        }
-                        long long ts = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-                        ((std::vector<std::tuple<long long,double>>*)c->attrib["freq_history"])->push_back(std::make_tuple(ts,freq));
-                    }
+                    freqs->push_back({c, freq});
                     //cout << "----------------Core " << c->GetId() << " (HW thread " << threads[current_thread_pos]->GetId() << ") frequency: " << freq << endl;
                     threads_processed++;
                     if(threads_processed == num_threads)
@@ -99,7 +176,39 @@ int readCpuinfoFreq(std::vector<Thread*> threads, bool keep_history = false)
     return 1;
 }
 
-int Node::RefreshCpuCoreFrequency(bool keep_history)
+//dispatches to the reader of the selected frequency source
+static int readFreq(std::vector<Thread*> threads, vector<pair<Core*,double>>* freqs, int freq_source)
+{
+    if(freq_source == SYS_SAGE_FREQ_SOURCE_CPUFREQ)
+        return readCpufreqFreq(threads, freqs);
+    return readCpuinfoFreq(threads, freqs);
+}
+
+//reads and stores the frequencies of threads
+static int refreshFreq(std::vector<Thread*> threads, bool keep_history, int freq_source)
+{
+    vector<pair<Core*,double>> freqs;
+    int ret = readFreq(threads, &freqs, freq_source);
+    for(auto const& [ c, freq ] : freqs)
+        storeCoreFreq(c, freq, keep_history);
+    return ret;
+}
+
+int Node::RefreshCpuCoreFrequency(bool keep_history, int freq_source)
+{
+    vector<pair<Core*,double>> freqs;
+    int ret = ReadCpuCoreFrequency(&freqs, freq_source);
+    StoreCpuCoreFrequency(freqs, keep_history);
+    return ret;
+}
+
+void Node::StoreCpuCoreFrequency(vector<pair<Core*,double>> const& freqs, bool keep_history)
+{
+    for(auto const& [ c, freq ] : freqs)
+        storeCoreFreq(c, freq, keep_history);
+}
+
+int Node::ReadCpuCoreFrequency(vector<pair<Core*,double>>* freqs, int freq_source)
 {
     vector<Component*> sockets = this->GetAllChildrenByType(SYS_SAGE_COMPONENT_CHIP);
     vector<Thread*> cpu_hw_threads, hw_threads_to_refresh;
@@ -123,27 +232,27 @@ int Node::RefreshCpuCoreFrequency(bool keep_history)
     }
     //cout << endl;
 
-    return readCpuinfoFreq(hw_threads_to_refresh, keep_history);
+    return readFreq(hw_threads_to_refresh, freqs, freq_source);
 }
 
-int Core::RefreshFreq(bool keep_history)
+int Core::RefreshFreq(bool keep_history, int freq_source)
 {
     vector<Thread*> cpu_hw_threads;
     Thread* hw_thread = (Thread*)this->GetChildByType(SYS_SAGE_COMPONENT_THREAD);
     if(hw_thread != NULL)
         cpu_hw_threads.push_back(hw_thread);
-    return readCpuinfoFreq(cpu_hw_threads, keep_history);
+    return refreshFreq(cpu_hw_threads, keep_history, freq_source);
 }
 
-int Thread::RefreshFreq(bool keep_history)
+int Thread::RefreshFreq(bool keep_history, int freq_source)
 {
     vector<Thread*> cpu_hw_threads;
     cpu_hw_threads.push_back(this);
-    return readCpuinfoFreq(cpu_hw_threads, keep_history);
+    return refreshFreq(cpu_hw_threads, keep_history, freq_source);
 }
 
 double Core::GetFreq() {return freq;}
-void Core::SetFreq(double _freq) {freq = _freq;}
+void Core::SetFreq(double _freq) {freq = _freq; MarkDirty();}
 double Thread::GetFreq()
 {
     Core * c = (Core*)this->FindParentByType(SYS_SAGE_COMPONENT_CORE);
@@ -0,0 +1,413 @@
+#ifndef RESCTRL_CPP
+#define RESCTRL_CPP
+
+#include "defines.hpp"
+#ifdef RESCTRL
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <tuple>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+
+#include "Component.hpp"
+#include "parsers/sysfs.hpp"
+
+using namespace std;
+
+//paths used by UpdateResctrlSettings and UpdateResctrlMonitoring; L3 cache ids of the HW threads (read from sysfs) are cached between the refreshes
+static struct {
+    std::mutex lock;
+    string resctrlRoot = "/sys/fs/resctrl";
+    string sysfsRoot = "/sys";
+    std::unordered_map<int,int> l3_domain; //HW thread id -> L3 cache id (resctrl domain id), -1 if unknown
+    std::map<string,std::tuple<long long,uint64_t>> mbm_prev; //mbm counter file -> (timestamp, bytes) of the previous monitoring refresh
+} resctrl;
+
+//one resctrl control group (the root directory or one of its subdirectories)
+struct resctrl_group {
+    string name;
+    uint64_t index; //local index of the group (0 for the root group), exported as "CATcos"; resctrl does not expose the kernel's CLOSID
+    std::map<int,uint64_t> l3_masks; //domain -> L3 way mask
+    std::map<int,uint64_t> mba; //domain -> MBA throttling value (% of bandwidth, or MBps if mounted with -o mba_MBps)
+};
+
+void SetResctrlRoot(string resctrlRoot, string sysfsRoot)
+{
+    std::lock_guard<std::mutex> guard(resctrl.lock);
+    resctrl.resctrlRoot = resctrlRoot;
+    resctrl.sysfsRoot = sysfsRoot;
+    resctrl.l3_domain.clear();
+    resctrl.mbm_prev.clear();
+}
+
+//parses the schemata file of a group, e.g. "L3:0=7ff;1=7ff" and "MB:0=100;1=100"; with CDP enabled, L3DATA is used as the L3 mask
+//returns false if the file cannot be read
+static bool resctrlParseSchemata(string path, resctrl_group* g)
+{
+    ifstream f(path);
+    if(!f.good())
+        return false;
+    string line;
+    std::map<int,uint64_t> l3_data;
+    while(getline(f, line))
+    {
+        line.erase(0, line.find_first_not_of(" \t"));
+        size_t colon = line.find(':');
+        if(colon == string::npos)
+            continue;
+        string resource = line.substr(0, colon);
+        std::map<int,uint64_t>* out;
+        int base;
+        if(resource == "L3") { out = &g->l3_masks; base = 16; }
+        else if(resource == "L3DATA") { out = &l3_data; base = 16; }
+        else if(resource == "MB") { out = &g->mba; base = 10; }
+        else continue;
+
+        stringstream ss(line.substr(colon + 1));
+        string domain;
+        while(getline(ss, domain, ';'))
+        {
+            size_t eq = domain.find('=');
+            if(eq == string::npos)
+                continue;
+            try{
+                (*out)[stoi(domain.substr(0, eq))] = stoull(domain.substr(eq + 1), NULL, base);
+            } catch(std::exception const&) {}
+        }
+    }
+    if(g->l3_masks.empty())
+        g->l3_masks = l3_data;
+    return true;
+}
+
+//L3 cache id of a HW thread from sysfs; the lock has to be held
+static int resctrlL3Domain(Thread* t)
+{
+    int cpu = t->GetId();
+    auto it = resctrl.l3_domain.find(cpu);
+    if(it != resctrl.l3_domain.end())
+        return it->second;
+
+    int domain = -1;
+    string cacheDir = resctrl.sysfsRoot + "/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/";
+    for(int index = 0; domain == -1; index++)
+    {
+        ifstream level(cacheDir + "index" + std::to_string(index) + "/level");
+        if(!level.good())
+            break;
+        int l = 0;
+        level >> l;
+        if(l != 3)
+            continue;
+        ifstream id(cacheDir + "index" + std::to_string(index) + "/id");
+        if(id.good())
+            id >> domain;
+    }
+    if(domain == -1) //no cache id in sysfs: L3 domains usually correspond to the sockets
+    {
+        Component* chip = t->GetAncestorByType(SYS_SAGE_COMPONENT_CHIP);
+        if(chip != NULL)
+            domain = chip->GetId();
+    }
+    resctrl.l3_domain[cpu] = domain;
+    return domain;
+}
+
+//stores a uint64_t attribute of a DataPath, reusing the existing value
+static void resctrlSetAttrib(DataPath* dp, string key, uint64_t value)
+{
+    auto it = dp->attrib.find(key);
+    if(it == dp->attrib.end())
+        dp->attrib[key] = (void*) new uint64_t(value);
+    else
+        *(uint64_t*)it->second = value;
+    dp->GetSource()->MarkDirty(true);
+}
+
+//directory of a control group
+static string resctrlGroupDir(resctrl_group& g)
+{
+    return g.name.empty() ? resctrl.resctrlRoot : resctrl.resctrlRoot + "/" + g.name;
+}
+
+//reads all control groups once: the root directory (index 0) and its subdirectories, except info, mon_groups and mon_data (indices 1.. in the alphabetical order)
+//cpu_group maps HW thread -> index in groups; HW threads not listed by any group belong to the root group (index 0)
+//returns false if the root group cannot be read; the lock has to be held
+static bool resctrlReadGroups(vector<resctrl_group>* groups, std::unordered_map<int,size_t>* cpu_group)
+{
+    groups->assign(1, resctrl_group());
+    (*groups)[0].name = "";
+    (*groups)[0].index = 0;
+    if(!resctrlParseSchemata(resctrl.resctrlRoot + "/schemata", &(*groups)[0]))
+        return false;
+    vector<string> names;
+    std::error_code ec;
+    for(auto const& entry : filesystem::directory_iterator(resctrl.resctrlRoot, ec))
+    {
+        string name = entry.path().filename().string();
+        if(entry.is_directory() && name != "info" && name != "mon_groups" && name != "mon_data")
+            names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    for(string& name : names)
+    {
+        resctrl_group g;
+        g.name = name;
+        g.index = groups->size();
+        if(resctrlParseSchemata(resctrl.resctrlRoot + "/" + name + "/schemata", &g))
+            groups->push_back(g);
+    }
+
+    for(size_t i = 0; i < groups->size(); i++)
+    {
+        string cpus;
+        ifstream f(resctrlGroupDir((*groups)[i]) + "/cpus_list");
+        getline(f, cpus);
+        for(int cpu : parseCpulist(cpus))
+            (*cpu_group)[cpu] = i;
+    }
+    return true;
+}
+
+//L3 cache above a HW thread, NULL if there is none
+static Cache* resctrlGetL3(Thread* t)
+{
+    for(Component* p = t->GetParent(); p != NULL; p = p->GetParent())
+        if(p->GetComponentType() == SYS_SAGE_COMPONENT_CACHE && ((Cache*)p)->GetCacheLevel() == 3)
+            return (Cache*)p;
+    return NULL;
+}
+
+//L3CAT DataPath between a HW thread and its L3, NULL if there is none
+static DataPath* resctrlGetL3CATDataPath(Thread* t, Cache* l3)
+{
+    for(DataPath* d : *t->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+        if(d->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_L3CAT && d->GetTarget() == l3)
+            return d;
+    return NULL;
+}
+
+int Node::UpdateResctrlSettings()
+{
+    std::lock_guard<std::mutex> guard(resctrl.lock);
+
+    vector<resctrl_group> groups;
+    std::unordered_map<int,size_t> cpu_group;
+    if(!resctrlReadGroups(&groups, &cpu_group)){
+        std::cerr << "Node::UpdateResctrlSettings: cannot read " << resctrl.resctrlRoot << "/schemata (is resctrl mounted?)" << std::endl;
+        return 1;
+    }
+
+    vector<Component*> threads;
+    GetAllSubcomponentsByType(&threads, SYS_SAGE_COMPONENT_THREAD);
+    int threads_processed = 0;
+    for(Component* c : threads)
+    {
+        Thread* t = (Thread*)c;
+        auto it = cpu_group.find(t->GetId());
+        resctrl_group* g = &groups[it == cpu_group.end() ? 0 : it->second];
+
+        Cache* l3 = resctrlGetL3(t);
+        if(l3 == NULL)
+            continue;
+        int domain = resctrlL3Domain(t);
+        auto mask = g->l3_masks.find(domain);
+        if(mask == g->l3_masks.end())
+            continue;
+
+        //update the DataPath of a previous refresh in place, or create it
+        DataPath* dp = resctrlGetL3CATDataPath(t, l3);
+        if(dp == NULL)
+            dp = new DataPath(t, l3, SYS_SAGE_DATAPATH_BIDIRECTIONAL, SYS_SAGE_DATAPATH_TYPE_L3CAT);
+
+        resctrlSetAttrib(dp, "CATcos", g->index);
+        resctrlSetAttrib(dp, "CATL3mask", mask->second);
+        auto mba = g->mba.find(domain);
+        if(mba != g->mba.end())
+            resctrlSetAttrib(dp, "MBAthrottle", mba->second);
+        auto group_name = dp->attrib.find("resctrl_group");
+        if(group_name == dp->attrib.end())
+            dp->attrib["resctrl_group"] = (void*) new string(g->name);
+        else
+            *(string*)group_name->second = g->name;
+        dp->GetSource()->MarkDirty(true);
+        threads_processed++;
+    }
+
+    if(threads_processed != (int)threads.size()){
+        std::cerr << "Node::UpdateResctrlSettings: " << threads_processed << " of " << threads.size() << " HW threads updated (missing L3 cache or resctrl domain)." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+//monitoring values of one control group in one L3 domain; bandwidths are only known from the second refresh on
+struct resctrl_mon {
+    double llc_occupancy = 0;
+    double mbm_total_bw = 0;
+    double mbm_local_bw = 0;
+    bool has_llc_occupancy = false;
+    bool has_mbm_total_bw = false;
+    bool has_mbm_local_bw = false;
+
+    void Add(resctrl_mon const& o)
+    {
+        llc_occupancy += o.llc_occupancy; has_llc_occupancy |= o.has_llc_occupancy;
+        mbm_total_bw += o.mbm_total_bw; has_mbm_total_bw |= o.has_mbm_total_bw;
+        mbm_local_bw += o.mbm_local_bw; has_mbm_local_bw |= o.has_mbm_local_bw;
+    }
+};
+
+//reads one counter file; false if it does not exist or reads "Unavailable"/"Error"
+static bool resctrlReadCounter(string path, uint64_t* value)
+{
+    ifstream f(path);
+    string s;
+    if(!getline(f, s) || s.empty() || !isdigit(s[0]))
+        return false;
+    *value = stoull(s);
+    return true;
+}
+
+//converts a byte counter to a rate (B/s) using the value of the previous refresh; false on the first refresh or if the counter was reset; the lock has to be held
+static bool resctrlCounterRate(string path, uint64_t bytes, long long ts, double* rate)
+{
+    auto it = resctrl.mbm_prev.find(path);
+    bool ok = false;
+    if(it != resctrl.mbm_prev.end())
+    {
+        auto [ prev_ts, prev_bytes ] = it->second;
+        if(ts > prev_ts && bytes >= prev_bytes){
+            *rate = (bytes - prev_bytes) / ((ts - prev_ts) / 1e9);
+            ok = true;
+        }
+    }
+    resctrl.mbm_prev[path] = std::make_tuple(ts, bytes);
+    return ok;
+}
+
+//appends a sample to the TimeSeries attribute key, creating it if needed
+static void resctrlAddSample(map<string,void*>* attrib, string key, long long ts, double value)
+{
+    auto it = attrib->find(key);
+    if(it == attrib->end())
+        it = attrib->insert({key, (void*) new TimeSeries()}).first;
+    ((TimeSeries*)it->second)->Add(ts, value);
+}
+
+static void resctrlAddSamples(map<string,void*>* attrib, resctrl_mon const& m, long long ts)
+{
+    if(m.has_llc_occupancy)
+        resctrlAddSample(attrib, "llc_occupancy", ts, m.llc_occupancy);
+    if(m.has_mbm_total_bw)
+        resctrlAddSample(attrib, "mbm_total_bw", ts, m.mbm_total_bw);
+    if(m.has_mbm_local_bw)
+        resctrlAddSample(attrib, "mbm_local_bw", ts, m.mbm_local_bw);
+}
+
+int Node::UpdateResctrlMonitoring()
+{
+    std::lock_guard<std::mutex> guard(resctrl.lock);
+
+    vector<resctrl_group> groups;
+    std::unordered_map<int,size_t> cpu_group;
+    if(!resctrlReadGroups(&groups, &cpu_group)){
+        std::cerr << "Node::UpdateResctrlMonitoring: cannot read " << resctrl.resctrlRoot << "/schemata (is resctrl mounted?)" << std::endl;
+        return 1;
+    }
+
+    //group index -> domain -> values
+    long long ts = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    vector<std::map<int,resctrl_mon>> mon(groups.size());
+    for(size_t i = 0; i < groups.size(); i++)
+    {
+        std::error_code ec;
+        for(auto const& entry : filesystem::directory_iterator(resctrlGroupDir(groups[i]) + "/mon_data", ec))
+        {
+            string name = entry.path().filename().string();
+            if(name.compare(0, 7, "mon_L3_") != 0 || name.size() == 7 || !isdigit(name[7]))
+                continue;
+            resctrl_mon& m = mon[i][stoi(name.substr(7))];
+            string dir = entry.path().string() + "/";
+            uint64_t value;
+            if(resctrlReadCounter(dir + "llc_occupancy", &value)){
+                m.llc_occupancy = value;
+                m.has_llc_occupancy = true;
+            }
+            if(resctrlReadCounter(dir + "mbm_total_bytes", &value))
+                m.has_mbm_total_bw = resctrlCounterRate(dir + "mbm_total_bytes", value, ts, &m.mbm_total_bw);
+            if(resctrlReadCounter(dir + "mbm_local_bytes", &value))
+                m.has_mbm_local_bw = resctrlCounterRate(dir + "mbm_local_bytes", value, ts, &m.mbm_local_bw);
+        }
+    }
+    if(mon[0].empty()){
+        std::cerr << "Node::UpdateResctrlMonitoring: no L3 monitoring data in " << resctrl.resctrlRoot << "/mon_data" << std::endl;
+        return 1;
+    }
+
+    //domain -> sum over all control groups
+    std::map<int,resctrl_mon> domain_total;
+    for(auto& group_mon : mon)
+        for(auto const& [ domain, m ] : group_mon)
+            domain_total[domain].Add(m);
+
+    //per HW thread: the L3CAT DataPath gets the values of its group; the L3 cache and the NUMA nodes get the sum of their domains
+    vector<Component*> threads;
+    GetAllSubcomponentsByType(&threads, SYS_SAGE_COMPONENT_THREAD);
+    std::map<Component*,std::set<int>> component_domains;
+    for(Component* c : threads)
+    {
+        Thread* t = (Thread*)c;
+        int domain = resctrlL3Domain(t);
+        Cache* l3 = resctrlGetL3(t);
+        if(l3 != NULL){
+            component_domains[l3].insert(domain);
+            DataPath* dp = resctrlGetL3CATDataPath(t, l3);
+            auto it = cpu_group.find(t->GetId());
+            std::map<int,resctrl_mon>& group_mon = mon[it == cpu_group.end() ? 0 : it->second];
+            auto m = group_mon.find(domain);
+            if(dp != NULL && m != group_mon.end())
+                resctrlAddSamples(&dp->attrib, m->second, ts);
+        }
+        Component* numa = t->GetAncestorByType(SYS_SAGE_COMPONENT_NUMA);
+        if(numa != NULL)
+            component_domains[numa].insert(domain);
+    }
+    //NUMA nodes below the L3 cache (no HW threads in their subtree) share the domains of the L3 cache
+    vector<Component*> numas;
+    GetAllSubcomponentsByType(&numas, SYS_SAGE_COMPONENT_NUMA);
+    for(Component* numa : numas)
+    {
+        if(component_domains.count(numa))
+            continue;
+        for(Component* p = numa->GetParent(); p != NULL; p = p->GetParent())
+            if(component_domains.count(p) && p->GetComponentType() == SYS_SAGE_COMPONENT_CACHE){
+                component_domains[numa] = component_domains[p];
+                break;
+            }
+    }
+
+    for(auto const& [ c, domains ] : component_domains)
+    {
+        resctrl_mon sum;
+        for(int domain : domains){
+            auto it = domain_total.find(domain);
+            if(it != domain_total.end())
+                sum.Add(it->second);
+        }
+        if(c->GetComponentType() == SYS_SAGE_COMPONENT_NUMA)
+            sum.has_llc_occupancy = false;
+        resctrlAddSamples(&c->attrib, sum, ts);
+    }
+    return 0;
+}
+
+#endif //RESCTRL
+#endif //RESCTRL_CPP
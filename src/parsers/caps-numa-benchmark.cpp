@@ -4,6 +4,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <tuple>
 
 using namespace std;
 
@@ -15,6 +16,13 @@ int parseCapsNumaBenchmark(Component* rootComponent, string benchmarkPath, strin
         cerr << "error: could not parse CapsNumaBenchmark file " << benchmarkPath.c_str() << endl;
         return 1;
     }
+    return parseCapsNumaBenchmarkData(rootComponent, benchmarkData);
+}
+
+int parseCapsNumaBenchmarkData(Component* rootComponent, const vector<vector<string> >& benchmarkData)
+{
+    if(benchmarkData.empty())
+        return 1;
 
     //get indexes of relevant columns
     int cpu_is_source=-1;//-1 initial, 0 numa is source, 1 cpu is source
@@ -24,6 +32,8 @@ int parseCapsNumaBenchmark(Component* rootComponent, string benchmarkPath, strin
     int target_numa_idx=-1;
     int ldlat_idx=-1;
     int bw_idx=-1;
+    //columns of the bandwidth sweep: bw_<kernel>_<threads>t(MB/s) -> (index, kernel, threads)
+    vector<std::tuple<int,string,int>> sweep_cols;
     for(unsigned int i=0; i<header.size(); i++)
     {
         if(header[i] == "src_cpu")
@@ -36,6 +46,16 @@ int parseCapsNumaBenchmark(Component* rootComponent, string benchmarkPath, strin
             ldlat_idx=i;
         else if(header[i] == "bw(MB/s)")
             bw_idx=i;
+        else if(header[i].rfind("bw_", 0) == 0 && header[i].size() > 10 && header[i].compare(header[i].size()-7, 7, "t(MB/s)") == 0)
+        {
+            string col = header[i].substr(3, header[i].size()-10); //<kernel>_<threads>
+            size_t sep = col.rfind('_');
+            if(sep == string::npos || sep == 0)
+                continue;
+            try{
+                sweep_cols.push_back(std::make_tuple(i, col.substr(0, sep), stoi(col.substr(sep+1))));
+            } catch(std::exception const&) {}
+        }
     }
     if(src_cpu_idx > -1)
         cpu_is_source += 2;
@@ -70,7 +90,16 @@ int parseCapsNumaBenchmark(Component* rootComponent, string benchmarkPath, strin
             bw = stoul(benchmarkData[i][bw_idx]);
             ldlat = stoul(benchmarkData[i][ldlat_idx]);
 
-            new DataPath(src, target, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_DATATRANSFER, (double)bw, (double)ldlat);
+            DataPath* dp = new DataPath(src, target, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_DATATRANSFER, (double)bw, (double)ldlat);
+
+            if(!sweep_cols.empty())
+            {
+                auto bw_sweep = new std::vector<std::tuple<string,int,double>>();
+                for(auto const& [idx, kernel, threads] : sweep_cols)
+                    if(idx < (int)benchmarkData[i].size())
+                        bw_sweep->push_back(std::make_tuple(kernel, threads, stod(benchmarkData[i][idx])));
+                dp->attrib["bw_sweep"] = (void*)bw_sweep;
+            }
 
         }
     }
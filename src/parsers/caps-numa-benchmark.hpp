@@ -4,7 +4,20 @@
 #include "Component.hpp"
 #include "DataPath.hpp"
 
+/**
+Parser of the output of caps-numa-benchmark. Creates a DataPath of type SYS_SAGE_DATAPATH_TYPE_DATATRANSFER from each source (Numa or Thread, depending on the column src_numa or src_cpu) to each target Numa, with the single-threaded bandwidth (column bw(MB/s)) and latency (column ldlat(ns)).
+\n If the CSV contains the columns of the bandwidth sweep (bw_<kernel>_<threads>t(MB/s), e.g. bw_read_4t(MB/s)), the bandwidth-vs-threads curve is stored in the DataPath as the attribute "bw_sweep" (std::vector<std::tuple<std::string,int,double>>*, one (kernel, number of threads, bandwidth in MB/s) entry per column).
+@param rootComponent - root of the subtree where the source and target components are searched.
+@param benchmarkPath - path to the CSV output of caps-numa-benchmark.
+@param delim (default ";") - delimiter in the CSV
+@return 0 on success, 1 on error.
+*/
 int parseCapsNumaBenchmark(Component* rootComponent, string benchmarkPath, string delim = ";");
+/**
+@private
+Creates the DataPaths of parseCapsNumaBenchmark() from an already read CSV (one vector of columns per line, the header first), e.g. read by CSVReader in parallel with other data sources.
+*/
+int parseCapsNumaBenchmarkData(Component* rootComponent, const vector<vector<string> >& benchmarkData);
 
 class CSVReader
 {
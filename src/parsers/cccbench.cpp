@@ -84,8 +84,10 @@ CccbenchParser::CccbenchParser(const char *csv_path)
     }
 }
 
-void CccbenchParser::applyDataPaths(Component *root)
+int CccbenchParser::applyDataPaths(Component *root)
 {
+    int ret = 0;
+    unsigned int dimension = 1 + this->lastCore - this->firstCore;
     auto corev = new vector<Component *>();
     root->GetAllSubcomponentsByType(corev, SYS_SAGE_COMPONENT_CORE);
     //auto corev = root->GetAllChildrenByType(SYS_SAGE_COMPONENT_CORE);
@@ -100,6 +102,12 @@ void CccbenchParser::applyDataPaths(Component *root)
             {
                 continue;
             }
+            //no measurements of this pair of cores
+            if(xci < 0 || yci < 0 || (unsigned int)xci >= dimension || (unsigned int)yci >= dimension || (*this->c2cDatapoints)[xci][yci].empty())
+            {
+                ret = 1;
+                continue;
+            }
             auto xtoylatv = (*this->c2cDatapoints)[xci][yci];
             auto sum = accumulate(xtoylatv.begin(), xtoylatv.end(), 0.0);
             auto mean = new float(sum / xtoylatv.size());
@@ -112,15 +120,17 @@ void CccbenchParser::applyDataPaths(Component *root)
             dtp->attrib.insert(std::pair<string, void *>("latency", (void *)mean));
         }
     }
+    delete corev;
+    return ret;
 }
 
 int parseCccbenchOutput(Node* n, std::string cccPath)
 {
     const char *cstr_path = cccPath.c_str();
     auto cccparser = new CccbenchParser(cstr_path);
-    cccparser->applyDataPaths(n);
+    int ret = cccparser->applyDataPaths(n);
     delete cccparser;
-    return 0;
+    return ret;
 }
 
 
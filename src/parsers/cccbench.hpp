@@ -44,7 +44,11 @@ public:
     unsigned int xtoi(unsigned int _x){return _x - this->firstCore;}
     unsigned int ytoi(unsigned int _y){return _y - this->firstCore;}
     CccbenchParser(const char *csv_path);
-    void applyDataPaths(Component *root);
+    /**
+    Adds a DataPath of type SYS_SAGE_DATAPATH_TYPE_C2C between each pair of Cores under root.
+    @return 0 on success, 1 if some pairs of Cores have no measurements (no DataPath is added for them)
+    */
+    int applyDataPaths(Component *root);
 };
 
 #endif
@@ -0,0 +1,282 @@
+#include "config-file.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cerrno>
+
+ConfigFile::ConfigFile() {}
+
+//removes leading and trailing whitespace
+static string configTrim(const string& s)
+{
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if(first == string::npos)
+        return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+int ConfigFile::Load(string path)
+{
+    ifstream f(path);
+    if(!f.good()){
+        std::cerr << "ConfigFile::Load: couldn't open " << path << std::endl;
+        return 1;
+    }
+    stringstream buf;
+    buf << f.rdbuf();
+    return LoadString(buf.str());
+}
+
+int ConfigFile::LoadString(const string& text)
+{
+    section_names.clear();
+    sections.clear();
+
+    map<string,string>* current = NULL;
+    size_t pos = 0;
+    while(pos < text.size())
+    {
+        size_t end = text.find('\n', pos);
+        if(end == string::npos)
+            end = text.size();
+        string line = configTrim(text.substr(pos, end - pos));
+        pos = end + 1;
+
+        if(line.empty() || line[0] == '#' || line[0] == ';')
+            continue;
+        if(line[0] == '['){
+            size_t close = line.find(']');
+            string name = configTrim(line.substr(1, close == string::npos ? string::npos : close - 1));
+            auto [ it, inserted ] = sections.try_emplace(name);
+            if(inserted)
+                section_names.push_back(name);
+            current = &it->second;
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        if(eq == string::npos)
+            continue;
+        string key = configTrim(line.substr(0, eq));
+        string value = line.substr(eq + 1);
+        //comment after the value
+        for(size_t i = 0; i < value.size(); i++){
+            if((value[i] == '#' || value[i] == ';') && (i == 0 || isspace((unsigned char)value[i-1]))){
+                value.resize(i);
+                break;
+            }
+        }
+        if(current == NULL){
+            auto [ it, inserted ] = sections.try_emplace("");
+            if(inserted)
+                section_names.push_back("");
+            current = &it->second;
+        }
+        (*current)[key] = configTrim(value);
+    }
+    return 0;
+}
+
+vector<string> ConfigFile::GetSectionNames() { return section_names; }
+
+bool ConfigFile::HasSection(string section) { return sections.count(section) > 0; }
+
+bool ConfigFile::HasKey(string section, string key)
+{
+    auto it = sections.find(section);
+    return it != sections.end() && it->second.count(key) > 0;
+}
+
+const map<string,string>* ConfigFile::GetSection(string section)
+{
+    auto it = sections.find(section);
+    return it == sections.end() ? NULL : &it->second;
+}
+
+string ConfigFile::Get(string section, string key, string def)
+{
+    auto it = sections.find(section);
+    if(it == sections.end())
+        return def;
+    auto kv = it->second.find(key);
+    return kv == it->second.end() ? def : kv->second;
+}
+
+//parses the whole string as a (decimal) number
+static bool configParseLongLong(const string& s, long long* v)
+{
+    char* end;
+    errno = 0;
+    long long r = strtoll(s.c_str(), &end, 10);
+    if(s.empty() || errno != 0 || *end != '\0')
+        return false;
+    *v = r;
+    return true;
+}
+static bool configParseDouble(const string& s, double* v)
+{
+    char* end;
+    double r = strtod(s.c_str(), &end);
+    if(s.empty() || *end != '\0')
+        return false;
+    *v = r;
+    return true;
+}
+
+long long ConfigFile::GetInt(string section, string key, long long def)
+{
+    long long v;
+    return configParseLongLong(Get(section, key), &v) ? v : def;
+}
+
+double ConfigFile::GetDouble(string section, string key, double def)
+{
+    double v;
+    return configParseDouble(Get(section, key), &v) ? v : def;
+}
+
+long long ConfigFile::GetSize(string section, string key, long long def)
+{
+    long long v;
+    return ParseSize(Get(section, key), &v) == 0 ? v : def;
+}
+
+int ConfigFile::ParseSize(string value, long long* size)
+{
+    value = configTrim(value);
+    char* end;
+    errno = 0;
+    long long number = strtoll(value.c_str(), &end, 10);
+    if(end == value.c_str() || errno != 0)
+        return 1;
+    string unit = configTrim(end);
+    std::transform(unit.begin(), unit.end(), unit.begin(), [](unsigned char c){ return std::tolower(c); });
+
+    long long multiplier;
+    if(unit.empty() || unit == "b")
+        multiplier = 1;
+    else if(unit == "kib") multiplier = 1024ll;
+    else if(unit == "mib") multiplier = 1024ll*1024;
+    else if(unit == "gib") multiplier = 1024ll*1024*1024;
+    else if(unit == "tib") multiplier = 1024ll*1024*1024*1024;
+    else if(unit == "kb") multiplier = 1000ll;
+    else if(unit == "mb") multiplier = 1000ll*1000;
+    else if(unit == "gb") multiplier = 1000ll*1000*1000;
+    else if(unit == "tb") multiplier = 1000ll*1000*1000*1000;
+    else
+        return 1;
+    *size = number * multiplier;
+    return 0;
+}
+
+Component* ConfigFile::CreateComponent(const ConfigMapping& m, Component* parent, int id)
+{
+    const map<string,string>* section = GetSection(m.section);
+    if(section == NULL){
+        std::cerr << "ConfigFile::CreateComponent: section [" << m.section << "] not found." << std::endl;
+        return NULL;
+    }
+
+    //collect all values first, so that nothing is created on error
+    map<string,string> props;
+    for(auto const& [ property, key ] : m.properties){
+        auto kv = section->find(key);
+        if(kv == section->end()){
+            std::cerr << "ConfigFile::CreateComponent: key " << key << " (" << property << ") not found in section [" << m.section << "]." << std::endl;
+            return NULL;
+        }
+        props[property] = kv->second;
+    }
+    map<string,long long> numbers;
+    for(auto const& [ property, value ] : props){
+        if(property == "name" || property == "cache_name" || property == "vendor" || property == "model")
+            continue;
+        long long v;
+        bool ok = (property == "size" || property == "cache_size") ? ParseSize(value, &v) == 0 : configParseLongLong(value, &v);
+        if(!ok){
+            std::cerr << "ConfigFile::CreateComponent: invalid value \"" << value << "\" of " << property << " in section [" << m.section << "]." << std::endl;
+            return NULL;
+        }
+        numbers[property] = v;
+    }
+    for(auto const& [ name, key, type ] : m.attribs){
+        auto kv = section->find(key);
+        long long ll;
+        double d;
+        bool ok = kv != section->end() && (type == SYS_SAGE_CONFIG_STRING ||
+            (type == SYS_SAGE_CONFIG_INT && configParseLongLong(kv->second, &ll)) ||
+            (type == SYS_SAGE_CONFIG_LONGLONG && ParseSize(kv->second, &ll) == 0) ||
+            (type == SYS_SAGE_CONFIG_DOUBLE && configParseDouble(kv->second, &d)));
+        if(!ok){
+            std::cerr << "ConfigFile::CreateComponent: key " << key << " (attribute " << name << ") missing or invalid in section [" << m.section << "]." << std::endl;
+            return NULL;
+        }
+    }
+
+    if(numbers.count("id"))
+        id = (int)numbers["id"];
+    auto num = [&](string p, long long def){ return numbers.count(p) ? numbers[p] : def; };
+    Component* c;
+    switch(m.componentType)
+    {
+        case SYS_SAGE_COMPONENT_THREAD:
+            c = new Thread(parent, id);
+            break;
+        case SYS_SAGE_COMPONENT_CORE:
+            c = new Core(parent, id);
+            break;
+        case SYS_SAGE_COMPONENT_CACHE:
+            if(props.count("cache_name"))
+                c = new Cache(parent, id, props["cache_name"], num("cache_size", -1), (int)num("cache_associativity_ways", -1), (int)num("cache_line_size", -1));
+            else
+                c = new Cache(parent, id, (int)num("cache_level", 0), num("cache_size", -1), (int)num("cache_associativity_ways", -1), (int)num("cache_line_size", -1));
+            break;
+        case SYS_SAGE_COMPONENT_SUBDIVISION:
+            c = new Subdivision(parent, id);
+            if(numbers.count("subdivision_type"))
+                ((Subdivision*)c)->SetSubdivisionType((int)numbers["subdivision_type"]);
+            break;
+        case SYS_SAGE_COMPONENT_NUMA:
+            c = new Numa(parent, id, num("size", -1));
+            break;
+        case SYS_SAGE_COMPONENT_CHIP:
+            c = new Chip(parent, id);
+            if(props.count("vendor"))
+                ((Chip*)c)->SetVendor(props["vendor"]);
+            if(props.count("model"))
+                ((Chip*)c)->SetModel(props["model"]);
+            break;
+        case SYS_SAGE_COMPONENT_MEMORY:
+            c = new Memory(parent, id, "Memory", num("size", -1));
+            break;
+        case SYS_SAGE_COMPONENT_STORAGE:
+            c = new Storage(parent, num("size", -1));
+            break;
+        case SYS_SAGE_COMPONENT_NODE:
+            c = new Node(parent, id);
+            break;
+        default:
+            c = new Component(parent, id);
+            break;
+    }
+    if(props.count("name"))
+        c->SetName(props["name"]);
+    for(auto const& [ name, key, type ] : m.attribs){
+        const string& value = section->at(key);
+        long long ll = 0;
+        double d = 0;
+        if(type == SYS_SAGE_CONFIG_STRING)
+            c->attrib[name] = (void*)new string(value);
+        else if(type == SYS_SAGE_CONFIG_INT && configParseLongLong(value, &ll))
+            c->attrib[name] = (void*)new int((int)ll);
+        else if(type == SYS_SAGE_CONFIG_LONGLONG && ParseSize(value, &ll) == 0)
+            c->attrib[name] = (void*)new long long(ll);
+        else if(configParseDouble(value, &d))
+            c->attrib[name] = (void*)new double(d);
+    }
+    return c;
+}
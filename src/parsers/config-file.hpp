@@ -0,0 +1,111 @@
+#ifndef CONFIG_FILE
+#define CONFIG_FILE
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <tuple>
+
+#include "Component.hpp"
+
+/*! \file */
+
+#define SYS_SAGE_CONFIG_STRING 1 /**< Config value stored as std::string* attribute. */
+#define SYS_SAGE_CONFIG_INT 2 /**< Config value stored as int* attribute. */
+#define SYS_SAGE_CONFIG_LONGLONG 4 /**< Config value stored as long long* attribute; a size unit is allowed (see ConfigFile::ParseSize()). */
+#define SYS_SAGE_CONFIG_DOUBLE 8 /**< Config value stored as double* attribute. */
+
+/**
+Declarative mapping of one section of a config file to one Component, used by ConfigFile::CreateComponent().
+\n Example (a cache described by [DL1Cache] level=1, size=32768, line-size=64, assoc=8, latency=4):
+\n ConfigMapping l1{"DL1Cache", SYS_SAGE_COMPONENT_CACHE, {{"cache_level","level"}, {"cache_size","size"}, {"cache_line_size","line-size"}, {"cache_associativity_ways","assoc"}}, {{"latency","latency",SYS_SAGE_CONFIG_DOUBLE}}};
+*/
+struct ConfigMapping {
+    string section; /**< name of the section (without the brackets) */
+    int componentType; /**< type of the created Component (SYS_SAGE_COMPONENT_*) */
+    /**
+    Component property -> key in the section. The properties are named as in the XML export: "id" and "name" (all types), "size" (Memory, Storage, Numa), "cache_level" (or "cache_name"), "cache_size", "cache_associativity_ways", "cache_line_size" (Cache), "vendor", "model" (Chip), "subdivision_type" (Subdivision).
+    \n Sizes may carry a unit (see ConfigFile::ParseSize()).
+    */
+    map<string,string> properties;
+    vector<tuple<string,string,int>> attribs; /**< (attribute name, key in the section, SYS_SAGE_CONFIG_* value type) of the attributes stored in Component::attrib */
+};
+
+/**
+Class ConfigFile - section/key-value config files (INI style), e.g. the configs of simulators like MUSA or gem5 (config.ini).
+\n The file is read and indexed in one pass: "[section]" starts a section, "key = value" (or "key=value") adds a key to the current section (keys before the first section belong to the section ""). Comments start with '#' or ';' at the beginning of a line, or after whitespace in a value. A key appearing twice keeps the last value.
+\n Lookups are then O(1) in the number of lines, so that one file can be mapped to many components (see CreateComponent()) without re-reading it.
+*/
+class ConfigFile {
+public:
+    ConfigFile();
+    /**
+    Reads and indexes a config file. Previously loaded contents are discarded.
+    @param path - path to the config file
+    @return 0 on success, 1 if the file could not be read
+    */
+    int Load(string path);
+    /**
+    Indexes config text (same format as Load()). Previously loaded contents are discarded.
+    @param text - contents of a config file
+    @return 0
+    */
+    int LoadString(const string& text);
+
+    /**
+    @returns the names of all sections, in the order of their first appearance
+    */
+    vector<string> GetSectionNames();
+    /**
+    @returns true if the section exists
+    */
+    bool HasSection(string section);
+    /**
+    @returns true if the key exists in the section
+    */
+    bool HasKey(string section, string key);
+    /**
+    @returns all keys and values of a section, or NULL if there is no such section
+    */
+    const map<string,string>* GetSection(string section);
+    /**
+    @returns the value of the key in the section, or def if there is none
+    */
+    string Get(string section, string key, string def = "");
+    /**
+    @returns the value of the key in the section as a (decimal) integer, or def if there is none or it is not a number
+    */
+    long long GetInt(string section, string key, long long def = 0);
+    /**
+    @returns the value of the key in the section as a floating point number, or def if there is none or it is not a number
+    */
+    double GetDouble(string section, string key, double def = 0);
+    /**
+    @returns the value of the key in the section as a size in bytes (see ParseSize()), or def if there is none or it is not a size
+    */
+    long long GetSize(string section, string key, long long def = 0);
+
+    /**
+    Creates a Component from a section, as described by a mapping.
+    @param m - the mapping
+    @param parent - parent of the new Component (inserted as its child), or NULL
+    @param id - id of the Component, unless the mapping contains the property "id"
+    @returns the new Component, or NULL if the section, a mapped key or a valid value is missing (an error is printed; nothing is created)
+    */
+    Component* CreateComponent(const ConfigMapping& m, Component* parent = NULL, int id = 0);
+
+    /**
+    Parses a size with an optional unit: no unit or "B" (bytes), "kB", "MB", "GB", "TB" (powers of 1000), "KiB", "MiB", "GiB", "TiB" (powers of 1024); the unit is case-insensitive and may be separated by whitespace, e.g. "32768", "32 KiB", "8Gb".
+    @param value - the string to parse
+    @param size - the size in bytes, set on success
+    @return 0 on success, 1 if value is not a size
+    */
+    static int ParseSize(string value, long long* size);
+
+private:
+    vector<string> section_names;
+    unordered_map<string, map<string,string>> sections;
+};
+
+#endif
@@ -0,0 +1,100 @@
+
+#include "cpu-cache-benchmark.hpp"
+#include "caps-numa-benchmark.hpp" //CSVReader
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+int parseCpuCacheBenchmark(Component* rootComponent, string benchmarkPath, string delim)
+{
+    CSVReader reader(benchmarkPath, delim);
+    vector<vector<string> > benchmarkData;
+    if(reader.getData(&benchmarkData) != 0 || benchmarkData.empty()) {//Error
+        cerr << "error: could not parse cpu-cache-benchmark file " << benchmarkPath.c_str() << endl;
+        return 1;
+    }
+    int ret = parseCpuCacheBenchmarkData(rootComponent, benchmarkData);
+    if(ret != 0)
+        cerr << "parseCpuCacheBenchmark: could not use " << benchmarkPath << endl;
+    return ret;
+}
+
+int parseCpuCacheBenchmarkData(Component* rootComponent, const vector<vector<string> >& benchmarkData)
+{
+    if(benchmarkData.empty())
+        return 1;
+
+    //get indexes of relevant columns
+    vector<string> header = benchmarkData[0];
+    int thread_idx=-1;
+    int cache_id_idx=-1;
+    int ws_idx=-1;
+    int ldlat_idx=-1;
+    int bw_idx=-1;
+    for(unsigned int i=0; i<header.size(); i++)
+    {
+        if(header[i] == "thread")
+            thread_idx=i;
+        else if(header[i] == "cache_id")
+            cache_id_idx=i;
+        else if(header[i] == "ws_size")
+            ws_idx=i;
+        else if(header[i] == "ldlat(ns)")
+            ldlat_idx=i;
+        else if(header[i] == "bw(MB/s)")
+            bw_idx=i;
+    }
+    if(thread_idx==-1 || cache_id_idx==-1 || ldlat_idx==-1 || bw_idx==-1){
+        cerr << "parseCpuCacheBenchmark: missing column(s) in the header" << endl;
+        return 1;
+    }
+
+    //parse each line as one DataPath, skip header
+    for(unsigned int i=1; i<benchmarkData.size(); i++)
+    {
+        if(benchmarkData[i].size() < header.size() - 1) //allow the trailing delimiter to be missing
+            continue;
+        int thread_id = stoi(benchmarkData[i][thread_idx]);
+        int cache_id = stoi(benchmarkData[i][cache_id_idx]);
+
+        Component* thread = rootComponent->GetSubcomponentById(thread_id, SYS_SAGE_COMPONENT_THREAD);
+        Component* cache = NULL;
+        for(Component* c = thread; c != NULL; c = c->GetParent()){
+            if(c->GetComponentType() == SYS_SAGE_COMPONENT_CACHE && c->GetId() == cache_id){
+                cache = c;
+                break;
+            }
+        }
+        if(thread == NULL || cache == NULL){
+            cerr << "error: could not find thread " << thread_id << " or its cache " << cache_id << "; skipping " << endl;
+            continue;
+        }
+
+        double bw = stod(benchmarkData[i][bw_idx]);
+        double ldlat = stod(benchmarkData[i][ldlat_idx]);
+
+        DataPath* dp = NULL;
+        for(DataPath* d : *thread->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)){
+            if(d->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_DATATRANSFER && d->GetTarget() == cache){
+                dp = d;
+                break;
+            }
+        }
+        if(dp == NULL){
+            dp = new DataPath(thread, cache, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_DATATRANSFER, bw, ldlat);
+        } else {
+            dp->SetBandwidth(bw);
+            dp->SetLatency(ldlat);
+        }
+
+        if(ws_idx != -1){
+            auto it = dp->attrib.find("working_set_size");
+            if(it != dp->attrib.end())
+                delete (long long*)it->second;
+            dp->attrib["working_set_size"] = (void*) new long long(stoll(benchmarkData[i][ws_idx]));
+        }
+    }
+    return 0;
+}
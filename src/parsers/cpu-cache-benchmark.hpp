@@ -0,0 +1,25 @@
+#ifndef CPU_CACHE_BENCHMARK
+#define CPU_CACHE_BENCHMARK
+
+#include "Component.hpp"
+#include "DataPath.hpp"
+
+/*! \file */
+
+/**
+Parser of the output of the cpu-cache-benchmark data source (load latency and read bandwidth of each CPU cache level, measured from a pinned HW thread).
+\n For each line of the CSV, a DataPath of type SYS_SAGE_DATAPATH_TYPE_DATATRANSFER is created from the Thread (column thread) to its ancestor Cache with the matching id (column cache_id). The bandwidth (column bw(MB/s)) and the load latency (column ldlat(ns)) are stored in the DataPath; the working set size used for the measurement (column ws_size) is stored as the attribute "working_set_size" (long long*).
+\n If a DataPath of this type already exists between the Thread and the Cache, its values are updated instead.
+@param rootComponent - root of the subtree where the Threads and Caches are searched (e.g. a Node parsed by parseHwlocOutput).
+@param benchmarkPath - path to the CSV output of cpu-cache-benchmark.
+@param delim (default ";") - delimiter in the CSV
+@return 0 on success, 1 if the file could not be read or the header is missing a required column.
+*/
+int parseCpuCacheBenchmark(Component* rootComponent, string benchmarkPath, string delim = ";");
+/**
+@private
+Creates the DataPaths of parseCpuCacheBenchmark() from an already read CSV (one vector of columns per line, the header first).
+*/
+int parseCpuCacheBenchmarkData(Component* rootComponent, const vector<vector<string> >& benchmarkData);
+
+#endif
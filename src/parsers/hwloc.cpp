@@ -229,18 +229,26 @@ int parseHwlocOutput(Node* n, string xmlPath)
         return 1;
     }
 
+    int err = parseHwlocDocument(n, document);
+    if(err != 0)
+        std::cerr << "parseHwlocOutput on file " << xmlPath << " failed" << std::endl;
+    xmlFreeDoc(document);
+    return err;
+}
+
+int parseHwlocDocument(Node* n, xmlDoc* document)
+{
     xmlNode *root= xmlDocGetRootElement(document);
     int err = xmlProcessChildren(n, root, 0);
     if(err != 0){
-        std::cerr << "parseHwlocOutput on file " << xmlPath << " failed on xmlProcessChildren" << std::endl;
+        std::cerr << "parseHwlocDocument failed on xmlProcessChildren" << std::endl;
         return err;
     }
     err = removeUnknownCompoents(n);
     if(err != 0){
-        std::cerr << "parseHwlocOutput on file " << xmlPath << " failed on removeUnknownCompoents BUT WILL CONTINUE" << std::endl;
+        std::cerr << "parseHwlocDocument failed on removeUnknownCompoents BUT WILL CONTINUE" << std::endl;
         //return ret;
     }
-    xmlFreeDoc(document);
     err = n->CheckComponentTreeConsistency();
     return err;
 }
@@ -18,6 +18,11 @@ Parser function for importing hwloc XML output to sys-sage.
 @param xmlPath - Path to the XML output of hwloc that should be parsed and uploaded to sys-sage.
 */
 int parseHwlocOutput(Node* n, std::string xmlPath);
+/**
+@private
+Builds the topology of parseHwlocOutput() from an already read hwloc XML document (e.g. read by xmlReadFile in parallel with other data sources). The document is not freed.
+*/
+int parseHwlocDocument(Node* n, xmlDoc* document);
 /// @private
 int xmlProcessChildren(Component* c, xmlNode* parent, int level);
 /// @private
@@ -0,0 +1,381 @@
+#include "ingestion.hpp"
+
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include "hwloc.hpp"
+#include "sysfs.hpp"
+#include "mt4g.hpp"
+#include "caps-numa-benchmark.hpp"
+#include "cpu-cache-benchmark.hpp"
+#include "cccbench.hpp"
+
+//built-in parsers
+
+class HwlocIngestionParser : public IngestionParser {
+public:
+    using IngestionParser::IngestionParser;
+    ~HwlocIngestionParser() { if(document != NULL) xmlFreeDoc(document); }
+    int Load() {
+        document = xmlReadFile(source.path.c_str(), NULL, 0);
+        if(document == NULL){
+            std::cerr << "error: could not parse file " << source.path << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    int Build(Component* root) { return parseHwlocDocument((Node*)root, document); }
+private:
+    xmlDoc* document = NULL;
+};
+
+class SysfsIngestionParser : public IngestionParser {
+public:
+    using IngestionParser::IngestionParser;
+    int Build(Component* root) { return parseSysfsTopology((Node*)root, source.path); }
+};
+
+class Mt4gIngestionParser : public IngestionParser {
+public:
+    using IngestionParser::IngestionParser;
+    ~Mt4gIngestionParser() { delete parser; }
+    Component* CreateSubtreeRoot() {
+        gpu = new Chip(source.id, "GPU", SYS_SAGE_CHIP_TYPE_GPU);
+        return gpu;
+    }
+    int Load() {
+        //only reads the file; the Chip is filled by Build()
+        parser = new Mt4gParser(gpu, source.path, source.delim);
+        return parser->ReadBenchmarkFile();
+    }
+    int Build(Component* root) { return parser->BuildTopology(); }
+private:
+    Chip* gpu = NULL;
+    Mt4gParser* parser = NULL;
+};
+
+class CsvIngestionParser : public IngestionParser {
+public:
+    CsvIngestionParser(const IngestionSource& _source, std::function<int(Component*, const vector<vector<string>>&)> _build) : IngestionParser(_source), build(_build) {}
+    int Load() {
+        CSVReader reader(source.path, source.delim);
+        if(reader.getData(&data) != 0 || data.empty()){
+            std::cerr << "error: could not read " << source.parser << " file " << source.path << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    int Build(Component* root) { return build(root, data); }
+private:
+    std::function<int(Component*, const vector<vector<string>>&)> build;
+    vector<vector<string>> data;
+};
+
+class CccbenchIngestionParser : public IngestionParser {
+public:
+    using IngestionParser::IngestionParser;
+    ~CccbenchIngestionParser() { delete parser; }
+    int Load() {
+        try{
+            parser = new CccbenchParser(source.path.c_str());
+        } catch(const char* e) {
+            std::cerr << "error: could not read cccbench file " << source.path << ": " << e << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    int Build(Component* root) { return parser->applyDataPaths(root); }
+private:
+    CccbenchParser* parser = NULL;
+};
+
+//registry
+
+struct ingestion_registry {
+    std::mutex lock;
+    std::map<string, std::pair<int, IngestionParserFactory>> parsers;
+    ingestion_registry()
+    {
+        parsers["hwloc"] = { SYS_SAGE_INGEST_NODE, [](const IngestionSource& s) { return (IngestionParser*)new HwlocIngestionParser(s); } };
+        parsers["sysfs"] = { SYS_SAGE_INGEST_NODE, [](const IngestionSource& s) { return (IngestionParser*)new SysfsIngestionParser(s); } };
+        parsers["mt4g"] = { SYS_SAGE_INGEST_SUBTREE, [](const IngestionSource& s) { return (IngestionParser*)new Mt4gIngestionParser(s); } };
+        parsers["caps-numa-benchmark"] = { SYS_SAGE_INGEST_DATAPATHS, [](const IngestionSource& s) { return (IngestionParser*)new CsvIngestionParser(s, parseCapsNumaBenchmarkData); } };
+        parsers["cpu-cache-benchmark"] = { SYS_SAGE_INGEST_DATAPATHS, [](const IngestionSource& s) { return (IngestionParser*)new CsvIngestionParser(s, parseCpuCacheBenchmarkData); } };
+        parsers["cccbench"] = { SYS_SAGE_INGEST_DATAPATHS, [](const IngestionSource& s) { return (IngestionParser*)new CccbenchIngestionParser(s); } };
+    }
+};
+static ingestion_registry& getIngestionRegistry()
+{
+    static ingestion_registry registry;
+    return registry;
+}
+
+int RegisterIngestionParser(string name, int kind, IngestionParserFactory factory)
+{
+    if(kind != SYS_SAGE_INGEST_NODE && kind != SYS_SAGE_INGEST_SUBTREE && kind != SYS_SAGE_INGEST_DATAPATHS){
+        std::cerr << "RegisterIngestionParser: invalid kind " << kind << " of parser " << name << std::endl;
+        return 1;
+    }
+    ingestion_registry& r = getIngestionRegistry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    r.parsers[name] = { kind, factory };
+    return 0;
+}
+
+int GetIngestionParserKind(string name)
+{
+    ingestion_registry& r = getIngestionRegistry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    auto it = r.parsers.find(name);
+    return it == r.parsers.end() ? 0 : it->second.first;
+}
+
+static IngestionParserFactory getIngestionParserFactory(string name)
+{
+    ingestion_registry& r = getIngestionRegistry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    auto it = r.parsers.find(name);
+    return it == r.parsers.end() ? IngestionParserFactory() : it->second.second;
+}
+
+//pipeline
+
+IngestionPipeline::IngestionPipeline(Node* _node, int _num_threads) : node(_node), num_threads(_num_threads)
+{
+    if(num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+IngestionPipeline::~IngestionPipeline() {}
+
+int IngestionPipeline::AddSource(string parser, string path, int id, string delim)
+{
+    if(GetIngestionParserKind(parser) == 0){
+        std::cerr << "IngestionPipeline::AddSource: no parser registered as " << parser << std::endl;
+        return -1;
+    }
+    sources.push_back({ parser, path, id, delim });
+    dependencies.emplace_back();
+    return sources.size() - 1;
+}
+
+int IngestionPipeline::AddDependency(int source, int depends_on)
+{
+    int n = sources.size();
+    if(source < 0 || source >= n || depends_on < 0 || depends_on >= n || source == depends_on ||
+       GetIngestionParserKind(sources[source].parser) != SYS_SAGE_INGEST_DATAPATHS || GetIngestionParserKind(sources[depends_on].parser) != SYS_SAGE_INGEST_DATAPATHS){
+        std::cerr << "IngestionPipeline::AddDependency: invalid dependency " << source << " -> " << depends_on << std::endl;
+        return 1;
+    }
+    //a cycle exists if depends_on (transitively) depends on source
+    vector<int> stack = { depends_on };
+    vector<bool> visited(n, false);
+    while(!stack.empty()){
+        int s = stack.back();
+        stack.pop_back();
+        if(s == source){
+            std::cerr << "IngestionPipeline::AddDependency: dependency " << source << " -> " << depends_on << " would create a cycle" << std::endl;
+            return 1;
+        }
+        if(visited[s])
+            continue;
+        visited[s] = true;
+        for(int d : dependencies[s])
+            stack.push_back(d);
+    }
+    dependencies[source].push_back(depends_on);
+    return 0;
+}
+
+int IngestionPipeline::runParallel(vector<std::function<void()>>& tasks)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for(size_t i = next++; i < tasks.size(); i = next++)
+            tasks[i]();
+    };
+    vector<std::thread> threads;
+    int n = std::min<int>(num_threads, tasks.size());
+    for(int i = 1; i < n; i++)
+        threads.emplace_back(worker);
+    worker();
+    for(std::thread& t : threads)
+        t.join();
+    return 0;
+}
+
+static double ingestionSecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int IngestionPipeline::Run()
+{
+    int n = sources.size();
+    results.assign(n, -1);
+    timings.clear();
+    vector<IngestionParser*> parsers(n, NULL);
+    vector<int> kinds(n);
+    vector<double> seconds(n, 0);
+    vector<Component*> subtree_roots(n, NULL);
+    std::mutex err_lock;
+    auto start = std::chrono::steady_clock::now();
+    auto record = [&](string stage, vector<int> const& idx, std::chrono::steady_clock::time_point stage_start) {
+        timings.push_back({ stage, -1, ingestionSecondsSince(stage_start) });
+        for(int i : idx)
+            timings.push_back({ stage, i, seconds[i] });
+    };
+
+    for(int i = 0; i < n; i++){
+        kinds[i] = GetIngestionParserKind(sources[i].parser);
+        IngestionParserFactory factory = getIngestionParserFactory(sources[i].parser);
+        if(factory)
+            parsers[i] = factory(sources[i]);
+        if(parsers[i] == NULL){
+            std::cerr << "IngestionPipeline::Run: could not create parser " << sources[i].parser << " of source " << i << std::endl;
+            results[i] = 1;
+        }
+        //the (detached) subtree roots exist before the load, so that a parser may refer to it
+        else if(kinds[i] == SYS_SAGE_INGEST_SUBTREE && (subtree_roots[i] = parsers[i]->CreateSubtreeRoot()) == NULL){
+            std::cerr << "IngestionPipeline::Run: parser " << sources[i].parser << " of source " << i << " created no subtree root" << std::endl;
+            delete parsers[i];
+            parsers[i] = NULL;
+            results[i] = 1;
+        }
+    }
+    //libxml2 has to be initialized before it is used by multiple threads
+    xmlInitParser();
+
+    //1. load
+    auto stage_start = std::chrono::steady_clock::now();
+    vector<std::function<void()>> tasks;
+    vector<int> loaded;
+    for(int i = 0; i < n; i++){
+        if(parsers[i] == NULL)
+            continue;
+        loaded.push_back(i);
+        tasks.push_back([&, i]() {
+            auto t = std::chrono::steady_clock::now();
+            results[i] = parsers[i]->Load();
+            seconds[i] = ingestionSecondsSince(t);
+            if(results[i] != 0){
+                std::lock_guard<std::mutex> guard(err_lock);
+                std::cerr << "IngestionPipeline::Run: loading " << sources[i].path << " (" << sources[i].parser << ") failed with " << results[i] << "; skipping" << std::endl;
+            }
+        });
+    }
+    runParallel(tasks);
+    record("load", loaded, stage_start);
+
+    //2. build: node parsers in order, in one task; each subtree in its own task
+    stage_start = std::chrono::steady_clock::now();
+    tasks.clear();
+    vector<int> built;
+    vector<int> node_sources;
+    for(int i : loaded){
+        if(results[i] != 0)
+            continue;
+        if(kinds[i] == SYS_SAGE_INGEST_NODE){
+            node_sources.push_back(i);
+            built.push_back(i);
+        }
+        else if(kinds[i] == SYS_SAGE_INGEST_SUBTREE){
+            built.push_back(i);
+            tasks.push_back([&, i]() {
+                auto t = std::chrono::steady_clock::now();
+                results[i] = parsers[i]->Build(subtree_roots[i]);
+                seconds[i] = ingestionSecondsSince(t);
+            });
+        }
+    }
+    tasks.push_back([&]() {
+        for(int i : node_sources){
+            auto t = std::chrono::steady_clock::now();
+            results[i] = parsers[i]->Build(node);
+            seconds[i] = ingestionSecondsSince(t);
+        }
+    });
+    runParallel(tasks);
+    record("build", built, stage_start);
+
+    //3. attach the subtrees in the order of the sources; the subtrees of failed sources are deleted
+    stage_start = std::chrono::steady_clock::now();
+    for(int i = 0; i < n; i++){
+        if(subtree_roots[i] == NULL)
+            continue;
+        if(results[i] != 0){
+            std::cerr << "IngestionPipeline::Run: building " << sources[i].path << " (" << sources[i].parser << ") failed with " << results[i] << "; skipping" << std::endl;
+            subtree_roots[i]->Delete(true);
+            continue;
+        }
+        node->InsertChild(subtree_roots[i]);
+    }
+    timings.push_back({ "attach", -1, ingestionSecondsSince(stage_start) });
+
+    //4. data paths, in dependency order (otherwise in the order of the sources)
+    stage_start = std::chrono::steady_clock::now();
+    vector<int> applied;
+    vector<bool> done(n, false);
+    vector<int> pending;
+    for(int i : loaded)
+        if(kinds[i] == SYS_SAGE_INGEST_DATAPATHS)
+            pending.push_back(i);
+    while(!pending.empty()){
+        //first pending source whose dependencies are done (AddDependency prevents cycles)
+        size_t k = 0;
+        for(; k < pending.size(); k++){
+            bool ready = true;
+            for(int d : dependencies[pending[k]])
+                if(!done[d] && std::find(pending.begin(), pending.end(), d) != pending.end())
+                    ready = false;
+            if(ready)
+                break;
+        }
+        int i = pending[k];
+        pending.erase(pending.begin() + k);
+        done[i] = true;
+        if(results[i] != 0)
+            continue;
+        auto t = std::chrono::steady_clock::now();
+        results[i] = parsers[i]->Build(node);
+        seconds[i] = ingestionSecondsSince(t);
+        applied.push_back(i);
+        if(results[i] != 0)
+            std::cerr << "IngestionPipeline::Run: applying " << sources[i].path << " (" << sources[i].parser << ") failed with " << results[i] << std::endl;
+    }
+    record("datapaths", applied, stage_start);
+
+    for(IngestionParser* p : parsers)
+        delete p;
+    timings.push_back({ "total", -1, ingestionSecondsSince(start) });
+
+    int failed = 0;
+    for(int r : results)
+        if(r != 0)
+            failed++;
+    return failed;
+}
+
+int IngestionPipeline::GetResult(int source)
+{
+    if(source < 0 || source >= (int)results.size())
+        return -1;
+    return results[source];
+}
+
+vector<IngestionTiming> IngestionPipeline::GetTimings() { return timings; }
+
+void IngestionPipeline::PrintTimings()
+{
+    for(IngestionTiming const& t : timings){
+        if(t.source < 0)
+            std::cout << t.stage << ": " << t.seconds << " s" << std::endl;
+        else
+            std::cout << "    " << sources[t.source].parser << " " << sources[t.source].path << ": " << t.seconds << " s" << std::endl;
+    }
+}
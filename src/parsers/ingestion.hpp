@@ -0,0 +1,149 @@
+#ifndef INGESTION
+#define INGESTION
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "Component.hpp"
+
+/*! \file */
+
+#define SYS_SAGE_INGEST_NODE 1 /**< The parser fills the Node itself (e.g. hwloc, sysfs). The parsers of this kind are built one after another, concurrently with the subtrees. */
+#define SYS_SAGE_INGEST_SUBTREE 2 /**< The parser builds an independent subtree (e.g. one GPU Chip by mt4g), which is attached to the Node after the build stage. The subtrees are built concurrently. */
+#define SYS_SAGE_INGEST_DATAPATHS 4 /**< The parser adds DataPaths or attributes to existing Components, possibly across subtrees (e.g. caps-numa-benchmark, cccbench). Applied after all subtrees are attached, in the order of the dependencies. */
+
+/**
+One data source of an IngestionPipeline.
+*/
+struct IngestionSource {
+    string parser; /**< name of the registered parser (see RegisterIngestionParser()) */
+    string path; /**< path to the data source (file or directory) */
+    int id; /**< id of the subtree root, for parsers of kind SYS_SAGE_INGEST_SUBTREE (e.g. GPU id) */
+    string delim; /**< delimiter, for CSV-based parsers */
+};
+
+/**
+Parser of one data source, used by IngestionPipeline. The work is split in two steps:
+\n Load() reads and tokenizes the data source; it must not access the topology, so the loads of all sources run in parallel.
+\n Build() creates the Components and DataPaths from the loaded data.
+*/
+class IngestionParser {
+public:
+    IngestionParser(const IngestionSource& _source) : source(_source) {}
+    virtual ~IngestionParser() {}
+    /**
+    Reads and tokenizes the data source. Runs in parallel with the other sources; must not access the topology.
+    @return 0 on success
+    */
+    virtual int Load() { return 0; }
+    /**
+    Creates the (detached) root of the subtree. Only called for parsers of kind SYS_SAGE_INGEST_SUBTREE.
+    @return the new root, without a parent
+    */
+    virtual Component* CreateSubtreeRoot() { return NULL; }
+    /**
+    Builds the topology from the loaded data.
+    @param root - the Node (SYS_SAGE_INGEST_NODE, SYS_SAGE_INGEST_DATAPATHS) or the root created by CreateSubtreeRoot() (SYS_SAGE_INGEST_SUBTREE)
+    @return 0 on success
+    */
+    virtual int Build(Component* root) = 0;
+protected:
+    IngestionSource source;
+};
+
+/**
+Creates the parser of a data source.
+*/
+typedef std::function<IngestionParser*(const IngestionSource&)> IngestionParserFactory;
+
+/**
+Registers a parser for IngestionPipeline under a name (an existing registration with the same name is replaced).
+\n Built-in parsers: "hwloc", "sysfs" (SYS_SAGE_INGEST_NODE), "mt4g" (SYS_SAGE_INGEST_SUBTREE, creates a GPU Chip with IngestionSource::id), "caps-numa-benchmark", "cpu-cache-benchmark", "cccbench" (SYS_SAGE_INGEST_DATAPATHS).
+@param name - name of the parser, used in IngestionPipeline::AddSource()
+@param kind - SYS_SAGE_INGEST_NODE, SYS_SAGE_INGEST_SUBTREE or SYS_SAGE_INGEST_DATAPATHS
+@param factory - creates the parser of a source
+@return 0 on success, 1 if kind is invalid
+*/
+int RegisterIngestionParser(string name, int kind, IngestionParserFactory factory);
+/**
+@returns kind of the registered parser (SYS_SAGE_INGEST_*), or 0 if no parser is registered under the name
+*/
+int GetIngestionParserKind(string name);
+
+/**
+Duration of one stage of IngestionPipeline::Run(), or of one source in a stage.
+*/
+struct IngestionTiming {
+    string stage; /**< "load", "build", "attach", "datapaths" or "total" */
+    int source; /**< index of the source (see IngestionPipeline::AddSource()), or -1 for the whole stage */
+    double seconds; /**< wall-clock time */
+};
+
+/**
+Class IngestionPipeline builds the topology of a Node from multiple data sources, overlapping the independent work:
+\n 1. load: the data sources are read and tokenized in parallel (IngestionParser::Load()).
+\n 2. build: the parsers of kind SYS_SAGE_INGEST_NODE run one after another on the Node while each SYS_SAGE_INGEST_SUBTREE source builds its own detached subtree, all in parallel.
+\n 3. attach: the subtrees are inserted as children of the Node, in the order of the sources.
+\n 4. datapaths: the SYS_SAGE_INGEST_DATAPATHS parsers are applied one after another, in the order of the sources unless a dependency (AddDependency()) requires otherwise.
+\n Example:
+\n IngestionPipeline p(node);
+\n p.AddSource("hwloc", "skylake_hwloc.xml");
+\n p.AddSource("mt4g", "gpu0.csv", 0);
+\n p.AddSource("mt4g", "gpu1.csv", 1);
+\n p.AddSource("caps-numa-benchmark", "caps_numa.csv");
+\n p.Run();
+\n p.PrintTimings();
+*/
+class IngestionPipeline {
+public:
+    /**
+    @param _node - the Node to build
+    @param _num_threads - number of threads of the load and build stages; 0 (default) uses std::thread::hardware_concurrency()
+    */
+    IngestionPipeline(Node* _node, int _num_threads = 0);
+    ~IngestionPipeline();
+    /**
+    Adds a data source.
+    @param parser - name of a registered parser (see RegisterIngestionParser())
+    @param path - path to the data source
+    @param id - id of the subtree root (SYS_SAGE_INGEST_SUBTREE parsers)
+    @param delim - delimiter (CSV-based parsers)
+    @return index of the source, or -1 if no such parser is registered
+    */
+    int AddSource(string parser, string path, int id = 0, string delim = ";");
+    /**
+    Makes a SYS_SAGE_INGEST_DATAPATHS source be applied after another one (e.g. when it updates DataPaths created by the other one).
+    @return 0 on success, 1 if a source does not exist, is not of kind SYS_SAGE_INGEST_DATAPATHS, or the dependency would create a cycle
+    */
+    int AddDependency(int source, int depends_on);
+    /**
+    Runs the pipeline. A source whose parser fails is skipped (its subtree is not attached); the other sources continue.
+    @return 0 on success, otherwise the number of failed sources
+    */
+    int Run();
+    /**
+    @returns the return value of the parser of a source in the last Run() (0 = success), or -1 if the source was not run
+    */
+    int GetResult(int source);
+    /**
+    @returns the durations of the stages and of each source in its stages, of the last Run()
+    */
+    vector<IngestionTiming> GetTimings();
+    /**
+    Prints the durations of the last Run() to stdout.
+    */
+    void PrintTimings();
+
+private:
+    int runParallel(vector<std::function<void()>>& tasks);
+
+    Node* node;
+    int num_threads;
+    vector<IngestionSource> sources;
+    vector<vector<int>> dependencies;
+    vector<int> results;
+    vector<IngestionTiming> timings;
+};
+
+#endif
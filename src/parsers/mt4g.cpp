@@ -81,6 +81,12 @@ int Mt4gParser::ParseBenchmarkData()
     int ret = ReadBenchmarkFile();
     if(ret != 0)
         return ret;
+    return BuildTopology();
+}
+
+int Mt4gParser::BuildTopology()
+{
+    int ret;
 
     if(benchmarkData.find("GPU_INFORMATION") == benchmarkData.end()){
         cerr << "parseMt4gTopo: Could not find GPU_INFORMATION in file " << dataSourcePath << endl;
@@ -421,11 +427,9 @@ int Mt4gParser::parseMemory(string header_name, string memory_name)
             cerr << "parseMemory:InsertBetweenParentAndChildren failed with return code " << ret << endl;
         }
         
+        //one broadcast DP to all threads below the memory
         if(latency != -1)
-            for(Component* sm: memory_children)
-                for(Component * c : *(sm->GetChildren()))
-                    if(c->GetComponentType() == SYS_SAGE_COMPONENT_THREAD)
-                        new DataPath(mem, c, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 0, latency); 
+            new DataPath(mem, mem, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 0, latency, SYS_SAGE_COMPONENT_THREAD);
     }
     else if(header_name == "SHARED_MEMORY") //very similar to parseCaches
     {   //shared memory is shared on an SM level
@@ -453,13 +457,9 @@ int Mt4gParser::parseMemory(string header_name, string memory_name)
 
                 Memory * mem = new Memory(parent, 0, memory_name, (long long)size);
 
-                //insert DP with latency
+                //insert (broadcast) DP with latency to all threads of the parent
                 if(latency != -1)
-                {
-                    vector<Component*> threads = parent->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD);
-                    for(Component* t: threads)
-                        new DataPath(mem, t, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 0, latency);
-                }
+                    new DataPath(mem, parent, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 0, latency, SYS_SAGE_COMPONENT_THREAD);
             }
         }
     }
@@ -660,13 +660,9 @@ int Mt4gParser::parseCaches(string header_name, string cache_type)
             cerr << "parseCaches:InsertBetweenParentAndChildren failed with return code " << ret << endl;
         }
         
-        //insert DP with latency
+        //insert (broadcast) DP with latency to all threads of the parent
         if(latency != -1)
-        {
-            vector<Component*> threads = parent->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD);
-            for(Component* t: threads)
-                new DataPath(cache, t, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 0, latency);
-        }
+            new DataPath(cache, parent, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 0, latency, SYS_SAGE_COMPONENT_THREAD);
     }
     else if(shared_on == 1) //shared on SM
     {
@@ -709,6 +705,10 @@ int Mt4gParser::parseCaches(string header_name, string cache_type)
                         cache->SetCacheLineSize(cache_line_size);
 
                     int cores_per_cache = (*(int*)root->attrib["Number_of_cores_per_SM"])/caches_per_sm;
+                    //for L1 and L2 caches, insert them between them and their cores as children
+                    bool insert_cache = (cache_type.find("L1") != std::string::npos && cache_type.find("Constant") == std::string::npos) || cache_type == "L2";
+                    //the threads of the cache form a subtree (its own or the whole SM) -> one broadcast DP; otherwise one DP per thread
+                    Component* dp_root = insert_cache ? cache : (caches_per_sm == 1 ? sm : NULL);
 
                     for(Component * thread : threads)
                     {
@@ -716,8 +716,7 @@ int Mt4gParser::parseCaches(string header_name, string cache_type)
                         int core_id = thread->GetId();
                         if(core_id >= cores_per_cache*(i) && core_id < cores_per_cache*(i+1))
                         {
-                            //for L1 and L2 caches, insert them between them and their cores as children
-                            if((cache_type.find("L1") != std::string::npos && cache_type.find("Constant") == std::string::npos) || cache_type == "L2")
+                            if(insert_cache)
                             {
                                 if((ret = cache->InsertBetweenParentAndChild(parent, thread, true)) != 0)
                                 {
@@ -725,10 +724,12 @@ int Mt4gParser::parseCaches(string header_name, string cache_type)
                                 }
                             }
 
-                            if(latency != -1)
+                            if(latency != -1 && dp_root == NULL)
                                 new DataPath(cache, thread, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 0, latency);
                         }
                     }
+                    if(latency != -1 && dp_root != NULL)
+                        new DataPath(cache, dp_root, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 0, latency, SYS_SAGE_COMPONENT_THREAD);
                     
                 }
             }
@@ -37,8 +37,9 @@ public:
     Mt4gParser(Chip* gpu, string dataSourcePath, string delim = ";");
 
     int ParseBenchmarkData();
-private:
     int ReadBenchmarkFile();
+    int BuildTopology();
+private:
     map<string,vector<string> > benchmarkData;
     string dataSourcePath;
     string delim;
@@ -0,0 +1,256 @@
+
+#include "sysfs.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <set>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+
+using namespace std;
+
+/// @private
+//a component shared by a set of HW threads (package, NUMA node, cache or core), collected before the tree is built
+struct sysfs_group
+{
+    int componentType;
+    int id;
+    int cache_level = 0;
+    long long size = -1;
+    int associativity = -1;
+    int line_size = -1;
+    set<int> cpus;
+    Component* component = NULL;
+};
+
+/// @private
+static bool sysfs_read_str(string path, string* out)
+{
+    ifstream f(path);
+    if(!f.good())
+        return false;
+    getline(f, *out);
+    return true;
+}
+
+/// @private
+static int sysfs_read_int(string path, int default_value)
+{
+    string s;
+    if(!sysfs_read_str(path, &s))
+        return default_value;
+    try{
+        return stoi(s);
+    } catch(std::exception const&) {
+        return default_value;
+    }
+}
+
+set<int> parseCpulist(string list)
+{
+    set<int> cpus;
+    stringstream ss(list);
+    string range;
+    while(getline(ss, range, ','))
+    {
+        if(range.empty() || !isdigit(range[0]))
+            continue;
+        char* end;
+        long first = strtol(range.c_str(), &end, 10);
+        long last = first;
+        if(*end == '-')
+        {
+            if(!isdigit(end[1]))
+                continue;
+            last = strtol(end + 1, &end, 10);
+        }
+        if(!isspace(*end) && *end != '\0')
+            continue;
+        for(long cpu = first; cpu <= last && cpu <= INT_MAX; cpu++)
+            cpus.insert(cpu);
+    }
+    return cpus;
+}
+
+/// @private
+//parses a cache size, e.g. "32K", "1024K", "16M"
+static long long sysfs_parse_size(string s)
+{
+    if(s.empty() || !isdigit(s[0]))
+        return -1;
+    long long size = stoll(s);
+    switch(s.back()){
+        case 'K': return size << 10;
+        case 'M': return size << 20;
+        case 'G': return size << 30;
+    }
+    return size;
+}
+
+/// @private
+//orders the groups of one HW thread from the top of the tree: more HW threads first; on a tie Chip > Numa > Cache (higher level first) > Core
+static int sysfs_group_rank(sysfs_group* g)
+{
+    switch(g->componentType){
+        case SYS_SAGE_COMPONENT_CHIP: return 0;
+        case SYS_SAGE_COMPONENT_NUMA: return 1;
+        case SYS_SAGE_COMPONENT_CACHE: return 100 - g->cache_level;
+        default: return 1000;
+    }
+}
+
+int parseSysfsTopology(Node* n, string sysfsRoot)
+{
+    string cpuDir = sysfsRoot + "/devices/system/cpu";
+    string nodeDir = sysfsRoot + "/devices/system/node";
+
+    //online HW threads
+    set<int> cpus;
+    string online;
+    if(sysfs_read_str(cpuDir + "/online", &online))
+        cpus = parseCpulist(online);
+    else
+    {
+        std::error_code ec;
+        for(auto const& entry : filesystem::directory_iterator(cpuDir, ec))
+        {
+            string name = entry.path().filename().string();
+            if(name.size() > 3 && name.compare(0, 3, "cpu") == 0 && all_of(name.begin() + 3, name.end(), ::isdigit))
+                cpus.insert(stoi(name.substr(3)));
+        }
+    }
+    if(cpus.empty()){
+        cerr << "parseSysfsTopology: no HW threads found in " << cpuDir << endl;
+        return 1;
+    }
+
+    //collect packages, cores and caches of each HW thread
+    map<string, sysfs_group> groups; //key -> group
+    map<int, vector<sysfs_group*>> cpu_groups;
+    auto add_to_group = [&](string key, int cpu, sysfs_group g) -> sysfs_group* {
+        auto it = groups.find(key);
+        if(it == groups.end())
+            it = groups.insert({key, g}).first;
+        it->second.cpus.insert(cpu);
+        cpu_groups[cpu].push_back(&it->second);
+        return &it->second;
+    };
+    for(int cpu : cpus)
+    {
+        string dir = cpuDir + "/cpu" + to_string(cpu);
+        int package = sysfs_read_int(dir + "/topology/physical_package_id", 0);
+        if(package < 0)
+            package = 0;
+        int core_id = sysfs_read_int(dir + "/topology/core_id", cpu);
+
+        add_to_group("chip:" + to_string(package), cpu, {SYS_SAGE_COMPONENT_CHIP, package});
+        add_to_group("core:" + to_string(package) + ":" + to_string(core_id), cpu, {SYS_SAGE_COMPONENT_CORE, core_id});
+
+        for(int index = 0; ; index++)
+        {
+            string cacheDir = dir + "/cache/index" + to_string(index);
+            string type, shared, size;
+            if(!sysfs_read_str(cacheDir + "/type", &type))
+                break;
+            if(type == "Instruction")
+                continue;
+            int level = sysfs_read_int(cacheDir + "/level", 0);
+            if(!sysfs_read_str(cacheDir + "/shared_cpu_list", &shared))
+                shared = to_string(cpu);
+            sysfs_read_str(cacheDir + "/size", &size);
+
+            sysfs_group g = {SYS_SAGE_COMPONENT_CACHE, 0, level};
+            g.size = sysfs_parse_size(size);
+            g.associativity = sysfs_read_int(cacheDir + "/ways_of_associativity", -1);
+            g.line_size = sysfs_read_int(cacheDir + "/coherency_line_size", -1);
+            add_to_group("cache:" + to_string(level) + ":" + shared, cpu, g);
+        }
+    }
+
+    //NUMA nodes
+    vector<sysfs_group> memory_only_numas;
+    std::error_code ec;
+    for(auto const& entry : filesystem::directory_iterator(nodeDir, ec))
+    {
+        string name = entry.path().filename().string();
+        if(name.size() <= 4 || name.compare(0, 4, "node") != 0 || !all_of(name.begin() + 4, name.end(), ::isdigit))
+            continue;
+        int node_id = stoi(name.substr(4));
+
+        sysfs_group g = {SYS_SAGE_COMPONENT_NUMA, node_id};
+        ifstream meminfo(entry.path().string() + "/meminfo");
+        string line;
+        while(getline(meminfo, line))
+        {
+            size_t pos = line.find("MemTotal:");
+            if(pos != string::npos){
+                g.size = stoll(line.substr(pos + 9)) * 1024; //kB
+                break;
+            }
+        }
+
+        string cpulist;
+        sysfs_read_str(entry.path().string() + "/cpulist", &cpulist);
+        set<int> node_cpus;
+        for(int cpu : parseCpulist(cpulist))
+            if(cpus.count(cpu))
+                node_cpus.insert(cpu);
+        if(node_cpus.empty())
+            memory_only_numas.push_back(g);
+        for(int cpu : node_cpus)
+            add_to_group("numa:" + to_string(node_id), cpu, g);
+    }
+
+    //build the tree: for each HW thread, walk its groups from the largest one and create the missing components
+    int cache_id = 0;
+    for(int cpu : cpus)
+    {
+        vector<sysfs_group*>& path = cpu_groups[cpu];
+        stable_sort(path.begin(), path.end(), [](sysfs_group* a, sysfs_group* b){
+            if(a->cpus.size() != b->cpus.size())
+                return a->cpus.size() > b->cpus.size();
+            return sysfs_group_rank(a) < sysfs_group_rank(b);
+        });
+
+        Component* parent = n;
+        set<int>* parent_cpus = &cpus;
+        for(sysfs_group* g : path)
+        {
+            if(g->component == NULL)
+            {
+                //only nest groups that are fully contained in the parent
+                if(!includes(parent_cpus->begin(), parent_cpus->end(), g->cpus.begin(), g->cpus.end()))
+                    continue;
+                switch(g->componentType){
+                    case SYS_SAGE_COMPONENT_CHIP:
+                        g->component = new Chip(parent, g->id, "socket", SYS_SAGE_CHIP_TYPE_CPU_SOCKET);
+                        break;
+                    case SYS_SAGE_COMPONENT_NUMA:
+                        g->component = new Numa(parent, g->id, g->size);
+                        break;
+                    case SYS_SAGE_COMPONENT_CACHE:
+                        g->component = new Cache(parent, cache_id++, g->cache_level, g->size, g->associativity, g->line_size);
+                        break;
+                    case SYS_SAGE_COMPONENT_CORE:
+                        g->component = new Core(parent, g->id);
+                        break;
+                }
+            }
+            parent = g->component;
+            parent_cpus = &g->cpus;
+        }
+        new Thread(parent, cpu, "HW_thread");
+    }
+
+    sort(memory_only_numas.begin(), memory_only_numas.end(), [](sysfs_group const& a, sysfs_group const& b){ return a.id < b.id; });
+    for(sysfs_group& g : memory_only_numas)
+        new Numa(n, g.id, g.size);
+
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef SYSFS
+#define SYSFS
+
+#include <string>
+#include <set>
+
+#include "Component.hpp"
+
+/*! \file */
+
+/**
+Parser that builds the CPU topology of a Linux machine directly from sysfs, i.e. without hwloc.
+\n The following information is read:
+\n - online HW threads: devices/system/cpu/online (or the cpuN directories)
+\n - per HW thread: devices/system/cpu/cpuN/topology/physical_package_id and core_id
+\n - per HW thread: devices/system/cpu/cpuN/cache/index* (level, type, size, ways_of_associativity, coherency_line_size, shared_cpu_list); instruction caches are skipped
+\n - NUMA nodes: devices/system/node/nodeN/cpulist and meminfo (MemTotal)
+\n Chip (one per package), Numa, Cache, Core and Thread components are created under n. Each component is nested under the smallest component whose HW threads contain its HW threads; if two components have the same HW threads, the order is Chip > Numa > Cache (higher level first) > Core. This matches the tree created by parseHwlocOutput for the common topologies.
+\n Thread ids are the OS indexes of the HW threads, Core ids are core_id, Chip ids are physical_package_id, Numa ids are the node numbers. Cache ids are assigned sequentially in the order the caches are created, so that they are unique across all cache levels. NUMA nodes without HW threads (memory-only nodes) are inserted directly under n.
+@param n - Pointer to an already existing Node where the topology will get parsed.
+@param sysfsRoot - Root of the sysfs tree (default "/sys"). Can point to a captured copy of sysfs, e.g. for testing.
+@return 0 on success, 1 if no HW thread could be found under sysfsRoot.
+*/
+int parseSysfsTopology(Node* n, std::string sysfsRoot = "/sys");
+
+/**
+Parses a Linux cpulist, e.g. "0-3,8,10-11" (the format of devices/system/cpu/online, cpulist and shared_cpu_list in sysfs, and of cpus_list in resctrl).
+@param list - the cpulist; malformed entries are skipped
+@return the ids of the listed CPUs
+*/
+std::set<int> parseCpulist(std::string list);
+
+#endif
@@ -16,7 +16,63 @@
 
 namespace py = pybind11;
 
-std::vector<std::string> default_attribs = {"CATcos","CATL3mask","mig_size","Number_of_streaming_multiprocessors","Number_of_cores_in_GPU","Number_of_cores_per_SM","Bus_Width_bit","Clock_Frequency","latency","latency_min","latency_max","CUDA_compute_capability","mig_uuid","freq_history","GPU_Clock_Rate"};
+//default attributes, i.e. those registered in the attribute registry (see Attribute.hpp), are stored as C++ values; the other ones as std::shared_ptr<py::object>*
+bool is_default_attrib(const std::string &key) {
+    return GetAttributeHandler(key) != NULL;
+}
+
+template <typename T>
+void set_python_converter(AttributeHandler *h) {
+    h->to_python = [](void *value) { return (void*)py::cast(*(T*)value).release().ptr(); };
+}
+
+//sets AttributeHandler::to_python of the registered keys whose value type is known
+void install_python_converters() {
+    for (auto const &key : GetAttributeHandlerKeys()) {
+        AttributeHandler *h = GetAttributeHandler(key);
+        if (h->to_python)
+            continue;
+        if (h->type == "uint64")
+            set_python_converter<uint64_t>(h);
+        else if (h->type == "long long")
+            set_python_converter<long long>(h);
+        else if (h->type == "int")
+            set_python_converter<int>(h);
+        else if (h->type == "double")
+            set_python_converter<double>(h);
+        else if (h->type == "float")
+            set_python_converter<float>(h);
+        else if (h->type == "string")
+            set_python_converter<std::string>(h);
+        else if (h->type == "timeseries")
+            h->to_python = [](void *value) {
+                py::dict freq_dict;
+                for (auto [ts, freq] : ((TimeSeries*)value)->GetSamples())
+                    freq_dict[py::cast(ts)] = py::cast(freq);
+                return (void*)freq_dict.release().ptr();
+            };
+        else if (h->type == "bw_sweep")
+            h->to_python = [](void *value) {
+                py::list sweep_list;
+                for (auto const& [kernel, threads, bw] : *(std::vector<std::tuple<std::string,int,double>>*)value)
+                    sweep_list.append(py::make_tuple(kernel, threads, bw));
+                return (void*)sweep_list.release().ptr();
+            };
+        else if (h->type == "clock_rate")
+            set_python_converter<double>(h);
+    }
+}
+
+//converts the value of a default attribute to a Python object
+py::object default_attrib_to_python(AttributeHandler *h, void *value) {
+    if (!h->to_python)
+        install_python_converters();
+    if (h->to_python)
+        return py::reinterpret_steal<py::object>((PyObject*)h->to_python(value));
+    if (h->serialize)
+        return py::str(h->serialize(value));
+    throw py::type_error("Attribute of type " + h->type + " cannot be converted to Python");
+}
 
 py::function print_attributes;
 
@@ -30,7 +86,7 @@ int convert(std::map<std::string, void*> &attributes, py::object comp, py::funct
 }
 
 int xmldumper(std::string key, void* value, std::string* ret_value_str) {
-    if(default_attribs.end() != std::find(default_attribs.begin(), default_attribs.end(), key))
+    if(is_default_attrib(key))
         return 0;
     auto * ptr = static_cast<std::shared_ptr<py::object>*>(value);
     py::object res = print_attributes(*ptr->get());
@@ -39,7 +95,7 @@ int xmldumper(std::string key, void* value, std::string* ret_value_str) {
 }
 
 void set_attribute(Component &self, const std::string &key, py::object &value) {
-    if(default_attribs.end() != std::find(default_attribs.begin(), default_attribs.end(), key))
+    if(is_default_attrib(key))
         throw py::type_error("Attribute " + key + " is read-only");
     auto obj = new std::shared_ptr<py::object>(std::make_shared<py::object>(value));
     // free existing value first
@@ -48,63 +104,17 @@ void set_attribute(Component &self, const std::string &key, py::object &value) {
         delete static_cast<std::shared_ptr<py::object>*>(val->second);
     }
     self.attrib[key] = static_cast<void*>(obj);
+    self.MarkDirty();
 }
 
 py::object get_attribute(Component &self, const std::string &key) {
     auto val = self.attrib.find(key);
     if (val != self.attrib.end()) {
-        if(!key.compare("CATcos") || !key.compare("CATL3mask")){
-            uint64_t retval = *((uint64_t*)val->second); 
-            return py::cast(retval);
-        }
-        else if(!key.compare("mig_size") )
-        {
-            return py::cast(*(long long*)val->second);
-        }
-        //val->secondue: int
-        else if(!key.compare("Number_of_streaming_multiprocessors") || 
-        !key.compare("Number_of_cores_in_GPU") || 
-        !key.compare("Number_of_cores_per_SM")  || 
-        !key.compare("Bus_Width_bit") )
-        {
-            return py::cast(*(int*)val->second);
-        }
-        //value: double
-        else if(!key.compare("Clock_Frequency") )
-        {
-            return py::cast(*(double*)val->second);
-        }
-        //value: float
-        else if(!key.compare("latency") ||
-        !key.compare("latency_min") ||
-        !key.compare("latency_max") )
-        {
-            return py::cast(*(float*)val->second);
-        }   
-        //value: string
-        else if(!key.compare("CUDA_compute_capability") || 
-        !key.compare("mig_uuid") )
-        {
-            return py::cast(*(string*)val->second);
-        }
-        else if(!key.compare("freq_history") ){
-            std::vector<std::tuple<long long,double>>* value = (std::vector<std::tuple<long long,double>>*)(val->second);
-            py::dict freq_dict;
-             for(auto [ ts,freq ] : *value){
-                 freq_dict[py::cast(ts)] = py::cast(freq);
-             }
-             return freq_dict;
-        }
-        else if(!key.compare("GPU_Clock_Rate")){
-            auto [ freq, unit ] = *(std::tuple<double, std::string>*)val->second;
-            py::dict freq_dict;
-            freq_dict[py::str("freq")] = py::cast(freq);
-            freq_dict[py::str("unit")] = py::cast(unit);       
-            return freq_dict;
-        }else{
-            auto * ptr = static_cast<std::shared_ptr<py::object>*>(val->second);
-            return *ptr->get();
-        }
+        AttributeHandler *h = GetAttributeHandler(key);
+        if(h != NULL)
+            return default_attrib_to_python(h, val->second);
+        auto * ptr = static_cast<std::shared_ptr<py::object>*>(val->second);
+        return *ptr->get();
     } else {
         throw py::attribute_error("Attribute '" + key + "' not found"); 
     }
@@ -113,8 +123,13 @@ py::object get_attribute(Component &self, const std::string &key) {
 void remove_attribute(Component &self, const std::string &key) {
     auto val = self.attrib.find(key);
     if (val != self.attrib.end()) {
-        delete static_cast<std::shared_ptr<py::object>*>(val->second);
+        AttributeHandler *h = GetAttributeHandler(key);
+        if (h != NULL && h->destroy)
+            h->destroy(val->second);
+        else if (h == NULL)
+            delete static_cast<std::shared_ptr<py::object>*>(val->second);
         self.attrib.erase(val);
+        self.MarkDirty();
     } else {
         throw py::attribute_error("Attribute " + key + " not found");
     }
@@ -123,55 +138,9 @@ void remove_attribute(Component &self, const std::string &key) {
 py::dict syncAttributes(std::map<std::string, void*> &attributes, py::dict object_attributes) {
     py::dict dict;
     for (auto const& [key, value] : attributes) {
-        if(!key.compare("CATcos") || !key.compare("CATL3mask")){
-            uint64_t retval = *((uint64_t*)value); 
-            dict[key.c_str()] = py::cast(retval);
-        }
-        else if(!key.compare("mig_size") )
-        {
-            dict[key.c_str()] = py::cast(*(long long*)value);
-        }
-        //value: int
-        else if(!key.compare("Number_of_streaming_multiprocessors") || 
-        !key.compare("Number_of_cores_in_GPU") || 
-        !key.compare("Number_of_cores_per_SM")  || 
-        !key.compare("Bus_Width_bit") )
-        {
-            dict[key.c_str()] = py::cast(*(int*)value);
-        }
-        //value: double
-        else if(!key.compare("Clock_Frequency") )
-        {
-            dict[key.c_str()] = py::cast(*(double*)value);
-        }
-        //value: float
-        else if(!key.compare("latency") ||
-        !key.compare("latency_min") ||
-        !key.compare("latency_max") )
-        {
-            dict[key.c_str()] = py::cast(*(float*)value);
-        }   
-        //value: string
-        else if(!key.compare("CUDA_compute_capability") || 
-        !key.compare("mig_uuid") )
-        {
-            dict[key.c_str()] = py::cast(*(string*)value);
-        }
-        else if(!key.compare("freq_history") ){
-            std::vector<std::tuple<long long,double>>* val = (std::vector<std::tuple<long long,double>>*)value;
-            py::dict freq_dict;
-             for(auto [ ts,freq ] : *val){
-                 freq_dict[py::cast(ts)] = py::cast(freq);
-             }
-             dict[key.c_str()] = freq_dict;
-        }
-        else if(!key.compare("GPU_Clock_Rate")){
-            auto [ freq, unit ] = *(std::tuple<double, std::string>*)value;
-            py::dict freq_dict;
-            freq_dict[py::str("freq")] = py::cast(freq);
-            freq_dict[py::str("unit")] = py::cast(unit);       
-            dict[key.c_str()] = freq_dict;
-        }
+        AttributeHandler *h = GetAttributeHandler(key);
+        if(h != NULL)
+            dict[key.c_str()] = default_attrib_to_python(h, value);
         else{
             //try to cast into py::object
            py::object val = py::cast<py::object>(static_cast<PyObject*>(value));
@@ -236,6 +205,13 @@ PYBIND11_MODULE(sys_sage, m) {
         m.attr("CHIP_TYPE_CPU_SOCKET") = SYS_SAGE_CHIP_TYPE_CPU_SOCKET;
         m.attr("CHIP_TYPE_GPU") = SYS_SAGE_CHIP_TYPE_GPU;
 
+        m.attr("FREQ_SOURCE_PROC_CPUINFO") = SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO;
+        m.attr("FREQ_SOURCE_CPUFREQ") = SYS_SAGE_FREQ_SOURCE_CPUFREQ;
+
+        m.attr("HASH_DATAPATHS") = SYS_SAGE_HASH_DATAPATHS;
+        m.attr("HASH_IGNORE_ID") = SYS_SAGE_HASH_IGNORE_ID;
+        m.attr("HASH_NO_CHILDREN") = SYS_SAGE_HASH_NO_CHILDREN;
+
         m.attr("DATAPATH_NONE") = SYS_SAGE_DATAPATH_NONE;
         m.attr("DATAPATH_OUTGOING") = SYS_SAGE_DATAPATH_OUTGOING;
         m.attr("DATAPATH_INCOMING") = SYS_SAGE_DATAPATH_INCOMING;
@@ -249,6 +225,21 @@ PYBIND11_MODULE(sys_sage, m) {
         m.attr("DATAPATH_TYPE_DATATRANSFER") = SYS_SAGE_DATAPATH_TYPE_DATATRANSFER;
         m.attr("DATAPATH_TYPE_C2C") = SYS_SAGE_DATAPATH_TYPE_C2C;
 
+        m.attr("XML_DATAPATH_MATRIX_NONE") = SYS_SAGE_XML_DATAPATH_MATRIX_NONE;
+        m.attr("XML_DATAPATH_MATRIX_TEXT") = SYS_SAGE_XML_DATAPATH_MATRIX_TEXT;
+        m.attr("XML_DATAPATH_MATRIX_BASE64") = SYS_SAGE_XML_DATAPATH_MATRIX_BASE64;
+        m.attr("DELTA_XML") = SYS_SAGE_DELTA_XML;
+        m.attr("DELTA_BINARY") = SYS_SAGE_DELTA_BINARY;
+        m.attr("EDIT_ADD_COMPONENT") = SYS_SAGE_EDIT_ADD_COMPONENT;
+        m.attr("EDIT_REMOVE_COMPONENT") = SYS_SAGE_EDIT_REMOVE_COMPONENT;
+        m.attr("EDIT_MOVE_COMPONENT") = SYS_SAGE_EDIT_MOVE_COMPONENT;
+        m.attr("EDIT_CHANGE_COMPONENT") = SYS_SAGE_EDIT_CHANGE_COMPONENT;
+        m.attr("EDIT_ADD_DATAPATH") = SYS_SAGE_EDIT_ADD_DATAPATH;
+        m.attr("EDIT_REMOVE_DATAPATH") = SYS_SAGE_EDIT_REMOVE_DATAPATH;
+        m.attr("EDIT_CHANGE_DATAPATH") = SYS_SAGE_EDIT_CHANGE_DATAPATH;
+
+        install_python_converters();
+
         m.def("test_fcn_integration", [](py::function f, int x, int y) { return f(x, y); });
 
     //bind component class
@@ -326,6 +317,15 @@ PYBIND11_MODULE(sys_sage, m) {
         .def("GetAllDataPathsByType", (vector<DataPath*> (Component::*)(int, int)) &Component::GetAllDataPathsByType,"Get all the data paths associated with the component by type")
         .def("CheckComponentTreeConsistency", &Component::CheckComponentTreeConsistency,"Check if the component tree is consistent")
         .def("GetTopologySize", (int (Component::*)(unsigned*, unsigned*)) (&Component::GetTopologySize),"Get the size of the topology")
+        .def("SetInstances", &Component::SetInstances,"Make the component a prototype of instances with the given ids")
+        .def("GetInstanceCount", &Component::GetInstanceCount,"Get the number of components represented by the component")
+        .def("GetInstanceIds", &Component::GetInstanceIds,"Get the ids of the instances represented by the component")
+        .def("ExpandInstance", &Component::ExpandInstance,"Materialize one instance of the component")
+        .def("ExpandAllInstances", &Component::ExpandAllInstances,"Materialize all instances in the subtree of the component")
+        .def("GetOrExpandSubcomponentById", &Component::GetOrExpandSubcomponentById,"Get a sub component by id, materializing it if it is an instance")
+        .def("CollapseIdenticalChildren", &Component::CollapseIdenticalChildren,"Replace identical subtrees by instances of one prototype")
+        .def("GetHash", &Component::GetHash,"Get the structural hash of the subtree of the component", py::arg("flags") = 0)
+        .def("MarkDirty", &Component::MarkDirty,"Invalidate the cached hash of the component and its ancestors", py::arg("datapaths_only") = false)
         .def("GetDepth", &Component::GetDepth,"Get the depth of the component")
         .def("DeleteDataPath", &Component::DeleteDataPath,"Delete a data path from the component")
         .def("DeleteAllDataPaths", &Component::DeleteAllDataPaths,"Delete all the data paths from the component")
@@ -347,7 +347,7 @@ PYBIND11_MODULE(sys_sage, m) {
     py::class_<Node, std::unique_ptr<Node, py::nodelete>, Component>(m, "Node")
         .def(py::init<int, string>(), py::arg("id") = 0, py::arg("name")= "Node")
         .def(py::init<Component*, int, string>(), py::arg("parent"), py::arg("id") = 0, py::arg("name") = "Node")
-        .def("RefreshCpuCoreFrequency", &Node::RefreshCpuCoreFrequency, py::arg("keep_history")=false,"Refresh the cpu core frequency");
+        .def("RefreshCpuCoreFrequency", &Node::RefreshCpuCoreFrequency, py::arg("keep_history")=false, py::arg("freq_source")=SYS_SAGE_FREQ_SOURCE_PROC_CPUINFO,"Refresh the cpu core frequency");
     // py::class_<Memory, Component>(m, "Memory")
     //     //.def(py::init<long long, bool>(), py::arg("size") = -1, py::arg("isVolatile") = false)
     //     //.def(py::init<Component*,int, string, long long, bool>(), py::arg("parent"), py::arg("id") = 0, py::arg("name") = "Memory", py::arg("size")=-1, py::arg("isVolatile")=false)
@@ -397,10 +397,15 @@ PYBIND11_MODULE(sys_sage, m) {
         .def(py::init<Component*, Component*, int, int>(), py::arg("source"), py::arg("target"), py::arg("oriented"), py::arg("type") = 32)
         .def(py::init<Component*, Component*, int, double, double>(), py::arg("source"), py::arg("target"), py::arg("oriented"), py::arg("bw"), py::arg("latency"))
         .def(py::init<Component*, Component*, int, int, double, double>(), py::arg("source"), py::arg("target"), py::arg("oriented"), py::arg("type"), py::arg("bw"), py::arg("latency"))
+        .def(py::init<Component*, Component*, int, int, double, double, int>(), py::arg("source"), py::arg("target"), py::arg("oriented"), py::arg("type"), py::arg("bw"), py::arg("latency"), py::arg("broadcast_type"))
         .def_property("bandwidth", &DataPath::GetBandwidth, &DataPath::SetBandwidth, "The bandwidth of the data path")
         .def_property("latency", &DataPath::GetLatency, &DataPath::SetLatency, "The latency of the data path")
         .def_property_readonly("type", &DataPath::GetDataPathType, "The type of the data path")
         .def_property_readonly("oriented", &DataPath::GetOrientation, "The orientation of the data path")
+        .def_property_readonly("broadcast_type", &DataPath::GetBroadcastType, "The component type(s) of the targets of a broadcast data path (0 if not a broadcast)")
+        .def("IsBroadcast", &DataPath::IsBroadcast, "Is the data path a broadcast to a subtree")
+        .def("HasTarget", &DataPath::HasTarget, "Does the data path lead to the component")
+        .def("GetTargets", &DataPath::GetTargets, "Get the targets of the data path")
         .def_property("source", &DataPath::GetSource, &DataPath::UpdateSource, "The source of the data path")
         .def_property("target", &DataPath::GetTarget, &DataPath::UpdateTarget, "The target of the data path");
 
@@ -414,10 +419,88 @@ PYBIND11_MODULE(sys_sage, m) {
 
     m.def("parseCapsNumaBenchmark", &parseCapsNumaBenchmark,  py::arg("root"), py::arg("benchmarkPath"), py::arg("delim") = ";");
 
+    py::class_<IngestionPipeline>(m, "IngestionPipeline")
+        .def(py::init<Node*, int>(), py::arg("node"), py::arg("num_threads") = 0)
+        .def("AddSource", &IngestionPipeline::AddSource, "Add a data source; returns its index or -1", py::arg("parser"), py::arg("path"), py::arg("id") = 0, py::arg("delim") = ";")
+        .def("AddDependency", &IngestionPipeline::AddDependency, "Apply a data path source after another one", py::arg("source"), py::arg("depends_on"))
+        .def("Run", &IngestionPipeline::Run, "Run the pipeline; returns the number of failed sources")
+        .def("GetResult", &IngestionPipeline::GetResult, "Return value of the parser of a source", py::arg("source"))
+        .def("PrintTimings", &IngestionPipeline::PrintTimings, "Print the durations of the stages");
+
     m.def("exportToXml", [](Component& root, string xmlPath, py::function print_a) {
         print_attributes = print_a;
         exportToXml(&root, xmlPath,xmldumper);
     },py::arg("root"), py::arg("xmlPath") = "out.xml", py::arg("print_a") = py::none());
+
+    py::class_<XmlExportOptions>(m, "XmlExportOptions")
+        .def(py::init<>())
+        .def_readwrite("component_types", &XmlExportOptions::component_types, "Mask of the exported Component types; the others are flattened")
+        .def_readwrite("max_depth", &XmlExportOptions::max_depth, "Maximum depth below the root of the export; -1: no limit")
+        .def_readwrite("subtree_roots", &XmlExportOptions::subtree_roots, "If not empty, only these subtrees are exported")
+        .def_readwrite("datapath_types", &XmlExportOptions::datapath_types, "Mask of the exported DataPath types")
+        .def_readwrite("filter_attributes", &XmlExportOptions::filter_attributes, "Export only the attributes in attributes")
+        .def_readwrite("attributes", &XmlExportOptions::attributes, "Allow-list of the exported attribute keys")
+        .def_readwrite("datapath_matrix", &XmlExportOptions::datapath_matrix, "Encoding of the DataPath matrices (XML_DATAPATH_MATRIX_*)")
+        .def_readwrite("datapath_matrix_min_size", &XmlExportOptions::datapath_matrix_min_size, "Minimum number of DataPaths of a matrix");
+
+    m.def("exportToXml", [](Component& root, string xmlPath, const XmlExportOptions& options) {
+        return exportToXml(&root, xmlPath, options);
+    },py::arg("root"), py::arg("xmlPath"), py::arg("options"));
+
+    py::class_<XmlLazyLoader>(m, "XmlLazyLoader")
+        .def(py::init<>())
+        .def("Open", &XmlLazyLoader::Open, "Read and index an XML file; returns 0 on success", py::arg("path"))
+        .def("GetNumComponents", &XmlLazyLoader::GetNumComponents, "Number of Components in the file")
+        .def("FindComponent", &XmlLazyLoader::FindComponent, "Index of the first Component with the type and id, or -1", py::arg("componentType"), py::arg("id"))
+        .def("LoadComponent", &XmlLazyLoader::LoadComponent, "Create a Component (and its subtree) and the path to the root", py::arg("index"), py::arg("with_subtree") = true)
+        .def("LoadTopology", &XmlLazyLoader::LoadTopology, "Create the Component Tree down to a depth (-1: all)", py::arg("max_depth") = -1)
+        .def("GetRoot", &XmlLazyLoader::GetRoot, "Root of the created tree")
+        .def("LoadAllDataPaths", &XmlLazyLoader::LoadAllDataPaths, "Load all DataPaths of the created Components");
+
+    py::class_<ChangeTracker>(m, "ChangeTracker")
+        .def(py::init<Component*>(), py::arg("root"))
+        .def("Checkpoint", &ChangeTracker::Checkpoint, "Record the current state of the tree as the checkpoint")
+        .def("GetChanges", [](ChangeTracker& self) -> py::object {
+            vector<Component*> attributes, datapaths;
+            if(self.GetChanges(&attributes, &datapaths) != 0)
+                return py::none();
+            return py::make_tuple(attributes, datapaths);
+        }, "Components whose attributes and whose DataPaths changed since the checkpoint, or None if Components were added or removed")
+        .def("WriteSnapshot", &ChangeTracker::WriteSnapshot, "Export the whole tree and take a checkpoint", py::arg("path"))
+        .def("AppendDelta", &ChangeTracker::AppendDelta, "Append the changes since the checkpoint to a delta log; 2 if a new snapshot is needed", py::arg("path"), py::arg("format") = SYS_SAGE_DELTA_XML)
+        .def("GetSequenceNumber", &ChangeTracker::GetSequenceNumber, "Number of deltas appended so far");
+
+    m.def("ApplyDeltas", [](Component& root, string path, size_t offset) {
+        int applied = ApplyDeltas(&root, path, &offset);
+        return py::make_tuple(applied, offset);
+    }, "Apply the deltas of a log from offset; returns (number of applied deltas or -1, new offset)", py::arg("root"), py::arg("path"), py::arg("offset") = 0);
+
+    py::class_<ComponentKey>(m, "ComponentKey")
+        .def_readonly("type", &ComponentKey::type)
+        .def_readonly("id", &ComponentKey::id)
+        .def_readonly("occurrence", &ComponentKey::occurrence);
+
+    py::class_<TopologyEdit>(m, "TopologyEdit")
+        .def_readonly("op", &TopologyEdit::op)
+        .def_readonly("path", &TopologyEdit::path)
+        .def_readonly("target", &TopologyEdit::target)
+        .def_readonly("position", &TopologyEdit::position)
+        .def_readonly("dp_type", &TopologyEdit::dp_type)
+        .def_readonly("orientation", &TopologyEdit::orientation)
+        .def_readonly("broadcast_type", &TopologyEdit::broadcast_type)
+        .def_readonly("occurrence", &TopologyEdit::occurrence)
+        .def_readonly("component", &TopologyEdit::component)
+        .def_readonly("datapath", &TopologyEdit::datapath);
+
+    m.def("GetComponentPath", &GetComponentPath, "Path of a Component from root (None: the root of the tree)", py::arg("c"), py::arg("root") = nullptr);
+    m.def("FindComponentByPath", &FindComponentByPath, "Component at a path, or None", py::arg("root"), py::arg("path"));
+    m.def("DiffTopologies", [](Component& old_root, Component& new_root) -> py::object {
+        vector<TopologyEdit> edits;
+        if(DiffTopologies(&old_root, &new_root, &edits) != 0)
+            return py::none();
+        return py::cast(edits);
+    }, "Edit script that turns the old tree into the new one, or None if the roots have different types or ids", py::arg("old_root"), py::arg("new_root"));
+    m.def("PatchTopology", &PatchTopology, "Apply an edit script created by DiffTopologies in place; returns 0 on success", py::arg("root"), py::arg("edits"));
 }
 
 
@@ -4,11 +4,21 @@
 //includes all other headers
 #include "Component.hpp"
 #include "DataPath.hpp"
+#include "Attribute.hpp"
+#include "TimeSeries.hpp"
+#include "RefreshScheduler.hpp"
+#include "external_interfaces/nvml_interface.hpp"
 #include "xml_dump.hpp"
 #include "xml_load.hpp"
+#include "ChangeTracker.hpp"
+#include "TopologyDiff.hpp"
 #include "parsers/hwloc.hpp"
 #include "parsers/caps-numa-benchmark.hpp"
 #include "parsers/mt4g.hpp"
 #include "parsers/cccbench.hpp"
+#include "parsers/cpu-cache-benchmark.hpp"
+#include "parsers/sysfs.hpp"
+#include "parsers/config-file.hpp"
+#include "parsers/ingestion.hpp"
 
 #endif //SYS_SAGE
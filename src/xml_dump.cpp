@@ -1,105 +1,115 @@
 #include <sstream>
 #include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <cstring>
 
 #include "xml_dump.hpp"
+#include "Attribute.hpp"
 #include <libxml/parser.h>
 
-std::function<int(string,void*,string*)> search_custom_attrib_key_fcn = NULL;
-std::function<int(string,void*,xmlNodePtr)> search_custom_complex_attrib_key_fcn = NULL;
-
-//methods for printing out default attributes, i.e. those 
+//methods for printing out default attributes, i.e. those registered in the attribute registry (see Attribute.hpp)
 //for a specific key, return the value as a string to be printed in the xml
 int search_default_attrib_key(string key, void* value, string* ret_value_str)
 {
-    //value: uint64_t 
-    if(!key.compare("CATcos") || 
-    !key.compare("CATL3mask") )
-    {
-        *ret_value_str=std::to_string(*(uint64_t*)value);
-        return 1;
-    }
-    //value: long long
-    else if(!key.compare("mig_size") )
-    {
-        *ret_value_str=std::to_string(*(long long*)value);
-        return 1;
-    }
-    //value: int
-    else if(!key.compare("Number_of_streaming_multiprocessors") || 
-    !key.compare("Number_of_cores_in_GPU") || 
-    !key.compare("Number_of_cores_per_SM")  || 
-    !key.compare("Bus_Width_bit") )
-    {
-        *ret_value_str=std::to_string(*(int*)value);
-        return 1;
-    }
-    //value: double
-    else if(!key.compare("Clock_Frequency") )
-    {
-        *ret_value_str=std::to_string(*(double*)value);
-        return 1;
-    }
-    //value: float
-    else if(!key.compare("latency") ||
-    !key.compare("latency_min") ||
-    !key.compare("latency_max") )
-    {
-        *ret_value_str=std::to_string(*(float*)value);
-        return 1;
-    }   
-    //value: string
-    else if(!key.compare("CUDA_compute_capability") || 
-    !key.compare("mig_uuid") )
-    {
-        *ret_value_str=*(string*)value;
-        return 1;
-    }
-
-    return 0;
+    AttributeHandler* h = GetAttributeHandler(key);
+    if(h == NULL || !h->serialize)
+        return 0;
+    *ret_value_str = h->serialize(value);
+    return 1;
 }
 
 int search_default_complex_attrib_key(string key, void* value, xmlNodePtr n)
 {
-    //value: std::vector<std::tuple<long long,double>>*
-    if(!key.compare("freq_history"))
+    AttributeHandler* h = GetAttributeHandler(key);
+    if(h == NULL || !h->serialize_xml)
+        return 0;
+    xmlNodePtr attrib_node = xmlNewNode(NULL, (const unsigned char *)"Attribute");
+    xmlNewProp(attrib_node, (const unsigned char *)"name", (const unsigned char *)key.c_str());
+    xmlAddChild(n, attrib_node);
+    h->serialize_xml(key, value, attrib_node);
+    return 1;
+}
+
+XmlExporter::XmlExporter(std::function<int(string,void*,string*)> _search_custom_attrib_key_fcn, std::function<int(string,void*,xmlNodePtr)> _search_custom_complex_attrib_key_fcn)
+    : search_custom_attrib_key_fcn(_search_custom_attrib_key_fcn), search_custom_complex_attrib_key_fcn(_search_custom_complex_attrib_key_fcn)
+{
+    xmlInitParser();
+}
+
+void XmlExporter::SetOptions(const XmlExportOptions& _options)
+{
+    options = _options;
+    subtree_roots = std::unordered_set<Component*>(options.subtree_roots.begin(), options.subtree_roots.end());
+    attributes = std::unordered_set<string>(options.attributes.begin(), options.attributes.end());
+}
+
+const XmlExportOptions& XmlExporter::GetOptions() const
+{
+    return options;
+}
+
+bool XmlExporter::ExportsAllComponents() const
+{
+    return options.component_types == -1 && options.max_depth < 0 && subtree_roots.empty();
+}
+
+bool XmlExporter::ExportsAttribute(const string& key) const
+{
+    return !options.filter_attributes || attributes.count(key) > 0;
+}
+
+bool XmlExporter::IsMatrixDataPath(DataPath* dp) const
+{
+    if(dp->IsBroadcast())
+        return false;
+    for(auto const& [key, val] : dp->attrib)
     {
-        std::vector<std::tuple<long long,double>>* val = (std::vector<std::tuple<long long,double>>*)value;
+        if(!ExportsAttribute(key))
+            continue;
+        if(search_custom_attrib_key_fcn != NULL || search_custom_complex_attrib_key_fcn != NULL)
+            return false;
+        AttributeHandler* h = GetAttributeHandler(key);
+        if(h == NULL || val == NULL || (h->type != "float" && h->type != "double"))
+            return false;
+    }
+    return true;
+}
 
-        xmlNodePtr attrib_node = xmlNewNode(NULL, (const unsigned char *)"Attribute");
-        xmlNewProp(attrib_node, (const unsigned char *)"name", (const unsigned char *)key.c_str());
-        xmlAddChild(n, attrib_node);
-        for(auto [ ts,freq ] : *val)
+int XmlExporter::ClassifyComponent(Component* c, int depth) const
+{
+    if(options.max_depth >= 0 && depth > options.max_depth)
+        return SYS_SAGE_XML_EXPORT_COMPONENT_NOT_EXPORTED;
+    if(!subtree_roots.empty())
+    {
+        //inside a selected subtree?
+        bool selected = false;
+        for(Component* a = c; a != NULL && !selected; a = a->GetParent())
+            selected = subtree_roots.count(a) > 0;
+        if(!selected)
         {
-            xmlNodePtr attrib = xmlNewNode(NULL, (const unsigned char *)key.c_str());
-            xmlNewProp(attrib, (const unsigned char *)"timestamp", (const unsigned char *)std::to_string(ts).c_str());
-            xmlNewProp(attrib, (const unsigned char *)"frequency", (const unsigned char *)std::to_string(freq).c_str());
-            xmlNewProp(attrib, (const unsigned char *)"unit", (const unsigned char *)"MHz");
-            xmlAddChild(attrib_node, attrib);
+            //on the path to a selected subtree: kept, but flattened if its type is not exported
+            bool on_path = false;
+            for(Component* r : options.subtree_roots)
+                for(Component* a = r->GetParent(); a != NULL && !on_path; a = a->GetParent())
+                    on_path = (a == c);
+            if(!on_path)
+                return SYS_SAGE_XML_EXPORT_COMPONENT_NOT_EXPORTED;
         }
-        return 1;
-    }
-    //value: std::tuple<double, std::string>
-    else if(!key.compare("GPU_Clock_Rate"))
-    {
-        xmlNodePtr attrib_node = xmlNewNode(NULL, (const unsigned char *)"Attribute");
-        xmlNewProp(attrib_node, (const unsigned char *)"name", (const unsigned char *)key.c_str());
-        xmlAddChild(n, attrib_node);
-
-        auto [ freq, unit ] = *(std::tuple<double, std::string>*)value;
-        xmlNodePtr attrib = xmlNewNode(NULL, (const unsigned char *)key.c_str());
-        xmlNewProp(attrib, (const unsigned char *)"frequency", (const unsigned char *)std::to_string(freq).c_str());
-        xmlNewProp(attrib, (const unsigned char *)"unit", (const unsigned char *)unit.c_str());
-        xmlAddChild(attrib_node, attrib);
-        return 1;
     }
-
-    return 0;
+    if(!(c->GetComponentType() & options.component_types))
+        return SYS_SAGE_XML_EXPORT_COMPONENT_FLATTENED;
+    return SYS_SAGE_XML_EXPORT_COMPONENT_EXPORTED;
 }
 
-int print_attrib(map<string,void*> attrib, xmlNodePtr n)
+int XmlExporter::PrintAttrib(const map<string,void*>& attrib, xmlNodePtr n) const
 {
     string attrib_value;
     for (auto const& [key, val] : attrib){
+        if(!ExportsAttribute(key))
+            continue;
         int ret = 0;
         if(search_custom_attrib_key_fcn != NULL)
             ret=search_custom_attrib_key_fcn(key,val,&attrib_value);
@@ -124,33 +134,38 @@ int print_attrib(map<string,void*> attrib, xmlNodePtr n)
     return 1;
 }
 
-xmlNodePtr Memory::CreateXmlSubtree()
+int print_attrib(map<string,void*> attrib, xmlNodePtr n)
+{
+    return XmlExporter().PrintAttrib(attrib, n);
+}
+
+xmlNodePtr Memory::CreateXmlSubtree(const XmlExporter* exporter, const XmlExportState* state, int depth)
 {
-    xmlNodePtr n = Component::CreateXmlSubtree();
+    xmlNodePtr n = Component::CreateXmlSubtree(exporter, state, depth);
     if(size > 0)
         xmlNewProp(n, (const unsigned char *)"size", (const unsigned char *)(std::to_string(size)).c_str());
     xmlNewProp(n, (const unsigned char *)"is_volatile", (const unsigned char *)(std::to_string(is_volatile?1:0)).c_str());
     return n;
 }
-xmlNodePtr Storage::CreateXmlSubtree()
+xmlNodePtr Storage::CreateXmlSubtree(const XmlExporter* exporter, const XmlExportState* state, int depth)
 {
-    xmlNodePtr n = Component::CreateXmlSubtree();
+    xmlNodePtr n = Component::CreateXmlSubtree(exporter, state, depth);
     if(size > 0)
         xmlNewProp(n, (const unsigned char *)"size", (const unsigned char *)(std::to_string(size)).c_str());
     return n;
 }
-xmlNodePtr Chip::CreateXmlSubtree()
+xmlNodePtr Chip::CreateXmlSubtree(const XmlExporter* exporter, const XmlExportState* state, int depth)
 {
-    xmlNodePtr n = Component::CreateXmlSubtree();
+    xmlNodePtr n = Component::CreateXmlSubtree(exporter, state, depth);
     if(!vendor.empty())
         xmlNewProp(n, (const unsigned char *)"vendor", (const unsigned char *)(vendor.c_str()));
     if(!model.empty())
         xmlNewProp(n, (const unsigned char *)"model", (const unsigned char *)(model.c_str()));
     return n;
 }
-xmlNodePtr Cache::CreateXmlSubtree()
+xmlNodePtr Cache::CreateXmlSubtree(const XmlExporter* exporter, const XmlExportState* state, int depth)
 {
-    xmlNodePtr n = Component::CreateXmlSubtree();
+    xmlNodePtr n = Component::CreateXmlSubtree(exporter, state, depth);
     xmlNewProp(n, (const unsigned char *)"cache_level", (const unsigned char *)cache_type.c_str());
     if(cache_size >= 0)
         xmlNewProp(n, (const unsigned char *)"cache_size", (const unsigned char *)(std::to_string(cache_size)).c_str());
@@ -160,75 +175,377 @@ xmlNodePtr Cache::CreateXmlSubtree()
         xmlNewProp(n, (const unsigned char *)"cache_line_size", (const unsigned char *)(std::to_string(cache_line_size)).c_str());
     return n;
 }
-xmlNodePtr Subdivision::CreateXmlSubtree()
+xmlNodePtr Subdivision::CreateXmlSubtree(const XmlExporter* exporter, const XmlExportState* state, int depth)
 {
-    xmlNodePtr n = Component::CreateXmlSubtree();
+    xmlNodePtr n = Component::CreateXmlSubtree(exporter, state, depth);
     xmlNewProp(n, (const unsigned char *)"subdivision_type", (const unsigned char *)(std::to_string(type)).c_str());
     return n;
 }
-xmlNodePtr Numa::CreateXmlSubtree()
+xmlNodePtr Numa::CreateXmlSubtree(const XmlExporter* exporter, const XmlExportState* state, int depth)
 {
-    xmlNodePtr n = Component::CreateXmlSubtree();
+    xmlNodePtr n = Component::CreateXmlSubtree(exporter, state, depth);
     if(size > 0)
         xmlNewProp(n, (const unsigned char *)"size", (const unsigned char *)(std::to_string(size)).c_str());
     return n;
 }
-xmlNodePtr Component::CreateXmlSubtree()
+
+//creates the XML subtree of c, including the properties of its class
+static xmlNodePtr createXmlSubtreeOfType(Component* c, const XmlExporter* exporter, const XmlExportState* state, int depth)
+{
+    switch (c->GetComponentType()) {
+        case SYS_SAGE_COMPONENT_CACHE:
+            return ((Cache*)c)->CreateXmlSubtree(exporter, state, depth);
+        case SYS_SAGE_COMPONENT_SUBDIVISION:
+            return ((Subdivision*)c)->CreateXmlSubtree(exporter, state, depth);
+        case SYS_SAGE_COMPONENT_NUMA:
+            return ((Numa*)c)->CreateXmlSubtree(exporter, state, depth);
+        case SYS_SAGE_COMPONENT_CHIP:
+            return ((Chip*)c)->CreateXmlSubtree(exporter, state, depth);
+        case SYS_SAGE_COMPONENT_MEMORY:
+            return ((Memory*)c)->CreateXmlSubtree(exporter, state, depth);
+        case SYS_SAGE_COMPONENT_STORAGE:
+            return ((Storage*)c)->CreateXmlSubtree(exporter, state, depth);
+        case SYS_SAGE_COMPONENT_NONE:
+        case SYS_SAGE_COMPONENT_THREAD:
+        case SYS_SAGE_COMPONENT_CORE:
+        case SYS_SAGE_COMPONENT_NODE:
+        case SYS_SAGE_COMPONENT_TOPOLOGY:
+        default:
+            return c->CreateXmlSubtree(exporter, state, depth);
+    }
+}
+
+//appends the XML subtrees of the children of c (depth levels below the root of the export) to n; the children flattened by the export options are replaced by their own children
+static void appendChildXmlSubtrees(Component* c, xmlNodePtr n, const XmlExporter* exporter, const XmlExportState* state, int depth)
+{
+    for(Component * child : *c->GetChildren())
+    {
+        int how = exporter->ClassifyComponent(child, depth + 1);
+        if(how == SYS_SAGE_XML_EXPORT_COMPONENT_NOT_EXPORTED)
+            continue;
+        if(how == SYS_SAGE_XML_EXPORT_COMPONENT_FLATTENED)
+        {
+            appendChildXmlSubtrees(child, n, exporter, state, depth + 1);
+            continue;
+        }
+        auto built = state != NULL ? state->prebuilt.find(child) : map<Component*, xmlNodePtr>::const_iterator();
+        if(state != NULL && built != state->prebuilt.end())
+            xmlAddChild(n, built->second);
+        else
+            xmlAddChild(n, createXmlSubtreeOfType(child, exporter, state, depth + 1));
+    }
+}
+
+//addr of c in the export: its index, or the pointer for Components without one (outside of the exported subtree, or without an export state)
+static string componentAddr(const XmlExportState* state, Component* c)
+{
+    if(state != NULL)
+    {
+        auto it = state->indices.find(c);
+        if(it != state->indices.end())
+            return std::to_string(it->second);
+    }
+    std::ostringstream addr;
+    addr << c;
+    return addr.str();
+}
+
+xmlNodePtr Component::CreateXmlSubtree(const XmlExporter* exporter, const XmlExportState* state, int depth)
 {
+    static const XmlExporter default_exporter;
+    if(exporter == NULL)
+        exporter = &default_exporter;
+
     xmlNodePtr n = xmlNewNode(NULL, (const unsigned char *)GetComponentTypeStr().c_str());
     xmlNewProp(n, (const unsigned char *)"id", (const unsigned char *)(std::to_string(id)).c_str());
     xmlNewProp(n, (const unsigned char *)"name", (const unsigned char *)name.c_str());
     if(count > 0)
         xmlNewProp(n, (const unsigned char *)"count", (const unsigned char *)(std::to_string(count)).c_str());
-    std::ostringstream addr;
-    addr << this;
-    xmlNewProp(n, (const unsigned char *)"addr", (const unsigned char *)(addr.str().c_str()));
+    if(!instance_ids.empty()){
+        string ids;
+        for(int i : instance_ids)
+            ids += (ids.empty() ? "" : ",") + std::to_string(i);
+        xmlNewProp(n, (const unsigned char *)"instance_ids", (const unsigned char *)ids.c_str());
+    }
+    xmlNewProp(n, (const unsigned char *)"addr", (const unsigned char *)(componentAddr(state, this).c_str()));
+
+    exporter->PrintAttrib(attrib, n);
+
+    appendChildXmlSubtrees(this, n, exporter, state, depth);
+
+    return n;
+}
+
+//calls fcn(i) for i in [0,n) on up to num_threads threads (including the calling one)
+static void parallelFor(int num_threads, size_t n, std::function<void(size_t)> fcn)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for(size_t i = next++; i < n; i = next++)
+            fcn(i);
+    };
+    vector<std::thread> threads;
+    for(int i = 1; i < std::min<int>(num_threads, n); i++)
+        threads.emplace_back(worker);
+    worker();
+    for(std::thread& t : threads)
+        t.join();
+}
+
+//appends the Components of the subtree of c exported by the export options to out, in the order of the export (the flattened ones are skipped)
+static void getExportedComponents(const XmlExporter* exporter, Component* c, int depth, vector<Component*>* out)
+{
+    int how = depth == 0 ? SYS_SAGE_XML_EXPORT_COMPONENT_EXPORTED : exporter->ClassifyComponent(c, depth);
+    if(how == SYS_SAGE_XML_EXPORT_COMPONENT_NOT_EXPORTED)
+        return;
+    if(how == SYS_SAGE_XML_EXPORT_COMPONENT_EXPORTED)
+        out->push_back(c);
+    for(Component* child : *c->GetChildren())
+        getExportedComponents(exporter, child, depth + 1, out);
+}
+
+//creates the (unlinked) datapath node of dp
+static xmlNodePtr createDataPathNode(const XmlExporter* exporter, const XmlExportState* state, DataPath* dpPtr)
+{
+    xmlNodePtr dp_n = xmlNewNode(NULL, BAD_CAST "datapath");
+    xmlNewProp(dp_n, (const unsigned char *)"source", (const unsigned char *)(componentAddr(state, dpPtr->GetSource()).c_str()));
+    xmlNewProp(dp_n, (const unsigned char *)"target", (const unsigned char *)(componentAddr(state, dpPtr->GetTarget()).c_str()));
+    xmlNewProp(dp_n, (const unsigned char *)"oriented", (const unsigned char *)(std::to_string(dpPtr->GetOrientation())).c_str());
+    xmlNewProp(dp_n, (const unsigned char *)"dp_type", (const unsigned char *)(std::to_string(dpPtr->GetDataPathType())).c_str());
+    xmlNewProp(dp_n, (const unsigned char *)"bw", (const unsigned char *)(std::to_string(dpPtr->GetBandwidth())).c_str());
+    xmlNewProp(dp_n, (const unsigned char *)"latency", (const unsigned char *)(std::to_string(dpPtr->GetLatency())).c_str());
+    if(dpPtr->IsBroadcast())
+        xmlNewProp(dp_n, (const unsigned char *)"broadcast_type", (const unsigned char *)(std::to_string(dpPtr->GetBroadcastType())).c_str());
+
+    exporter->PrintAttrib(dpPtr->attrib, dp_n);
+    return dp_n;
+}
+
+//creates the datapath nodes of the DataPaths incoming to c (unlinked, in the order of the export); exported - if not NULL, only the DataPaths with both ends in it are created; matrix - if not NULL, the DataPaths that may be written as cells of a datapath-matrix are collected there instead
+static void createDataPathNodes(const XmlExporter* exporter, const XmlExportState* state, Component* c, const std::unordered_map<Component*, size_t>* exported, vector<xmlNodePtr>* out, vector<DataPath*>* matrix)
+{
+    int dp_types = exporter->GetOptions().datapath_types;
+    vector<DataPath*>* dpList = c->GetDataPaths(SYS_SAGE_DATAPATH_INCOMING);
+    set<DataPath*> printed_dp;
+
+    for(DataPath* dpPtr : *dpList)
+    {
+        //check if previously processed
+        if (printed_dp.find(dpPtr) == printed_dp.end())
+        {
+            if(!(dpPtr->GetDataPathType() & dp_types) || (exported != NULL && (exported->count(dpPtr->GetSource()) == 0 || exported->count(dpPtr->GetTarget()) == 0)))
+                continue;
+            if(matrix != NULL && exporter->IsMatrixDataPath(dpPtr))
+                matrix->push_back(dpPtr);
+            else
+                out->push_back(createDataPathNode(exporter, state, dpPtr));
+
+            printed_dp.insert(dpPtr);
+        }
+    }
+}
 
-    print_attrib(attrib, n);
+//formats a value of a DataPath matrix: the short form if it restores the value exactly
+static string formatMatrixValue(double v, bool is_float)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), is_float ? "%.7g" : "%.15g", v);
+    if(!std::isnan(v) && (is_float ? (float)strtod(buf, NULL) != (float)v : strtod(buf, NULL) != v))
+        snprintf(buf, sizeof(buf), is_float ? "%.9g" : "%.17g", v);
+    return buf;
+}
 
-    for(Component * c : children)
+//appends one matrix (row-major; cells - the DataPath of each cell, or NULL) to a values node: as the constant property if all DataPaths have the same value, otherwise as text or as base64 of little-endian binary numbers (stored as float if all values of a double matrix are floats; cells without a DataPath are 0)
+static void printMatrixValues(xmlNodePtr values_n, const vector<double>& values, const vector<DataPath*>& cells, size_t cols, bool is_float, int encoding)
+{
+    bool constant = true, fits_float = true;
+    double first = 0;
+    bool have_first = false;
+    for(size_t i = 0; i < values.size(); i++)
     {
-        xmlNodePtr child;
-        switch (c->GetComponentType()) {
-            case SYS_SAGE_COMPONENT_CACHE:
-                child = ((Cache*)c)->CreateXmlSubtree();
-                break;
-            case SYS_SAGE_COMPONENT_SUBDIVISION:
-                child = ((Subdivision*)c)->CreateXmlSubtree();
-                break;
-            case SYS_SAGE_COMPONENT_NUMA:
-                child = ((Numa*)c)->CreateXmlSubtree();
-                break;
-            case SYS_SAGE_COMPONENT_CHIP:
-                child = ((Chip*)c)->CreateXmlSubtree();
-                break;
-            case SYS_SAGE_COMPONENT_MEMORY:
-                child = ((Memory*)c)->CreateXmlSubtree();
-                break;
-            case SYS_SAGE_COMPONENT_STORAGE:
-                child = ((Storage*)c)->CreateXmlSubtree();
-                break;
-            case SYS_SAGE_COMPONENT_NONE:
-            case SYS_SAGE_COMPONENT_THREAD:
-            case SYS_SAGE_COMPONENT_CORE:
-            case SYS_SAGE_COMPONENT_NODE:
-            case SYS_SAGE_COMPONENT_TOPOLOGY:
-            default:
-                child = c->CreateXmlSubtree();
-                break;
-        };
+        if(cells[i] == NULL)
+            continue;
+        if(!have_first){
+            first = values[i];
+            have_first = true;
+        }
+        else if(values[i] != first && !(std::isnan(values[i]) && std::isnan(first)))
+            constant = false;
+        if(!std::isnan(values[i]) && (double)(float)values[i] != values[i])
+            fits_float = false;
+    }
+    if(constant)
+    {
+        xmlNewProp(values_n, (const unsigned char *)"constant", (const unsigned char *)formatMatrixValue(first, is_float).c_str());
+        return;
+    }
+    if(!is_float && fits_float)
+    {
+        xmlNewProp(values_n, (const unsigned char *)"precision", (const unsigned char *)"float");
+        is_float = true;
+    }
 
-        xmlAddChild(n, child);
+    string out;
+    if(encoding == SYS_SAGE_XML_DATAPATH_MATRIX_BASE64)
+    {
+        string bin;
+        bin.reserve(values.size() * (is_float ? 4 : 8));
+        for(size_t i = 0; i < values.size(); i++)
+        {
+            double v = cells[i] == NULL ? 0 : values[i];
+            uint64_t bits = 0;
+            int bytes = 8;
+            if(is_float){
+                float f = (float)v;
+                uint32_t fbits;
+                memcpy(&fbits, &f, sizeof(f));
+                bits = fbits;
+                bytes = 4;
+            }
+            else
+                memcpy(&bits, &v, sizeof(v));
+            for(int b = 0; b < bytes; b++)
+                bin.push_back((char)((bits >> (8 * b)) & 0xff));
+        }
+        out = Base64Encode(bin);
     }
+    else
+    {
+        for(size_t i = 0; i < values.size(); i++)
+        {
+            out += cells[i] == NULL ? "0" : formatMatrixValue(values[i], is_float);
+            out += ((i + 1) % cols == 0) ? '\n' : ' ';
+        }
+    }
+    xmlNodeAddContent(values_n, BAD_CAST out.c_str());
+}
 
+//creates the datapath-matrix nodes of the collected DataPaths: one per group with the same source Node, type, orientation and attribute keys; the DataPaths of groups that are too small or too sparse (or that contain two DataPaths between the same Components) are created as datapath nodes
+static void createDataPathMatrixNodes(const XmlExporter* exporter, const XmlExportState* state, const vector<DataPath*>& matrix, vector<xmlNodePtr>* out)
+{
+    const XmlExportOptions& options = exporter->GetOptions();
+    //groups: (Node of the source, type, orientation, attribute keys); the Nodes are numbered in the order of the export
+    map<tuple<int, int, int, vector<string>>, vector<DataPath*>> groups;
+    map<Component*, int> nodes;
+    set<DataPath*> seen;
+    for(DataPath* dp : matrix)
+    {
+        //a bidirectional DataPath is an incoming DataPath of both of its ends
+        if(!seen.insert(dp).second)
+            continue;
+        vector<string> keys;
+        for(auto const& [key, val] : dp->attrib)
+            if(exporter->ExportsAttribute(key))
+                keys.push_back(key);
+        Component* node = dp->GetSource()->GetAncestorByType(SYS_SAGE_COMPONENT_NODE);
+        int node_idx = nodes.emplace(node, nodes.size()).first->second;
+        groups[std::make_tuple(node_idx, dp->GetDataPathType(), dp->GetOrientation(), keys)].push_back(dp);
+    }
 
-    return n;
+    for(auto const& [group, dps] : groups)
+    {
+        auto const& [node_idx, dp_type, oriented, keys] = group;
+        vector<Component*> sources, targets;
+        map<Component*, size_t> src_idx, trg_idx;
+        for(DataPath* dp : dps)
+        {
+            if(src_idx.emplace(dp->GetSource(), sources.size()).second)
+                sources.push_back(dp->GetSource());
+            if(trg_idx.emplace(dp->GetTarget(), targets.size()).second)
+                targets.push_back(dp->GetTarget());
+        }
+        size_t rows = sources.size(), cols = targets.size();
+        vector<DataPath*> cells;
+        bool dense = dps.size() >= options.datapath_matrix_min_size && dps.size() * 2 >= rows * cols;
+        if(dense)
+        {
+            cells.assign(rows * cols, NULL);
+            for(DataPath* dp : dps)
+            {
+                DataPath*& cell = cells[src_idx[dp->GetSource()] * cols + trg_idx[dp->GetTarget()]];
+                if(cell != NULL){
+                    dense = false;
+                    break;
+                }
+                cell = dp;
+            }
+        }
+        if(!dense)
+        {
+            for(DataPath* dp : dps)
+                out->push_back(createDataPathNode(exporter, state, dp));
+            continue;
+        }
+
+        xmlNodePtr m_n = xmlNewNode(NULL, BAD_CAST "datapath-matrix");
+        xmlNewProp(m_n, (const unsigned char *)"oriented", (const unsigned char *)(std::to_string(oriented)).c_str());
+        xmlNewProp(m_n, (const unsigned char *)"dp_type", (const unsigned char *)(std::to_string(dp_type)).c_str());
+        xmlNewProp(m_n, (const unsigned char *)"rows", (const unsigned char *)(std::to_string(rows)).c_str());
+        xmlNewProp(m_n, (const unsigned char *)"cols", (const unsigned char *)(std::to_string(cols)).c_str());
+        xmlNewProp(m_n, (const unsigned char *)"encoding", (const unsigned char *)(options.datapath_matrix == SYS_SAGE_XML_DATAPATH_MATRIX_BASE64 ? "base64" : "text"));
+        for(auto [name, components] : {std::make_pair("sources", &sources), std::make_pair("targets", &targets)})
+        {
+            string addrs;
+            for(size_t i = 0; i < components->size(); i++)
+                addrs += (i == 0 ? "" : " ") + componentAddr(state, (*components)[i]);
+            xmlNewTextChild(m_n, NULL, BAD_CAST name, BAD_CAST addrs.c_str());
+        }
+        //which cells have a DataPath (omitted if all of them): one 0/1 character per cell, or base64 of a bitmap (least significant bit first)
+        if(dps.size() < rows * cols)
+        {
+            string present;
+            if(options.datapath_matrix == SYS_SAGE_XML_DATAPATH_MATRIX_BASE64)
+            {
+                string bin((cells.size() + 7) / 8, 0);
+                for(size_t i = 0; i < cells.size(); i++)
+                    if(cells[i] != NULL)
+                        bin[i / 8] |= (char)(1 << (i % 8));
+                present = Base64Encode(bin);
+            }
+            else
+            {
+                for(size_t i = 0; i < cells.size(); i++)
+                {
+                    present += cells[i] != NULL ? '1' : '0';
+                    if((i + 1) % cols == 0)
+                        present += '\n';
+                }
+            }
+            xmlNewTextChild(m_n, NULL, BAD_CAST "cells", BAD_CAST present.c_str());
+        }
+
+        //bw, latency and the attributes, each as one matrix
+        vector<string> names = {"bw", "latency"};
+        names.insert(names.end(), keys.begin(), keys.end());
+        for(size_t k = 0; k < names.size(); k++)
+        {
+            bool is_float = k >= 2 && GetAttributeHandler(names[k])->type == "float";
+            vector<double> values(rows * cols, 0);
+            for(size_t i = 0; i < cells.size(); i++)
+            {
+                DataPath* dp = cells[i];
+                if(dp == NULL)
+                    continue;
+                if(k == 0)
+                    values[i] = dp->GetBandwidth();
+                else if(k == 1)
+                    values[i] = dp->GetLatency();
+                else
+                    values[i] = is_float ? *(float*)dp->attrib[names[k]] : *(double*)dp->attrib[names[k]];
+            }
+            xmlNodePtr values_n = xmlNewChild(m_n, NULL, BAD_CAST "values", NULL);
+            xmlNewProp(values_n, (const unsigned char *)"name", (const unsigned char *)names[k].c_str());
+            xmlNewProp(values_n, (const unsigned char *)"type", (const unsigned char *)(is_float ? "float" : "double"));
+            printMatrixValues(values_n, values, cells, cols, is_float, options.datapath_matrix);
+        }
+        out->push_back(m_n);
+    }
 }
 
-int exportToXml(Component* root, string path, std::function<int(string,void*,string*)> _search_custom_attrib_key_fcn, std::function<int(string,void*,xmlNodePtr)> _search_custom_complex_attrib_key_fcn)
+xmlDocPtr XmlExporter::CreateDocument(Component* root, int num_threads) const
 {
-    search_custom_attrib_key_fcn=_search_custom_attrib_key_fcn;
-    search_custom_complex_attrib_key_fcn=_search_custom_complex_attrib_key_fcn;
+    if(num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
 
     xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
 
@@ -239,48 +556,124 @@ int exportToXml(Component* root, string path, std::function<int(string,void*,str
     xmlNodePtr data_paths_root = xmlNewNode(NULL, BAD_CAST "data-paths");
     xmlAddChild(sys_sage_root, data_paths_root);
 
-    //build a tree for Components
-    xmlNodePtr n = root->CreateXmlSubtree();
-    xmlAddChild(components_root, n);
-
-    //scan all Components for their DataPaths
+    //the exported Components in the DFS order of the export; their positions are their addresses in the file
+    XmlExportState state;
     vector<Component*> components;
-    root->GetComponentsInSubtree(&components);
-    std::cout << "Number of components to export: " << components.size() << std::endl;
-    for(Component* cPtr : components)
-    {
-        vector<DataPath*>* dpList = cPtr->GetDataPaths(SYS_SAGE_DATAPATH_INCOMING);
-        set<DataPath*> printed_dp;
+    if(ExportsAllComponents())
+        root->GetComponentsInSubtree(&components);
+    else
+        getExportedComponents(this, root, 0, &components);
+    state.indices.reserve(components.size());
+    for(size_t i = 0; i < components.size(); i++)
+        state.indices[components[i]] = i;
 
-        for(DataPath* dpPtr : *dpList)
-        {
-            //check if previously processed
-            if (printed_dp.find(dpPtr) == printed_dp.end())
+    //build a tree for Components
+    if(num_threads > 1)
+    {
+        //the lazily imported DataPaths (see XmlLazyLoader) are loaded now: loading them from the worker threads would modify the DataPath lists of Components that other threads read
+        for(Component* c : components)
+            c->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING);
+        //chunks: the first level of the exported tree (below the root) with enough Components to keep the threads busy; the flattened Components are replaced by their exported descendants
+        vector<pair<Component*, int>> chunks;
+        std::function<void(Component*, int)> addChildren = [&](Component* c, int depth) {
+            for(Component* child : *c->GetChildren())
             {
-                xmlNodePtr dp_n = xmlNewNode(NULL, BAD_CAST "datapath");
-                std::ostringstream src_addr;
-                src_addr << dpPtr->GetSource();
-                std::ostringstream target_addr;
-                target_addr << dpPtr->GetTarget();
-                xmlNewProp(dp_n, (const unsigned char *)"source", (const unsigned char *)(src_addr.str().c_str()));
-                xmlNewProp(dp_n, (const unsigned char *)"target", (const unsigned char *)(target_addr.str().c_str()));
-                xmlNewProp(dp_n, (const unsigned char *)"oriented", (const unsigned char *)(std::to_string(dpPtr->GetOrientation())).c_str());
-                xmlNewProp(dp_n, (const unsigned char *)"dp_type", (const unsigned char *)(std::to_string(dpPtr->GetDataPathType())).c_str());
-                xmlNewProp(dp_n, (const unsigned char *)"bw", (const unsigned char *)(std::to_string(dpPtr->GetBandwidth())).c_str());
-                xmlNewProp(dp_n, (const unsigned char *)"latency", (const unsigned char *)(std::to_string(dpPtr->GetLatency())).c_str());
-                xmlAddChild(data_paths_root, dp_n);
-
-                print_attrib(dpPtr->attrib, dp_n);
-
-                printed_dp.insert(dpPtr);
+                int how = ClassifyComponent(child, depth + 1);
+                if(how == SYS_SAGE_XML_EXPORT_COMPONENT_EXPORTED)
+                    chunks.push_back({child, depth + 1});
+                else if(how == SYS_SAGE_XML_EXPORT_COMPONENT_FLATTENED)
+                    addChildren(child, depth + 1);
+            }
+        };
+        addChildren(root, 0);
+        while(chunks.size() < (size_t)SYS_SAGE_XML_EXPORT_CHUNKS_PER_THREAD * num_threads)
+        {
+            vector<pair<Component*, int>> level;
+            level.swap(chunks);
+            for(auto const& [c, depth] : level)
+                addChildren(c, depth);
+            if(chunks.empty()){
+                chunks.swap(level);
+                break;
             }
         }
+        //the subtrees of the chunks are built in parallel; the Components above them (and the leaves above their level) by the serial pass below
+        vector<xmlNodePtr> chunk_nodes(chunks.size());
+        parallelFor(num_threads, chunks.size(), [&](size_t i) {
+            chunk_nodes[i] = createXmlSubtreeOfType(chunks[i].first, this, &state, chunks[i].second);
+        });
+        for(size_t i = 0; i < chunks.size(); i++)
+            state.prebuilt[chunks[i].first] = chunk_nodes[i];
+    }
+    xmlNodePtr n = root->CreateXmlSubtree(this, &state, 0);
+    xmlAddChild(components_root, n);
+
+    //scan all exported Components for their DataPaths
+    //partitions of consecutive Components are processed in parallel and concatenated in order
+    size_t partitions = options.datapath_types == 0 ? 0 : num_threads > 1 ? std::min<size_t>(components.size(), (size_t)SYS_SAGE_XML_EXPORT_CHUNKS_PER_THREAD * num_threads) : 1;
+    vector<vector<xmlNodePtr>> dp_nodes(partitions);
+    vector<vector<DataPath*>> matrix_dps(partitions);
+    bool matrix = options.datapath_matrix != SYS_SAGE_XML_DATAPATH_MATRIX_NONE;
+    parallelFor(num_threads, partitions, [&](size_t p) {
+        size_t begin = components.size() * p / partitions, end = components.size() * (p + 1) / partitions;
+        for(size_t i = begin; i < end; i++)
+            createDataPathNodes(this, &state, components[i], ExportsAllComponents() ? NULL : &state.indices, &dp_nodes[p], matrix ? &matrix_dps[p] : NULL);
+    });
+    for(auto const& partition : dp_nodes)
+        for(xmlNodePtr dp_n : partition)
+            xmlAddChild(data_paths_root, dp_n);
+    if(matrix)
+    {
+        //the DataPath matrices follow the datapath elements
+        vector<DataPath*> all_matrix_dps;
+        for(auto const& partition : matrix_dps)
+            all_matrix_dps.insert(all_matrix_dps.end(), partition.begin(), partition.end());
+        vector<xmlNodePtr> matrix_nodes;
+        createDataPathMatrixNodes(this, &state, all_matrix_dps, &matrix_nodes);
+        for(xmlNodePtr n : matrix_nodes)
+            xmlAddChild(data_paths_root, n);
     }
 
-    xmlSaveFormatFileEnc(path=="" ? "-" : path.c_str(), doc, "UTF-8", 1);
+    return doc;
+}
 
+int XmlExporter::Export(Component* root, string path, int num_threads) const
+{
+    xmlDocPtr doc = CreateDocument(root, num_threads);
+    int ret = xmlSaveFormatFileEnc(path=="" ? "-" : path.c_str(), doc, "UTF-8", 1);
     xmlFreeDoc(doc);
-    xmlCleanupParser();
-
+    if(ret < 0){
+        std::cerr << "exportToXml: could not write " << path << std::endl;
+        return 1;
+    }
     return 0;
 }
+
+int exportToXml(Component* root, string path, std::function<int(string,void*,string*)> search_custom_attrib_key_fcn, std::function<int(string,void*,xmlNodePtr)> search_custom_complex_attrib_key_fcn)
+{
+    return XmlExporter(search_custom_attrib_key_fcn, search_custom_complex_attrib_key_fcn).Export(root, path);
+}
+
+int exportToXml(Component* root, string path, const XmlExportOptions& options)
+{
+    XmlExporter exporter;
+    exporter.SetOptions(options);
+    return exporter.Export(root, path);
+}
+
+int exportToXmlBatch(const vector<Component*>& roots, const vector<string>& paths, int num_threads, const XmlExporter& exporter)
+{
+    if(roots.size() != paths.size()){
+        std::cerr << "exportToXmlBatch: " << roots.size() << " roots but " << paths.size() << " paths" << std::endl;
+        return std::max(roots.size(), paths.size());
+    }
+    if(num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::atomic<int> failed(0);
+    parallelFor(num_threads, roots.size(), [&](size_t i) {
+        if(exporter.Export(roots[i], paths[i]) != 0)
+            failed++;
+    });
+    return failed;
+}
@@ -2,25 +2,152 @@
 #define XML_DUMP
 
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "Component.hpp"
 #include "DataPath.hpp"
 
+#define SYS_SAGE_XML_EXPORT_CHUNKS_PER_THREAD 8 /**< Parallel export: number of subtrees (and of DataPath partitions) per thread, for load balancing. */
+
+#define SYS_SAGE_XML_EXPORT_COMPONENT_NOT_EXPORTED 0 /**< XmlExporter::ClassifyComponent(): neither the Component nor its descendants are exported. */
+#define SYS_SAGE_XML_EXPORT_COMPONENT_FLATTENED 1 /**< XmlExporter::ClassifyComponent(): the Component is not exported, its exported descendants are attached to its closest exported ancestor. */
+#define SYS_SAGE_XML_EXPORT_COMPONENT_EXPORTED 2 /**< XmlExporter::ClassifyComponent(): the Component is exported. */
+
+#define SYS_SAGE_XML_DATAPATH_MATRIX_NONE 0 /**< XmlExportOptions::datapath_matrix: every DataPath is written as a datapath element. */
+#define SYS_SAGE_XML_DATAPATH_MATRIX_TEXT 1 /**< XmlExportOptions::datapath_matrix: the values of the matrices are written as text. */
+#define SYS_SAGE_XML_DATAPATH_MATRIX_BASE64 2 /**< XmlExportOptions::datapath_matrix: the values of the matrices are written as base64 of little-endian binary numbers. */
+#define SYS_SAGE_XML_DATAPATH_MATRIX_MIN_SIZE 16 /**< Default XmlExportOptions::datapath_matrix_min_size. */
+
+/**
+ * Selects the parts of the Component Tree written by the XML export. The filters are applied while the tree is traversed, so the excluded parts are not visited at all (except for the flattened Components).
+ * \n The root of the export is always exported. The default options export everything.
+ */
+struct XmlExportOptions {
+    int component_types = -1; /**< Mask of the exported Component types (SYS_SAGE_COMPONENT_*). The Components of other types are flattened: their exported descendants are attached to their closest exported ancestor. Default: all types */
+    int max_depth = -1; /**< Components more than max_depth levels below the root of the export are not exported (nor are their descendants). -1 (default): no limit */
+    vector<Component*> subtree_roots; /**< If not empty, only the subtrees of these Components are exported, plus the Components on the path from the root of the export to them. */
+    int datapath_types = -1; /**< Mask of the exported DataPath types (SYS_SAGE_DATAPATH_TYPE_*); 0 exports no DataPaths. Only the DataPaths whose source and target are both exported are written. Default: all types */
+    bool filter_attributes = false; /**< If true, only the attributes listed in attributes are exported (of both Components and DataPaths). */
+    vector<string> attributes; /**< Allow-list of the exported attribute keys, used if filter_attributes is true. */
+    int datapath_matrix = SYS_SAGE_XML_DATAPATH_MATRIX_NONE; /**< Encoding of the DataPath matrices (SYS_SAGE_XML_DATAPATH_MATRIX_*). If not NONE, the DataPaths with the same type, orientation and attribute keys whose sources are in the same Node (e.g. the cccbench or the caps-numa DataPaths of a Node) are written as one datapath-matrix element: the addresses of the sources and targets are listed once, followed by one dense row-major matrix per value (bw, latency and each attribute). Only the DataPaths that are not broadcast and whose attributes are all float or double values of the attribute registry qualify (no attributes with custom attribute callbacks). The values are stored exactly: a matrix whose values are all equal is written as one constant, and a double matrix whose values are all floats is stored as floats. */
+    size_t datapath_matrix_min_size = SYS_SAGE_XML_DATAPATH_MATRIX_MIN_SIZE; /**< Minimum number of DataPaths of a matrix; smaller groups, and groups that fill less than half of their matrix, are written as datapath elements. */
+};
+
+/**
+ * @private
+ * State of one export (see XmlExporter::CreateDocument()), read by Component::CreateXmlSubtree().
+ */
+struct XmlExportState {
+    map<Component *, xmlNodePtr> prebuilt; /**< XML subtrees of some Components already created by the parallel export, inserted instead of creating them again */
+    std::unordered_map<Component *, size_t> indices; /**< Index of each exported Component, written as its addr (and as the ends of the DataPaths): the position in the DFS order of the export */
+};
+
+/**
+ * Context of the XML export: holds the custom attribute callbacks and the export options, so that multiple exports (also with different callbacks) can run concurrently.
+ * \n Export() does not modify the exporter, so one XmlExporter may be shared by multiple threads, as long as each thread exports a different topology (or the topologies are not modified during the export).
+ */
+class XmlExporter {
+public:
+    /**
+     * @param _search_custom_attrib_key_fcn - for a key, prints the value of a custom attribute into the string; returns 1 if the attribute was handled, 0 otherwise
+     * @param _search_custom_complex_attrib_key_fcn - for a key, adds a custom attribute as child nodes of the xmlNode; returns 1 if the attribute was handled, 0 otherwise
+     */
+    XmlExporter(std::function<int(string, void *, string *)> _search_custom_attrib_key_fcn = NULL, std::function<int(string, void *, xmlNodePtr)> _search_custom_complex_attrib_key_fcn = NULL);
+    /**
+     * Sets the filters of the export (see XmlExportOptions).
+     */
+    void SetOptions(const XmlExportOptions &_options);
+    /**
+     * @return the filters of the export
+     */
+    const XmlExportOptions &GetOptions() const;
+    /**
+     * Exports the Component Tree to an XML file.
+     * @param root - root of the exported subtree
+     * @param path - path of the XML file; "" prints to stdout
+     * @param num_threads - number of threads creating the XML document (see CreateDocument()); default 1
+     * @return 0 on success, 1 if the file could not be written
+     */
+    int Export(Component *root, string path = "", int num_threads = 1) const;
+    /**
+     * Creates the XML document of the Component Tree (the caller frees it with xmlFreeDoc()).
+     * \n With num_threads > 1, the subtrees of the first level of the tree with at least SYS_SAGE_XML_EXPORT_CHUNKS_PER_THREAD * num_threads Components are created in parallel, and so are the DataPaths of consecutive partitions of the Components; the parts are joined in the order of the serial export, so the document is identical. The custom attribute callbacks are then called concurrently and must be thread-safe.
+     * @param root - root of the exported subtree
+     * @param num_threads - number of threads; 1 (default) creates the document serially, 0 uses std::thread::hardware_concurrency()
+     */
+    xmlDocPtr CreateDocument(Component *root, int num_threads = 1) const;
+    /**
+     * @private
+     * Prints the attributes (custom callbacks first, then the attribute registry) as Attribute children of n.
+     */
+    int PrintAttrib(const map<string, void *> &attrib, xmlNodePtr n) const;
+    /**
+     * @private
+     * How the export options treat the Component c, depth levels below the root of the export.
+     * @return SYS_SAGE_XML_EXPORT_COMPONENT_NOT_EXPORTED, SYS_SAGE_XML_EXPORT_COMPONENT_FLATTENED or SYS_SAGE_XML_EXPORT_COMPONENT_EXPORTED
+     */
+    int ClassifyComponent(Component *c, int depth) const;
+    /**
+     * @private
+     * @return true if the options export all Components (no type mask, depth limit nor subtree roots)
+     */
+    bool ExportsAllComponents() const;
+    /**
+     * @private
+     * @return true if the options export the attribute key
+     */
+    bool ExportsAttribute(const string &key) const;
+    /**
+     * @private
+     * @return true if dp may be written as a cell of a datapath-matrix (see XmlExportOptions::datapath_matrix)
+     */
+    bool IsMatrixDataPath(DataPath *dp) const;
+
+private:
+    XmlExportOptions options;
+    std::unordered_set<Component *> subtree_roots;
+    std::unordered_set<string> attributes;
+
+    std::function<int(string, void *, string *)> search_custom_attrib_key_fcn;
+    std::function<int(string, void *, xmlNodePtr)> search_custom_complex_attrib_key_fcn;
+};
+
 /**
  * Exports the Component Tree to an XML file.
+ * \n Equivalent to XmlExporter(search_custom_attrib_key_fcn, search_custom_complex_attrib_key_fcn).Export(root, path).
  */
 int exportToXml(Component *root, string path = "", std::function<int(string, void *, string *)> search_custom_attrib_key_fcn = NULL, std::function<int(string, void *, xmlNodePtr)> search_custom_complex_attrib_key_fcn = NULL);
 
+/**
+ * Exports the selected parts of the Component Tree to an XML file (default attributes only).
+ * @param root - root of the exported subtree
+ * @param path - path of the XML file; "" prints to stdout
+ * @param options - the filters of the export
+ * @return 0 on success, 1 if the file could not be written
+ */
+int exportToXml(Component *root, string path, const XmlExportOptions &options);
+
+/**
+ * Exports multiple Component Trees, each to its own XML file, on a pool of threads.
+ * @param roots - roots of the exported subtrees (distinct topologies)
+ * @param paths - the XML file of each root
+ * @param num_threads - number of threads; 0 (default) uses std::thread::hardware_concurrency()
+ * @param exporter - the export context shared by all exports
+ * @return 0 on success, otherwise the number of files that could not be written (also when the sizes of roots and paths differ)
+ */
+int exportToXmlBatch(const vector<Component *> &roots, const vector<string> &paths, int num_threads = 0, const XmlExporter &exporter = XmlExporter());
+
 /**
  * @private
- * For searching default attributes, i.e. those 
+ * For searching default attributes, i.e. those
     for a specific key, return the value as a string to be printed in the xml
  */
 int search_default_attrib_key(string key, void *value, string *ret_value_str);
 
 /**
  * @private
- * Prints the attributes.
+ * Prints the attributes (default attributes only).
  */
 int print_attrib(map<string, void *> attrib, xmlNodePtr n);
 #endif
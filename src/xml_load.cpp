@@ -1,30 +1,31 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <functional>
+#include <sstream>
 #include <string>
 #include <sys/types.h>
+#include <thread>
 #include <tuple>
 #include <vector>
 
 #include "xml_load.hpp"
+#include "Attribute.hpp"
 
 using namespace std;
 
 #import <libxml/parser.h>
 
-// Function pointer for custom attribute key search
-std::function<void*(xmlNodePtr)> search_custom_attrib_key_fcn = NULL;
-
-// Function pointer for custom complex attribute key search
-std::function<int(xmlNodePtr, Component *)>
-    search_custom_complex_attrib_key_fcn = NULL;
-
-// Create map of addresses to Components created
-// this is used to create the Datapaths
-std::map<string, Component *> addr_to_component;
-
 //Helper-Function to retrieve string from xml-node
 std::string getStringFromProp(xmlNodePtr n, string prop) {
   const unsigned char *v = xmlGetProp(n, (const unsigned char *)prop.c_str());
@@ -33,105 +34,32 @@ std::string getStringFromProp(xmlNodePtr n, string prop) {
 }
 
 // Extract attribute value from xml-node based on attribute name
+// (the keys and value types are looked up in the attribute registry, see Attribute.hpp)
 void* search_default_attrib_key(xmlNodePtr n) {
-  string key, value;
   //check if the node has a name-attribute
-  if (xmlHasProp(n, (const xmlChar *)"name") && xmlHasProp(n, (const xmlChar *)"value")) {
-    key = getStringFromProp(n, "name");
-    value = getStringFromProp(n, "value");
-  }
-  else {
+  if (!xmlHasProp(n, (const xmlChar *)"name") || !xmlHasProp(n, (const xmlChar *)"value"))
     return NULL;
-  }
-  // Handle attributes with uint64_t values
-  if (!key.compare("CATcos") || !key.compare("CATL3mask")) {
-    return new long long (std::strtoull((const char *)value.c_str(), NULL, 16));
-  }
-  // Handle attributes with long long values
-  else if (!key.compare("mig_size")) {
-    return new long long (std::strtoull((const char *)value.c_str(), NULL, 10));
-  }
-
-  // Handle attributes with int values
-  else if (!key.compare("Number_of_streaming_multiprocessors") ||
-           !key.compare("Number_of_cores_in_GPU") ||
-           !key.compare("Number_of_cores_per_SM") ||
-           !key.compare("Bus_Width_bit")) {
-    return (new int(std::stoi(value)));
-  }
-
-  // Handle attributes with double values
-  else if (!key.compare("Clock_Frequency")) {
-    return new double(std::stod(value));
-  }
-
-  // Handle attributes with float values
-  else if (!key.compare("latency") || !key.compare("latency_min") ||
-           !key.compare("latency_max")) {
-    return new float(std::stof(value));
-  }
-
-  // Handle attributes with string values
-  else if (!key.compare("CUDA_compute_capability") ||
-           !key.compare("mig_uuid")) {
-    return new std::string(value);
-  }
-
-  return NULL; // Attribute not found or not handled
+  AttributeHandler *h = GetAttributeHandler(getStringFromProp(n, "name"));
+  if (h == NULL || !h->deserialize)
+    return NULL; // Attribute not found or not handled
+  return h->deserialize(getStringFromProp(n, "value"));
 }
-// Search for custom complex attributes in xmlNode n and add them to Component c
+// Search for default complex attributes in xmlNode n and add them to Component c
 //
 // Complex attributes are attributes that have a value that is not a simple type
-// but a more complex structure like a vector
+// but a more complex structure like a vector or a TimeSeries
 int search_default_complex_attrib_key(xmlNodePtr n, Component *c) {
-  string key;
-  if (xmlHasProp(n, (const xmlChar *)"name")) {
-    key = getStringFromProp(n, "name");
-  }
-  else {
+  if (!xmlHasProp(n, (const xmlChar *)"name"))
     return 0;
-  }
-  // freq_history is a vector of tuples containing the timestamp and the
-  // frequency
-  if (!key.compare("freq_history")) {
-    std::vector<std::tuple<long long, double>>* val = new std::vector<std::tuple<long long, double>>();
-    for (xmlNodePtr cur = n->children; cur != NULL; cur = cur->next) {
-      // skip text nodes
-      if (cur->type == XML_TEXT_NODE)
-        continue;
-
-      // add value to vector
-
-      string ts = getStringFromProp(cur, "timestamp");
-      string freq = getStringFromProp(cur, "frequency");
-
-      long long ts_ll = std::strtoll((const char *)ts.c_str(), NULL, 10);
-      double freq_d = std::stod(freq);
-
-      val->push_back(std::make_tuple(ts_ll, freq_d));
-    }
-    c->attrib[key] = (void*) val;
-    return 1;
-  } else if (!key.compare("GPU_Clock_Rate")) {
-    // GPU_Clock_Rate is a vector of tuples containing the frequency and the
-    // unit
-    xmlNodePtr attr = n->children;
-    if(attr->type == XML_TEXT_NODE)
-      attr = attr->next;
-
-    string unit = getStringFromProp(attr, "unit");
-    string freq = getStringFromProp(attr, "frequency");
-
-    double freq_d = std::stod(freq);
-
-    auto val = new std::tuple<double, std::string>(freq_d, unit); 
-    void *value = (void *)val;
-    c->attrib[key] = value;
-
-    return 1;
-  }
-
-  return 0;
+  string key = getStringFromProp(n, "name");
+  AttributeHandler *h = GetAttributeHandler(key);
+  if (h == NULL || !h->deserialize_xml)
+    return 0;
+  void *value = h->deserialize_xml(n);
+  if (value == NULL)
+    return 0;
+  c->attrib[key] = value;
+  return 1;
 }
 
 // Collect all attributes and add to Component c
@@ -140,7 +68,7 @@ int search_default_complex_attrib_key(xmlNodePtr n, Component *c) {
 // The attributes are added to the Component c.
 // If the custom functions are not null, they are called first. If they
 // can not handle the attribute, the default functions are used.
-int collect_attrib(xmlNodePtr n, Component *c) {
+int XmlImporter::CollectAttrib(xmlNodePtr n, Component *c) const {
   void *attrib_value = NULL;
   // try custom attribute search function
   if (search_custom_attrib_key_fcn != NULL)
@@ -164,11 +92,74 @@ int collect_attrib(xmlNodePtr n, Component *c) {
   return 0;
 }
 
+int collect_attrib(xmlNodePtr n, Component *c) {
+  return XmlImporter().CollectAttrib(n, c);
+}
+
+// index written by the current export (decimal digits only), or false for
+// the pointers written by older versions (e.g. 0x55d1c3a0)
+static bool parseAddrIndex(const string &addr, size_t *index) {
+  if (addr.empty() || addr.size() > 18 || addr.find_first_not_of("0123456789") != string::npos)
+    return false;
+  *index = std::stoull(addr);
+  return true;
+}
+
+// comma-separated ids of the instances (see Component::SetInstances), or
+// false if the list is malformed
+static bool parseInstanceIds(const string &s, vector<int> *ids) {
+  std::stringstream ss(s);
+  string value;
+  while (std::getline(ss, value, ',')) {
+    char *end;
+    errno = 0;
+    long id = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || errno != 0 || id < INT_MIN || id > INT_MAX)
+      return false;
+    ids->push_back((int)id);
+  }
+  return true;
+}
+
+// the vector grows only by this much beyond its size: the Components are
+// created close to DFS order (a Component after its subtree), so a larger
+// index comes from a malformed file (or a lazily loaded part of one) and is
+// kept in the map, instead of allocating memory for the indices in between
+#define XML_IMPORT_MAX_INDEX_GAP 4096
+
+void XmlImportAddresses::Add(const string &addr, Component *c) {
+  size_t index;
+  if (!parseAddrIndex(addr, &index) || index >= by_index.size() + XML_IMPORT_MAX_INDEX_GAP) {
+    by_pointer[addr] = c;
+    return;
+  }
+  if (index >= by_index.size())
+    by_index.resize(index + 1, NULL);
+  by_index[index] = c;
+}
+
+Component *XmlImportAddresses::Find(const string &addr) const {
+  size_t index;
+  if (parseAddrIndex(addr, &index) && index < by_index.size() && by_index[index] != NULL)
+    return by_index[index];
+  auto it = by_pointer.find(addr);
+  return it != by_pointer.end() ? it->second : NULL;
+}
+
+void XmlImportAddresses::Remove(const string &addr) {
+  size_t index;
+  if (parseAddrIndex(addr, &index) && index < by_index.size())
+    by_index[index] = NULL;
+  by_pointer.erase(addr);
+}
+
 // Create ComponentSubtree from xmlNodes
 //
 // This function creates a ComponentSubtree from the xmlNode n by creating
 // a Component and then recursively calling itself for all children of n.
-Component *CreateComponentSubtree(xmlNodePtr n, string type) {
+// The created Components are added to addr_to_component (addr in the file
+// -> Component), which is used to create the DataPaths.
+Component *XmlImporter::createComponentSubtree(xmlNodePtr n, string type, XmlImportAddresses &addr_to_component) const {
   Component *c = NULL;
 
   std::string name = getStringFromProp(n, "name");
@@ -217,11 +208,11 @@ Component *CreateComponentSubtree(xmlNodePtr n, string type) {
     c = new Cache(id);
     if (xmlHasProp(n, (const xmlChar *)"cache_level")) {
       string value = getStringFromProp(n, "cache_level");
-      ((Cache *)c)->SetCacheLevel(std::stoi(value));
+      ((Cache *)c)->SetCacheName(value); // exported as the cache type, e.g. "3" or "L2"
     }
     if (xmlHasProp(n, (const xmlChar *)"cache_size")) {
       string value = getStringFromProp(n, "cache_size");
-      ((Cache *)c)->SetCacheSize(std::stoi(value));
+      ((Cache *)c)->SetCacheSize(std::stoll(value));
     }
     if (xmlHasProp(n, (const xmlChar *)"cache_associativity_ways")) {
       string value = getStringFromProp(n, "cache_associativity_ways");
@@ -234,9 +225,12 @@ Component *CreateComponentSubtree(xmlNodePtr n, string type) {
   }
   if (type.compare("Subdivision") == 0) {
     c = new Subdivision(id);
-    int sd_type = std::stoi(getStringFromProp(n, "type"));
-    
-    ((Subdivision *)c)->SetSubdivisionType(sd_type);
+    // exported as subdivision_type
+    const char *prop = xmlHasProp(n, (const xmlChar *)"subdivision_type") ? "subdivision_type" : "type";
+    if (xmlHasProp(n, (const xmlChar *)prop)) {
+      int sd_type = std::stoi(getStringFromProp(n, prop));
+      ((Subdivision *)c)->SetSubdivisionType(sd_type);
+    }
   }
   if (type.compare("NUMA") == 0) {
     c = new Numa(id);
@@ -261,6 +255,17 @@ Component *CreateComponentSubtree(xmlNodePtr n, string type) {
     c = new Topology();
   }
 
+  // ids of the instances represented by the Component (see Component::SetInstances)
+  if (c != NULL && xmlHasProp(n, (const xmlChar *)"instance_ids")) {
+    vector<int> ids;
+    if (!parseInstanceIds(getStringFromProp(n, "instance_ids"), &ids)) {
+      std::cerr << "importFromXml: malformed instance_ids of component " << addr << ", skipping it" << std::endl;
+      delete c;
+      return NULL;
+    }
+    c->SetInstances(ids);
+  }
+
   // Recursively traverse all children of n and create Components
   for (xmlNodePtr cur = n->children; cur != NULL; cur = cur->next) {
     std::string type(reinterpret_cast<const char *>(cur->name));
@@ -270,67 +275,647 @@ Component *CreateComponentSubtree(xmlNodePtr n, string type) {
       continue;
     // Check if cur is Attribute-Node
     if (type.compare("Attribute") == 0) {
-      collect_attrib(cur, c);
+      CollectAttrib(cur, c);
     } else {
-      Component *child = CreateComponentSubtree(cur, type);
+      Component *child = createComponentSubtree(cur, type, addr_to_component);
       if (child != NULL) {
         c->InsertChild(child);
       }
     }
   }
   // Add the Component to the hashmap
-  addr_to_component[addr] = c;
+  addr_to_component.Add(addr, c);
   return c;
 }
 
 // Create DataPath objects from xmlNode dpNode and add them to the
 // corresponding Components
-int CreateDataPaths(xmlNodePtr dpNode) {
+int XmlImporter::createDataPaths(xmlNodePtr dpNode, XmlImportAddresses &addr_to_component) const {
 
   for (xmlNodePtr cur = dpNode->children; cur != NULL; cur = cur->next) {
 
     // skip non-element nodes
     if (cur->type != XML_ELEMENT_NODE)
       continue;
+    // dense matrix of DataPaths (see XmlExportOptions::datapath_matrix)
+    if (xmlStrcmp(cur->name, (const xmlChar *)"datapath-matrix") == 0) {
+      createDataPathMatrix(cur, addr_to_component);
+      continue;
+    }
     string src = getStringFromProp(cur, "source");
     string trg = getStringFromProp(cur, "target");
     int oriented = std::stoi(getStringFromProp(cur, "oriented"));
     int dp_type = std::stoi(getStringFromProp(cur, "dp_type"));
     double bw = std::stod(getStringFromProp(cur, "bw"));
     double latency = std::stod(getStringFromProp(cur, "latency"));
+    // broadcast DataPaths lead to all Components of a type in the target subtree
+    int broadcast_type = 0;
+    if (xmlHasProp(cur, (const xmlChar *)"broadcast_type"))
+      broadcast_type = std::stoi(getStringFromProp(cur, "broadcast_type"));
 
     // get source and target Components from hashmap
-    Component *src_c = addr_to_component[src];
-    Component *trg_c = addr_to_component[trg];
+    Component *src_c = addr_to_component.Find(src);
+    Component *trg_c = addr_to_component.Find(trg);
+    if (src_c == NULL || trg_c == NULL) {
+      std::cerr << "importFromXml: datapath " << src << " -> " << trg << " has no such component, skipping" << std::endl;
+      continue;
+    }
     // Datapath constructor adds dp to Component-objects. Also handles
     // bidirectional relations
-    new DataPath(src_c, trg_c, oriented, dp_type, bw, latency);
+    DataPath *dp = new DataPath(src_c, trg_c, oriented, dp_type, bw, latency, broadcast_type);
+
+    CollectDataPathAttrib(cur, dp);
   }
   return 1;
 }
 
-Component *importFromXml(
-    string path,
-    std::function<void*(xmlNodePtr)> _search_custom_attrib_key_fcn,
-    std::function<int(xmlNodePtr, Component *)>
-        _search_custom_complex_attrib_key_fcn) {
+// simple attributes of the DataPath (e.g. mig_uuid, CATcos)
+int XmlImporter::CollectDataPathAttrib(xmlNodePtr dpNode, DataPath *dp) const {
+  for (xmlNodePtr attr = dpNode->children; attr != NULL; attr = attr->next) {
+    if (attr->type != XML_ELEMENT_NODE)
+      continue;
+    void *attrib_value = NULL;
+    if (search_custom_attrib_key_fcn != NULL)
+      attrib_value = search_custom_attrib_key_fcn(attr);
+    if (attrib_value == NULL)
+      attrib_value = search_default_attrib_key(attr);
+    if (attrib_value != NULL)
+      dp->attrib[getStringFromProp(attr, "name")] = attrib_value;
+  }
+  return 0;
+}
+
+// Reads the values of one matrix of a datapath-matrix node: a constant, text,
+// or base64 of little-endian binary numbers; returns 1 if it does not have n values
+static int readMatrixValues(xmlNodePtr valuesNode, bool base64, size_t n, vector<double> *values) {
+  values->clear();
+  if (xmlHasProp(valuesNode, (const xmlChar *)"constant")) {
+    double v = std::strtod(getStringFromProp(valuesNode, "constant").c_str(), NULL);
+    values->assign(n, getStringFromProp(valuesNode, "type") == "float" ? (double)(float)v : v);
+    return 0;
+  }
+  xmlChar *content = xmlNodeGetContent(valuesNode);
+  string text = content != NULL ? reinterpret_cast<const char *>(content) : "";
+  xmlFree(content);
+  bool is_float = getStringFromProp(valuesNode, "type") == "float" ||
+                  (xmlHasProp(valuesNode, (const xmlChar *)"precision") && getStringFromProp(valuesNode, "precision") == "float");
+  values->reserve(n);
+  if (base64) {
+    string bin;
+    size_t bytes = is_float ? 4 : 8;
+    if (Base64Decode(text, &bin) != 0 || bin.size() != n * bytes)
+      return 1;
+    for (size_t i = 0; i < n; i++) {
+      uint64_t bits = 0;
+      for (size_t b = 0; b < bytes; b++)
+        bits |= (uint64_t)(uint8_t)bin[i * bytes + b] << (8 * b);
+      if (is_float) {
+        uint32_t fbits = (uint32_t)bits;
+        float f;
+        memcpy(&f, &fbits, sizeof(f));
+        values->push_back(f);
+      } else {
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        values->push_back(d);
+      }
+    }
+  } else {
+    const char *p = text.c_str();
+    char *end;
+    // float values are written in their shortest form, which restores the float (not the double)
+    for (double v = strtod(p, &end); end != p; v = strtod(p, &end)) {
+      values->push_back(is_float ? (double)(float)v : v);
+      p = end;
+    }
+  }
+  return values->size() == n ? 0 : 1;
+}
 
-  search_custom_attrib_key_fcn = _search_custom_attrib_key_fcn;
-  search_custom_complex_attrib_key_fcn = _search_custom_complex_attrib_key_fcn;
+// Reads which cells of a datapath-matrix have a DataPath: one 0/1 character
+// per cell, or base64 of a bitmap; returns 1 if it does not have n cells
+static int readMatrixCells(xmlNodePtr cellsNode, bool base64, size_t n, vector<bool> *present) {
+  xmlChar *content = xmlNodeGetContent(cellsNode);
+  string text = content != NULL ? reinterpret_cast<const char *>(content) : "";
+  xmlFree(content);
+  present->clear();
+  if (base64) {
+    string bin;
+    if (Base64Decode(text, &bin) != 0 || bin.size() != (n + 7) / 8)
+      return 1;
+    for (size_t i = 0; i < n; i++)
+      present->push_back((bin[i / 8] >> (i % 8)) & 1);
+  } else {
+    for (char c : text)
+      if (c == '0' || c == '1')
+        present->push_back(c == '1');
+  }
+  return present->size() == n ? 0 : 1;
+}
 
+// Create the DataPaths of a datapath-matrix node: one per cell with a
+// DataPath, with the values of the other matrices as latency and attributes
+int XmlImporter::createDataPathMatrix(xmlNodePtr matrixNode, XmlImportAddresses &addr_to_component) const {
+  int oriented = std::stoi(getStringFromProp(matrixNode, "oriented"));
+  int dp_type = std::stoi(getStringFromProp(matrixNode, "dp_type"));
+  size_t rows = std::stoul(getStringFromProp(matrixNode, "rows"));
+  size_t cols = std::stoul(getStringFromProp(matrixNode, "cols"));
+  bool base64 = getStringFromProp(matrixNode, "encoding") == "base64";
+
+  vector<Component *> sources, targets;
+  vector<bool> present(rows * cols, true);
+  vector<string> names;
+  vector<bool> is_float;
+  vector<vector<double>> values;
+  for (xmlNodePtr cur = matrixNode->children; cur != NULL; cur = cur->next) {
+    if (cur->type != XML_ELEMENT_NODE)
+      continue;
+    string name(reinterpret_cast<const char *>(cur->name));
+    if (name == "sources" || name == "targets") {
+      vector<Component *> &components = name == "sources" ? sources : targets;
+      xmlChar *content = xmlNodeGetContent(cur);
+      std::stringstream ss(content != NULL ? reinterpret_cast<const char *>(content) : "");
+      xmlFree(content);
+      string addr;
+      while (ss >> addr)
+        components.push_back(addr_to_component.Find(addr));
+    } else if (name == "cells") {
+      if (readMatrixCells(cur, base64, rows * cols, &present) != 0) {
+        std::cerr << "importFromXml: datapath-matrix cells do not have " << rows << "x" << cols << " elements, skipping the matrix" << std::endl;
+        return 0;
+      }
+    } else if (name == "values") {
+      names.push_back(getStringFromProp(cur, "name"));
+      is_float.push_back(getStringFromProp(cur, "type") == "float");
+      values.emplace_back();
+      if (readMatrixValues(cur, base64, rows * cols, &values.back()) != 0) {
+        std::cerr << "importFromXml: datapath-matrix values " << names.back() << " do not have " << rows << "x" << cols << " elements, skipping the matrix" << std::endl;
+        return 0;
+      }
+    }
+  }
+  if (sources.size() != rows || targets.size() != cols || names.size() < 2 || names[0] != "bw" || names[1] != "latency") {
+    std::cerr << "importFromXml: malformed datapath-matrix, skipping" << std::endl;
+    return 0;
+  }
+
+  for (size_t i = 0; i < rows; i++) {
+    for (size_t j = 0; j < cols; j++) {
+      size_t cell = i * cols + j;
+      if (!present[cell] || sources[i] == NULL || targets[j] == NULL)
+        continue;
+      DataPath *dp = new DataPath(sources[i], targets[j], oriented, dp_type, values[0][cell], values[1][cell]);
+      for (size_t k = 2; k < names.size(); k++) {
+        if (is_float[k])
+          dp->attrib[names[k]] = new float(values[k][cell]);
+        else
+          dp->attrib[names[k]] = new double(values[k][cell]);
+      }
+    }
+  }
+  return 1;
+}
+
+XmlImporter::XmlImporter(std::function<void*(xmlNodePtr)> _search_custom_attrib_key_fcn, std::function<int(xmlNodePtr, Component *)> _search_custom_complex_attrib_key_fcn)
+    : search_custom_attrib_key_fcn(_search_custom_attrib_key_fcn), search_custom_complex_attrib_key_fcn(_search_custom_complex_attrib_key_fcn) {
   xmlInitParser();
+}
+
+Component *XmlImporter::Import(string path) const {
   xmlDocPtr doc = xmlReadFile(path.c_str(), NULL, 0);
+  if (doc == NULL) {
+    std::cerr << "importFromXml: could not read " << path << std::endl;
+    return NULL;
+  }
   xmlNodePtr sys_sage_root = xmlDocGetRootElement(doc);
 
   xmlNodePtr root = sys_sage_root->children;
   xmlNodePtr r = root->next;
 
-  Component *c = CreateComponentSubtree(r->children->next, "Topology");
+  XmlImportAddresses addr_to_component;
+  Component *c = createComponentSubtree(r->children->next, "Topology", addr_to_component);
 
   xmlNodePtr dp_root = r->next->next;
 
-  CreateDataPaths(dp_root);
+  createDataPaths(dp_root, addr_to_component);
 
+  xmlFreeDoc(doc);
   return c;
 }
 
+Component *importFromXml(
+    string path,
+    std::function<void*(xmlNodePtr)> search_custom_attrib_key_fcn,
+    std::function<int(xmlNodePtr, Component *)>
+        search_custom_complex_attrib_key_fcn) {
+  return XmlImporter(search_custom_attrib_key_fcn, search_custom_complex_attrib_key_fcn).Import(path);
+}
+
+vector<Component *> importFromXmlBatch(const vector<string> &paths, int num_threads, const XmlImporter &importer) {
+  vector<Component *> roots(paths.size(), NULL);
+  if (num_threads <= 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  num_threads = std::min<int>(num_threads, paths.size());
+
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < paths.size(); i = next++)
+      roots[i] = importer.Import(paths[i]);
+  };
+  vector<std::thread> threads;
+  for (int i = 1; i < num_threads; i++)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread &t : threads)
+    t.join();
+  return roots;
+}
+
+// Lazy import: the file is indexed by a scan of its tags (the export writes
+// no DTD, CDATA nor '>' in attribute values, but comments and processing
+// instructions are skipped); the indexed elements are parsed by libxml when
+// they are created.
+
+// the value of an attribute of the start tag data[begin, end), "" if missing
+static string tagAttribute(const string &data, size_t begin, size_t end, const string &name) {
+  string key = name + "=\"";
+  for (size_t pos = data.find(key, begin); pos != string::npos && pos < end; pos = data.find(key, pos + 1)) {
+    if (!isspace((unsigned char)data[pos - 1]))
+      continue;
+    size_t value = pos + key.size();
+    size_t quote = data.find('"', value);
+    if (quote == string::npos || quote >= end)
+      return "";
+    return data.substr(value, quote - value);
+  }
+  return "";
+}
+
+static int componentTypeOfElement(const string &name) {
+  static const std::unordered_map<string, int> types = {
+      {"None", SYS_SAGE_COMPONENT_NONE},       {"HW_thread", SYS_SAGE_COMPONENT_THREAD},
+      {"Core", SYS_SAGE_COMPONENT_CORE},       {"Cache", SYS_SAGE_COMPONENT_CACHE},
+      {"Subdivision", SYS_SAGE_COMPONENT_SUBDIVISION}, {"NUMA", SYS_SAGE_COMPONENT_NUMA},
+      {"Chip", SYS_SAGE_COMPONENT_CHIP},       {"Memory", SYS_SAGE_COMPONENT_MEMORY},
+      {"Storage", SYS_SAGE_COMPONENT_STORAGE}, {"Node", SYS_SAGE_COMPONENT_NODE},
+      {"Topology", SYS_SAGE_COMPONENT_TOPOLOGY}};
+  auto it = types.find(name);
+  return it != types.end() ? it->second : 0;
+}
+
+XmlLazyLoader::XmlLazyLoader(const XmlImporter &_importer) : importer(_importer) {}
+
+XmlLazyLoader::~XmlLazyLoader() {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  for (auto const &[c, index] : created) {
+    c->lazy_loader = nullptr;
+    c->lazy_datapaths = false;
+  }
+}
+
+int XmlLazyLoader::Open(string _path) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  std::ifstream in(_path, std::ios::binary);
+  if (!in) {
+    std::cerr << "XmlLazyLoader: could not read " << _path << std::endl;
+    return 1;
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  string data = ss.str();
+
+  // element kinds of the scan
+  enum { ELEMENT_OTHER, ELEMENT_COMPONENTS, ELEMENT_DATA_PATHS, ELEMENT_COMPONENT, ELEMENT_ATTRIBUTE, ELEMENT_DATAPATH, ELEMENT_MATRIX_ADDRS };
+  struct OpenElement {
+    int kind;
+    size_t begin, start_end, entry;
+  };
+  vector<ComponentEntry> new_components;
+  vector<DataPathEntry> new_datapaths;
+  vector<OpenElement> stack;
+  bool malformed = false;
+
+  auto finish = [&](const OpenElement &e, size_t content_end, size_t end) {
+    if (e.kind == ELEMENT_COMPONENT) {
+      new_components[e.entry].end = end;
+    } else if (e.kind == ELEMENT_ATTRIBUTE) {
+      new_components[stack.back().entry].attributes.push_back({e.begin, end});
+    } else if (e.kind == ELEMENT_DATAPATH) {
+      new_datapaths[e.entry].end = end;
+    } else if (e.kind == ELEMENT_MATRIX_ADDRS) {
+      std::stringstream addrs(data.substr(e.start_end, content_end - e.start_end));
+      string addr;
+      while (addrs >> addr)
+        new_datapaths[e.entry].addrs.push_back(addr);
+    }
+  };
+
+  size_t pos = 0;
+  while (!malformed && (pos = data.find('<', pos)) != string::npos) {
+    size_t gt;
+    if (data.compare(pos, 4, "<!--") == 0) {
+      gt = data.find("-->", pos);
+      pos = gt == string::npos ? data.size() : gt + 3;
+      continue;
+    }
+    if (data.compare(pos, 2, "<?") == 0 || data.compare(pos, 2, "<!") == 0) {
+      gt = data.find('>', pos);
+      pos = gt == string::npos ? data.size() : gt + 1;
+      continue;
+    }
+    if (data.compare(pos, 2, "</") == 0) {
+      gt = data.find('>', pos);
+      if (gt == string::npos || stack.empty()) {
+        malformed = true;
+        break;
+      }
+      OpenElement e = stack.back();
+      stack.pop_back();
+      finish(e, pos, gt + 1);
+      pos = gt + 1;
+      continue;
+    }
+    // start tag (the quoted attribute values may contain '/')
+    char quote = 0;
+    for (gt = pos + 1; gt < data.size(); gt++) {
+      if (quote != 0) {
+        if (data[gt] == quote)
+          quote = 0;
+      } else if (data[gt] == '"' || data[gt] == '\'') {
+        quote = data[gt];
+      } else if (data[gt] == '>') {
+        break;
+      }
+    }
+    if (gt >= data.size()) {
+      malformed = true;
+      break;
+    }
+    bool self_closing = data[gt - 1] == '/';
+    size_t name_end = data.find_first_of(" \t\r\n/>", pos + 1);
+    string name = data.substr(pos + 1, name_end - pos - 1);
+
+    OpenElement e{ELEMENT_OTHER, pos, gt + 1, 0};
+    int parent_kind = stack.empty() ? ELEMENT_OTHER : stack.back().kind;
+    if (stack.size() == 1) {
+      e.kind = name == "components" ? ELEMENT_COMPONENTS : name == "data-paths" ? ELEMENT_DATA_PATHS : ELEMENT_OTHER;
+    } else if (parent_kind == ELEMENT_COMPONENT && name == "Attribute") {
+      e.kind = ELEMENT_ATTRIBUTE;
+    } else if (parent_kind == ELEMENT_COMPONENTS || parent_kind == ELEMENT_COMPONENT) {
+      e.kind = ELEMENT_COMPONENT;
+      e.entry = new_components.size();
+      string id = tagAttribute(data, pos, gt, "id");
+      ComponentEntry entry{name, id.empty() ? 0 : std::stoi(id), tagAttribute(data, pos, gt, "addr"), pos, gt + 1, gt + 1, self_closing,
+                           parent_kind == ELEMENT_COMPONENT ? stack.back().entry : SIZE_MAX, {}, {}, NULL, false};
+      if (parent_kind == ELEMENT_COMPONENT)
+        new_components[entry.parent].children.push_back(e.entry);
+      else if (!new_components.empty())
+        malformed = true; // one root
+      new_components.push_back(entry);
+    } else if (parent_kind == ELEMENT_DATA_PATHS && (name == "datapath" || name == "datapath-matrix")) {
+      e.kind = ELEMENT_DATAPATH;
+      e.entry = new_datapaths.size();
+      DataPathEntry entry{pos, gt + 1, {}, false};
+      if (name == "datapath")
+        entry.addrs = {tagAttribute(data, pos, gt, "source"), tagAttribute(data, pos, gt, "target")};
+      new_datapaths.push_back(entry);
+    } else if (parent_kind == ELEMENT_DATAPATH && (name == "sources" || name == "targets")) {
+      e.kind = ELEMENT_MATRIX_ADDRS;
+      e.entry = stack.back().entry;
+    }
+    if (self_closing)
+      finish(e, gt + 1, gt + 1);
+    else
+      stack.push_back(e);
+    pos = gt + 1;
+  }
+  if (malformed || !stack.empty() || new_components.empty()) {
+    std::cerr << "XmlLazyLoader: malformed file " << _path << std::endl;
+    return 1;
+  }
+
+  for (auto const &[c, index] : created) {
+    c->lazy_loader = nullptr;
+    c->lazy_datapaths = false;
+  }
+  created.clear();
+  addresses = XmlImportAddresses();
+  datapaths_by_addr.clear();
+  components = std::move(new_components);
+  datapaths = std::move(new_datapaths);
+  for (size_t i = 0; i < datapaths.size(); i++) {
+    std::set<string> addrs(datapaths[i].addrs.begin(), datapaths[i].addrs.end());
+    for (const string &addr : addrs)
+      datapaths_by_addr[addr].push_back(i);
+  }
+  path = _path;
+  file.close();
+  file.clear();
+  file.open(path, std::ios::binary);
+  return 0;
+}
+
+size_t XmlLazyLoader::GetNumComponents() const {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  return components.size();
+}
+
+int XmlLazyLoader::FindComponent(int componentType, int id) const {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  for (size_t i = 0; i < components.size(); i++) {
+    // the root is imported as the Topology
+    int type = i == 0 ? SYS_SAGE_COMPONENT_TOPOLOGY : componentTypeOfElement(components[i].name);
+    if (type == componentType && components[i].id == id && !components[i].deleted)
+      return i;
+  }
+  return -1;
+}
+
+Component *XmlLazyLoader::GetRoot() const {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  return components.empty() ? NULL : components[0].c;
+}
+
+string XmlLazyLoader::readRange(size_t begin, size_t end) {
+  string out(end - begin, '\0');
+  file.clear();
+  file.seekg(begin);
+  file.read(&out[0], out.size());
+  return out;
+}
+
+// registers the Components created from the entry (and its subtree)
+void XmlLazyLoader::attachCreated(size_t index, bool with_subtree) {
+  ComponentEntry &e = components[index];
+  e.c = addresses.Find(e.addr);
+  if (e.c == NULL)
+    return;
+  e.c->lazy_loader = this;
+  created[e.c] = index;
+  updatePending(e.c, index);
+  if (with_subtree)
+    for (size_t child : e.children)
+      attachCreated(child, true);
+}
+
+// creates the Component of the entry (and its subtree), whose parent has been created
+Component *XmlLazyLoader::createComponent(size_t index, bool with_subtree) {
+  ComponentEntry &e = components[index];
+  string fragment;
+  if (with_subtree || e.self_closing) {
+    fragment = readRange(e.begin, e.end);
+  } else {
+    // the start tag and the attributes, without the child Components
+    fragment = readRange(e.begin, e.start_end);
+    for (auto [begin, end] : e.attributes)
+      fragment += readRange(begin, end);
+    fragment += "</" + e.name + ">";
+  }
+  xmlDocPtr doc = xmlReadMemory(fragment.data(), fragment.size(), NULL, "UTF-8", 0);
+  if (doc == NULL) {
+    std::cerr << "XmlLazyLoader: could not parse component " << e.addr << " of " << path << std::endl;
+    return NULL;
+  }
+  Component *c = importer.createComponentSubtree(xmlDocGetRootElement(doc), index == 0 ? "Topology" : e.name, addresses);
+  xmlFreeDoc(doc);
+  if (c == NULL)
+    return NULL;
+  if (e.parent != SIZE_MAX) {
+    // keep the order of the file: after the closest preceding sibling that has been created
+    Component *parent = components[e.parent].c;
+    parent->InsertChild(c);
+    vector<Component *> *children = parent->GetChildren();
+    children->pop_back();
+    auto pos = children->begin();
+    const vector<size_t> &siblings = components[e.parent].children;
+    for (auto it = std::find(siblings.begin(), siblings.end(), index); it != siblings.begin();) {
+      Component *sibling = components[*--it].c;
+      auto found = std::find(children->begin(), children->end(), sibling);
+      if (sibling != NULL && found != children->end()) {
+        pos = found + 1;
+        break;
+      }
+    }
+    children->insert(pos, c);
+  }
+  attachCreated(index, with_subtree);
+  return c;
+}
+
+Component *XmlLazyLoader::LoadComponent(size_t index, bool with_subtree) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  if (index >= components.size() || components[index].deleted)
+    return NULL;
+  ComponentEntry &e = components[index];
+  if (e.c == NULL) {
+    if (e.parent != SIZE_MAX && LoadComponent(e.parent, false) == NULL)
+      return NULL;
+    if (createComponent(index, with_subtree) == NULL)
+      return NULL;
+  } else if (with_subtree) {
+    // some children may not have been created yet
+    for (size_t child : e.children)
+      if (!components[child].deleted)
+        LoadComponent(child, true);
+  }
+  return e.c;
+}
+
+Component *XmlLazyLoader::LoadTopology(int max_depth) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  if (components.empty())
+    return NULL;
+  if (max_depth < 0)
+    return LoadComponent(0, true);
+  vector<std::pair<size_t, int>> todo = {{0, 0}};
+  while (!todo.empty()) {
+    auto [index, depth] = todo.back();
+    todo.pop_back();
+    if (LoadComponent(index, false) == NULL || depth == max_depth)
+      continue;
+    for (size_t child : components[index].children)
+      todo.push_back({child, depth + 1});
+  }
+  return components[0].c;
+}
+
+// a DataPath element can be loaded once all of its Components have been created
+bool XmlLazyLoader::loadable(const DataPathEntry &dp) const {
+  if (dp.loaded)
+    return false;
+  for (const string &addr : dp.addrs)
+    if (addresses.Find(addr) == NULL)
+      return false;
+  return true;
+}
+
+void XmlLazyLoader::loadDataPath(size_t dp_index) {
+  DataPathEntry &dp = datapaths[dp_index];
+  dp.loaded = true;
+  string fragment = "<data-paths>" + readRange(dp.begin, dp.end) + "</data-paths>";
+  xmlDocPtr doc = xmlReadMemory(fragment.data(), fragment.size(), NULL, "UTF-8", 0);
+  if (doc == NULL) {
+    std::cerr << "XmlLazyLoader: could not parse a datapath of " << path << std::endl;
+    return;
+  }
+  importer.createDataPaths(xmlDocGetRootElement(doc), addresses);
+  xmlFreeDoc(doc);
+}
+
+// c has DataPaths to load if an element of its DataPaths has not been loaded yet
+void XmlLazyLoader::updatePending(Component *c, size_t index) {
+  c->lazy_datapaths = false;
+  auto it = datapaths_by_addr.find(components[index].addr);
+  if (it == datapaths_by_addr.end())
+    return;
+  for (size_t dp_index : it->second)
+    if (!datapaths[dp_index].loaded)
+      c->lazy_datapaths = true;
+}
+
+void XmlLazyLoader::LoadDataPaths(Component *c) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  // another thread may have loaded them while this one was waiting for the lock
+  if (!c->lazy_datapaths)
+    return;
+  auto it = created.find(c);
+  if (it == created.end())
+    return;
+  // the flag is cleared first: creating the DataPaths accesses the DataPaths of c
+  c->lazy_datapaths = false;
+  auto dps = datapaths_by_addr.find(components[it->second].addr);
+  if (dps == datapaths_by_addr.end())
+    return;
+  for (size_t dp_index : dps->second)
+    if (loadable(datapaths[dp_index]))
+      loadDataPath(dp_index);
+  updatePending(c, it->second);
+}
+
+int XmlLazyLoader::LoadAllDataPaths() {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  int loaded = 0;
+  for (size_t i = 0; i < datapaths.size(); i++) {
+    if (loadable(datapaths[i])) {
+      loadDataPath(i);
+      loaded++;
+    }
+  }
+  for (auto const &[c, index] : created)
+    c->lazy_datapaths = false;
+  return loaded;
+}
+
+void XmlLazyLoader::Forget(Component *c) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  auto it = created.find(c);
+  if (it == created.end())
+    return;
+  ComponentEntry &e = components[it->second];
+  e.c = NULL;
+  e.deleted = true;
+  addresses.Remove(e.addr);
+  c->lazy_loader = nullptr;
+  c->lazy_datapaths = false;
+  created.erase(it);
+}
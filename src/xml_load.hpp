@@ -2,30 +2,207 @@
 #define XML_LOAD
 
 #include <functional>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
 
 #include "Component.hpp"
 #include "DataPath.hpp"
 
+/**
+ * @private
+ * The Components of an imported file by their addr: the dense indices written by the current export in a vector, the pointers written by older versions (and indices far beyond the ones seen so far, e.g. of a malformed file) in a map.
+ */
+class XmlImportAddresses {
+public:
+    void Add(const string& addr, Component* c);
+    /**
+     * @return the Component with the addr, or NULL if there is none
+     */
+    Component* Find(const string& addr) const;
+    void Remove(const string& addr);
+
+private:
+    vector<Component*> by_index;
+    map<string, Component*> by_pointer;
+};
+
+/**
+ * Context of the XML import: holds the custom attribute callbacks. The state of one import (e.g. the component addresses used to restore the DataPaths) is local to Import(), so one XmlImporter may be used by multiple threads concurrently.
+ */
+class XmlImporter {
+public:
+    /**
+     * @param _search_custom_attrib_key_fcn Function for custom attribute key search: returns the new value of the attribute node, or NULL if it does not handle the attribute.
+     * @param _search_custom_complex_attrib_key_fcn Function for custom complex attribute key search: adds the attribute to the Component and returns 1, or returns 0 if it does not handle the attribute.
+     */
+    XmlImporter(std::function<void*(xmlNodePtr)> _search_custom_attrib_key_fcn = NULL, std::function<int(xmlNodePtr, Component*)> _search_custom_complex_attrib_key_fcn = NULL);
+    /**
+     * Imports the sys-sage internal representation from an XML file.
+     * @param path Path to the XML file.
+     * @return the imported Topology, or NULL if the file could not be read
+     */
+    Component* Import(string path) const;
+    /**
+     * @private
+     * Collects the attributes from an xmlNode and adds them to a Component.
+     */
+    int CollectAttrib(xmlNodePtr n, Component* c) const;
+    /**
+     * @private
+     * Collects the (simple) attributes of a datapath xmlNode and adds them to a DataPath.
+     */
+    int CollectDataPathAttrib(xmlNodePtr dpNode, DataPath* dp) const;
+
+private:
+    Component* createComponentSubtree(xmlNodePtr n, string type, XmlImportAddresses& addr_to_component) const;
+    int createDataPaths(xmlNodePtr dpNode, XmlImportAddresses& addr_to_component) const;
+    int createDataPathMatrix(xmlNodePtr matrixNode, XmlImportAddresses& addr_to_component) const;
+
+    std::function<void*(xmlNodePtr)> search_custom_attrib_key_fcn;
+    std::function<int(xmlNodePtr, Component*)> search_custom_complex_attrib_key_fcn;
+
+    friend class XmlLazyLoader;
+};
+
+/**
+ * Lazy import of large XML files, e.g. a multi-node topology of which only one Node subtree, or only the Component Tree without the DataPaths, is needed.
+ * \n Open() reads the file once and indexes it: the position of each Component (and of its attributes) and of each DataPath in the file, and the Components each DataPath connects. Nothing is created yet. The Components are then created on demand: LoadComponent() creates a subtree (or only one Component), together with the Components on the path to the root, so that the created Components always form one tree rooted at GetRoot(). Only the requested parts of the file are read and parsed again.
+ * \n The DataPaths are created lazily, the first time the DataPaths of one of their Components are accessed (GetDataPaths(), GetDataPathByType(), ...), and only once all their Components have been created. A datapath-matrix is created as a whole, once all of its sources and targets have been created.
+ * \n The loader must stay alive while the created Components are used; destroying it drops the DataPaths that were not loaded yet (call LoadAllDataPaths() first to keep them).
+ * \n Thread safety: the methods of the loader (including the lazy loads triggered by the accesses to the DataPaths) are serialized by an internal lock, so the file and the index are never accessed concurrently. A lazy load still modifies the created tree: it appends the new DataPaths to the DataPath lists of all the Components they connect, which other threads may be reading. Before reading the created tree from multiple threads (e.g. under the shared lock of RefreshScheduler), call LoadAllDataPaths(); XmlExporter::CreateDocument() with multiple threads loads the DataPaths of the exported Components itself before its parallel phase.
+ * \n Example (the tree without DataPaths, then the DataPaths of one Node):
+ * \n XmlLazyLoader loader; loader.Open("cluster.xml");
+ * \n Component* topo = loader.LoadTopology(); //no DataPaths are read
+ * \n Component* node = loader.LoadComponent(loader.FindComponent(SYS_SAGE_COMPONENT_NODE, 3));
+ * \n node->GetSubcomponentById(0, SYS_SAGE_COMPONENT_NUMA)->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING); //loads the DataPaths of the NUMA region
+ */
+class XmlLazyLoader {
+public:
+    /**
+     * @param _importer - import context (custom attribute callbacks) used to create the Components and DataPaths
+     */
+    XmlLazyLoader(const XmlImporter& _importer = XmlImporter());
+    /**
+     * Detaches the created Components; their DataPaths that were not loaded yet are dropped.
+     */
+    ~XmlLazyLoader();
+    /**
+     * Reads and indexes an XML file exported by sys-sage. The file must not change while the loader is used.
+     * @param path - path to the XML file
+     * @return 0 on success, 1 if the file could not be read or is malformed
+     */
+    int Open(string path);
+    /**
+     * @return the number of Components in the file
+     */
+    size_t GetNumComponents() const;
+    /**
+     * Finds a Component in the index (without creating it).
+     * @param componentType - SYS_SAGE_COMPONENT_* type of the Component
+     * @param id - id of the Component
+     * @return the index of the first such Component in the file (in DFS order, i.e. its addr in the files of the current export), or -1 if there is none
+     */
+    int FindComponent(int componentType, int id) const;
+    /**
+     * Creates a Component of the file, and the Components on the path from the root to it (without their other children).
+     * @param index - index of the Component (see FindComponent())
+     * @param with_subtree - if true (default), also creates the whole subtree of the Component
+     * @return the Component, or NULL if the index is out of range or the Component was deleted
+     */
+    Component* LoadComponent(size_t index, bool with_subtree = true);
+    /**
+     * Creates the Component Tree down to a depth (the DataPaths are still loaded lazily).
+     * @param max_depth - number of levels below the root to create; -1 (default) creates the whole tree
+     * @return the root of the tree, or NULL if no file is open
+     */
+    Component* LoadTopology(int max_depth = -1);
+    /**
+     * @return the root of the created tree, or NULL if nothing has been created yet
+     */
+    Component* GetRoot() const;
+    /**
+     * Loads all DataPaths whose Components have been created, and detaches the created Components from the DataPaths that cannot be loaded (so that the loader may be destroyed without losing DataPaths of the created tree).
+     * @return the number of loaded datapath and datapath-matrix elements
+     */
+    int LoadAllDataPaths();
+    /**
+     * @private
+     * Loads the DataPaths of c whose Components have been created (called on the first access to the DataPaths of c).
+     */
+    void LoadDataPaths(Component* c);
+    /**
+     * @private
+     * Forgets a deleted Component: it is not created again and its DataPaths are not loaded.
+     */
+    void Forget(Component* c);
+
+private:
+    struct ComponentEntry {
+        string name; /**< element name */
+        int id;
+        string addr;
+        size_t begin, start_end, end; /**< the element, the end of its start tag */
+        bool self_closing;
+        size_t parent; /**< index of the parent entry; SIZE_MAX for the root */
+        vector<size_t> children;
+        vector<std::pair<size_t, size_t>> attributes; /**< the Attribute elements */
+        Component* c;
+        bool deleted;
+    };
+    struct DataPathEntry {
+        size_t begin, end;
+        vector<string> addrs; /**< the Components the element connects */
+        bool loaded;
+    };
+
+    string readRange(size_t begin, size_t end);
+    Component* createComponent(size_t index, bool with_subtree);
+    void attachCreated(size_t index, bool with_subtree);
+    bool loadable(const DataPathEntry& dp) const;
+    void loadDataPath(size_t dp_index);
+    void updatePending(Component* c, size_t index);
+
+    XmlImporter importer;
+    mutable std::recursive_mutex lock; /**< serializes the methods; recursive, because creating a DataPath accesses the DataPaths of its Components, which may load them */
+    string path;
+    std::ifstream file;
+    vector<ComponentEntry> components;
+    vector<DataPathEntry> datapaths;
+    std::unordered_map<string, vector<size_t>> datapaths_by_addr;
+    std::unordered_map<Component*, size_t> created;
+    XmlImportAddresses addresses;
+};
+
 /**
  * Imports the sys-sage internal representation from an XML file.
+ * \n Equivalent to XmlImporter(search_custom_attrib_key_fcn, search_custom_complex_attrib_key_fcn).Import(path).
  * @param path Path to the XML file.
  * @param search_custom_attrib_key_fcn Function pointer for custom attribute key search.
  * @param search_custom_complex_attrib_key_fcn Function pointer for custom complex attribute key search.
  */
 Component* importFromXml(string path, std::function<void*(xmlNodePtr)> search_custom_attrib_key_fcn = NULL, std::function<int(xmlNodePtr, Component*)> search_custom_complex_attrib_key_fcn = NULL);
 
+/**
+ * Imports multiple XML files on a pool of threads.
+ * @param paths Paths to the XML files.
+ * @param num_threads Number of threads; 0 (default) uses std::thread::hardware_concurrency().
+ * @param importer The import context shared by all imports.
+ * @return the imported Topology of each path (in the same order), NULL for the files that could not be read
+ */
+vector<Component*> importFromXmlBatch(const vector<string>& paths, int num_threads = 0, const XmlImporter& importer = XmlImporter());
+
 /**
  * @private
- * For searching default attributes, i.e. those 
+ * For searching default attributes, i.e. those
     for a specific key, and adding them to the Component.
  */
 void* search_default_attrib_key(xmlNodePtr n);
 
 /**
  * @private
- * Collects the attributes from an xmlNode and adds them to a Component.
+ * Collects the attributes from an xmlNode and adds them to a Component (default attributes only).
  */
 int collect_attrib(xmlNodePtr n, Component* c);
 
 #endif
-
@@ -0,0 +1,95 @@
+#include <boost/ut.hpp>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static suite<"attribute"> _ = []
+{
+    "Default attribute keys"_test = []
+    {
+        auto catcos = GetAttributeHandler("CATcos");
+        expect(that % (catcos != nullptr) >> fatal);
+        expect(that % "uint64"sv == catcos->type);
+        uint64_t cos = 5;
+        expect(that % "5"sv == catcos->serialize(&cos));
+        expect(that % "timeseries"sv == GetAttributeHandler("freq_history")->type);
+        expect(that % (GetAttributeHandler("freq_history")->serialize_xml != nullptr));
+        expect(that % (GetAttributeHandler("no_such_key") == nullptr));
+        expect(that % (GetAttributeHandlerKeys().size() >= 22));
+
+        auto latency = (float *)GetAttributeHandler("latency")->deserialize("412.5");
+        expect(that % 412.5f == *latency);
+        GetAttributeHandler("latency")->destroy(latency);
+        expect(that % (GetAttributeHandler("Bus_Width_bit")->deserialize("wide") == nullptr));
+    };
+
+    "User-registered keys are exported and imported"_test = []
+    {
+        expect(that % 1 == RegisterAttributeHandler("empty", AttributeHandler{}));
+        expect(that % 0 == RegisterAttributeHandler("temperature", ScalarAttributeHandler<double>("double")));
+
+        AttributeHandler pair;
+        pair.type = "pair";
+        pair.serialize_xml = [](const string &key, void *value, xmlNodePtr n)
+        {
+            auto p = (std::pair<int, int> *)value;
+            xmlNodePtr c = xmlNewNode(NULL, BAD_CAST(key.c_str()));
+            xmlNewProp(c, BAD_CAST("first"), BAD_CAST(std::to_string(p->first).c_str()));
+            xmlNewProp(c, BAD_CAST("second"), BAD_CAST(std::to_string(p->second).c_str()));
+            xmlAddChild(n, c);
+        };
+        pair.deserialize_xml = [](xmlNodePtr n) -> void *
+        {
+            xmlNodePtr c = n->children;
+            while (c != NULL && c->type != XML_ELEMENT_NODE)
+                c = c->next;
+            if (c == NULL)
+                return NULL;
+            xmlChar *first = xmlGetProp(c, BAD_CAST("first"));
+            xmlChar *second = xmlGetProp(c, BAD_CAST("second"));
+            auto p = new std::pair<int, int>(atoi((char *)first), atoi((char *)second));
+            xmlFree(first);
+            xmlFree(second);
+            return p;
+        };
+        pair.size = [](void *) { return sizeof(std::pair<int, int>); };
+        expect(that % 0 == RegisterAttributeHandler("ports", pair));
+
+        Topology topo;
+        Node node{&topo, 1};
+        double temperature = 38.5;
+        std::pair<int, int> ports{3, 7};
+        std::string uuid = "MIG-1";
+        node.attrib["temperature"] = &temperature;
+        node.attrib["ports"] = &ports;
+        node.attrib["mig_uuid"] = &uuid;
+        node.attrib["not_registered"] = &temperature;
+
+        unsigned component_size = 0, dataPath_size = 0;
+        node.GetTopologySize(&component_size, &dataPath_size);
+        expect(that % (sizeof(Node) + 4 * (sizeof(string) + sizeof(void *)) + sizeof(double) + sizeof(std::pair<int, int>) + sizeof(string) + uuid.capacity() == component_size));
+
+        exportToXml(&topo, "attribute.xml");
+        expect(that % 0 == UnregisterAttributeHandler("temperature"));
+        expect(that % 1 == UnregisterAttributeHandler("temperature"));
+        Component *imported = importFromXml("attribute.xml");
+        expect(that % (imported != nullptr) >> fatal);
+        Component *n = imported->GetChild(1);
+        expect(that % (n != nullptr) >> fatal);
+        // "temperature" was unregistered before the import
+        expect(that % 2_u == n->attrib.size());
+        expect(that % (n->attrib.count("temperature") == 0));
+        expect(that % "MIG-1"sv == *(std::string *)n->attrib["mig_uuid"]);
+        auto p = (std::pair<int, int> *)n->attrib["ports"];
+        expect(that % 3 == p->first);
+        expect(that % 7 == p->second);
+
+        expect(that % 0 == RegisterAttributeHandler("temperature", ScalarAttributeHandler<double>("double")));
+        imported = importFromXml("attribute.xml");
+        expect(that % (imported != nullptr) >> fatal);
+        expect(that % 38.5 == *(double *)imported->GetChild(1)->attrib["temperature"]);
+        UnregisterAttributeHandler("temperature");
+        UnregisterAttributeHandler("ports");
+    };
+};
@@ -96,4 +96,44 @@ static suite<"caps-numa-benchmark"> _ = []
         expect(that % 211 == dp(2, 3)->GetLatency());
         expect(that % 246 == dp(3, 3)->GetLatency());
     };
+
+    "No bandwidth sweep in the single-threaded output"_test = [&]
+    {
+        for (const auto &dp : *numas[0]->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+            expect(that % (dp->attrib.find("bw_sweep") == dp->attrib.end()));
+    };
+
+    "Bandwidth sweep"_test = []
+    {
+        Topology topo;
+        Node node{&topo};
+        expect(that % (0 == parseHwlocOutput(&node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+        expect(that % (0 == parseCapsNumaBenchmark(&node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark_sweep.csv")) >> fatal);
+
+        auto numa0 = node.GetSubcomponentById(0, SYS_SAGE_COMPONENT_NUMA);
+        expect(that % (4 == numa0->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size()) >> fatal);
+        auto dp = (*numa0->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))[2];
+        expect(that % 6439 == dp->GetBandwidth());
+        expect(that % 302 == dp->GetLatency());
+
+        auto it = dp->attrib.find("bw_sweep");
+        expect(that % (it != dp->attrib.end()) >> fatal);
+        auto sweep = (std::vector<std::tuple<std::string, int, double>> *)it->second;
+        expect(that % (9 == sweep->size()) >> fatal);
+
+        auto [kernel0, threads0, bw0] = (*sweep)[0];
+        expect(that % ("read" == kernel0));
+        expect(that % 1 == threads0);
+        expect(that % 8410 == bw0);
+
+        auto [kernel5, threads5, bw5] = (*sweep)[5];
+        expect(that % ("write" == kernel5));
+        expect(that % 6 == threads5);
+        expect(that % 12080 == bw5);
+
+        auto [kernel7, threads7, bw7] = (*sweep)[7];
+        expect(that % ("copy" == kernel7));
+        expect(that % 3 == threads7);
+        expect(that % 14210 == bw7);
+    };
 };
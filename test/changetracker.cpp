@@ -0,0 +1,156 @@
+#include <boost/ut.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static std::multiset<std::string> dataPathsSection(Component *root)
+{
+    xmlDocPtr doc = XmlExporter().CreateDocument(root);
+    xmlChar *buffer = nullptr;
+    int size = 0;
+    xmlDocDumpFormatMemory(doc, &buffer, &size, 1);
+    std::string out(reinterpret_cast<char *>(buffer), size);
+    xmlFree(buffer);
+    xmlFreeDoc(doc);
+    // the DataPaths of a Component changed by a delta are created again, i.e. in a different order
+    std::istringstream section(out.substr(out.find("<data-paths>")));
+    std::multiset<std::string> lines;
+    for (std::string line; std::getline(section, line);)
+        lines.insert(line);
+    return lines;
+}
+
+static suite<"changetracker"> _ = []
+{
+    "Deltas follow the changes of the topology"_test = []
+    {
+        Topology *topo = new Topology();
+        Node *node = new Node(topo, 0);
+        expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+        expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+        vector<Component *> cores, numas;
+        topo->GetAllSubcomponentsByType(&cores, SYS_SAGE_COMPONENT_CORE);
+        topo->GetAllSubcomponentsByType(&numas, SYS_SAGE_COMPONENT_NUMA);
+        expect(that % (cores.size() >= 2 && numas.size() >= 2) >> fatal);
+        std::remove("delta_snapshot.xml");
+        std::remove("delta.log");
+
+        ChangeTracker tracker(topo);
+        expect(that % 0 == tracker.WriteSnapshot("delta_snapshot.xml"));
+        vector<Component *> changed_attrib, changed_dp;
+        expect(that % 0 == tracker.GetChanges(&changed_attrib, &changed_dp));
+        expect(that % (changed_attrib.empty() && changed_dp.empty()));
+        // nothing changed, nothing is appended
+        expect(that % 0 == tracker.AppendDelta("delta.log"));
+        expect(that % (!std::filesystem::exists("delta.log")));
+
+        // first delta (XML): an attribute and a new DataPath of a Core, the bandwidth of a caps-numa DataPath
+        uint64_t cos = 3;
+        cores[0]->attrib["CATcos"] = &cos;
+        uint64_t dp_cos = 1;
+        DataPath *dp = new DataPath(cores[0], cores[1], SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_PHYSICAL, 5.5, 2.0);
+        dp->attrib["CATcos"] = &dp_cos;
+        DataPath *numa_dp = numas[1]->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->at(0);
+        numa_dp->SetBandwidth(1234.5);
+#ifdef PROC_CPUINFO
+        ((Core *)cores[1])->SetFreq(2100.5);
+#endif
+        expect(that % 0 == tracker.GetChanges(&changed_attrib, &changed_dp));
+        expect(that % (std::find(changed_attrib.begin(), changed_attrib.end(), cores[0]) != changed_attrib.end()));
+        expect(that % (std::find(changed_dp.begin(), changed_dp.end(), cores[0]) != changed_dp.end()));
+        expect(that % (std::find(changed_dp.begin(), changed_dp.end(), numas[1]) != changed_dp.end()));
+        expect(that % (std::find(changed_dp.begin(), changed_dp.end(), numas[0]) == changed_dp.end()));
+        expect(that % 0 == tracker.AppendDelta("delta.log"));
+        expect(that % 1 == tracker.GetSequenceNumber());
+        // the delta carries only the changed Components
+        auto delta_size = std::filesystem::file_size("delta.log");
+        expect(that % (delta_size * 10 < std::filesystem::file_size("delta_snapshot.xml")));
+
+        // the consumer follows the log
+        Component *imported = importFromXml("delta_snapshot.xml");
+        expect(that % (imported != nullptr) >> fatal);
+        vector<Component *> imported_cores;
+        imported->GetAllSubcomponentsByType(&imported_cores, SYS_SAGE_COMPONENT_CORE);
+        size_t offset = 0;
+        expect(that % 1 == ApplyDeltas(imported, "delta.log", &offset, XmlImporter()));
+        expect(that % (offset == delta_size));
+        expect(that % 3_u == *(uint64_t *)imported_cores[0]->attrib["CATcos"]);
+        expect(that % 1_u == imported_cores[0]->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+#ifdef PROC_CPUINFO
+        expect(that % 2100.5 == ((Core *)imported_cores[1])->GetFreq());
+#endif
+
+        // second delta (binary): the attribute changes, the DataPath is deleted
+        cos = 7;
+        cores[0]->DeleteDataPath(dp);
+        expect(that % 0 == tracker.AppendDelta("delta.log", SYS_SAGE_DELTA_BINARY));
+        expect(that % 2 == tracker.GetSequenceNumber());
+        expect(that % 0 == tracker.GetChanges(&changed_attrib, &changed_dp));
+
+        expect(that % 1 == ApplyDeltas(imported, "delta.log", &offset));
+        expect(that % (offset == std::filesystem::file_size("delta.log")));
+        expect(that % 0 == ApplyDeltas(imported, "delta.log", &offset));
+        expect(that % 7_u == *(uint64_t *)imported_cores[0]->attrib["CATcos"]);
+        expect(that % 0_u == imported_cores[0]->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+        expect(that % (dataPathsSection(topo) == dataPathsSection(imported)));
+
+        // a record that is still being written is left for the next call
+        {
+            std::ofstream log("delta.log", std::ios::app | std::ios::binary);
+            log.write("SSD1\x40\x00", 6);
+        }
+        size_t end = offset;
+        expect(that % 0 == ApplyDeltas(imported, "delta.log", &offset));
+        expect(that % (offset == end));
+        {
+            std::ofstream log("delta_bad.log");
+            log << "garbage";
+        }
+        expect(that % -1 == ApplyDeltas(imported, "delta_bad.log"));
+        {
+            // a complete record whose frequency (flag 4) is cut short: seq 1, 1 component, addr 0, 3 of the 8 bytes of the double
+            std::ofstream log("delta_bad.log", std::ios::binary);
+            log.write("SSD1\x07\x00\x00\x00\x01\x01\x00\x04\x00\x00\x00", 15);
+        }
+        offset = 0;
+        expect(that % -1 == ApplyDeltas(imported, "delta_bad.log", &offset));
+        expect(that % (offset == 0));
+        {
+            // the first component is valid, the DataPath of the second one has no bandwidth: nothing is applied
+            vector<Component *> dfs = imported->GetComponentsInSubtree();
+            size_t addr = std::find(dfs.begin(), dfs.end(), imported_cores[0]) - dfs.begin();
+            std::ofstream log("delta_bad.log");
+            log << "<sys-sage-delta seq=\"9\"><component addr=\"" << addr << "\"><attributes/></component>"
+                << "<component addr=\"1\"><datapaths><datapath target=\"2\" oriented=\"1\" dp_type=\"1\" latency=\"1\"/></datapaths></component></sys-sage-delta>\n"
+                << "<sys-sage-delta seq=\"10\"><component addr=\"1\" freq=\"fast\"/></sys-sage-delta>\n";
+        }
+        expect(that % -1 == ApplyDeltas(imported, "delta_bad.log", &offset));
+        expect(that % (offset == 0));
+        expect(that % 7_u == *(uint64_t *)imported_cores[0]->attrib["CATcos"]);
+        std::string bad = "<sys-sage-delta seq=\"10\">";
+        std::ifstream bad_log("delta_bad.log");
+        std::string contents((std::istreambuf_iterator<char>(bad_log)), std::istreambuf_iterator<char>());
+        offset = contents.find(bad);
+        expect(that % -1 == ApplyDeltas(imported, "delta_bad.log", &offset)) << "malformed frequency";
+        expect(that % -1 == ApplyDeltas(imported, "no_such.log"));
+
+        // added Components cannot be described by a delta
+        Thread *t = new Thread(cores[0], 1000);
+        expect(that % 1 == tracker.GetChanges(NULL, NULL));
+        expect(that % 2 == tracker.AppendDelta("delta.log"));
+        expect(that % 0 == tracker.WriteSnapshot("delta_snapshot.xml"));
+        expect(that % 0 == tracker.GetChanges(NULL, NULL));
+        t->Delete(false);
+
+        cores[0]->attrib.erase("CATcos");
+        imported->Delete(true);
+        topo->Delete(true);
+    };
+};
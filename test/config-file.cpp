@@ -0,0 +1,96 @@
+#include <boost/ut.hpp>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static suite<"config-file"> _ = []
+{
+    ConfigFile config;
+    expect(that % (0 == config.Load(SYS_SAGE_TEST_RESOURCE_DIR "/musa.conf")) >> fatal);
+
+    "Sections and values"_test = [&]
+    {
+        auto names = config.GetSectionNames();
+        expect(that % (names.size() > 10) >> fatal);
+        expect(that % "Global"sv == names[0]);
+        expect(config.HasSection("L3Cache"));
+        expect(!config.HasSection("L4Cache"));
+        expect(config.HasKey("DL1Cache", "line-size"));
+        expect(!config.HasKey("DL1Cache", "ncpus"));
+
+        expect(that % 24 == config.GetInt("Global", "ncpus"));
+        expect(that % "MEMORY"sv == config.Get("Global", "mode_selector"));
+        expect(that % 16 == config.GetInt("L3Cache", "assoc"));
+        expect(that % 2100.0 == config.GetDouble("Global", "cpu_freq_mhz"));
+        // inline comments are stripped
+        expect(that % 153600000000.0 == config.GetDouble("Memory", "bandwidth"));
+        expect(that % 120 == config.GetInt("Memory", "latency"));
+        // "size= 16" without a space before '='
+        expect(that % 16 == config.GetInt("DL1MSHR", "size"));
+        // values with spaces are kept
+        expect(that % "CPU CACHE RAM"sv == config.Get("Paraver", "modules"));
+        // defaults
+        expect(that % "none"sv == config.Get("Global", "missing", "none"));
+        expect(that % -1 == config.GetInt("Global", "mode_selector", -1));
+
+        auto section = config.GetSection("LRU");
+        expect(that % (section != nullptr) >> fatal);
+        expect(that % 1_u == section->size());
+        expect(that % (config.GetSection("missing") == nullptr));
+    };
+
+    "Sizes with units"_test = []
+    {
+        long long size = 0;
+        expect(that % (0 == ConfigFile::ParseSize("32768", &size)));
+        expect(that % 32768 == size);
+        expect(that % (0 == ConfigFile::ParseSize("32 KiB", &size)));
+        expect(that % 32768 == size);
+        expect(that % (0 == ConfigFile::ParseSize("8Gb", &size)));
+        expect(that % 8000000000ll == size);
+        expect(that % (0 == ConfigFile::ParseSize("2MiB", &size)));
+        expect(that % 2097152 == size);
+        expect(that % (1 == ConfigFile::ParseSize("2 parsecs", &size)));
+        expect(that % (1 == ConfigFile::ParseSize("large", &size)));
+
+        ConfigFile c;
+        c.LoadString("top = 1\nlevel = 010\n[system.cpu.dcache]\nsize=64kB ; gem5-style\nassoc=2\n");
+        expect(that % 1 == c.GetInt("", "top"));
+        expect(that % 10 == c.GetInt("", "level")) << "decimal, like the sizes";
+        expect(that % 64000 == c.GetSize("system.cpu.dcache", "size"));
+        expect(that % 2 == c.GetInt("system.cpu.dcache", "assoc"));
+    };
+
+    "Declarative mapping to components"_test = [&]
+    {
+        Chip socket;
+        ConfigMapping l1{"DL1Cache", SYS_SAGE_COMPONENT_CACHE, {{"cache_level", "level"}, {"cache_size", "size"}, {"cache_line_size", "line-size"}, {"cache_associativity_ways", "assoc"}}, {{"latency", "latency", SYS_SAGE_CONFIG_DOUBLE}, {"policy", "policy", SYS_SAGE_CONFIG_STRING}}};
+        auto cache = dynamic_cast<Cache *>(config.CreateComponent(l1, &socket, 3));
+        expect(that % (cache != nullptr) >> fatal);
+        expect(that % &socket == cache->GetParent());
+        expect(that % 3 == cache->GetId());
+        expect(that % 1 == cache->GetCacheLevel());
+        expect(that % 32768 == cache->GetCacheSize());
+        expect(that % 64 == cache->GetCacheLineSize());
+        expect(that % 8 == cache->GetCacheAssociativityWays());
+        expect(that % 4.0 == *(double *)cache->attrib["latency"]);
+        expect(that % "LRUPOLICY"sv == *(std::string *)cache->attrib["policy"]);
+
+        ConfigMapping core{"Global", SYS_SAGE_COMPONENT_CORE, {{"id", "threads_per_cpu"}}, {{"freq", "cpu_freq_mhz", SYS_SAGE_CONFIG_INT}}};
+        auto c = config.CreateComponent(core, cache);
+        expect(that % (c != nullptr) >> fatal);
+        expect(that % SYS_SAGE_COMPONENT_CORE == c->GetComponentType());
+        expect(that % 1 == c->GetId());
+        expect(that % 2100 == *(int *)c->attrib["freq"]);
+
+        // errors: nothing is created
+        ConfigMapping missingSection{"L4Cache", SYS_SAGE_COMPONENT_CACHE, {}, {}};
+        ConfigMapping missingKey{"L2Cache", SYS_SAGE_COMPONENT_CACHE, {{"cache_size", "capacity"}}, {}};
+        ConfigMapping invalidValue{"L2Cache", SYS_SAGE_COMPONENT_CACHE, {{"cache_size", "policy"}}, {}};
+        ConfigMapping invalidAttrib{"L2Cache", SYS_SAGE_COMPONENT_CACHE, {}, {{"latency", "policy", SYS_SAGE_CONFIG_DOUBLE}}};
+        for (auto const &m : {missingSection, missingKey, invalidValue, invalidAttrib})
+            expect(that % (config.CreateComponent(m, &socket) == nullptr));
+        expect(that % 1_u == socket.GetChildren()->size());
+    };
+};
@@ -0,0 +1,73 @@
+#include <boost/ut.hpp>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static suite<"cpu-cache-benchmark"> _ = []
+{
+    Topology topo;
+    Node node{&topo};
+
+    expect(that % (0 == parseHwlocOutput(&node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal)
+        << "Parse hwloc XML file";
+
+    expect(that % (0 == parseCpuCacheBenchmark(&node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_cpu_cache_benchmark.csv")) >> fatal)
+        << "Parse benchmark CSV file";
+
+    auto thread0 = node.GetSubcomponentById(0, SYS_SAGE_COMPONENT_THREAD);
+    auto thread1 = node.GetSubcomponentById(1, SYS_SAGE_COMPONENT_THREAD);
+    expect(that % (thread0 != nullptr) >> fatal);
+    expect(that % (thread1 != nullptr) >> fatal);
+
+    "Number, type, and orientation of data paths"_test = [&]
+    {
+        for (const auto &thread : {thread0, thread1})
+        {
+            expect(that % (3 == thread->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size()) >> fatal);
+            for (const auto &dp : *thread->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+            {
+                expect(that % SYS_SAGE_DATAPATH_TYPE_DATATRANSFER == dp->GetDataPathType());
+                expect(that % SYS_SAGE_DATAPATH_ORIENTED == dp->GetOrientation());
+                expect(that % SYS_SAGE_COMPONENT_CACHE == dp->GetTarget()->GetComponentType());
+            }
+        }
+    };
+
+    "Data paths lead to the caches of the thread"_test = [&]
+    {
+        auto dps = thread0->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING);
+        for (size_t i = 0; i < 3; ++i)
+        {
+            auto cache = dynamic_cast<Cache *>((*dps)[i]->GetTarget());
+            expect(that % (cache != nullptr) >> fatal);
+            expect(that % cache->GetCacheLevel() == (int)i + 1);
+        }
+
+        auto l3 = node.GetSubcomponentById(7, SYS_SAGE_COMPONENT_CACHE);
+        expect(that % (2 == l3->GetDataPaths(SYS_SAGE_DATAPATH_INCOMING)->size()));
+    };
+
+    "Bandwidth, latency, and working set size"_test = [&]
+    {
+        auto dp = (*thread1->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))[1];
+        expect(that % 11 == dp->GetTarget()->GetId());
+        expect(that % 61102.7 == dp->GetBandwidth());
+        expect(that % 4.41 == dp->GetLatency());
+        auto ws = (long long *)dp->attrib["working_set_size"];
+        expect(that % (ws != nullptr) >> fatal);
+        expect(that % 540672 == *ws);
+    };
+
+    "Parsing again updates the existing data paths"_test = [&]
+    {
+        expect(that % (0 == parseCpuCacheBenchmark(&node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_cpu_cache_benchmark.csv")) >> fatal);
+        expect(that % (3 == thread0->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size()));
+    };
+
+    "Missing file"_test = []
+    {
+        Topology t;
+        expect(that % (1 == parseCpuCacheBenchmark(&t, "/nonexistent.csv")));
+    };
+};
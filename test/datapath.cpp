@@ -133,4 +133,47 @@ static suite<"data-path"> _ = []
             expect(that % std::vector{&dp2, &dp3, &dp4} == v);
         };
     };
+
+    "Broadcast data path"_test = []
+    {
+        Chip chip;
+        Cache l2{&chip, 0, 2};
+        Core core0{&l2, 0};
+        Thread t0{&core0, 0};
+        Thread t1{&core0, 1};
+        Core core1{&l2, 1};
+        Thread t2{&core1, 2};
+        Memory memory{&chip};
+        DataPath dp{&memory, &l2, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 10.0, 42.0, SYS_SAGE_COMPONENT_THREAD};
+
+        expect(dp.IsBroadcast());
+        expect(that % SYS_SAGE_COMPONENT_THREAD == dp.GetBroadcastType());
+        // stored once
+        expect(that % (std::vector{&dp}) == *memory.GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING));
+        expect(that % (std::vector{&dp}) == *l2.GetDataPaths(SYS_SAGE_DATAPATH_INCOMING));
+        expect(that % t1.GetDataPaths(SYS_SAGE_DATAPATH_INCOMING)->empty());
+        // resolved for the threads of the subtree
+        for (Component *t : {&t0, &t1, &t2})
+        {
+            expect(that % &dp == t->GetDataPathByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_INCOMING));
+            expect(that % std::vector{&dp} == t->GetAllDataPathsByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_INCOMING));
+            expect(dp.HasTarget(t));
+        }
+        expect(that % nullptr == t0.GetDataPathByType(SYS_SAGE_DATAPATH_TYPE_PHYSICAL, SYS_SAGE_DATAPATH_INCOMING));
+        expect(that % nullptr == core0.GetDataPathByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_INCOMING));
+        expect(that % nullptr == l2.GetDataPathByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_INCOMING));
+        expect(!dp.HasTarget(&core0));
+        expect(that % (std::vector<Component *>{&t0, &t1, &t2}) == dp.GetTargets());
+
+        // the component types are flags
+        DataPath dp2{&memory, &l2, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_PHYSICAL, 1.0, 1.0, SYS_SAGE_COMPONENT_CORE | SYS_SAGE_COMPONENT_THREAD};
+        expect(that % (std::vector<Component *>{&core0, &t0, &t1, &core1, &t2}) == dp2.GetTargets());
+        expect(that % &dp2 == core1.GetDataPathByType(SYS_SAGE_DATAPATH_TYPE_PHYSICAL, SYS_SAGE_DATAPATH_INCOMING));
+
+        // a regular data path is not a broadcast
+        DataPath dp3{&memory, &t0, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 1.0, 1.0, 0};
+        expect(!dp3.IsBroadcast());
+        expect(that % (std::vector<Component *>{&t0}) == dp3.GetTargets());
+        expect(that % std::vector{&dp3, &dp} == t0.GetAllDataPathsByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_INCOMING));
+    };
 };
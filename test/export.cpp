@@ -263,4 +263,185 @@ static suite<"export"> _ = []
             }
         }
     };
+
+    "Parallel export is identical to the serial export"_test = []
+    {
+        Topology topo;
+        for (int i = 0; i < 3; i++)
+        {
+            Node *node = new Node(&topo, i);
+            expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+            expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+            expect(that % (0 == parseMt4gTopo(node, SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv", 0)) >> fatal);
+        }
+
+        XmlExporter exporter;
+        auto dump = [&](int threads)
+        {
+            auto doc = raii<xmlDoc>{exporter.CreateDocument(&topo, threads), xmlFreeDoc};
+            xmlChar *buffer = nullptr;
+            int size = 0;
+            xmlDocDumpFormatMemory(doc.get(), &buffer, &size, 1);
+            std::string out(reinterpret_cast<char *>(buffer), size);
+            xmlFree(buffer);
+            return out;
+        };
+        std::string serial = dump(1);
+        expect(that % (serial.size() > 0));
+        for (int threads : {2, 3, 8, 0})
+            expect(that % (serial == dump(threads))) << "threads:" << threads;
+
+        expect(that % 0 == exporter.Export(&topo, "parallel.xml", 4));
+        topo.DeleteSubtree();
+    };
+
+    "Component addresses are DFS indices"_test = []
+    {
+        auto dump = [](Component *root)
+        {
+            auto doc = raii<xmlDoc>{XmlExporter().CreateDocument(root), xmlFreeDoc};
+            xmlChar *buffer = nullptr;
+            int size = 0;
+            xmlDocDumpFormatMemory(doc.get(), &buffer, &size, 1);
+            std::string out(reinterpret_cast<char *>(buffer), size);
+            xmlFree(buffer);
+            return out;
+        };
+        auto build = []
+        {
+            Topology *topo = new Topology();
+            Node *node = new Node(topo, 0);
+            expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+            expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+            return topo;
+        };
+        // two identical topologies (at different addresses in memory) are exported identically
+        Topology *a = build();
+        Topology *b = build();
+        std::string out = dump(a);
+        expect(that % (out == dump(b)));
+        expect(that % (out.find("addr=\"0\"") != std::string::npos));
+        expect(that % (out.find("addr=\"0x") == std::string::npos));
+        expect(that % (out.find(std::to_string(a->CountAllSubcomponents()) + "\"") != std::string::npos));
+
+        expect(that % 0 == exportToXml(a, "indices.xml"));
+        validate("indices.xml");
+        Component *imported = importFromXml("indices.xml");
+        expect(that % (imported != nullptr) >> fatal);
+        // the DataPaths refer to the same indices after the import
+        std::string reexported = dump(imported);
+        expect(that % (out.substr(out.find("<data-paths>")) == reexported.substr(reexported.find("<data-paths>"))));
+        imported->Delete(true);
+        a->Delete(true);
+        b->Delete(true);
+    };
+
+    "Selective export"_test = []
+    {
+        Topology topo;
+        for (int i = 0; i < 2; i++)
+        {
+            Node *node = new Node(&topo, i);
+            expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+            expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+        }
+        uint64_t cos = 3;
+        std::string group = "g1";
+        topo.GetChild(0)->attrib["CATcos"] = &cos;
+        topo.GetChild(0)->attrib["resctrl_group"] = &group;
+
+        XmlExporter exporter;
+        auto dump = [&](int threads)
+        {
+            auto doc = raii<xmlDoc>{exporter.CreateDocument(&topo, threads), xmlFreeDoc};
+            xmlChar *buffer = nullptr;
+            int size = 0;
+            xmlDocDumpFormatMemory(doc.get(), &buffer, &size, 1);
+            std::string out(reinterpret_cast<char *>(buffer), size);
+            xmlFree(buffer);
+            return out;
+        };
+        auto count = [](const std::string &xml, const char *query)
+        {
+            auto doc = raii<xmlDoc>{xmlReadMemory(xml.c_str(), xml.size(), nullptr, nullptr, 0), xmlFreeDoc};
+            auto context = raii<xmlXPathContext>{xmlXPathNewContext(doc.get()), xmlXPathFreeContext};
+            auto result = raii<xmlXPathObject>{xmlXPathEvalExpression(BAD_CAST(query), context.get()), xmlXPathFreeObject};
+            return result->nodesetval == nullptr ? 0 : result->nodesetval->nodeNr;
+        };
+        std::string full = dump(1);
+        int threads = count(full, "//HW_thread");
+        expect(that % (threads > 0));
+        expect(that % (count(full, "//Cache") > 0));
+        expect(that % (count(full, "//datapath") > 0));
+
+        // Caches are flattened: the Cores are attached to the closest exported ancestor
+        XmlExportOptions options;
+        options.component_types = ~SYS_SAGE_COMPONENT_CACHE;
+        exporter.SetOptions(options);
+        std::string no_caches = dump(1);
+        expect(that % 0 == count(no_caches, "//Cache"));
+        expect(that % threads == count(no_caches, "//HW_thread"));
+        expect(that % count(full, "//Core") == count(no_caches, "//Core"));
+        expect(that % count(full, "//Core") == count(no_caches, "//NUMA/Core"));
+        expect(that % count(full, "//datapath") == count(no_caches, "//datapath"));
+        expect(that % (no_caches.size() < full.size()));
+        for (int t : {2, 4})
+            expect(that % (no_caches == dump(t))) << "threads:" << t;
+
+        // the NUMA regions are too deep: their DataPaths are not exported either
+        options = XmlExportOptions();
+        options.max_depth = 2;
+        exporter.SetOptions(options);
+        std::string shallow = dump(1);
+        expect(that % 2 == count(shallow, "//Node"));
+        expect(that % 0 == count(shallow, "//Node/*/*"));
+        expect(that % 0 == count(shallow, "//datapath"));
+        expect(that % (shallow == dump(4)));
+
+        // only the subtree of the second Node, without DataPaths and attributes
+        options = XmlExportOptions();
+        options.subtree_roots = {topo.GetChild(1)};
+        options.datapath_types = SYS_SAGE_DATAPATH_TYPE_NONE;
+        options.filter_attributes = true;
+        exporter.SetOptions(options);
+        std::string subtree = dump(1);
+        expect(that % 1 == count(subtree, "//Node"));
+        expect(that % 1 == count(subtree, "//Node[@id='1']"));
+        expect(that % (threads / 2) == count(subtree, "//HW_thread"));
+        expect(that % 0 == count(subtree, "//Attribute"));
+        expect(that % (subtree == dump(4)));
+
+        // only the subtree of the first Node, with the allowed attribute
+        options.subtree_roots = {topo.GetChild(0)};
+        options.datapath_types = -1;
+        options.attributes = {"CATcos"};
+        exporter.SetOptions(options);
+        expect(that % 0 == exporter.Export(&topo, "selective.xml"));
+        validate("selective.xml");
+        std::string first = dump(1);
+        expect(that % 1 == count(first, "//Attribute"));
+        expect(that % 1 == count(first, "//Attribute[@name='CATcos']"));
+        expect(that % (count(first, "//datapath") * 2 == count(full, "//datapath")));
+
+        options = XmlExportOptions();
+        options.datapath_types = 0;
+        expect(that % 0 == exportToXml(&topo, "selective.xml", options));
+        validate("selective.xml");
+
+        // the caps-numa DataPaths as matrices
+        for (int encoding : {SYS_SAGE_XML_DATAPATH_MATRIX_TEXT, SYS_SAGE_XML_DATAPATH_MATRIX_BASE64})
+        {
+            options = XmlExportOptions();
+            options.datapath_matrix = encoding;
+            expect(that % 0 == exportToXml(&topo, "selective.xml", options));
+            validate("selective.xml");
+            exporter.SetOptions(options);
+            std::string matrix = dump(1);
+            expect(that % 2 == count(matrix, "//datapath-matrix"));
+            expect(that % 0 == count(matrix, "//datapath"));
+        }
+
+        topo.GetChild(0)->attrib.clear();
+        topo.DeleteSubtree();
+    };
 };
@@ -0,0 +1,103 @@
+#include <boost/ut.hpp>
+
+#include <cstdio>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static Node *buildNode(Component *parent, int id)
+{
+    Node *node = new Node(parent, id);
+    expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+    expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+    return node;
+}
+
+static suite<"hash"> _ = []
+{
+    "Identical subtrees have equal hashes"_test = []
+    {
+        Topology *topo = new Topology();
+        Node *n0 = buildNode(topo, 0);
+        Node *n1 = buildNode(topo, 1);
+        expect(that % (n0->GetHash() != n1->GetHash()));
+        expect(that % (n0->GetHash(SYS_SAGE_HASH_IGNORE_ID) == n1->GetHash(SYS_SAGE_HASH_IGNORE_ID)));
+        expect(that % (n0->GetHash(SYS_SAGE_HASH_IGNORE_ID | SYS_SAGE_HASH_DATAPATHS) == n1->GetHash(SYS_SAGE_HASH_IGNORE_ID | SYS_SAGE_HASH_DATAPATHS)));
+        expect(that % (n0->GetHash() != n0->GetHash(SYS_SAGE_HASH_DATAPATHS)));
+        vector<Component *> numas0 = n0->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_NUMA);
+        vector<Component *> numas1 = n1->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_NUMA);
+        expect(that % (numas0.size() >= 2 && numas0.size() == numas1.size()) >> fatal);
+        expect(that % (numas0[0]->GetHash() == numas1[0]->GetHash()));
+        expect(that % (numas0[0]->GetHash() != numas0[1]->GetHash()));
+
+        // two imports of the same file
+        expect(that % (0 == exportToXml(topo, "hash.xml")) >> fatal);
+        Component *imported = importFromXml("hash.xml");
+        Component *imported_again = importFromXml("hash.xml");
+        expect(that % (imported != nullptr && imported_again != nullptr) >> fatal);
+        expect(that % (imported->GetHash() == imported_again->GetHash()));
+        expect(that % (imported->GetHash(SYS_SAGE_HASH_DATAPATHS) == imported_again->GetHash(SYS_SAGE_HASH_DATAPATHS)));
+        imported->Delete(true);
+        imported_again->Delete(true);
+        std::remove("hash.xml");
+        topo->Delete(true);
+    };
+
+    "Changes invalidate the hashes of the ancestors"_test = []
+    {
+        Topology *topo = new Topology();
+        Node *n0 = buildNode(topo, 0);
+        Node *n1 = buildNode(topo, 1);
+        uint64_t topo_hash = topo->GetHash();
+        uint64_t topo_dp_hash = topo->GetHash(SYS_SAGE_HASH_DATAPATHS);
+        uint64_t n1_hash = n1->GetHash();
+        expect(that % (topo_hash == topo->GetHash()));
+
+        Cache *l3 = (Cache *)n0->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_CACHE)[0];
+        expect(that % (l3 != nullptr) >> fatal);
+        long long size = l3->GetCacheSize();
+        l3->SetCacheSize(size / 2);
+        expect(that % (topo_hash != topo->GetHash()));
+        expect(that % (topo_dp_hash != topo->GetHash(SYS_SAGE_HASH_DATAPATHS)));
+        expect(that % (n1_hash == n1->GetHash()));
+        l3->SetCacheSize(size);
+        expect(that % (topo_hash == topo->GetHash()));
+        expect(that % (topo_dp_hash == topo->GetHash(SYS_SAGE_HASH_DATAPATHS)));
+
+        // a new child, then removed again
+        Thread *t = new Thread(l3, 1000);
+        expect(that % (topo_hash != topo->GetHash()));
+        t->Delete(false);
+        expect(that % (topo_hash == topo->GetHash()));
+
+        // attribute values modified in place are noticed after MarkDirty()
+        uint64_t *cos = new uint64_t(3);
+        l3->attrib["CATcos"] = cos;
+        l3->MarkDirty();
+        uint64_t with_cos = topo->GetHash();
+        expect(that % (topo_hash != with_cos));
+        *cos = 4;
+        expect(that % (with_cos == topo->GetHash()));
+        l3->MarkDirty();
+        expect(that % (with_cos != topo->GetHash()));
+        l3->attrib.erase("CATcos");
+        delete cos;
+        l3->MarkDirty();
+        expect(that % (topo_hash == topo->GetHash()));
+
+        // DataPaths change only the hashes with SYS_SAGE_HASH_DATAPATHS
+        Component *numa = n0->GetSubcomponentById(0, SYS_SAGE_COMPONENT_NUMA);
+        expect(that % (numa != nullptr) >> fatal);
+        DataPath *dp = new DataPath(l3, numa, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_PHYSICAL, 10.0, 5.0);
+        expect(that % (topo_hash == topo->GetHash()));
+        uint64_t with_dp = topo->GetHash(SYS_SAGE_HASH_DATAPATHS);
+        expect(that % (topo_dp_hash != with_dp));
+        dp->SetBandwidth(20.0);
+        expect(that % (with_dp != topo->GetHash(SYS_SAGE_HASH_DATAPATHS)));
+        l3->DeleteDataPath(dp);
+        expect(that % (topo_dp_hash == topo->GetHash(SYS_SAGE_HASH_DATAPATHS)));
+        expect(that % (n1_hash == n1->GetHash()));
+        topo->Delete(true);
+    };
+};
@@ -8,8 +8,10 @@
 
 #include "sys-sage.hpp"
 
+#include <fstream>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -51,6 +53,261 @@ static suite<"import"> _ = [] {
     }
     expect(found == std::set<int>{0,1,2,3});
   };
+
+  "batch"_test = [] {
+    // the custom attribute callbacks are kept by the exporter/importer, not globally
+    XmlExporter exporter{[](string key, void *value, string *ret) {
+      if (key != "rack")
+        return 0;
+      *ret = std::to_string(*(int *)value);
+      return 1;
+    }};
+    XmlImporter importer{[](xmlNodePtr n) -> void * {
+      xmlChar *name = xmlGetProp(n, BAD_CAST("name"));
+      xmlChar *value = xmlGetProp(n, BAD_CAST("value"));
+      void *ret = NULL;
+      if (name != NULL && value != NULL && std::string((char *)name) == "rack")
+        ret = new int(std::stoi((char *)value));
+      xmlFree(name);
+      xmlFree(value);
+      return ret;
+    }};
+
+    const int files = 8;
+    std::vector<Component *> roots;
+    std::vector<std::string> paths;
+    std::vector<int> racks(files);
+    for (int i = 0; i < files; i++) {
+      Topology *topo = new Topology();
+      Node *node = new Node(topo, i);
+      expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+      expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+      racks[i] = 100 + i;
+      node->attrib["rack"] = &racks[i];
+      roots.push_back(topo);
+      paths.push_back("batch_" + std::to_string(i) + ".xml");
+    }
+    expect(that % 0 == exportToXmlBatch(roots, paths, 4, exporter));
+    expect(that % (0 != exportToXmlBatch(roots, {"batch_x.xml"}, 4, exporter)));
+
+    paths.push_back("nonexistent.xml");
+    std::vector<Component *> imported = importFromXmlBatch(paths, 4, importer);
+    expect(that % ((size_t)files + 1 == imported.size()) >> fatal);
+    expect(that % (imported[files] == nullptr));
+    for (int i = 0; i < files; i++) {
+      expect(that % (imported[i] != nullptr) >> fatal);
+      Component *node = imported[i]->GetChild(i);
+      expect(that % (node != nullptr) >> fatal);
+      expect(that % (100 + i) == *(int *)node->attrib["rack"]);
+      expect(that % roots[i]->CountAllSubcomponents() == imported[i]->CountAllSubcomponents());
+      Component *numa = node->GetSubcomponentById(0, SYS_SAGE_COMPONENT_NUMA);
+      expect(that % (numa != nullptr) >> fatal);
+      expect(that % 4_u == numa->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+      imported[i]->Delete(true);
+      roots[i]->GetChild(i)->attrib.erase("rack");
+      roots[i]->Delete(true);
+    }
+  };
+
+  "datapath matrix"_test = [] {
+    Topology topo;
+    Node *node = new Node(&topo, 0);
+    expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+    expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+    // all-to-all core-to-core latencies, as created by the cccbench parser
+    vector<Component *> cores = node->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_CORE);
+    for (Component *x : cores)
+      for (Component *y : cores) {
+        if (x == y)
+          continue;
+        float latency = 40 + x->GetId() * 0.37f + y->GetId() / 3.0f;
+        DataPath *dp = new DataPath(x, y, SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_C2C, 0, latency);
+        dp->attrib["latency"] = new float(latency);
+        dp->attrib["latency_min"] = new float(latency - 1.1f);
+        dp->attrib["latency_max"] = new float(latency + 2.3f);
+      }
+    size_t dps = cores.size() * (cores.size() - 1) + 16;
+
+    auto countDataPaths = [](Component *root) {
+      size_t n = 0;
+      for (Component *c : root->GetComponentsInSubtree())
+        n += c->GetDataPaths(SYS_SAGE_DATAPATH_INCOMING)->size();
+      return n;
+    };
+    auto fileSize = [](const char *path) {
+      FILE *f = fopen(path, "rb");
+      fseek(f, 0, SEEK_END);
+      long size = ftell(f);
+      fclose(f);
+      return size;
+    };
+    expect(that % dps == countDataPaths(&topo));
+    expect(that % 0 == exportToXml(&topo, "matrix_none.xml", XmlExportOptions()));
+    XmlExportOptions no_datapaths;
+    no_datapaths.datapath_types = 0;
+    expect(that % 0 == exportToXml(&topo, "matrix_components.xml", no_datapaths));
+    // size of the data-paths section
+    long components_size = fileSize("matrix_components.xml");
+    long datapaths_size = fileSize("matrix_none.xml") - components_size;
+
+    for (int encoding : {SYS_SAGE_XML_DATAPATH_MATRIX_TEXT, SYS_SAGE_XML_DATAPATH_MATRIX_BASE64}) {
+      XmlExportOptions options;
+      options.datapath_matrix = encoding;
+      expect(that % 0 == exportToXml(&topo, "matrix.xml", options));
+      expect(that % ((fileSize("matrix.xml") - components_size) * (encoding == SYS_SAGE_XML_DATAPATH_MATRIX_BASE64 ? 10 : 5) < datapaths_size)) << "encoding:" << encoding;
+
+      Component *imported = importFromXml("matrix.xml");
+      expect(that % (imported != nullptr) >> fatal);
+      expect(that % dps == countDataPaths(imported));
+      vector<Component *> imported_cores = imported->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_CORE);
+      expect(that % (cores.size() == imported_cores.size()) >> fatal);
+      Component *x = imported_cores[5];
+      Component *y = imported_cores[17];
+      DataPath *dp = nullptr;
+      for (DataPath *d : *x->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+        if (d->GetTarget() == y)
+          dp = d;
+      expect(that % (dp != nullptr) >> fatal);
+      float latency = 40 + x->GetId() * 0.37f + y->GetId() / 3.0f;
+      expect(that % SYS_SAGE_DATAPATH_TYPE_C2C == dp->GetDataPathType());
+      expect(that % (double)latency == dp->GetLatency());
+      expect(that % latency == *(float *)dp->attrib["latency"]);
+      expect(that % (latency - 1.1f) == *(float *)dp->attrib["latency_min"]);
+      expect(that % (latency + 2.3f) == *(float *)dp->attrib["latency_max"]);
+      // the caps-numa DataPaths (4x4 NUMA regions) form a matrix as well
+      Component *numa = imported->GetChild(0)->GetSubcomponentById(0, SYS_SAGE_COMPONENT_NUMA);
+      expect(that % (numa != nullptr) >> fatal);
+      expect(that % 4_u == numa->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+      imported->Delete(true);
+    }
+
+    // too few DataPaths for a matrix: written as datapath elements
+    XmlExportOptions options;
+    options.datapath_matrix = SYS_SAGE_XML_DATAPATH_MATRIX_TEXT;
+    options.datapath_matrix_min_size = dps;
+    expect(that % 0 == exportToXml(&topo, "matrix.xml", options));
+    expect(that % fileSize("matrix_none.xml") == fileSize("matrix.xml"));
+    topo.DeleteSubtree();
+  };
+
+  "huge addresses"_test = [] {
+    // a malformed file must not make the import allocate memory for all indices up to its addr values
+    {
+      std::ofstream f("huge_addr.xml");
+      f << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<sys-sage>\n  <components>\n"
+           "    <Topology id=\"0\" name=\"sys-sage Topology\" addr=\"0\">\n"
+           "      <Node id=\"0\" name=\"Node\" addr=\"999999999999999999\">\n"
+           "        <Core id=\"0\" name=\"Core\" addr=\"2\"/>\n"
+           "        <Core id=\"1\" name=\"Core\" addr=\"3\"/>\n"
+           "      </Node>\n    </Topology>\n  </components>\n  <data-paths>\n"
+           "    <datapath source=\"999999999999999999\" target=\"3\" oriented=\"16\" dp_type=\"128\" bw=\"1.000000\" latency=\"2.000000\"/>\n"
+           "  </data-paths>\n</sys-sage>\n";
+    }
+    Component *topo = importFromXml("huge_addr.xml");
+    expect(that % (topo != nullptr) >> fatal);
+    Component *node = topo->GetChild(0);
+    expect(that % (node != nullptr) >> fatal);
+    expect(that % 2_u == node->GetChildren()->size());
+    expect(that % 1_u == node->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+    topo->Delete(true);
+    std::remove("huge_addr.xml");
+  };
+
+  "lazy loading"_test = [] {
+    Topology topo;
+    for (int i = 0; i < 3; i++) {
+      Node *node = new Node(&topo, i);
+      expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+      expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+    }
+    XmlExportOptions matrix;
+    matrix.datapath_matrix = SYS_SAGE_XML_DATAPATH_MATRIX_TEXT;
+    expect(that % 0 == exportToXml(&topo, "lazy.xml", XmlExportOptions()));
+    expect(that % 0 == exportToXml(&topo, "lazy_matrix.xml", matrix));
+    auto dataPathSize = [](Component *root) {
+      unsigned component_size = 0, datapath_size = 0;
+      root->GetTopologySize(&component_size, &datapath_size);
+      return datapath_size;
+    };
+    auto dump = [](Component *root, int num_threads = 1) {
+      xmlDocPtr doc = XmlExporter().CreateDocument(root, num_threads);
+      xmlChar *buffer = nullptr;
+      int size = 0;
+      xmlDocDumpFormatMemory(doc, &buffer, &size, 1);
+      std::istringstream out(std::string(reinterpret_cast<char *>(buffer), size));
+      xmlFree(buffer);
+      xmlFreeDoc(doc);
+      // the lazily loaded DataPaths are created in a different order
+      std::multiset<std::string> lines;
+      for (std::string line; std::getline(out, line);)
+        lines.insert(line);
+      return lines;
+    };
+
+    for (const char *path : {"lazy.xml", "lazy_matrix.xml"}) {
+      Component *imported = importFromXml(path);
+      expect(that % (imported != nullptr) >> fatal);
+      XmlLazyLoader loader;
+      expect(that % 0 == loader.Open(path));
+      expect(that % ((size_t)imported->CountAllSubcomponents() + 1 == loader.GetNumComponents()));
+      expect(that % -1 == loader.FindComponent(SYS_SAGE_COMPONENT_NODE, 7));
+
+      // only the Node 1 subtree
+      int index = loader.FindComponent(SYS_SAGE_COMPONENT_NODE, 1);
+      expect(that % (index > 0) >> fatal);
+      Component *node = loader.LoadComponent(index);
+      expect(that % (node != nullptr) >> fatal);
+      Component *root = loader.GetRoot();
+      expect(that % (root != nullptr && node->GetParent() == root) >> fatal);
+      expect(that % 1_u == root->GetChildren()->size());
+      expect(that % imported->GetChild(1)->CountAllSubcomponents() == node->CountAllSubcomponents());
+      expect(that % (loader.LoadComponent(index) == node));
+      // no DataPaths are read before they are accessed
+      expect(that % 0_u == dataPathSize(root));
+      Component *numa = node->GetSubcomponentById(2, SYS_SAGE_COMPONENT_NUMA);
+      expect(that % (numa != nullptr) >> fatal);
+      expect(that % 4_u == numa->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+      expect(that % 4_u == numa->GetDataPaths(SYS_SAGE_DATAPATH_INCOMING)->size());
+      expect(that % (dataPathSize(root) > 0));
+
+      // a deleted Component is not created again
+      Component *thread = node->GetSubcomponentById(0, SYS_SAGE_COMPONENT_THREAD);
+      expect(that % (thread != nullptr) >> fatal);
+      thread->Delete(true);
+
+      // the rest of the tree; the parallel export loads all DataPaths before its worker threads access them
+      expect(that % (loader.LoadTopology() == root));
+      expect(that % 3_u == root->GetChildren()->size());
+      expect(that % (imported->CountAllSubcomponents() - 1 == root->CountAllSubcomponents()));
+      imported->GetChild(1)->GetSubcomponentById(0, SYS_SAGE_COMPONENT_THREAD)->Delete(true);
+      expect(that % (dump(imported) == dump(root, 4)));
+      expect(that % 0 == loader.LoadAllDataPaths());
+      imported->Delete(true);
+      root->Delete(true);
+    }
+
+    // components only, down to the Nodes
+    XmlLazyLoader loader;
+    expect(that % 0 == loader.Open("lazy.xml"));
+    Component *root = loader.LoadTopology(1);
+    expect(that % (root != nullptr) >> fatal);
+    expect(that % 3 == root->CountAllSubcomponents());
+    expect(that % 0 == loader.LoadAllDataPaths());
+    expect(that % 0_u == dataPathSize(root));
+    root->Delete(true);
+
+    // files of older versions (pointer addresses)
+    Component *imported = importFromXml(SYS_SAGE_TEST_RESOURCE_DIR "/sys-sage_sample_output.xml");
+    expect(that % (imported != nullptr) >> fatal);
+    expect(that % 0 == loader.Open(SYS_SAGE_TEST_RESOURCE_DIR "/sys-sage_sample_output.xml"));
+    root = loader.LoadTopology();
+    expect(that % (root != nullptr) >> fatal);
+    expect(that % (dump(imported) == dump(root)));
+    imported->Delete(true);
+    root->Delete(true);
+    expect(that % 1 == loader.Open("nonexistent.xml"));
+    topo.DeleteSubtree();
+  };
 };
 // Compare two XML files
 // TODO: Add more tests
@@ -0,0 +1,137 @@
+#include <boost/ut.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static int countDataPaths(Component *root)
+{
+    int n = 0;
+    for (auto c : root->GetComponentsInSubtree())
+        n += c->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size();
+    return n;
+}
+
+class CountingParser : public IngestionParser
+{
+public:
+    using IngestionParser::IngestionParser;
+    int Build(Component *root)
+    {
+        // numbers the threads in the order of the data path parsers
+        for (auto t : root->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD))
+            t->attrib["order"] = (void *)new std::string(t->attrib.count("order") ? *(std::string *)t->attrib["order"] + source.path : source.path);
+        return 0;
+    }
+};
+
+static suite<"ingestion"> _ = []
+{
+    "Same topology as the sequential parsers"_test = []
+    {
+        Topology topo;
+        Node node{&topo};
+        IngestionPipeline pipeline{&node, 4};
+        expect(that % 0 == pipeline.AddSource("hwloc", SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml"));
+        expect(that % 1 == pipeline.AddSource("mt4g", SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv", 1));
+        expect(that % 2 == pipeline.AddSource("caps-numa-benchmark", SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv"));
+        expect(that % 3 == pipeline.AddSource("mt4g", SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv", 2));
+        expect(that % 4 == pipeline.AddSource("cpu-cache-benchmark", SYS_SAGE_TEST_RESOURCE_DIR "/skylake_cpu_cache_benchmark.csv"));
+        expect(that % 0 == pipeline.Run());
+
+        Topology seqTopo;
+        Node seqNode{&seqTopo};
+        expect(that % (0 == parseHwlocOutput(&seqNode, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+        expect(that % (0 == parseMt4gTopo(&seqNode, SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv", 1)) >> fatal);
+        expect(that % (0 == parseMt4gTopo(&seqNode, SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv", 2)) >> fatal);
+        expect(that % (0 == parseCapsNumaBenchmark(&seqNode, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+        expect(that % (0 == parseCpuCacheBenchmark(&seqNode, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_cpu_cache_benchmark.csv")) >> fatal);
+
+        expect(that % seqNode.CountAllSubcomponents() == node.CountAllSubcomponents());
+        expect(that % countDataPaths(&seqNode) == countDataPaths(&node));
+        expect(that % 0 == node.CheckComponentTreeConsistency());
+
+        // the GPUs are attached after the hwloc topology, in the order of the sources
+        auto gpus = node.GetAllChildrenByType(SYS_SAGE_COMPONENT_CHIP);
+        expect(that % (gpus.size() >= 2) >> fatal);
+        expect(that % 1 == gpus[gpus.size() - 2]->GetId());
+        expect(that % 2 == gpus[gpus.size() - 1]->GetId());
+        expect(that % SYS_SAGE_CHIP_TYPE_GPU == ((Chip *)gpus.back())->GetChipType());
+
+        std::vector<std::string> stages;
+        for (auto const &t : pipeline.GetTimings())
+        {
+            expect(that % (t.seconds >= 0.0));
+            if (t.source < 0)
+                stages.push_back(t.stage);
+        }
+        expect(that % (std::vector<std::string>{"load", "build", "attach", "datapaths", "total"}) == stages);
+    };
+
+    "Failed sources are skipped"_test = []
+    {
+        Topology topo;
+        Node node{&topo};
+        IngestionPipeline pipeline{&node};
+        expect(that % -1 == pipeline.AddSource("unknown-parser", "x"));
+        pipeline.AddSource("mt4g", SYS_SAGE_TEST_RESOURCE_DIR "/nonexistent.csv", 1);
+        pipeline.AddSource("mt4g", SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv", 2);
+        pipeline.AddSource("caps-numa-benchmark", SYS_SAGE_TEST_RESOURCE_DIR "/nonexistent.csv");
+        expect(that % 2 == pipeline.Run());
+        expect(that % (0 != pipeline.GetResult(0)));
+        expect(that % 0 == pipeline.GetResult(1));
+        expect(that % (0 != pipeline.GetResult(2)));
+        expect(that % -1 == pipeline.GetResult(3));
+        expect(that % 1_u == node.GetChildren()->size());
+        expect(that % 2 == node.GetChildren()->front()->GetId());
+    };
+
+    "The status of the cccbench parser is reported"_test = []
+    {
+        // measurements of cores 0 and 1 only
+        const std::filesystem::path csv = std::filesystem::temp_directory_path() / "sys-sage-test-cccbench.csv";
+        std::ofstream(csv) << "xcore,ycore,xylat\n0,1,10\n1,0,12\n";
+        Topology topo;
+        Node node{&topo};
+        IngestionPipeline pipeline{&node};
+        pipeline.AddSource("hwloc", SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml");
+        pipeline.AddSource("cccbench", csv.string());
+        expect(that % 1 == pipeline.Run());
+        expect(that % 0 == pipeline.GetResult(0));
+        expect(that % 1 == pipeline.GetResult(1));
+        // cores 0 and 1 of both sockets
+        expect(that % 8 == countDataPaths(&node));
+        std::filesystem::remove(csv);
+    };
+
+    "Custom parsers and dependencies"_test = []
+    {
+        expect(that % 1 == RegisterIngestionParser("counting", 3, [](const IngestionSource &s)
+                                                   { return (IngestionParser *)new CountingParser(s); }));
+        expect(that % 0 == RegisterIngestionParser("counting", SYS_SAGE_INGEST_DATAPATHS, [](const IngestionSource &s)
+                                                   { return (IngestionParser *)new CountingParser(s); }));
+        expect(that % SYS_SAGE_INGEST_DATAPATHS == GetIngestionParserKind("counting"));
+        expect(that % SYS_SAGE_INGEST_SUBTREE == GetIngestionParserKind("mt4g"));
+        expect(that % 0 == GetIngestionParserKind("unknown-parser"));
+
+        Topology topo;
+        Node node{&topo};
+        IngestionPipeline pipeline{&node, 2};
+        int gpu = pipeline.AddSource("mt4g", SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv", 0);
+        int a = pipeline.AddSource("counting", "a");
+        int b = pipeline.AddSource("counting", "b");
+        int c = pipeline.AddSource("counting", "c");
+        expect(that % 0 == pipeline.AddDependency(a, c));
+        expect(that % 0 == pipeline.AddDependency(c, b));
+        expect(that % 1 == pipeline.AddDependency(b, a)); // cycle
+        expect(that % 1 == pipeline.AddDependency(a, gpu)); // not a data path source
+        expect(that % 0 == pipeline.Run());
+
+        auto thread = node.GetSubcomponentById(0, SYS_SAGE_COMPONENT_THREAD);
+        expect(that % (thread != nullptr) >> fatal);
+        expect(that % "bca"sv == *(std::string *)thread->attrib["order"]);
+    };
+};
@@ -0,0 +1,154 @@
+#include <boost/ut.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static suite<"instancing"> _ = []
+{
+    "Instanced component is counted but not materialized"_test = []
+    {
+        Node node;
+        Chip chip{&node, 0};
+        Core core{&chip, 0};
+        Thread thread{&core, 0};
+        core.SetInstances({1, 2, 3});
+        expect(that % 4 == core.GetInstanceCount());
+        expect(that % 4 == chip.CountAllChildrenByType(SYS_SAGE_COMPONENT_CORE));
+        expect(that % 4 == node.CountAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD));
+        expect(that % 9 == node.CountAllSubcomponents());
+        expect(that % 1_u == chip.GetChildren()->size());
+
+        auto c2 = node.GetOrExpandSubcomponentById(2, SYS_SAGE_COMPONENT_CORE);
+        expect(that % (c2 != nullptr) >> fatal);
+        expect(that % 2 == c2->GetId());
+        expect(that % &chip == c2->GetParent());
+        expect(that % 1_u == c2->GetChildren()->size());
+        expect(that % 2_u == chip.GetChildren()->size());
+        expect(that % 3 == core.GetInstanceCount());
+        expect(that % 9 == node.CountAllSubcomponents());
+        expect(that % (c2 == node.GetOrExpandSubcomponentById(2, SYS_SAGE_COMPONENT_CORE)));
+        expect(that % (node.GetOrExpandSubcomponentById(7, SYS_SAGE_COMPONENT_CORE) == nullptr));
+
+        expect(that % 2 == node.ExpandAllInstances());
+        expect(that % 4_u == chip.GetChildren()->size());
+        expect(that % 9 == node.CountAllSubcomponents());
+    };
+
+    "Collapsing identical subtrees of a GPU"_test = []
+    {
+        Topology topo;
+        Chip gpu{&topo};
+        expect(that % (0 == parseMt4gTopo(&gpu, SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv")) >> fatal);
+        int all = topo.CountAllSubcomponents();
+        unsigned component_size = 0, dataPath_size = 0;
+        int size_before = topo.GetTopologySize(&component_size, &dataPath_size);
+
+        // one SM with one thread per L1 cache remains
+        expect(that % 4012 == topo.CollapseIdenticalChildren());
+        expect(that % all == topo.CountAllSubcomponents());
+        expect(that % 3840 == topo.CountAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD));
+        expect(that % 30 == topo.CountAllSubcomponentsByType(SYS_SAGE_COMPONENT_SUBDIVISION));
+        component_size = dataPath_size = 0;
+        expect(that % (topo.GetTopologySize(&component_size, &dataPath_size) < size_before / 4));
+        auto memory = gpu.GetChildByType(SYS_SAGE_COMPONENT_MEMORY);
+        expect(that % 1_u == memory->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+        auto memoryDataPath = (*memory->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))[0];
+        expect(that % 2_u == memoryDataPath->GetTargets().size());
+        // nothing more to collapse
+        expect(that % 0 == topo.CollapseIdenticalChildren());
+
+        // the expanded thread gets the data paths of its prototype
+        auto thread = topo.GetOrExpandSubcomponentById(5, SYS_SAGE_COMPONENT_THREAD);
+        expect(that % (thread != nullptr) >> fatal);
+        auto prototype = (*thread->GetParent()->GetChildren())[0];
+        auto prototypeDataPaths = prototype->GetAllDataPathsByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_INCOMING);
+        expect(that % (prototypeDataPaths.size() > 0));
+        expect(that % prototypeDataPaths.size() == thread->GetAllDataPathsByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_INCOMING).size());
+        expect(that % 3_u == memoryDataPath->GetTargets().size());
+
+        // XML round trip keeps the instances
+        exportToXml(&topo, "instancing.xml");
+        Component *imported = importFromXml("instancing.xml");
+        expect(that % (imported != nullptr) >> fatal);
+        expect(that % all == imported->CountAllSubcomponents());
+        expect(that % 3840 == imported->CountAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD));
+
+        expect(that % 154 == topo.ExpandAllInstances());
+        expect(that % 3840_u == topo.GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD).size());
+        expect(that % 30_u == topo.GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_SUBDIVISION).size());
+        expect(that % 3840_u == memoryDataPath->GetTargets().size());
+    };
+
+    "Expanded instances own copies of the attribute values"_test = []
+    {
+        Node node;
+        Chip chip{&node, 0};
+        Core *core = new Core(&chip, 0);
+        Core *other = new Core(&chip, 1);
+        core->attrib["CATcos"] = new uint64_t(3);
+        uint64_t *other_cos = new uint64_t(3);
+        other->attrib["CATcos"] = other_cos;
+        // equal values collapse, although they are different objects
+        expect(that % 1 == chip.CollapseIdenticalChildren());
+        expect(that % 2 == core->GetInstanceCount());
+
+        Component *expanded = core->ExpandInstance(1);
+        expect(that % (expanded != nullptr) >> fatal);
+        expect(that % (expanded->attrib["CATcos"] != core->attrib["CATcos"]));
+        expect(that % 3_u == *(uint64_t *)expanded->attrib["CATcos"]);
+        // destroying the values of the copy leaves the prototype intact
+        DestroyAttributes(&expanded->attrib);
+        expect(that % 3_u == *(uint64_t *)core->attrib["CATcos"]);
+        DestroyAttributes(&core->attrib);
+        delete other_cos;
+    };
+
+    "Collapsing counts the deleted components"_test = []
+    {
+        Node node;
+        Chip *chip = new Chip(&node, 0);
+        Core *core = new Core(chip, 0);
+        new Thread(core, 0);
+        core->SetInstances({2, 3});
+        Core *other = new Core(chip, 1);
+        new Thread(other, 0);
+        other->SetInstances({4});
+        // the other core and its thread are deleted, whatever instances they carried
+        expect(that % 2 == chip->CollapseIdenticalChildren());
+        expect(that % (core->GetInstanceIds() == vector<int>{2, 3, 1, 4}));
+        expect(that % 11 == node.CountAllSubcomponents());
+    };
+
+    "Malformed instance ids are rejected by the import"_test = []
+    {
+        Topology topo;
+        Node *node = new Node(&topo, 0);
+        Core *core = new Core(node, 0);
+        core->SetInstances({1, 2});
+        new Core(node, 5);
+        expect(that % (0 == exportToXml(&topo, "instancing_bad.xml")) >> fatal);
+        std::string xml;
+        {
+            std::ifstream in("instancing_bad.xml");
+            std::stringstream ss;
+            ss << in.rdbuf();
+            xml = ss.str();
+        }
+        auto pos = xml.find("instance_ids=\"1,2\"");
+        expect(that % (pos != std::string::npos) >> fatal);
+        xml.replace(pos, 18, "instance_ids=\"1,x\"");
+        std::ofstream("instancing_bad.xml") << xml;
+
+        Component *imported = importFromXml("instancing_bad.xml");
+        expect(that % (imported != nullptr) >> fatal);
+        // the core with the malformed ids is skipped, the rest is imported
+        expect(that % 1 == imported->CountAllSubcomponentsByType(SYS_SAGE_COMPONENT_CORE));
+        imported->Delete(true);
+        std::remove("instancing_bad.xml");
+    };
+};
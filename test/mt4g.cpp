@@ -28,7 +28,11 @@ static suite<"mt4g"> _ = []
     auto memory = dynamic_cast<Memory *>(gpu.GetChildByType(SYS_SAGE_COMPONENT_MEMORY));
     expect(that % (nullptr != memory) >> fatal);
     expect(that % 25637224578 == memory->GetSize());
-    expect(that % 3840_u == memory->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+    // one broadcast data path to all threads
+    expect(that % 1_u == memory->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+    auto memoryDataPath = (*memory->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))[0];
+    expect(that % SYS_SAGE_COMPONENT_THREAD == memoryDataPath->GetBroadcastType());
+    expect(that % 3840_u == memoryDataPath->GetTargets().size());
 
     auto cacheL2 = dynamic_cast<Cache *>(memory->GetChildByType(SYS_SAGE_COMPONENT_CACHE));
     expect(that % (nullptr != cacheL2) >> fatal);
@@ -46,5 +50,19 @@ static suite<"mt4g"> _ = []
 
     auto thread = dynamic_cast<Thread *>(cacheL1->GetChildByType(SYS_SAGE_COMPONENT_THREAD));
     expect(that % (nullptr != thread) >> fatal);
+    // memory, L2, shared memory, L1 (shared with texture and read-only), constant L1
+    expect(that % 5_u == thread->GetAllDataPathsByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_INCOMING).size());
+    expect(that % 412.0 == memory->GetDataPathByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_OUTGOING)->GetLatency());
+
+    // broadcast data paths survive the XML round trip
+    exportToXml(&topo, "mt4g.xml");
+    Component *imported = importFromXml("mt4g.xml");
+    expect(that % (imported != nullptr) >> fatal);
+    auto importedMemory = imported->GetSubcomponentById(0, SYS_SAGE_COMPONENT_MEMORY);
+    expect(that % (importedMemory != nullptr) >> fatal);
+    auto importedDataPath = importedMemory->GetDataPathByType(SYS_SAGE_DATAPATH_TYPE_LOGICAL, SYS_SAGE_DATAPATH_OUTGOING);
+    expect(that % (importedDataPath != nullptr) >> fatal);
+    expect(that % SYS_SAGE_COMPONENT_THREAD == importedDataPath->GetBroadcastType());
+    expect(that % 3840_u == importedDataPath->GetTargets().size());
     //topo.Delete(true);
 };
@@ -0,0 +1,114 @@
+#include <boost/ut.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+#ifdef NVIDIA_MIG
+
+static int countMIGDataPaths(Component *chip, const std::string &uuid)
+{
+    int n = 0;
+    for (auto dp : *chip->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+        if (dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_MIG && *(std::string *)dp->attrib["mig_uuid"] == uuid)
+            n++;
+    return n;
+}
+
+static suite<"nvidia_mig"> _ = []
+{
+    // work on a copy, so that the MIG instances can be changed between the updates
+    std::filesystem::copy_file(SYS_SAGE_TEST_RESOURCE_DIR "/nvml_stub.txt", "nvml_stub.txt", std::filesystem::copy_options::overwrite_existing);
+    NvmlStub stub{"nvml_stub.txt"};
+    SetNvmlInterface(&stub);
+    unsetenv("CUDA_VISIBLE_DEVICES");
+
+    Topology topo;
+    Chip gpu{&topo};
+    expect(that % (0 == parseMt4gTopo(&gpu, SYS_SAGE_TEST_RESOURCE_DIR "/pascal_gpu_topo.csv")) >> fatal);
+    auto memory = dynamic_cast<Memory *>(gpu.GetChildByType(SYS_SAGE_COMPONENT_MEMORY));
+    expect(that % (nullptr != memory) >> fatal);
+    auto cacheL2 = dynamic_cast<Cache *>(memory->GetChildByType(SYS_SAGE_COMPONENT_CACHE));
+    expect(that % (nullptr != cacheL2) >> fatal);
+
+    "MIG instance from the NVML stub"_test = [&]
+    {
+        expect(that % (0 == gpu.UpdateMIGSettings("MIG-half")) >> fatal);
+        expect(that % 14 == gpu.GetMIGNumSMs("MIG-half"));
+        expect(that % gpu.GetMIGNumCores("MIG-half") == (14 * 128));
+        expect(that % 12818000000ll == memory->GetMIGSize("MIG-half"));
+        expect(that % cacheL2->GetMIGSize("MIG-half") == (3145728 / 2));
+        // memory, L2 and one per SM
+        expect(that % 16 == countMIGDataPaths(&gpu, "MIG-half"));
+
+        expect(that % (0 == gpu.UpdateMIGSettings("MIG-small")) >> fatal);
+        expect(that % 7 == gpu.GetMIGNumSMs("MIG-small"));
+        expect(that % cacheL2->GetMIGSize("MIG-small") == (3145728 / 4));
+
+        // whole GPU
+        expect(that % 30 == gpu.GetMIGNumSMs());
+        expect(that % gpu.GetMIGNumCores() == (30 * 128));
+        expect(that % 25637224578 == memory->GetMIGSize());
+    };
+
+    "Repeated updates are idempotent and reuse the NVML session"_test = [&]
+    {
+        expect(that % (0 == gpu.UpdateMIGSettings("MIG-half")) >> fatal);
+        expect(that % 16 == countMIGDataPaths(&gpu, "MIG-half"));
+        expect(that % 9 == countMIGDataPaths(&gpu, "MIG-small"));
+        expect(that % 1 == stub.GetInitCount());
+        expect(that % 0 == stub.GetShutdownCount());
+
+        // shrink the instance: the SMs that left it lose their data paths, the sizes are updated in place
+        std::ofstream("nvml_stub.txt") << "MIG-half 10 2 2 6409\n";
+        expect(that % (0 == gpu.UpdateMIGSettings("MIG-half")) >> fatal);
+        expect(that % 12 == countMIGDataPaths(&gpu, "MIG-half"));
+        expect(that % 10 == gpu.GetMIGNumSMs("MIG-half"));
+        expect(that % 6409000000ll == memory->GetMIGSize("MIG-half"));
+        expect(that % cacheL2->GetMIGSize("MIG-half") == (3145728 / 4));
+
+        expect(that % (2 == gpu.UpdateMIGSettings("MIG-unknown")));
+        expect(that % 0 == countMIGDataPaths(&gpu, "MIG-unknown"));
+    };
+
+    "MIG index of an imported topology"_test = [&]
+    {
+        std::string path = "nvidia_mig.xml";
+        exportToXml(&topo, path);
+        Component *imported = importFromXml(path);
+        expect(that % (imported != nullptr) >> fatal);
+        auto chip = dynamic_cast<Chip *>(imported->GetChildByType(SYS_SAGE_COMPONENT_CHIP));
+        expect(that % (chip != nullptr) >> fatal);
+        expect(that % 10 == chip->GetMIGNumSMs("MIG-half"));
+        expect(that % chip->GetMIGNumCores("MIG-half") == (10 * 128));
+        expect(that % 7 == chip->GetMIGNumSMs("MIG-small"));
+        auto mem = dynamic_cast<Memory *>(chip->GetChildByType(SYS_SAGE_COMPONENT_MEMORY));
+        expect(that % (mem != nullptr) >> fatal);
+        expect(that % 6409000000ll == mem->GetMIGSize("MIG-half"));
+
+        // the index follows edits made outside UpdateMIGSettings()
+        for (auto dp : *chip->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+        {
+            if (dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_MIG && *(std::string *)dp->attrib["mig_uuid"] == "MIG-half" && dp->GetTarget()->GetComponentType() == SYS_SAGE_COMPONENT_SUBDIVISION)
+            {
+                chip->DeleteDataPath(dp);
+                break;
+            }
+        }
+        expect(that % 9 == chip->GetMIGNumSMs("MIG-half"));
+        expect(that % 7 == chip->GetMIGNumSMs("MIG-small"));
+    };
+
+    "Session is shut down when the interface is replaced"_test = [&]
+    {
+        SetNvmlInterface(NULL);
+        expect(that % 1 == stub.GetInitCount());
+        expect(that % 1 == stub.GetShutdownCount());
+    };
+};
+
+#endif
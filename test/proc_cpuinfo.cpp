@@ -4,7 +4,7 @@
 
 using namespace boost::ut;
 
-#if PROC_CPUINFO
+#ifdef PROC_CPUINFO
 
 static suite<"cpuinfo"> _ = []
 {
@@ -14,6 +14,41 @@ static suite<"cpuinfo"> _ = []
     core.SetFreq(42.0);
     expect(that % 42.0 == core.GetFreq());
     expect(that % 42.0 == thread.GetFreq());
+
+    "cpufreq sysfs"_test = []
+    {
+        Topology topo;
+        Node node{&topo};
+        expect(that % (0 == parseSysfsTopology(&node, SYS_SAGE_TEST_RESOURCE_DIR "/sysfs_2socket")) >> fatal);
+        SetCpufreqSysfsRoot(SYS_SAGE_TEST_RESOURCE_DIR "/sysfs_2socket");
+
+        expect(that % (0 == node.RefreshCpuCoreFrequency(true, SYS_SAGE_FREQ_SOURCE_CPUFREQ)) >> fatal);
+        auto thread0 = (Thread *)node.GetSubcomponentById(0, SYS_SAGE_COMPONENT_THREAD);
+        auto thread1 = (Thread *)node.GetSubcomponentById(1, SYS_SAGE_COMPONENT_THREAD);
+        auto thread3 = (Thread *)node.GetSubcomponentById(3, SYS_SAGE_COMPONENT_THREAD);
+        expect(that % 2100.0 == thread0->GetFreq());
+        expect(that % 2200.0 == thread1->GetFreq());
+        expect(that % 1800.0 == thread3->GetFreq()) << "fallback to cpuinfo_cur_freq";
+
+        //the second refresh re-reads the already opened files
+        expect(that % (0 == node.RefreshCpuCoreFrequency(true, SYS_SAGE_FREQ_SOURCE_CPUFREQ)) >> fatal);
+        auto core0 = thread0->GetParent();
+        auto history = (TimeSeries *)core0->attrib["freq_history"];
+        expect(that % (history != nullptr) >> fatal);
+        expect(that % 2_u == history->GetSize());
+        expect(that % 2100.0 == std::get<1>(history->Get(1)));
+
+        //the sibling thread of cpu 1 is cpu 5
+        auto thread5 = (Thread *)node.GetSubcomponentById(5, SYS_SAGE_COMPONENT_THREAD);
+        expect(that % (0 == thread5->RefreshFreq(false, SYS_SAGE_FREQ_SOURCE_CPUFREQ)));
+        expect(that % 2600.0 == thread1->GetFreq());
+        expect(that % (0 == ((Core *)thread1->GetParent())->RefreshFreq(false, SYS_SAGE_FREQ_SOURCE_CPUFREQ)));
+        expect(that % 2200.0 == thread1->GetFreq());
+
+        SetCpufreqSysfsRoot(SYS_SAGE_TEST_RESOURCE_DIR "/nonexistent");
+        expect(that % (1 == thread5->RefreshFreq(false, SYS_SAGE_FREQ_SOURCE_CPUFREQ)));
+        SetCpufreqSysfsRoot("/sys");
+    };
 };
 
 #endif
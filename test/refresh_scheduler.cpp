@@ -0,0 +1,163 @@
+#include <boost/ut.hpp>
+
+#include <atomic>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+using namespace std::chrono_literals;
+
+static suite<"refresh scheduler"> _ = []
+{
+    "On-demand refresh without worker threads"_test = []
+    {
+        RefreshScheduler sched;
+        int calls = 0;
+        int id = sched.AddSource("counter", [&calls] { return ++calls == 1 ? 0 : 3; }, 0ms);
+        expect(that % (!sched.IsRunning()));
+        expect(that % 0 == sched.RefreshNow(id));
+        expect(that % 3 == sched.RefreshNow(id));
+        expect(that % 2 == calls);
+        expect(that % (2 == sched.GetSampleCount(id)));
+        expect(that % 3 == sched.GetLastResult(id));
+        expect(that % -1 == sched.RefreshNow(id + 1));
+        expect(that % -1 == sched.WaitForNextSample(id)) << "not running";
+    };
+
+    "Periodic refresh on worker threads"_test = []
+    {
+        RefreshScheduler sched{2};
+        std::atomic<int> fast{0}, slow{0};
+        int fast_id = sched.AddSource("fast", [&fast] { fast++; return 0; }, 5ms);
+        int slow_id = sched.AddSource("slow", [&slow] { slow++; return 0; }, 1h);
+        sched.Start();
+        expect(that % sched.IsRunning());
+        for (int i = 0; i < 3; ++i)
+            expect(that % 0 == sched.WaitForNextSample(fast_id, 5000ms));
+        expect(that % fast.load() >= 3);
+        expect(that % -2 == sched.WaitForNextSample(slow_id, 20ms)) << "timeout";
+        expect(that % 1 == slow.load()) << "refreshed once when added";
+
+        expect(that % 0 == sched.RefreshNow(slow_id));
+        expect(that % 2 == slow.load());
+
+        expect(that % 0 == sched.RemoveSource(fast_id));
+        expect(that % 1 == sched.RemoveSource(fast_id));
+        expect(that % -1 == sched.RefreshNow(fast_id));
+        sched.Stop();
+        expect(that % (!sched.IsRunning()));
+    };
+
+    "Concurrent requests are coalesced"_test = []
+    {
+        RefreshScheduler sched;
+        std::atomic<int> calls{0};
+        std::atomic<bool> release{false};
+        int id = sched.AddSource("blocking", [&] {
+            calls++;
+            while (!release.load())
+                std::this_thread::yield();
+            return 0;
+        }, 0ms);
+        sched.Start();
+
+        // the first request starts a refresh that blocks until released; the requests arriving meanwhile share the next refresh
+        std::thread first([&] { sched.RefreshNow(id); });
+        while (calls.load() == 0)
+            std::this_thread::yield();
+        std::atomic<int> failed{0};
+        std::vector<std::thread> others;
+        for (int i = 0; i < 4; ++i)
+            others.emplace_back([&] { if (sched.RefreshNow(id) != 0) failed++; });
+        std::this_thread::sleep_for(20ms);
+        release = true;
+        first.join();
+        for (auto &t : others)
+            t.join();
+        expect(that % 0 == failed.load());
+        expect(that % 2 == calls.load());
+        expect(that % (2 == sched.GetSampleCount(id)));
+    };
+
+    "Removing a source that other callers wait for"_test = []
+    {
+        RefreshScheduler sched;
+        std::atomic<int> calls{0};
+        std::atomic<bool> release{false};
+        int id = sched.AddSource("blocking", [&] {
+            calls++;
+            while (!release.load())
+                std::this_thread::yield();
+            return 0;
+        }, 0ms);
+
+        // without worker threads, the refresh runs on the first caller; the others wait for it to finish
+        std::thread first([&] { expect(that % 0 == sched.RefreshNow(id)); });
+        while (calls.load() == 0)
+            std::this_thread::yield();
+        std::atomic<int> removed{0};
+        std::vector<std::thread> others;
+        for (int i = 0; i < 2; ++i)
+            others.emplace_back([&] { if (sched.RemoveSource(id) == 0) removed++; });
+        int waiting_result = -2;
+        std::thread waiting([&] { waiting_result = sched.RefreshNow(id); });
+        std::this_thread::sleep_for(20ms);
+        release = true;
+        first.join();
+        waiting.join();
+        for (auto &t : others)
+            t.join();
+        expect(that % 1 == removed.load()) << "only one of the removers removes the source";
+        expect(that % (waiting_result == 0 || waiting_result == -1));
+        expect(that % -1 == sched.RefreshNow(id));
+    };
+
+    "Refreshes hold the topology lock exclusively"_test = []
+    {
+        RefreshScheduler sched;
+        Topology topo;
+        Core core{&topo, 0};
+        int id = sched.AddSource("freq", [&core] {
+            core.attrib["a"] = (void *)1;
+            std::this_thread::sleep_for(1ms);
+            core.attrib["b"] = (void *)1;
+            return 0;
+        }, 1ms);
+        sched.Start();
+        for (int i = 0; i < 20; ++i)
+        {
+            std::shared_lock lock(sched.GetTopologyLock());
+            expect(that % core.attrib.count("a") == core.attrib.count("b"));
+        }
+        sched.Stop();
+        expect(that % -1 == sched.WaitForNextSample(id));
+    };
+
+    "Split sources are read in parallel"_test = []
+    {
+        RefreshScheduler sched{2};
+        Topology topo;
+        std::atomic<int> reading{0};
+        std::atomic<bool> overlapped{false};
+        auto collect = [&] {
+            // both sources wait for each other while reading; this only succeeds if their reads overlap
+            reading++;
+            for (int i = 0; i < 5000 && reading.load() < 2; ++i)
+                std::this_thread::sleep_for(1ms);
+            if (reading.load() == 2)
+                overlapped = true;
+            return std::function<int()>([&topo] { topo.attrib["applied"] = (void *)1; return 0; });
+        };
+        int a = sched.AddSplitSource("a", collect, 0ms);
+        int b = sched.AddSplitSource("b", collect, 0ms);
+        sched.Start();
+        std::thread t([&] { expect(that % 0 == sched.RefreshNow(a)); });
+        expect(that % 0 == sched.RefreshNow(b));
+        t.join();
+        expect(that % overlapped.load());
+        expect(that % (topo.attrib.count("applied") == 1));
+        int failing = sched.AddSplitSource("failing", [] { return std::function<int()>(); }, 0ms);
+        expect(that % -1 == sched.RefreshNow(failing));
+        sched.Stop();
+    };
+};
@@ -0,0 +1,190 @@
+#include <boost/ut.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+#ifdef RESCTRL
+
+static DataPath *getL3CATDataPath(Component *thread)
+{
+    DataPath *ret = nullptr;
+    for (auto dp : *thread->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING))
+        if (dp->GetDataPathType() == SYS_SAGE_DATAPATH_TYPE_L3CAT)
+        {
+            expect(that % (ret == nullptr)) << "only one L3CAT data path per HW thread";
+            ret = dp;
+        }
+    return ret;
+}
+
+static suite<"resctrl"> _ = []
+{
+    // work on a temporary copy, so that the settings can be changed between the refreshes
+    const std::filesystem::path resctrl = std::filesystem::temp_directory_path() / "sys-sage-test-resctrl";
+    std::filesystem::remove_all(resctrl);
+    std::filesystem::copy(SYS_SAGE_TEST_RESOURCE_DIR "/resctrl", resctrl, std::filesystem::copy_options::recursive);
+    SetResctrlRoot(resctrl.string(), SYS_SAGE_TEST_RESOURCE_DIR "/sysfs_2socket");
+
+    Topology topo;
+    Node node{&topo};
+    expect(that % (0 == parseSysfsTopology(&node, SYS_SAGE_TEST_RESOURCE_DIR "/sysfs_2socket")) >> fatal);
+    expect(that % (0 == node.UpdateResctrlSettings()) >> fatal);
+
+    "COS, L3 mask and MBA per HW thread"_test = [&]
+    {
+        // cpu, cos, L3 mask, MBA, group; cpus 0,1,4,5 are on L3 domain 0, cpus 2,3,6,7 on domain 1
+        std::vector<std::tuple<int, uint64_t, uint64_t, uint64_t, std::string>> expected = {
+            {0, 1, 0x00f, 50, "grpA"}, {1, 0, 0x7ff, 100, ""}, {2, 1, 0x0f0, 100, "grpA"}, {5, 2, 0x700, 20, "grpB"}, {7, 0, 0x7ff, 100, ""}};
+        for (auto const &[cpu, cos, mask, mba, group] : expected)
+        {
+            auto thread = node.GetSubcomponentById(cpu, SYS_SAGE_COMPONENT_THREAD);
+            expect(that % (thread != nullptr) >> fatal);
+            auto dp = getL3CATDataPath(thread);
+            expect(that % (dp != nullptr) >> fatal);
+            expect(that % SYS_SAGE_COMPONENT_CACHE == dp->GetTarget()->GetComponentType());
+            expect(that % 3 == ((Cache *)dp->GetTarget())->GetCacheLevel());
+            expect(that % cos == *(uint64_t *)dp->attrib["CATcos"]);
+            expect(that % mask == *(uint64_t *)dp->attrib["CATL3mask"]);
+            expect(that % mba == *(uint64_t *)dp->attrib["MBAthrottle"]);
+            expect(that % group == *(std::string *)dp->attrib["resctrl_group"]);
+        }
+    };
+
+    "CAT-aware L3 size"_test = [&]
+    {
+        // 11264 KiB, 11 ways; grpB has 3 ways
+        auto thread5 = (Thread *)node.GetSubcomponentById(5, SYS_SAGE_COMPONENT_THREAD);
+        expect(that % thread5->GetCATAwareL3Size() == 3 * 1024 * 1024);
+    };
+
+    "Refresh updates the data paths in place"_test = [&]
+    {
+        auto thread5 = node.GetSubcomponentById(5, SYS_SAGE_COMPONENT_THREAD);
+        auto dp = getL3CATDataPath(thread5);
+        std::ofstream(resctrl / "grpB/schemata") << "    L3:0=7f0;1=7f0\n    MB:0= 40;1= 40\n";
+        std::ofstream(resctrl / "grpA/cpus_list") << "0,2,5\n";
+        std::ofstream(resctrl / "grpB/cpus_list") << "\n";
+
+        expect(that % (0 == node.UpdateResctrlSettings()) >> fatal);
+        expect(that % (dp == getL3CATDataPath(thread5)));
+        expect(that % 1u == *(uint64_t *)dp->attrib["CATcos"]);
+        expect(that % 0x00fu == *(uint64_t *)dp->attrib["CATL3mask"]);
+        expect(that % 50u == *(uint64_t *)dp->attrib["MBAthrottle"]);
+        expect(that % 1_u == thread5->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING)->size());
+    };
+
+    "LLC occupancy and memory bandwidth"_test = [&]
+    {
+        using clock = std::chrono::high_resolution_clock;
+        auto seconds = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+        auto thread0 = (Thread *)node.GetSubcomponentById(0, SYS_SAGE_COMPONENT_THREAD);
+        auto thread2 = (Thread *)node.GetSubcomponentById(2, SYS_SAGE_COMPONENT_THREAD);
+        auto l3_0 = getL3CATDataPath(thread0)->GetTarget();
+        auto l3_1 = getL3CATDataPath(thread2)->GetTarget();
+        auto numa0 = node.GetSubcomponentById(0, SYS_SAGE_COMPONENT_NUMA);
+        expect(that % (numa0 != nullptr) >> fatal);
+
+        auto t0 = clock::now();
+        expect(that % (0 == node.UpdateResctrlMonitoring()) >> fatal);
+        auto t1 = clock::now();
+        auto occupancy = (TimeSeries *)l3_0->attrib["llc_occupancy"];
+        expect(that % (occupancy != nullptr) >> fatal);
+        expect(that % 1_u == occupancy->GetSize());
+        expect(that % 4718592.0 == std::get<1>(occupancy->GetLast())) << "sum of all groups in domain 0";
+        expect(that % 0_u == l3_0->attrib.count("mbm_total_bw")) << "no rate after the first read";
+
+        // 1 GB more in the root group, 1 MB more in grpA (cpus 0,2,5 since the previous test) on domain 0
+        std::ofstream(resctrl / "mon_data/mon_L3_00/mbm_total_bytes") << "2000000000\n";
+        std::ofstream(resctrl / "grpA/mon_data/mon_L3_00/mbm_total_bytes") << "1000100\n";
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto t2 = clock::now();
+        expect(that % (0 == node.UpdateResctrlMonitoring()) >> fatal);
+        auto t3 = clock::now();
+
+        auto total_bw = (TimeSeries *)l3_0->attrib["mbm_total_bw"];
+        expect(that % (total_bw != nullptr) >> fatal);
+        double bw = std::get<1>(total_bw->GetLast());
+        expect(bw >= 1.001e9 / seconds(t3 - t0) && bw <= 1.001e9 / seconds(t2 - t1)) << bw;
+        expect(that % 0.0 == std::get<1>(((TimeSeries *)l3_0->attrib["mbm_local_bw"])->GetLast()));
+        expect(that % 0.0 == std::get<1>(((TimeSeries *)l3_1->attrib["mbm_total_bw"])->GetLast()));
+        expect(that % 2097152.0 == std::get<1>(((TimeSeries *)l3_1->attrib["llc_occupancy"])->GetLast()));
+
+        auto numa_bw = (TimeSeries *)numa0->attrib["mbm_total_bw"];
+        expect(that % (numa_bw != nullptr) >> fatal);
+        expect(that % bw == std::get<1>(numa_bw->GetLast())) << "NUMA node 0 is in L3 domain 0";
+        expect(that % 0_u == numa0->attrib.count("llc_occupancy"));
+
+        auto thread5 = (Thread *)node.GetSubcomponentById(5, SYS_SAGE_COMPONENT_THREAD);
+        for (auto thread : {thread0, thread5})
+        {
+            auto dp = getL3CATDataPath(thread);
+            auto group_occupancy = (TimeSeries *)dp->attrib["llc_occupancy"];
+            expect(that % (group_occupancy != nullptr) >> fatal);
+            expect(that % 2_u == group_occupancy->GetSize());
+            expect(that % 524288.0 == std::get<1>(group_occupancy->GetLast()));
+            double group_bw = std::get<1>(((TimeSeries *)dp->attrib["mbm_total_bw"])->GetLast());
+            expect(group_bw >= 1e6 / seconds(t3 - t0) && group_bw <= 1e6 / seconds(t2 - t1)) << group_bw;
+        }
+    };
+
+    "CAT-aware L3 sizes of all HW threads"_test = [&]
+    {
+        // L3 domain 0 (cpus 0,1,4,5): cpus 0,5 in grpA (COS 1, ways 0-3), cpus 1,4 in the root group (COS 0, all 11 ways); one way is 1 MiB
+        constexpr long long MiB = 1024 * 1024;
+        auto index = [](CATAwareL3Sizes const &s, int thread_id) {
+            return std::find(s.thread_id.begin(), s.thread_id.end(), thread_id) - s.thread_id.begin();
+        };
+
+        auto sizes = node.GetCATAwareL3Sizes();
+        expect(that % (8 == sizes.thread_id.size()) >> fatal);
+        expect(that % (8 == sizes.effective_l3_size.size()) >> fatal);
+        auto i0 = index(sizes, 0), i1 = index(sizes, 1), i4 = index(sizes, 4), i5 = index(sizes, 5);
+        expect(that % 1 == sizes.cos[i0]);
+        expect(that % 0x00fu == sizes.mask[i0]);
+        expect(that % 2 == sizes.cos_threads[i0]);
+        expect(that % sizes.l3_size[i0] == 4 * MiB);
+        expect(that % sizes.effective_l3_size[i0] == 1 * MiB) << "ways 0-3 are shared by 4 HW threads";
+        expect(that % sizes.l3_size[i1] == 11 * MiB);
+        expect(that % sizes.effective_l3_size[i1] == 4 * MiB / 4 + 7 * MiB / 2);
+        expect(that % sizes.l3_id[i0] == sizes.l3_id[i1]);
+        for (size_t i = 0; i < sizes.thread_id.size(); ++i)
+        {
+            auto thread = (Thread *)node.GetSubcomponentById(sizes.thread_id[i], SYS_SAGE_COMPONENT_THREAD);
+            expect(that % sizes.l3_size[i] == thread->GetCATAwareL3Size());
+        }
+
+        // hypothetical: COS 1 gets ways 4-10 instead; nothing is applied to the topology
+        auto moved_mask = node.GetCATAwareL3Sizes({}, {{1, 0x7f0}});
+        expect(that % 0x7f0u == moved_mask.mask[i0]);
+        expect(that % moved_mask.effective_l3_size[i0] == 7 * MiB / 4);
+        expect(that % moved_mask.effective_l3_size[i1] == 4 * MiB / 2 + 7 * MiB / 4);
+        expect(that % 0x00fu == *(uint64_t *)getL3CATDataPath(node.GetSubcomponentById(0, SYS_SAGE_COMPONENT_THREAD))->attrib["CATL3mask"]);
+
+        // hypothetical: HW thread 1 joins COS 1 (and gets its mask)
+        auto moved_thread = node.GetCATAwareL3Sizes({{1, 1}});
+        expect(that % 1 == moved_thread.cos[i1]);
+        expect(that % 0x00fu == moved_thread.mask[i1]);
+        expect(that % 3 == moved_thread.cos_threads[i1]);
+        expect(that % moved_thread.effective_l3_size[i1] == 1 * MiB);
+        expect(that % moved_thread.effective_l3_size[i4] == 4 * MiB / 4 + 7 * MiB);
+        expect(that % sizes.effective_l3_size[i5] == moved_thread.effective_l3_size[i5]);
+    };
+
+    "Missing resctrl"_test = [&]
+    {
+        SetResctrlRoot(SYS_SAGE_TEST_RESOURCE_DIR "/nonexistent");
+        expect(that % (1 == node.UpdateResctrlSettings()));
+        SetResctrlRoot("/sys/fs/resctrl");
+    };
+
+    std::filesystem::remove_all(resctrl);
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "sys-sage.hpp"
+
+#include <boost/ut.hpp>
+
+using namespace boost::ut;
+
+static suite<"sysfs"> _ = []
+{
+    Topology topo;
+    Node node{&topo};
+    expect(that % (0 == parseSysfsTopology(&node, SYS_SAGE_TEST_RESOURCE_DIR "/sysfs_2socket")) >> fatal);
+
+    for (const auto &[type, count] : std::vector{
+             std::tuple{SYS_SAGE_COMPONENT_CHIP, 2},
+             std::tuple{SYS_SAGE_COMPONENT_NUMA, 3},
+             std::tuple{SYS_SAGE_COMPONENT_CACHE, 10},
+             std::tuple{SYS_SAGE_COMPONENT_CORE, 4},
+             std::tuple{SYS_SAGE_COMPONENT_THREAD, 8},
+         })
+    {
+        std::vector<Component *> components;
+        topo.GetSubcomponentsByType(&components, type);
+        expect(that % _u(count) == components.size());
+    }
+
+    auto chip = dynamic_cast<Chip *>(node.GetChildById(1));
+    expect(that % (chip != nullptr) >> fatal);
+    expect(that % SYS_SAGE_CHIP_TYPE_CPU_SOCKET == chip->GetChipType());
+
+    auto numa = dynamic_cast<Numa *>(chip->GetChildByType(SYS_SAGE_COMPONENT_NUMA));
+    expect(that % (numa != nullptr) >> fatal);
+    expect(that % 1 == numa->GetId());
+    expect(that % numa->GetSize() == 16513360ll * 1024);
+
+    auto cacheL3 = dynamic_cast<Cache *>(numa->GetChildByType(SYS_SAGE_COMPONENT_CACHE));
+    expect(that % (cacheL3 != nullptr) >> fatal);
+    expect(that % 3 == cacheL3->GetCacheLevel());
+    expect(that % 11534336 == cacheL3->GetCacheSize());
+    expect(that % 11 == cacheL3->GetCacheAssociativityWays());
+    expect(that % 64 == cacheL3->GetCacheLineSize());
+    expect(that % 2_u == cacheL3->GetChildren()->size());
+
+    auto cacheL2 = dynamic_cast<Cache *>(cacheL3->GetChildByType(SYS_SAGE_COMPONENT_CACHE));
+    expect(that % (cacheL2 != nullptr) >> fatal);
+    expect(that % 2 == cacheL2->GetCacheLevel());
+    expect(that % 1048576 == cacheL2->GetCacheSize());
+    expect(that % 16 == cacheL2->GetCacheAssociativityWays());
+
+    auto cacheL1 = dynamic_cast<Cache *>(cacheL2->GetChildByType(SYS_SAGE_COMPONENT_CACHE));
+    expect(that % (cacheL1 != nullptr) >> fatal);
+    expect(that % 1 == cacheL1->GetCacheLevel());
+    expect(that % 32768 == cacheL1->GetCacheSize());
+    expect(that % 1_u == cacheL2->GetChildren()->size()) << "instruction caches are skipped";
+
+    auto core = dynamic_cast<Core *>(cacheL1->GetChildByType(SYS_SAGE_COMPONENT_CORE));
+    expect(that % (core != nullptr) >> fatal);
+    expect(that % 0 == core->GetId());
+
+    std::vector<Component *> threads;
+    core->GetSubcomponentsByType(&threads, SYS_SAGE_COMPONENT_THREAD);
+    expect(that % (2 == threads.size()) >> fatal);
+    expect(that % 2 == threads[0]->GetId());
+    expect(that % 6 == threads[1]->GetId());
+
+    "Cache ids are unique"_test = [&]
+    {
+        std::vector<Component *> caches;
+        topo.GetSubcomponentsByType(&caches, SYS_SAGE_COMPONENT_CACHE);
+        std::set<int> ids;
+        for (const auto &c : caches)
+            ids.insert(c->GetId());
+        expect(that % ids.size() == caches.size());
+    };
+
+    "Memory-only NUMA node"_test = [&]
+    {
+        auto memNuma = dynamic_cast<Numa *>(node.GetChildById(2));
+        expect(that % (memNuma != nullptr) >> fatal);
+        expect(that % SYS_SAGE_COMPONENT_NUMA == memNuma->GetComponentType());
+        expect(that % 0_u == memNuma->GetChildren()->size());
+    };
+
+    "Missing sysfs root"_test = []
+    {
+        Topology t;
+        Node n{&t};
+        expect(that % (1 == parseSysfsTopology(&n, SYS_SAGE_TEST_RESOURCE_DIR "/nonexistent")));
+    };
+
+    "Cpulists"_test = []
+    {
+        expect(that % (std::set<int>{0, 1, 2, 3, 8, 10, 11} == parseCpulist("0-3,8,10-11\n")));
+        expect(that % (std::set<int>{2, 5} == parseCpulist("5,x,3-,2,4y")));
+        expect(that % parseCpulist("\n").empty());
+    };
+};
@@ -0,0 +1,113 @@
+#include <boost/ut.hpp>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static constexpr long long NS = 1000000000ll;
+
+static suite<"timeseries"> _ = []
+{
+    "Ring buffer keeps the newest samples"_test = []
+    {
+        TimeSeries ts{4};
+        expect(that % 0_u == ts.GetSize());
+        expect(that % (ts.Get(0) == std::make_tuple(0ll, 0.0)));
+        for (int i = 0; i < 6; ++i)
+            ts.Add(i * NS, 100.0 + i);
+        expect(that % 4_u == ts.GetSize());
+        expect(that % 4_u == ts.GetCapacity());
+        expect(that % std::get<0>(ts.Get(0)) == 2 * NS);
+        expect(that % 102.0 == std::get<1>(ts.Get(0)));
+        expect(that % 105.0 == std::get<1>(ts.GetLast()));
+
+        auto samples = ts.GetSamples();
+        expect(that % (4 == samples.size()) >> fatal);
+        for (size_t i = 0; i < samples.size(); ++i)
+            expect(that % std::get<1>(samples[i]) == 102.0 + i);
+
+        ts.SetCapacity(2);
+        expect(that % 2_u == ts.GetSize());
+        expect(that % 104.0 == std::get<1>(ts.Get(0)));
+        ts.SetCapacity(8);
+        ts.Add(6 * NS, 106.0);
+        expect(that % 3_u == ts.GetSize());
+        expect(that % 106.0 == std::get<1>(ts.GetLast()));
+        expect(that % (ts.Get(3) == std::make_tuple(0ll, 0.0)));
+    };
+
+    "Windowed aggregates"_test = []
+    {
+        TimeSeries ts;
+        for (int i = 0; i < 10; ++i)
+            ts.Add(i * NS, (double)(i + 1));
+        expect(that % 1.0 == ts.Min());
+        expect(that % 10.0 == ts.Max());
+        expect(that % 5.5 == ts.Mean());
+        expect(that % 5.0 == ts.Percentile(50));
+        expect(that % 10.0 == ts.Percentile(100));
+        expect(that % 1.0 == ts.Percentile(0));
+
+        // last 3 seconds: samples at 6, 7, 8 and 9 s
+        expect(that % 7.0 == ts.Min(3));
+        expect(that % 10.0 == ts.Max(3));
+        expect(that % 8.5 == ts.Mean(3));
+        expect(that % 9.0 == ts.Percentile(75, 3));
+
+        TimeSeries empty;
+        expect(that % 0.0 == empty.Mean());
+    };
+
+    "Binary and base64 round trip"_test = []
+    {
+        TimeSeries ts{16};
+        for (int i = 0; i < 20; ++i)
+            ts.Add(1700000000000000000ll + i * 100000000ll + (i % 3), i < 10 ? 2100.0 : 2400.5 - i);
+
+        std::string bin = ts.Serialize();
+        // regular timestamps and mostly repeated values compress well below 16 B per sample
+        expect(bin.size() < 16 * 8u);
+
+        TimeSeries copy;
+        expect(that % (0 == copy.Deserialize(bin)) >> fatal);
+        expect(that % 16_u == copy.GetCapacity());
+        expect(that % (16 == copy.GetSize()) >> fatal);
+        for (size_t i = 0; i < ts.GetSize(); ++i)
+        {
+            expect(that % std::get<0>(ts.Get(i)) == std::get<0>(copy.Get(i)));
+            expect(that % std::get<1>(ts.Get(i)) == std::get<1>(copy.Get(i)));
+        }
+
+        TimeSeries copy64;
+        expect(that % (0 == copy64.FromBase64(ts.ToBase64())) >> fatal);
+        expect(that % 16_u == copy64.GetSize());
+        expect(that % ts.Mean() == copy64.Mean());
+
+        expect(that % (1 == copy.Deserialize("garbage")));
+        expect(that % 0_u == copy.GetSize());
+        expect(that % (1 == copy.Deserialize(bin.substr(0, bin.size() - 1))));
+    };
+
+    "XML export and import of freq_history"_test = []
+    {
+        Topology topo;
+        Core core{&topo, 0};
+        auto history = new TimeSeries{8};
+        for (int i = 0; i < 5; ++i)
+            history->Add(i * NS, 2000.0 + 100 * i);
+        core.attrib["freq_history"] = (void *)history;
+
+        std::string path = "timeseries.xml";
+        exportToXml(&topo, path);
+        Component *imported = importFromXml(path);
+        expect(that % (imported != nullptr) >> fatal);
+        auto c = imported->GetChild(0);
+        expect(that % (c != nullptr) >> fatal);
+        auto loaded = (TimeSeries *)c->attrib["freq_history"];
+        expect(that % (loaded != nullptr) >> fatal);
+        expect(that % 8_u == loaded->GetCapacity());
+        expect(that % (5 == loaded->GetSize()) >> fatal);
+        expect(that % 2400.0 == std::get<1>(loaded->GetLast()));
+        expect(that % std::get<0>(loaded->GetLast()) == 4 * NS);
+    };
+};
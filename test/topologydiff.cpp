@@ -0,0 +1,146 @@
+#include <boost/ut.hpp>
+
+#include "sys-sage.hpp"
+
+using namespace boost::ut;
+
+static Topology *buildTopology()
+{
+    Topology *topo = new Topology();
+    for (int id = 0; id < 2; id++)
+    {
+        Node *node = new Node(topo, id);
+        expect(that % (0 == parseHwlocOutput(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_hwloc.xml")) >> fatal);
+        expect(that % (0 == parseCapsNumaBenchmark(node, SYS_SAGE_TEST_RESOURCE_DIR "/skylake_caps_numa_benchmark.csv")) >> fatal);
+    }
+    return topo;
+}
+
+static int countOps(const vector<TopologyEdit> &edits, int op)
+{
+    return std::count_if(edits.begin(), edits.end(), [op](const TopologyEdit &e) { return e.op == op; });
+}
+
+static suite<"topologydiff"> _ = []
+{
+    "Component paths"_test = []
+    {
+        Topology *topo = buildTopology();
+        vector<Component *> threads = topo->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD);
+        expect(that % (threads.size() >= 2) >> fatal);
+        for (Component *t : threads)
+            expect(that % (FindComponentByPath(topo, GetComponentPath(t)) == t));
+        Component *node = topo->GetChild(1);
+        ComponentPath path = GetComponentPath(threads.back(), node);
+        expect(that % (FindComponentByPath(node, path) == threads.back()));
+        expect(that % (GetComponentPath(topo).empty()));
+        path.back().id = -5;
+        expect(that % (FindComponentByPath(node, path) == nullptr));
+        topo->Delete(true);
+    };
+
+    "Identical trees give an empty script"_test = []
+    {
+        Topology *a = buildTopology();
+        Topology *b = buildTopology();
+        vector<TopologyEdit> edits;
+        expect(that % (0 == DiffTopologies(a, b, &edits)));
+        expect(that % (edits.empty()));
+        Node *node = new Node(1);
+        expect(that % (1 == DiffTopologies(a, node, &edits)));
+        // the ids of the roots cannot be patched
+        expect(that % (1 == DiffTopologies(b->GetChild(0), node, &edits)));
+        expect(that % (edits.empty()));
+        node->Delete(true);
+        a->Delete(true);
+        b->Delete(true);
+    };
+
+    "The patch turns the old tree into the new one"_test = []
+    {
+        Topology *old_topo = buildTopology();
+        Topology *new_topo = buildTopology();
+        Component *n0 = new_topo->GetChild(0);
+        Component *n1 = new_topo->GetChild(1);
+
+        // a HW thread goes offline, a new one appears
+        vector<Component *> threads = n0->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD);
+        expect(that % (threads.size() >= 2) >> fatal);
+        threads[0]->Delete(true);
+        Component *core = threads[1]->GetParent();
+        Thread *added = new Thread(core, 1000);
+        // a cache is resized and gets an attribute
+        Cache *l3 = (Cache *)n1->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_CACHE)[0];
+        l3->SetCacheSize(l3->GetCacheSize() / 2);
+        uint64_t cos = 3;
+        l3->attrib["CATcos"] = &cos;
+        l3->MarkDirty();
+        // DataPaths are added, changed and removed
+        vector<Component *> numas = n1->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_NUMA);
+        expect(that % (numas.size() >= 2) >> fatal);
+        new DataPath(l3, numas[0], SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_PHYSICAL, 10.0, 5.0);
+        new DataPath(added, numas[1], SYS_SAGE_DATAPATH_ORIENTED, SYS_SAGE_DATAPATH_TYPE_LOGICAL, 1.0, 2.0);
+        vector<DataPath *> numa_dps = *numas[1]->GetDataPaths(SYS_SAGE_DATAPATH_OUTGOING);
+        expect(that % (numa_dps.size() >= 2) >> fatal);
+        numa_dps[0]->SetBandwidth(1234.5);
+        numas[1]->DeleteDataPath(numa_dps[1]);
+        // a subtree moves to the other Node, the children of a Core change their order
+        Component *moved = n1->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_CORE).back();
+        moved->GetParent()->RemoveChild(moved);
+        n0->InsertChild(moved);
+        vector<Component *> *core_children = core->GetChildren();
+        std::reverse(core_children->begin(), core_children->end());
+        core->MarkDirty();
+
+        uint64_t old_hash = old_topo->GetHash(SYS_SAGE_HASH_DATAPATHS);
+        vector<TopologyEdit> edits;
+        expect(that % (0 == DiffTopologies(old_topo, new_topo, &edits)));
+        // the script is much smaller than the trees
+        expect(that % (edits.size() < 20u));
+        expect(that % (1 == countOps(edits, SYS_SAGE_EDIT_REMOVE_COMPONENT)));
+        expect(that % (1 == countOps(edits, SYS_SAGE_EDIT_ADD_COMPONENT)));
+        expect(that % (countOps(edits, SYS_SAGE_EDIT_MOVE_COMPONENT) >= 1));
+        expect(that % (1 == countOps(edits, SYS_SAGE_EDIT_CHANGE_COMPONENT)));
+        expect(that % (2 == countOps(edits, SYS_SAGE_EDIT_ADD_DATAPATH)));
+        expect(that % (1 == countOps(edits, SYS_SAGE_EDIT_CHANGE_DATAPATH)));
+        expect(that % (countOps(edits, SYS_SAGE_EDIT_REMOVE_DATAPATH) >= 1));
+
+        // the unchanged Components stay in place
+        Component *kept = old_topo->GetChild(1)->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD)[0];
+        expect(that % (0 == PatchTopology(old_topo, edits)));
+        expect(that % (old_hash != old_topo->GetHash(SYS_SAGE_HASH_DATAPATHS)));
+        expect(that % (old_topo->GetHash(SYS_SAGE_HASH_DATAPATHS) == new_topo->GetHash(SYS_SAGE_HASH_DATAPATHS)));
+        expect(that % (kept == old_topo->GetChild(1)->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD)[0]));
+        expect(that % (0 == DiffTopologies(old_topo, new_topo, &edits)));
+        expect(that % (edits.empty()));
+
+        // the patched tree owns copies of the attribute values
+        Component *patched_l3 = old_topo->GetChild(1)->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_CACHE)[0];
+        expect(that % (patched_l3->attrib.count("CATcos") == 1) >> fatal);
+        expect(that % (patched_l3->attrib["CATcos"] != &cos));
+        expect(that % 3_u == *(uint64_t *)patched_l3->attrib["CATcos"]);
+        new_topo->Delete(true);
+        expect(that % 3_u == *(uint64_t *)patched_l3->attrib["CATcos"]);
+        DestroyAttributes(&patched_l3->attrib);
+        old_topo->Delete(true);
+    };
+
+    "A script that does not match the tree is rejected"_test = []
+    {
+        Topology *old_topo = buildTopology();
+        Topology *new_topo = buildTopology();
+        new_topo->GetChild(0)->GetAllSubcomponentsByType(SYS_SAGE_COMPONENT_THREAD)[0]->Delete(true);
+        vector<TopologyEdit> edits;
+        expect(that % (0 == DiffTopologies(old_topo, new_topo, &edits)));
+        expect(that % (1 == edits.size()));
+        Topology *other = new Topology();
+        Node *node = new Node(other, 5);
+        uint64_t hash = other->GetHash();
+        expect(that % (1 == PatchTopology(other, edits)));
+        expect(that % (hash == other->GetHash()));
+        node->Delete(true);
+        other->Delete(true);
+        old_topo->Delete(true);
+        new_topo->Delete(true);
+    };
+};